@@ -11,13 +11,31 @@ Author: Elliott Hong <s.hong@digipen.edu>
 Creation date: Sep 29, 2021
 End Header ---------------------------------------------------------*/
 #version 450 core
+#extension GL_ARB_bindless_texture : enable
 out vec4 FragColor;
 
-struct Material {
-    sampler2D diffuse;
-    sampler2D specular;
-    sampler2D grid;
-}; 
+// Material textures live in texture array pools; a reference packs
+// (pool << 16) | layer and is -1 until the texture is resident
+struct MaterialData {
+    int diffuse;
+    int specular;
+    int normal;
+    int flags;
+    vec4 color;
+    vec4 emissive;
+    vec4 ka;
+    vec4 kd;
+    vec4 ks;
+};
+#define MATERIAL_TEXTURED 1
+
+layout (std430, binding = 3) readonly buffer Materials { MaterialData materials[]; };
+#ifdef GL_ARB_bindless_texture
+layout (std430, binding = 4) readonly buffer TexturePools { sampler2DArray texturePools[]; };
+#else
+layout (binding = 8) uniform sampler2DArray texturePools[8];
+#endif
+uniform int materialIndex;
 
 struct Light {
     vec3 position;
@@ -52,15 +70,14 @@ in vec3 EPos;
 in vec3 Enorm;
 
 uniform vec3 globalAmbient;
-uniform vec3 Emissive;
-uniform vec3 Ka;
-uniform vec3 Kd;
-uniform vec3 Ks;
+vec3 Emissive;
+vec3 Ka;
+vec3 Kd;
+vec3 Ks;
 uniform vec3 viewPos;
 uniform vec3 min_;
 uniform vec3 max_;
 uniform Light Lights[NR_POINT_LIGHTS];
-uniform Material material;
 uniform int lightNum;
 uniform int lightType;
 uniform bool bCalcUV;
@@ -74,7 +91,8 @@ uniform int isShading;
 uniform float fresnel;
 uniform float inputRatio;
 uniform float mixRatio;
-uniform sampler2D cube[6];
+// Environment faces, one layer per face
+layout (binding = 4) uniform sampler2DArray cube;
 
 vec3 CalcDirLight(Light light, vec3 normal, vec3 viewDir, vec3 FragPos);
 vec3 CalcPointLight(Light light, vec3 normal, vec3 fragPos, vec3 viewDir);
@@ -89,9 +107,30 @@ vec2 calcPlanarUV(vec3 centVec);
 
 vec2 FragTexCoord;
 int planeNum;
+MaterialData material;
+
+MaterialData getMaterial()
+{
+    if (materialIndex < 0)
+        return MaterialData(-1, -1, -1, 0, vec4(1.0), vec4(0.0), vec4(0.0), vec4(1.0), vec4(1.0));
+    return materials[materialIndex];
+}
+
+// materialIndex is uniform, so the pool index is dynamically uniform
+vec4 sampleMaterial(int ref, vec2 uv)
+{
+    if (ref < 0)
+        return vec4(0.5);
+    return texture(texturePools[ref >> 16], vec3(uv, ref & 0xFFFF));
+}
 
 void main()
 {    
+    material = getMaterial();
+    Emissive = material.emissive.rgb;
+    Ka = material.ka.rgb;
+    Kd = material.kd.rgb;
+    Ks = material.ks.rgb;
     vec3 norm = normalize(Normal);
     vec3 viewDir = normalize(viewPos - FragPos);
     vec3 color = vec3(0.f);
@@ -103,7 +142,7 @@ void main()
         vec3 reflectVec = 2 * dot(viewDir, norm) * norm - viewDir;
         vec2 envUV = calcCubeMap(reflectVec);
 
-        color = texture(cube[planeNum], envUV).rgb;
+        color = texture(cube, vec3(envUV, planeNum)).rgb;
     }
     else if(bShowReflect == false && bShowRefract == true)
     {
@@ -111,13 +150,13 @@ void main()
         vec3 refractVec = CalcRefract(-viewDir, norm, ratio);
         vec2 envUV = calcCubeMap(refractVec);
 
-        color = texture(cube[planeNum], envUV).rgb;
+        color = texture(cube, vec3(envUV, planeNum)).rgb;
     }
     else if(bShowReflect == true && bShowRefract == true)
     {
         vec3 reflectVec = 2 * dot(viewDir, norm) * norm - viewDir;
         vec2 reflectUV = calcCubeMap(reflectVec);
-        reflectColor = texture(cube[planeNum], reflectUV).rgb;
+        reflectColor = texture(cube, vec3(reflectUV, planeNum)).rgb;
 
         float ratio = 1.f / inputRatio;
         vec3 refractVec[3];
@@ -131,9 +170,9 @@ void main()
         refractUV[2] = calcCubeMap(refractVec[2]);
 
         refractColor = vec3(0.f);
-        refractColor.r = texture(cube[planeNum], refractUV[0]).r;
-        refractColor.g = texture(cube[planeNum], refractUV[1]).g;
-        refractColor.b = texture(cube[planeNum], refractUV[2]).b;
+        refractColor.r = texture(cube, vec3(refractUV[0], planeNum)).r;
+        refractColor.g = texture(cube, vec3(refractUV[1], planeNum)).g;
+        refractColor.b = texture(cube, vec3(refractUV[2], planeNum)).b;
 
         color = mix(reflectColor, refractColor, mixRatio);
     }
@@ -220,7 +259,7 @@ vec3 CalcDirLight(Light light, vec3 normal, vec3 viewDir, vec3 fragPos)
     float Ks_r = 0.f;
     if(dot(normal, lightDir) > 0.0)
     {
-        Ks_r = texture(material.specular, FragTexCoord).r;
+        Ks_r = sampleMaterial(material.specular, FragTexCoord).r;
         spec = pow(max(dot(viewDir, halfVec), 0.0), Ks_r*Ks_r*32);
     }
     else
@@ -232,15 +271,15 @@ vec3 CalcDirLight(Light light, vec3 normal, vec3 viewDir, vec3 fragPos)
     {
         if(bShowUV)
         {
-            ambient = light.ambient * vec3(texture(material.grid, FragTexCoord))/16;
-            diffuse = Kd * light.diffuse * diff * vec3(texture(material.grid, FragTexCoord));
-            specular = Ks * light.specular * pow(max(dot(normal, halfVec),0.0),32) * vec3(texture(material.grid, FragTexCoord));
+            ambient = light.ambient * vec3(sampleMaterial(material.diffuse, FragTexCoord))/16;
+            diffuse = Kd * light.diffuse * diff * vec3(sampleMaterial(material.diffuse, FragTexCoord));
+            specular = Ks * light.specular * pow(max(dot(normal, halfVec),0.0),32) * vec3(sampleMaterial(material.diffuse, FragTexCoord));
         }
         else
         { 
-            ambient = light.ambient * vec3(texture(material.diffuse, FragTexCoord))/16;
-            diffuse = Kd * light.diffuse * diff * vec3(texture(material.diffuse, FragTexCoord));
-            specular = Ks * light.specular * spec * vec3(texture(material.specular, FragTexCoord));
+            ambient = light.ambient * vec3(sampleMaterial(material.diffuse, FragTexCoord))/16;
+            diffuse = Kd * light.diffuse * diff * vec3(sampleMaterial(material.diffuse, FragTexCoord));
+            specular = Ks * light.specular * spec * vec3(sampleMaterial(material.specular, FragTexCoord));
         }
     }
     else
@@ -266,7 +305,7 @@ vec3 CalcPointLight(Light light, vec3 normal, vec3 fragPos, vec3 viewDir)
     float Ks_r = 0.f;
     if(dot(normal, lightDir) > 0.0)
     {
-        Ks_r = texture(material.specular, FragTexCoord).r;
+        Ks_r = sampleMaterial(material.specular, FragTexCoord).r;
         spec = pow(max(dot(viewDir, halfVec), 0.0), Ks_r*Ks_r*32);
     }
     else 
@@ -282,15 +321,15 @@ vec3 CalcPointLight(Light light, vec3 normal, vec3 fragPos, vec3 viewDir)
     {
         if(bShowUV)
         {
-            ambient = light.ambient * vec3(texture(material.grid, FragTexCoord))/16;
-            diffuse = Kd * light.diffuse * diff * vec3(texture(material.grid, FragTexCoord));
-            specular = Ks * light.specular * pow(max(dot(normal, halfVec),0.0),32) * vec3(texture(material.grid, FragTexCoord));
+            ambient = light.ambient * vec3(sampleMaterial(material.diffuse, FragTexCoord))/16;
+            diffuse = Kd * light.diffuse * diff * vec3(sampleMaterial(material.diffuse, FragTexCoord));
+            specular = Ks * light.specular * pow(max(dot(normal, halfVec),0.0),32) * vec3(sampleMaterial(material.diffuse, FragTexCoord));
         }
         else
         { 
-            ambient = light.ambient * vec3(texture(material.diffuse, FragTexCoord))/16;
-            diffuse = Kd * light.diffuse * diff * vec3(texture(material.diffuse, FragTexCoord));
-            specular = Ks * light.specular * spec * vec3(texture(material.specular, FragTexCoord));
+            ambient = light.ambient * vec3(sampleMaterial(material.diffuse, FragTexCoord))/16;
+            diffuse = Kd * light.diffuse * diff * vec3(sampleMaterial(material.diffuse, FragTexCoord));
+            specular = Ks * light.specular * spec * vec3(sampleMaterial(material.specular, FragTexCoord));
         }
     }
     else
@@ -317,7 +356,7 @@ vec3 CalcSpotLight(Light light, vec3 normal, vec3 fragPos, vec3 viewDir)
     float Ks_r = 0.f;
     if(dot(normal, lightDir) > 0.0)
     {
-        Ks_r = texture(material.specular, FragTexCoord).r;
+        Ks_r = sampleMaterial(material.specular, FragTexCoord).r;
         spec = pow(max(dot(viewDir, halfVec), 0.0), Ks_r*Ks_r*32);
     }
     else
@@ -337,15 +376,15 @@ vec3 CalcSpotLight(Light light, vec3 normal, vec3 fragPos, vec3 viewDir)
     {
         if(bShowUV)
         {
-            ambient = light.ambient * vec3(texture(material.grid, FragTexCoord))/16;
-            diffuse = Kd * light.diffuse * diff * vec3(texture(material.grid, FragTexCoord));
-            specular = Ks * light.specular * pow(max(dot(normal, halfVec),0.0),32) * vec3(texture(material.grid, FragTexCoord));
+            ambient = light.ambient * vec3(sampleMaterial(material.diffuse, FragTexCoord))/16;
+            diffuse = Kd * light.diffuse * diff * vec3(sampleMaterial(material.diffuse, FragTexCoord));
+            specular = Ks * light.specular * pow(max(dot(normal, halfVec),0.0),32) * vec3(sampleMaterial(material.diffuse, FragTexCoord));
         }
         else
         { 
-            ambient = light.ambient * vec3(texture(material.diffuse, FragTexCoord))/16;
-            diffuse = Kd * light.diffuse * diff * vec3(texture(material.diffuse, FragTexCoord));
-            specular = Ks * light.specular * spec * vec3(texture(material.specular, FragTexCoord));
+            ambient = light.ambient * vec3(sampleMaterial(material.diffuse, FragTexCoord))/16;
+            diffuse = Kd * light.diffuse * diff * vec3(sampleMaterial(material.diffuse, FragTexCoord));
+            specular = Ks * light.specular * spec * vec3(sampleMaterial(material.specular, FragTexCoord));
         }
     }
     else
@@ -0,0 +1,19 @@
+/* Start Header -------------------------------------------------------
+Copyright (C) 2021 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the prior written
+consent of DigiPen Institute of Technology is prohibited.
+File Name: fallback.frag
+Purpose: This file is fragment shader for the stand-in of programs still compiling
+Language: glsl
+Platform: OpenGL 4.5
+Project:  HGraphics
+Author: Elliott Hong <s.hong@digipen.edu>
+Creation date: Oct 19, 2026
+End Header ---------------------------------------------------------*/
+#version 450 core
+out vec4 FragColor;
+
+void main()
+{
+    FragColor = vec4(0.5, 0.5, 0.5, 1.0);
+}
@@ -0,0 +1,55 @@
+/* Start Header -------------------------------------------------------
+Copyright (C) 2021 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the prior written
+consent of DigiPen Institute of Technology is prohibited.
+File Name: fallback.vert
+Purpose: This file is vertex shader for the stand-in of programs still compiling
+Language: glsl
+Platform: OpenGL 4.5
+Project:  HGraphics
+Author: Elliott Hong <s.hong@digipen.edu>
+Creation date: Oct 19, 2026
+End Header ---------------------------------------------------------*/
+#version 450 core
+layout (location = 0) in vec3 aPos;
+layout (location = 4) in uint aInstanceID;
+
+// Dequantization constants of the mesh, see VertexQuantizer; identity for float meshes
+layout (location = 5) in vec4 aPositionOffset;
+layout (location = 6) in vec4 aPositionScale;
+
+// Culled instances of GPUCuller draws, read when bInstanced is set as in geometry.vert
+struct Instance
+{
+    mat4 model;
+    vec4 boundsMin;
+    vec4 boundsMax;
+    uvec4 meshIndex;
+};
+layout (std430, binding = 0) readonly buffer Instances { Instance instances[]; };
+uniform bool bInstanced;
+
+// Same instance records as the other scene shaders, instanceBase is -1 for direct draws
+struct QueuedInstance
+{
+    mat4 model;
+    mat4 normalMatrix;
+    vec4 color;
+};
+layout (std430, binding = 6) readonly buffer QueuedInstances { QueuedInstance queued[]; };
+uniform int instanceBase;
+
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+
+void main()
+{
+    vec3 position = aPositionOffset.xyz + aPos * aPositionScale.xyz;
+    mat4 M = model;
+    if (bInstanced)
+        M = instances[aInstanceID].model;
+    else if (instanceBase >= 0)
+        M = queued[instanceBase + gl_InstanceID].model;
+    gl_Position = projection * view * M * vec4(position, 1.0);
+}
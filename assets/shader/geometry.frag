@@ -11,16 +11,33 @@ Author: Elliott Hong <s.hong@digipen.edu>
 Creation date: Jan 8, 2022
 End Header ---------------------------------------------------------*/
 #version 450 core
+#extension GL_ARB_bindless_texture : enable
 layout (location = 0) out vec4 gPosition;
 layout (location = 1) out vec4 gNormal;
 layout (location = 2) out vec4 gAlbedo;
 
-uniform vec3 diffColor;
+// Material textures live in texture array pools; a reference packs
+// (pool << 16) | layer and is -1 until the texture is resident
+struct MaterialData {
+    int diffuse;
+    int specular;
+    int normal;
+    int flags;
+    vec4 color;
+    vec4 emissive;
+    vec4 ka;
+    vec4 kd;
+    vec4 ks;
+};
+#define MATERIAL_TEXTURED 1
 
-uniform sampler2D texture_diff;
-uniform sampler2D texture_normal;
-
-uniform int isWithTexture;
+layout (std430, binding = 3) readonly buffer Materials { MaterialData materials[]; };
+#ifdef GL_ARB_bindless_texture
+layout (std430, binding = 4) readonly buffer TexturePools { sampler2DArray texturePools[]; };
+#else
+layout (binding = 8) uniform sampler2DArray texturePools[8];
+#endif
+uniform int materialIndex;
 
 float near = 10;
 float far = 10000.0;
@@ -30,13 +47,28 @@ in vec3 Normal;
 in vec2 FragUV;
 in vec3 Tangents;
 
+MaterialData getMaterial()
+{
+    if (materialIndex < 0)
+        return MaterialData(-1, -1, -1, 0, vec4(1.0), vec4(0.0), vec4(0.0), vec4(1.0), vec4(1.0));
+    return materials[materialIndex];
+}
+
+vec4 sampleMaterial(int ref, vec2 uv, vec4 fallback)
+{
+    if (ref < 0)
+        return fallback;
+    return texture(texturePools[ref >> 16], vec3(uv, ref & 0xFFFF));
+}
+
 void main()
 {
-    if(isWithTexture == 1.0)
+    MaterialData material = getMaterial();
+    if((material.flags & MATERIAL_TEXTURED) != 0)
     {
-        gAlbedo = vec4(texture(texture_diff, FragUV * 4.0).rgb, 1.0);
+        gAlbedo = vec4(sampleMaterial(material.diffuse, FragUV * 4.0, vec4(0.5)).rgb, 1.0);
 
-        vec3 delta = texture(texture_normal, FragUV * 4.0).xyz;
+        vec3 delta = sampleMaterial(material.normal, FragUV * 4.0, vec4(0.5, 0.5, 1.0, 1.0)).xyz;
 
         delta = delta * 2.0 - vec3(1.0);
         vec3 T = normalize(Tangents);
@@ -49,7 +81,7 @@ void main()
     }
     else
     {
-        gAlbedo = vec4(diffColor, 1.0);
+        gAlbedo = vec4(material.color.rgb, 1.0);
         gNormal = vec4(Normal * 0.5 + 0.5, 1.0);
     }
 
@@ -15,6 +15,22 @@ layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec2 aTexCoords;
 layout (location = 3) in vec3 aTangents;
+layout (location = 4) in uint aInstanceID;
+
+// Dequantization constants of the mesh, see VertexQuantizer; identity for float meshes.
+// Offset w is 1 when the normal is octahedral
+layout (location = 5) in vec4 aPositionOffset;
+layout (location = 6) in vec4 aPositionScale;
+layout (location = 7) in vec4 aUVDecode;
+
+struct Instance
+{
+    mat4 model;
+    vec4 boundsMin;
+    vec4 boundsMax;
+    uvec4 meshIndex;
+};
+layout (std430, binding = 0) readonly buffer Instances { Instance instances[]; };
 
 out vec3 FragPos;
 out vec3 Normal;
@@ -24,13 +40,38 @@ out vec3 Tangents;
 uniform mat4 model;
 uniform mat4 view;
 uniform mat4 projection;
+uniform bool bInstanced;
+
+vec3 decodePosition(vec3 p)
+{
+    return aPositionOffset.xyz + p * aPositionScale.xyz;
+}
+
+vec3 decodeNormal(vec3 n)
+{
+    if (aPositionOffset.w == 0.0)
+        return n;
+    vec3 o = vec3(n.xy, 1.0 - abs(n.x) - abs(n.y));
+    float t = max(-o.z, 0.0);
+    o.xy += vec2(o.x >= 0.0 ? -t : t, o.y >= 0.0 ? -t : t);
+    return normalize(o);
+}
+
+vec2 decodeUV(vec2 uv)
+{
+    return aUVDecode.xy + uv * aUVDecode.zw;
+}
 
 void main()
 {
-    FragPos = vec3(model * vec4(aPos, 1.0));
-    Normal = mat3(transpose(inverse(model))) * aNormal;
-    FragUV = aTexCoords;
-    Tangents = mat3(model) * aTangents;
+    vec3 position = decodePosition(aPos);
+    vec3 normal = decodeNormal(aNormal);
+    vec2 texCoords = decodeUV(aTexCoords);
+    mat4 M = bInstanced ? instances[aInstanceID].model : model;
+    FragPos = vec3(M * vec4(position, 1.0));
+    Normal = mat3(transpose(inverse(M))) * normal;
+    FragUV = texCoords;
+    Tangents = mat3(M) * aTangents;
     gl_Position = projection * view * vec4(FragPos, 1.0);
 }
 
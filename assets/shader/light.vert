@@ -11,7 +11,11 @@ Author: Elliott Hong <s.hong@digipen.edu>
 Creation date: Jan 8, 2022
 End Header ---------------------------------------------------------*/
 #version 450 core
-in vec3 position;
+layout (location = 0) in vec3 position;
+
+// Dequantization constants of the mesh, see VertexQuantizer; identity for float meshes
+layout (location = 5) in vec4 aPositionOffset;
+layout (location = 6) in vec4 aPositionScale;
 
 uniform mat4 mView;
 uniform mat4 projection;
@@ -19,7 +23,12 @@ uniform mat4 projection;
 uniform vec3 worldPos;
 uniform float radius;
 
+vec3 decodePosition(vec3 p)
+{
+    return aPositionOffset.xyz + p * aPositionScale.xyz;
+}
+
 void main() {
-	vec3 wPos = (position * radius) + worldPos;
+	vec3 wPos = (decodePosition(position) * radius) + worldPos;
 	gl_Position = projection * mView * vec4(wPos, 1.0);
 }
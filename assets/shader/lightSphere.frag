@@ -13,9 +13,9 @@ End Header ---------------------------------------------------------*/
 #version 450 core
 out vec4 FragColor;
 
-uniform vec3 objectColor;
+flat in vec3 Color;
 
 void main()
 {
-    FragColor = vec4(objectColor, 1.0);
+    FragColor = vec4(Color, 1.0);
 }
\ No newline at end of file
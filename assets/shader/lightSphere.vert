@@ -14,11 +14,43 @@ End Header ---------------------------------------------------------*/
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aNormal;
 
+// Dequantization constants of the mesh, see VertexQuantizer; identity for float meshes
+layout (location = 5) in vec4 aPositionOffset;
+layout (location = 6) in vec4 aPositionScale;
+
+// Render queue draws read one record per instance; direct draws set
+// instanceBase to -1 and use model and objectColor
+struct QueuedInstance
+{
+    mat4 model;
+    mat4 normalMatrix;
+    vec4 color;
+};
+layout (std430, binding = 6) readonly buffer QueuedInstances { QueuedInstance queued[]; };
+uniform int instanceBase;
+
 uniform mat4 model;
 uniform mat4 view;
 uniform mat4 projection;
+uniform vec3 objectColor;
+
+flat out vec3 Color;
+
+vec3 decodePosition(vec3 p)
+{
+    return aPositionOffset.xyz + p * aPositionScale.xyz;
+}
 
 void main()
 {
-    gl_Position = projection * view * model * vec4(aPos, 1.0);
+    vec3 position = decodePosition(aPos);
+    mat4 M = model;
+    Color = objectColor;
+    if (instanceBase >= 0)
+    {
+        QueuedInstance instance = queued[instanceBase + gl_InstanceID];
+        M = instance.model;
+        Color = instance.color.rgb;
+    }
+    gl_Position = projection * view * M * vec4(position, 1.0);
 }
\ No newline at end of file
@@ -11,19 +11,43 @@ Author: Elliott Hong <s.hong@digipen.edu>
 Creation date: Sep 29, 2021
 End Header ---------------------------------------------------------*/
 #version 450 core
+#extension GL_ARB_bindless_texture : enable
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec2 aTexCoords;
 
+// Dequantization constants of the mesh, see VertexQuantizer; identity for float meshes.
+// Offset w is 1 when the normal is octahedral
+layout (location = 5) in vec4 aPositionOffset;
+layout (location = 6) in vec4 aPositionScale;
+layout (location = 7) in vec4 aUVDecode;
+
 out VS_OUT {
     vec3 outColor;
 } vs_out;
 
-struct Material {
-    sampler2D diffuse;
-    sampler2D specular;
-    sampler2D grid;
-}; 
+// Material textures live in texture array pools; a reference packs
+// (pool << 16) | layer and is -1 until the texture is resident
+struct MaterialData {
+    int diffuse;
+    int specular;
+    int normal;
+    int flags;
+    vec4 color;
+    vec4 emissive;
+    vec4 ka;
+    vec4 kd;
+    vec4 ks;
+};
+#define MATERIAL_TEXTURED 1
+
+layout (std430, binding = 3) readonly buffer Materials { MaterialData materials[]; };
+#ifdef GL_ARB_bindless_texture
+layout (std430, binding = 4) readonly buffer TexturePools { sampler2DArray texturePools[]; };
+#else
+layout (binding = 8) uniform sampler2DArray texturePools[8];
+#endif
+uniform int materialIndex;
 
 struct Light {
     vec3 position;
@@ -58,15 +82,14 @@ in vec3 EPos;
 in vec3 Enorm;
 
 uniform vec3 globalAmbient;
-uniform vec3 Emissive;
-uniform vec3 Ka;
-uniform vec3 Kd;
-uniform vec3 Ks;
+vec3 Emissive;
+vec3 Ka;
+vec3 Kd;
+vec3 Ks;
 uniform vec3 viewPos;
 uniform vec3 min_;
 uniform vec3 max_;
 uniform Light Lights[NR_POINT_LIGHTS];
-uniform Material material;
 uniform int lightNum;
 uniform int lightType;
 uniform bool bCalcUV;
@@ -85,25 +108,81 @@ vec2 calcCylindricalUV(vec3 centVec);
 vec2 calcSphericalUV(vec3 centVec);
 vec2 calcPlanarUV(vec3 centVec);
 
-uniform mat3 normalMatrix;
-uniform mat4 model;
+mat3 normalMatrix;
+// Drawn through the render queue, one record per instance
+struct QueuedInstance
+{
+    mat4 model;
+    mat4 normalMatrix;
+    vec4 color;
+};
+layout (std430, binding = 6) readonly buffer QueuedInstances { QueuedInstance queued[]; };
+uniform int instanceBase;
+mat4 model;
 uniform mat4 view;
 uniform mat4 projection;
 
 vec2 FragTexCoord;
+MaterialData material;
+
+MaterialData getMaterial()
+{
+    if (materialIndex < 0)
+        return MaterialData(-1, -1, -1, 0, vec4(1.0), vec4(0.0), vec4(0.0), vec4(1.0), vec4(1.0));
+    return materials[materialIndex];
+}
+
+// Vertex stage has no derivatives, so sample the top level
+vec4 sampleMaterial(int ref, vec2 uv)
+{
+    if (ref < 0)
+        return vec4(0.5);
+    return textureLod(texturePools[ref >> 16], vec3(uv, ref & 0xFFFF), 0.0);
+}
+
+vec3 decodePosition(vec3 p)
+{
+    return aPositionOffset.xyz + p * aPositionScale.xyz;
+}
+
+vec3 decodeNormal(vec3 n)
+{
+    if (aPositionOffset.w == 0.0)
+        return n;
+    vec3 o = vec3(n.xy, 1.0 - abs(n.x) - abs(n.y));
+    float t = max(-o.z, 0.0);
+    o.xy += vec2(o.x >= 0.0 ? -t : t, o.y >= 0.0 ? -t : t);
+    return normalize(o);
+}
+
+vec2 decodeUV(vec2 uv)
+{
+    return aUVDecode.xy + uv * aUVDecode.zw;
+}
 
 void main(){
+    vec3 position = decodePosition(aPos);
+    vec3 normal = decodeNormal(aNormal);
+    vec2 texCoords = decodeUV(aTexCoords);
+    QueuedInstance instance = queued[instanceBase + gl_InstanceID];
+    model = instance.model;
+    normalMatrix = mat3(instance.normalMatrix);
+    material = getMaterial();
+    Emissive = material.emissive.rgb;
+    Ka = material.ka.rgb;
+    Kd = material.kd.rgb;
+    Ks = material.ks.rgb;
     
-    vec4 vertPos = model * vec4(aPos, 1.0);
-    vec3 norm = normalMatrix * aNormal;
+    vec4 vertPos = model * vec4(position, 1.0);
+    vec3 norm = normalMatrix * normal;
     vec3 viewDir = normalize(viewPos - vertPos.xyz);
 
-    FragTexCoord = aTexCoords;
+    FragTexCoord = texCoords;
     vec3 EntityPos;
     if(bCalcPos)
-        EntityPos = aPos;
+        EntityPos = position;
     else
-        EntityPos = aNormal;
+        EntityPos = normal;
 
     if(bCalcUV)
     {
@@ -124,7 +203,7 @@ void main(){
         }
     }
     else
-        FragTexCoord = aTexCoords;
+        FragTexCoord = texCoords;
     vec3 result = vec3(0.f);
     vec3 fogResult = vec3(0.f);
     fogResult += CalcFog(norm, vertPos.xyz, viewDir);
@@ -167,7 +246,7 @@ vec3 CalcDirLight(Light light, vec3 normal, vec3 viewDir, vec3 fragPos)
     float Ks_r = 0.f;
     if(dot(normal, lightDir) > 0.0)
     {
-        Ks_r = texture(material.specular, FragTexCoord).r;
+        Ks_r = sampleMaterial(material.specular, FragTexCoord).r;
         spec = pow(max(dot(viewDir, reflectDir), 0.0), Ks_r*Ks_r*32+0.00001);
     }
     else
@@ -180,15 +259,15 @@ vec3 CalcDirLight(Light light, vec3 normal, vec3 viewDir, vec3 fragPos)
     {
         if(bShowUV)
         {
-            ambient = light.ambient * vec3(texture(material.grid, FragTexCoord))/16;
-            diffuse = Kd * light.diffuse * diff * vec3(texture(material.grid, FragTexCoord));
-            specular = Ks * light.specular * pow(max(dot(viewDir, reflectDir),0.0),32) * vec3(texture(material.grid, FragTexCoord));
+            ambient = light.ambient * vec3(sampleMaterial(material.diffuse, FragTexCoord))/16;
+            diffuse = Kd * light.diffuse * diff * vec3(sampleMaterial(material.diffuse, FragTexCoord));
+            specular = Ks * light.specular * pow(max(dot(viewDir, reflectDir),0.0),32) * vec3(sampleMaterial(material.diffuse, FragTexCoord));
         }
         else
         { 
-            ambient = light.ambient * vec3(texture(material.diffuse, FragTexCoord))/16;
-            diffuse = Kd * light.diffuse * diff * vec3(texture(material.diffuse, FragTexCoord));
-            specular = Ks * light.specular * spec * vec3(texture(material.specular, FragTexCoord));
+            ambient = light.ambient * vec3(sampleMaterial(material.diffuse, FragTexCoord))/16;
+            diffuse = Kd * light.diffuse * diff * vec3(sampleMaterial(material.diffuse, FragTexCoord));
+            specular = Ks * light.specular * spec * vec3(sampleMaterial(material.specular, FragTexCoord));
         }
     }
     else
@@ -213,7 +292,7 @@ vec3 CalcPointLight(Light light, vec3 normal, vec3 fragPos, vec3 viewDir)
     float Ks_r = 0.f;
     if(dot(normal, lightDir) > 0.0)
     {
-        Ks_r = texture(material.specular, FragTexCoord).r;
+        Ks_r = sampleMaterial(material.specular, FragTexCoord).r;
         spec = pow(max(dot(viewDir, reflectDir), 0.0), Ks_r*Ks_r*32+0.00001);
     }
     else 
@@ -229,15 +308,15 @@ vec3 CalcPointLight(Light light, vec3 normal, vec3 fragPos, vec3 viewDir)
     {
         if(bShowUV)
         {
-            ambient = light.ambient * vec3(texture(material.grid, FragTexCoord))/16;
-            diffuse = Kd * light.diffuse * diff * vec3(texture(material.grid, FragTexCoord));
-            specular = Ks * light.specular * pow(max(dot(viewDir, reflectDir),0.0),32) * vec3(texture(material.grid, FragTexCoord));
+            ambient = light.ambient * vec3(sampleMaterial(material.diffuse, FragTexCoord))/16;
+            diffuse = Kd * light.diffuse * diff * vec3(sampleMaterial(material.diffuse, FragTexCoord));
+            specular = Ks * light.specular * pow(max(dot(viewDir, reflectDir),0.0),32) * vec3(sampleMaterial(material.diffuse, FragTexCoord));
         }
         else
         { 
-            ambient = light.ambient * vec3(texture(material.diffuse, FragTexCoord))/16;
-            diffuse = Kd * light.diffuse * diff * vec3(texture(material.diffuse, FragTexCoord));
-            specular = Ks * light.specular * spec * vec3(texture(material.specular, FragTexCoord));
+            ambient = light.ambient * vec3(sampleMaterial(material.diffuse, FragTexCoord))/16;
+            diffuse = Kd * light.diffuse * diff * vec3(sampleMaterial(material.diffuse, FragTexCoord));
+            specular = Ks * light.specular * spec * vec3(sampleMaterial(material.specular, FragTexCoord));
         }
     }
     else
@@ -264,7 +343,7 @@ vec3 CalcSpotLight(Light light, vec3 normal, vec3 fragPos, vec3 viewDir)
     float Ks_r = 0.f;
     if(dot(normal, lightDir) > 0.0)
     {
-        Ks_r = texture(material.specular, FragTexCoord).r;
+        Ks_r = sampleMaterial(material.specular, FragTexCoord).r;
         spec = pow(max(dot(viewDir, reflectDir), 0.0), Ks_r*Ks_r*32+0.00001);
     }
     else
@@ -284,15 +363,15 @@ vec3 CalcSpotLight(Light light, vec3 normal, vec3 fragPos, vec3 viewDir)
     {
         if(bShowUV)
         {
-            ambient = light.ambient * vec3(texture(material.grid, FragTexCoord))/16;
-            diffuse = Kd * light.diffuse * diff * vec3(texture(material.grid, FragTexCoord));
-            specular = Ks * light.specular * pow(max(dot(viewDir, reflectDir),0.0),32) * vec3(texture(material.grid, FragTexCoord));
+            ambient = light.ambient * vec3(sampleMaterial(material.diffuse, FragTexCoord))/16;
+            diffuse = Kd * light.diffuse * diff * vec3(sampleMaterial(material.diffuse, FragTexCoord));
+            specular = Ks * light.specular * pow(max(dot(viewDir, reflectDir),0.0),32) * vec3(sampleMaterial(material.diffuse, FragTexCoord));
         }
         else
         { 
-            ambient = light.ambient * vec3(texture(material.diffuse, FragTexCoord))/16;
-            diffuse = Kd * light.diffuse * diff * vec3(texture(material.diffuse, FragTexCoord));
-            specular = Ks * light.specular * spec * vec3(texture(material.specular, FragTexCoord));
+            ambient = light.ambient * vec3(sampleMaterial(material.diffuse, FragTexCoord))/16;
+            diffuse = Kd * light.diffuse * diff * vec3(sampleMaterial(material.diffuse, FragTexCoord));
+            specular = Ks * light.specular * spec * vec3(sampleMaterial(material.specular, FragTexCoord));
         }
     }
     else
@@ -15,26 +15,66 @@ layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec2 aTexCoords;
 
+// Dequantization constants of the mesh, see VertexQuantizer; identity for float meshes.
+// Offset w is 1 when the normal is octahedral
+layout (location = 5) in vec4 aPositionOffset;
+layout (location = 6) in vec4 aPositionScale;
+layout (location = 7) in vec4 aUVDecode;
+
 out vec3 FragPos;
 out vec3 Normal;
 out vec2 TexCoords;
 out vec3 EPos;
 out vec3 Enorm;
 
-uniform mat4 model;
+// Drawn through the render queue, one record per instance
+struct QueuedInstance
+{
+    mat4 model;
+    mat4 normalMatrix;
+    vec4 color;
+};
+layout (std430, binding = 6) readonly buffer QueuedInstances { QueuedInstance queued[]; };
+uniform int instanceBase;
+mat4 model;
 uniform mat4 view;
 uniform mat4 projection;
-uniform mat3 normalMatrix;
+mat3 normalMatrix;
+
+vec3 decodePosition(vec3 p)
+{
+    return aPositionOffset.xyz + p * aPositionScale.xyz;
+}
 
+vec3 decodeNormal(vec3 n)
+{
+    if (aPositionOffset.w == 0.0)
+        return n;
+    vec3 o = vec3(n.xy, 1.0 - abs(n.x) - abs(n.y));
+    float t = max(-o.z, 0.0);
+    o.xy += vec2(o.x >= 0.0 ? -t : t, o.y >= 0.0 ? -t : t);
+    return normalize(o);
+}
+
+vec2 decodeUV(vec2 uv)
+{
+    return aUVDecode.xy + uv * aUVDecode.zw;
+}
 
 void main()
 {
-    EPos = aPos;
-    Enorm = aNormal;
-    FragPos = vec3(model * vec4(aPos, 1.0));
-    Normal = normalMatrix * aNormal;
+    vec3 position = decodePosition(aPos);
+    vec3 normal = decodeNormal(aNormal);
+    vec2 texCoords = decodeUV(aTexCoords);
+    QueuedInstance instance = queued[instanceBase + gl_InstanceID];
+    model = instance.model;
+    normalMatrix = mat3(instance.normalMatrix);
+    EPos = position;
+    Enorm = normal;
+    FragPos = vec3(model * vec4(position, 1.0));
+    Normal = normalMatrix * normal;
 
-    TexCoords = aTexCoords;
+    TexCoords = texCoords;
     gl_Position = projection * view * vec4(FragPos, 1.0);
 }
 
@@ -12,12 +12,34 @@ Creation date: Jan 8, 2022
 End Header ---------------------------------------------------------*/
 #version 450 core
 layout(location = 0) in vec3 position;
+layout(location = 4) in uint aInstanceID;
+
+// Dequantization constants of the mesh, see VertexQuantizer; identity for float meshes
+layout (location = 5) in vec4 aPositionOffset;
+layout (location = 6) in vec4 aPositionScale;
+
+struct Instance
+{
+    mat4 model;
+    vec4 boundsMin;
+    vec4 boundsMax;
+    uvec4 meshIndex;
+};
+layout (std430, binding = 0) readonly buffer Instances { Instance instances[]; };
 
 uniform mat4 mvp;
+uniform bool bInstanced;
 
 out vec3 fragPos;
 
+vec3 decodePosition(vec3 p)
+{
+    return aPositionOffset.xyz + p * aPositionScale.xyz;
+}
+
 void main() {
-	gl_Position = mvp * vec4(position, 1.0);
-	fragPos = position;
+	vec3 localPos = decodePosition(position);
+	vec4 worldPos = bInstanced ? instances[aInstanceID].model * vec4(localPos, 1.0) : vec4(localPos, 1.0);
+	gl_Position = mvp * worldPos;
+	fragPos = worldPos.xyz;
 }
\ No newline at end of file
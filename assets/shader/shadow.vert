@@ -12,11 +12,33 @@ Creation date: Sep 29, 2021
 End Header ---------------------------------------------------------*/
 #version 450 core
 layout (location = 0) in vec3 aPos;
+layout (location = 4) in uint aInstanceID;
+
+// Dequantization constants of the mesh, see VertexQuantizer; identity for float meshes
+layout (location = 5) in vec4 aPositionOffset;
+layout (location = 6) in vec4 aPositionScale;
+
+struct Instance
+{
+    mat4 model;
+    vec4 boundsMin;
+    vec4 boundsMax;
+    uvec4 meshIndex;
+};
+layout (std430, binding = 0) readonly buffer Instances { Instance instances[]; };
 
 uniform mat4 lightSpaceMatrix;
 uniform mat4 model;
+uniform bool bInstanced;
+
+vec3 decodePosition(vec3 p)
+{
+    return aPositionOffset.xyz + p * aPositionScale.xyz;
+}
 
 void main()
 {
-    gl_Position = lightSpaceMatrix * model * vec4(aPos, 1.0);
+    vec3 position = decodePosition(aPos);
+    mat4 M = bInstanced ? instances[aInstanceID].model : model;
+    gl_Position = lightSpaceMatrix * M * vec4(position, 1.0);
 }
\ No newline at end of file
@@ -17,6 +17,7 @@ uniform mat4 projection;
 
 uniform int kernelSize;
 uniform vec2 noiseScale;
+uniform vec2 uvScale;
 uniform vec3 kernel[500];
 
 uniform sampler2D positionMap;
@@ -51,8 +52,9 @@ void main() {
 		offset.xy /= offset.w;
 		offset.xy = offset.xy * 0.5 + 0.5;
 
-		//Get sample depth
-		float sampleDepth = texture(positionMap, offset.xy).z;
+		//Get sample depth, clamped to the drawn area as the edge clamp did for the whole target
+		vec2 halfTexel = 0.5 / vec2(textureSize(positionMap, 0));
+		float sampleDepth = texture(positionMap, clamp(offset.xy * uvScale, halfTexel, uvScale - halfTexel)).z;
 
 		//Range check and accumulate
 		float rangeCheck = abs(origin.z - sampleDepth) < radius ? 1.0 : 0.0;
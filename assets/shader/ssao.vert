@@ -15,7 +15,10 @@ in vec2 vertexPos;
 
 out vec2 coord;
 
+// Drawn area / target size, the targets are allocated for the largest render scale
+uniform vec2 uvScale;
+
 void main() {
-    coord = vertexPos * 0.5f + 0.5f;
+    coord = (vertexPos * 0.5f + 0.5f) * uvScale;
     gl_Position = vec4(vertexPos, 0.0, 1.0);
 }
\ No newline at end of file
@@ -0,0 +1,122 @@
+/* Start Header -------------------------------------------------------
+Copyright (C) 2021 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the prior written
+consent of DigiPen Institute of Technology is prohibited.
+File Name: AllocationCounter.cpp
+Purpose: This file is source for the heap allocation counter.
+Language: c++
+Platform: VS2019 / Window
+Project:  HGraphics
+Author: Elliott Hong <s.hong@digipen.edu>
+Creation date: Oct 19, 2026
+End Header ---------------------------------------------------------*/
+#include "AllocationCounter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+    // Plain thread locals, constructing anything here could allocate from inside operator new
+    thread_local uint64_t thread_count = 0;
+    thread_local unsigned allow_depth = 0;
+    std::atomic<uint64_t> total_count(0);
+}
+
+AllocationCounter::AllowScope::AllowScope()
+{
+    ++allow_depth;
+}
+
+AllocationCounter::AllowScope::~AllowScope()
+{
+    --allow_depth;
+}
+
+bool AllocationCounter::isCompiledIn()
+{
+#ifdef HGRAPHICS_ALLOCATION_COUNTER
+    return true;
+#else
+    return false;
+#endif
+}
+
+uint64_t AllocationCounter::getThreadCount()
+{
+    return thread_count;
+}
+
+uint64_t AllocationCounter::getTotalCount()
+{
+    return total_count.load(std::memory_order_relaxed);
+}
+
+void AllocationCounter::count()
+{
+    if (allow_depth != 0)
+        return;
+    ++thread_count;
+    total_count.fetch_add(1, std::memory_order_relaxed);
+}
+
+#ifdef HGRAPHICS_ALLOCATION_COUNTER
+
+// The aligned forms are left to the runtime, nothing in the renderer asks for over-aligned types
+
+void* operator new(size_t size)
+{
+    AllocationCounter::count();
+    if (void* memory = std::malloc(size ? size : 1))
+        return memory;
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+    AllocationCounter::count();
+    return std::malloc(size ? size : 1);
+}
+
+void* operator new[](size_t size, const std::nothrow_t& tag) noexcept
+{
+    return operator new(size, tag);
+}
+
+void operator delete(void* memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete[](void* memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete[](void* memory, size_t) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void* memory, const std::nothrow_t&) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete[](void* memory, const std::nothrow_t&) noexcept
+{
+    std::free(memory);
+}
+
+#endif
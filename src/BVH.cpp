@@ -0,0 +1,546 @@
+/* Start Header -------------------------------------------------------
+Copyright (C) 2021 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the prior written
+consent of DigiPen Institute of Technology is prohibited.
+File Name: BVH.cpp
+Purpose: This file builds SAH bounding volume hierarchies and traverses them with SSE.
+Language: c++
+Platform: VS2019 / Window
+Project:  HGraphics
+Author: Elliott Hong <s.hong@digipen.edu>
+Creation date: Oct 19, 2026
+End Header ---------------------------------------------------------*/
+#include "BVH.h"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <emmintrin.h>
+
+#include "GPUCuller.h"
+#include "JobSystem.h"
+
+namespace
+{
+    constexpr int SAH_BINS = 16;
+    constexpr int MAX_STACK = 128;
+    // Traversal holds at most one pending sibling per level plus the node being split, so
+    // nodes this deep become leaves however many primitives they have left
+    constexpr int MAX_DEPTH = MAX_STACK - 2;
+    // Subtrees this large are built as their own job, down to PARALLEL_DEPTH levels
+    constexpr unsigned PARALLEL_MIN_PRIMITIVES = 32 * 1024;
+    constexpr int PARALLEL_DEPTH = 6;
+
+    struct Bounds
+    {
+        glm::vec3 min = glm::vec3(FLT_MAX);
+        glm::vec3 max = glm::vec3(-FLT_MAX);
+
+        void grow(const glm::vec3& p) { min = glm::min(min, p); max = glm::max(max, p); }
+        void grow(const Bounds& b) { min = glm::min(min, b.min); max = glm::max(max, b.max); }
+        float area() const
+        {
+            const glm::vec3 d = glm::max(max - min, glm::vec3(0.f));
+            return 2.f * (d.x * d.y + d.y * d.z + d.z * d.x);
+        }
+    };
+
+    struct BuildInput
+    {
+        const Bounds* bounds;
+        const glm::vec3* centroids;
+        unsigned maxLeafSize;
+    };
+
+    void buildNode(const BuildInput& input, GLuint* order, unsigned begin, unsigned end, int depth,
+                   std::vector<BVHNode>& nodes)
+    {
+        Bounds bounds, centroidBounds;
+        for (unsigned i = begin; i < end; ++i)
+        {
+            bounds.grow(input.bounds[order[i]]);
+            centroidBounds.grow(input.centroids[order[i]]);
+        }
+
+        const unsigned count = end - begin;
+        const GLuint index = static_cast<GLuint>(nodes.size());
+        nodes.push_back({ bounds.min, begin, bounds.max, count });
+        if (count <= 1 || depth >= MAX_DEPTH)
+            return;
+
+        // Binned SAH over centroids; costs are in primitive tests with one unit per traversal step
+        int bestAxis = -1;
+        int bestSplit = 0;
+        float bestCost = FLT_MAX;
+        const glm::vec3 extent = centroidBounds.max - centroidBounds.min;
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            // A denormal extent overflows the scale, and an infinite bin index is out of range
+            const float scale = SAH_BINS / extent[axis];
+            if (extent[axis] <= 0.f || !std::isfinite(scale))
+                continue;
+
+            Bounds binBounds[SAH_BINS];
+            unsigned binCount[SAH_BINS] = {};
+            for (unsigned i = begin; i < end; ++i)
+            {
+                const GLuint p = order[i];
+                const int bin = std::min(static_cast<int>((input.centroids[p][axis] - centroidBounds.min[axis]) * scale), SAH_BINS - 1);
+                binBounds[bin].grow(input.bounds[p]);
+                ++binCount[bin];
+            }
+
+            float rightArea[SAH_BINS];
+            unsigned rightCount[SAH_BINS];
+            Bounds accum;
+            unsigned accumCount = 0;
+            for (int b = SAH_BINS - 1; b > 0; --b)
+            {
+                accum.grow(binBounds[b]);
+                accumCount += binCount[b];
+                rightArea[b] = accum.area();
+                rightCount[b] = accumCount;
+            }
+
+            accum = Bounds();
+            accumCount = 0;
+            for (int b = 1; b < SAH_BINS; ++b)
+            {
+                accum.grow(binBounds[b - 1]);
+                accumCount += binCount[b - 1];
+                if (accumCount == 0 || rightCount[b] == 0)
+                    continue;
+                const float cost = accum.area() * accumCount + rightArea[b] * rightCount[b];
+                if (cost < bestCost)
+                {
+                    bestCost = cost;
+                    bestAxis = axis;
+                    bestSplit = b;
+                }
+            }
+        }
+
+        const float nodeArea = std::max(bounds.area(), 1e-20f);
+        const float splitCost = 1.f + bestCost / nodeArea;
+        if (count <= input.maxLeafSize && (bestAxis < 0 || splitCost >= static_cast<float>(count)))
+            return;
+
+        unsigned mid;
+        if (bestAxis >= 0)
+        {
+            const float scale = SAH_BINS / extent[bestAxis];
+            const float axisMin = centroidBounds.min[bestAxis];
+            const int split = bestSplit;
+            const glm::vec3* centroids = input.centroids;
+            mid = static_cast<unsigned>(std::partition(order + begin, order + end, [=](GLuint p)
+            {
+                return std::min(static_cast<int>((centroids[p][bestAxis] - axisMin) * scale), SAH_BINS - 1) < split;
+            }) - order);
+        }
+        else
+        {
+            // All centroids coincide; split the list in half to respect the leaf size
+            mid = begin + count / 2;
+        }
+
+        // Interior: left child follows, offset is patched to the right child below
+        nodes[index].count = 0;
+        if (depth < PARALLEL_DEPTH && count >= PARALLEL_MIN_PRIMITIVES)
+        {
+            std::vector<BVHNode> right;
+            JobSystem::Counter rightDone;
+            JOB_SYSTEM.run([&] { buildNode(input, order, mid, end, depth + 1, right); }, &rightDone);
+            buildNode(input, order, begin, mid, depth + 1, nodes);
+            JOB_SYSTEM.wait(rightDone);
+
+            const GLuint rightIndex = static_cast<GLuint>(nodes.size());
+            for (BVHNode node : right)
+            {
+                if (!node.isLeaf())
+                    node.offset += rightIndex;
+                nodes.push_back(node);
+            }
+            nodes[index].offset = rightIndex;
+        }
+        else
+        {
+            buildNode(input, order, begin, mid, depth + 1, nodes);
+            nodes[index].offset = static_cast<GLuint>(nodes.size());
+            buildNode(input, order, mid, end, depth + 1, nodes);
+        }
+    }
+
+    void buildTree(const std::vector<Bounds>& bounds, const std::vector<glm::vec3>& centroids, unsigned maxLeafSize,
+                   std::vector<BVHNode>& nodes, std::vector<GLuint>& order)
+    {
+        nodes.clear();
+        order.resize(bounds.size());
+        for (size_t i = 0; i < order.size(); ++i)
+            order[i] = static_cast<GLuint>(i);
+        if (order.empty())
+            return;
+
+        nodes.reserve(2 * order.size() / std::max(maxLeafSize / 2, 1u) + 1);
+        const BuildInput input{ bounds.data(), centroids.data(), maxLeafSize };
+        buildNode(input, order.data(), 0, static_cast<unsigned>(order.size()), 0, nodes);
+    }
+
+    // Division by zero directions would give inf * 0 = NaN in the slab test
+    glm::vec3 safeInverse(const glm::vec3& d)
+    {
+        glm::vec3 inv;
+        for (int i = 0; i < 3; ++i)
+            inv[i] = 1.f / (std::fabs(d[i]) > 1e-20f ? d[i] : std::copysign(1e-20f, d[i]));
+        return inv;
+    }
+
+    // Entry distance of the ray into the node, or false if it misses or starts beyond tMax
+    inline bool intersectNode(const BVHNode& node, __m128 origin, __m128 invDir, float tMax, float& tEntry)
+    {
+        const __m128 t0 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(&node.bounds_min.x), origin), invDir);
+        const __m128 t1 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(&node.bounds_max.x), origin), invDir);
+        alignas(16) float tNear[4], tFar[4];
+        _mm_store_ps(tNear, _mm_min_ps(t0, t1));
+        _mm_store_ps(tFar, _mm_max_ps(t0, t1));
+
+        // Lane 3 reads offset/count and is ignored
+        const float enter = std::max(std::max(tNear[0], tNear[1]), std::max(tNear[2], 0.f));
+        const float exit = std::min(std::min(tFar[0], tFar[1]), std::min(tFar[2], tMax));
+        tEntry = enter;
+        return enter <= exit;
+    }
+
+    struct StackEntry
+    {
+        GLuint node;
+        float t;
+    };
+
+    // Shared traversal; leafTest(node) handles one leaf and may shrink hit.t
+    template <typename LeafTest>
+    bool traverse(const std::vector<BVHNode>& nodes, const Ray& ray, RayHit& hit, LeafTest leafTest)
+    {
+        if (nodes.empty())
+            return false;
+
+        const glm::vec3 inv = safeInverse(ray.direction);
+        const __m128 origin = _mm_setr_ps(ray.origin.x, ray.origin.y, ray.origin.z, 0.f);
+        const __m128 invDir = _mm_setr_ps(inv.x, inv.y, inv.z, 0.f);
+
+        float tRoot;
+        if (!intersectNode(nodes[0], origin, invDir, hit.t, tRoot))
+            return false;
+
+        StackEntry stack[MAX_STACK];
+        int top = 0;
+        stack[top++] = { 0, tRoot };
+        bool found = false;
+
+        while (top > 0)
+        {
+            const StackEntry entry = stack[--top];
+            if (entry.t > hit.t)
+                continue;
+
+            const BVHNode& node = nodes[entry.node];
+            if (node.isLeaf())
+            {
+                found |= leafTest(node);
+                continue;
+            }
+
+            const GLuint left = entry.node + 1;
+            const GLuint right = node.offset;
+            float tLeft, tRight;
+            const bool hitLeft = intersectNode(nodes[left], origin, invDir, hit.t, tLeft);
+            const bool hitRight = intersectNode(nodes[right], origin, invDir, hit.t, tRight);
+            assert(top + 2 <= MAX_STACK && "BVH: tree deeper than the traversal stack");
+            if (top + 2 > MAX_STACK)
+                break;
+
+            // Push the far child first so the near one is popped next
+            if (hitLeft && hitRight)
+            {
+                if (tLeft <= tRight)
+                {
+                    stack[top++] = { right, tRight };
+                    stack[top++] = { left, tLeft };
+                }
+                else
+                {
+                    stack[top++] = { left, tLeft };
+                    stack[top++] = { right, tRight };
+                }
+            }
+            else if (hitLeft)
+                stack[top++] = { left, tLeft };
+            else if (hitRight)
+                stack[top++] = { right, tRight };
+        }
+
+        return found;
+    }
+}
+
+void MeshBVH::build(const glm::vec3* vertices, const GLuint* indices, unsigned triangleCount)
+{
+    const auto start = std::chrono::high_resolution_clock::now();
+
+    std::vector<Bounds> bounds(triangleCount);
+    std::vector<glm::vec3> centroids(triangleCount);
+    for (unsigned t = 0; t < triangleCount; ++t)
+    {
+        const glm::vec3& a = vertices[indices[3 * t]];
+        const glm::vec3& b = vertices[indices[3 * t + 1]];
+        const glm::vec3& c = vertices[indices[3 * t + 2]];
+        bounds[t].grow(a);
+        bounds[t].grow(b);
+        bounds[t].grow(c);
+        centroids[t] = (a + b + c) / 3.f;
+    }
+
+    std::vector<GLuint> order;
+    buildTree(bounds, centroids, 8, nodes_, order);
+
+    // Repack every leaf's triangles into 4-wide packets; leaves then index packets
+    packets_.clear();
+    packets_.reserve(triangleCount / 4 + nodes_.size());
+    for (auto& node : nodes_)
+    {
+        if (!node.isLeaf())
+            continue;
+
+        const GLuint firstPacket = static_cast<GLuint>(packets_.size());
+        for (GLuint i = 0; i < node.count; i += 4)
+        {
+            TrianglePacket packet = {};
+            for (GLuint lane = 0; lane < 4; ++lane)
+            {
+                // Unused lanes keep zero edges, which never pass the determinant test
+                packet.id[lane] = ~0u;
+                if (i + lane >= node.count)
+                    continue;
+
+                const GLuint t = order[node.offset + i + lane];
+                const glm::vec3& a = vertices[indices[3 * t]];
+                const glm::vec3 e1 = vertices[indices[3 * t + 1]] - a;
+                const glm::vec3 e2 = vertices[indices[3 * t + 2]] - a;
+                for (int axis = 0; axis < 3; ++axis)
+                {
+                    packet.v0[axis][lane] = a[axis];
+                    packet.e1[axis][lane] = e1[axis];
+                    packet.e2[axis][lane] = e2[axis];
+                }
+                packet.id[lane] = t;
+            }
+            packets_.push_back(packet);
+        }
+        node.offset = firstPacket;
+        node.count = static_cast<GLuint>(packets_.size()) - firstPacket;
+    }
+
+    build_ms_ = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+void MeshBVH::clear()
+{
+    nodes_.clear();
+    packets_.clear();
+}
+
+bool MeshBVH::intersect(const Ray& ray, RayHit& hit) const
+{
+    const __m128 ox = _mm_set1_ps(ray.origin.x), oy = _mm_set1_ps(ray.origin.y), oz = _mm_set1_ps(ray.origin.z);
+    const __m128 dx = _mm_set1_ps(ray.direction.x), dy = _mm_set1_ps(ray.direction.y), dz = _mm_set1_ps(ray.direction.z);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.f);
+    const __m128 epsilon = _mm_set1_ps(1e-12f);
+    const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+
+    return traverse(nodes_, ray, hit, [&](const BVHNode& leaf)
+    {
+        bool found = false;
+        for (GLuint p = leaf.offset; p < leaf.offset + leaf.count; ++p)
+        {
+            // Moller-Trumbore on four triangles at once, double sided
+            const TrianglePacket& packet = packets_[p];
+            const __m128 e1x = _mm_loadu_ps(packet.e1[0]), e1y = _mm_loadu_ps(packet.e1[1]), e1z = _mm_loadu_ps(packet.e1[2]);
+            const __m128 e2x = _mm_loadu_ps(packet.e2[0]), e2y = _mm_loadu_ps(packet.e2[1]), e2z = _mm_loadu_ps(packet.e2[2]);
+
+            const __m128 px = _mm_sub_ps(_mm_mul_ps(dy, e2z), _mm_mul_ps(dz, e2y));
+            const __m128 py = _mm_sub_ps(_mm_mul_ps(dz, e2x), _mm_mul_ps(dx, e2z));
+            const __m128 pz = _mm_sub_ps(_mm_mul_ps(dx, e2y), _mm_mul_ps(dy, e2x));
+            const __m128 det = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e1x, px), _mm_mul_ps(e1y, py)), _mm_mul_ps(e1z, pz));
+            __m128 mask = _mm_cmpgt_ps(_mm_and_ps(det, absMask), epsilon);
+            if (_mm_movemask_ps(mask) == 0)
+                continue;
+            const __m128 invDet = _mm_div_ps(one, det);
+
+            const __m128 tx = _mm_sub_ps(ox, _mm_loadu_ps(packet.v0[0]));
+            const __m128 ty = _mm_sub_ps(oy, _mm_loadu_ps(packet.v0[1]));
+            const __m128 tz = _mm_sub_ps(oz, _mm_loadu_ps(packet.v0[2]));
+            const __m128 u = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(tx, px), _mm_mul_ps(ty, py)), _mm_mul_ps(tz, pz)), invDet);
+
+            const __m128 qx = _mm_sub_ps(_mm_mul_ps(ty, e1z), _mm_mul_ps(tz, e1y));
+            const __m128 qy = _mm_sub_ps(_mm_mul_ps(tz, e1x), _mm_mul_ps(tx, e1z));
+            const __m128 qz = _mm_sub_ps(_mm_mul_ps(tx, e1y), _mm_mul_ps(ty, e1x));
+            const __m128 v = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, qx), _mm_mul_ps(dy, qy)), _mm_mul_ps(dz, qz)), invDet);
+            const __m128 t = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(e2x, qx), _mm_mul_ps(e2y, qy)), _mm_mul_ps(e2z, qz)), invDet);
+
+            mask = _mm_and_ps(mask, _mm_cmpge_ps(u, zero));
+            mask = _mm_and_ps(mask, _mm_cmpge_ps(v, zero));
+            mask = _mm_and_ps(mask, _mm_cmple_ps(_mm_add_ps(u, v), one));
+            mask = _mm_and_ps(mask, _mm_cmpgt_ps(t, zero));
+            mask = _mm_and_ps(mask, _mm_cmplt_ps(t, _mm_set1_ps(hit.t)));
+            const int lanes = _mm_movemask_ps(mask);
+            if (lanes == 0)
+                continue;
+
+            alignas(16) float tLane[4], uLane[4], vLane[4];
+            _mm_store_ps(tLane, t);
+            _mm_store_ps(uLane, u);
+            _mm_store_ps(vLane, v);
+            for (int lane = 0; lane < 4; ++lane)
+            {
+                if ((lanes & (1 << lane)) && tLane[lane] < hit.t)
+                {
+                    hit.t = tLane[lane];
+                    hit.u = uLane[lane];
+                    hit.v = vLane[lane];
+                    hit.triangle = packet.id[lane];
+                    found = true;
+                }
+            }
+        }
+        return found;
+    });
+}
+
+bool MeshBVH::empty() const
+{
+    return nodes_.empty();
+}
+
+glm::vec3 MeshBVH::getBoundsMin() const
+{
+    return nodes_.empty() ? glm::vec3(0.f) : nodes_[0].bounds_min;
+}
+
+glm::vec3 MeshBVH::getBoundsMax() const
+{
+    return nodes_.empty() ? glm::vec3(0.f) : nodes_[0].bounds_max;
+}
+
+unsigned MeshBVH::getNodeCount() const
+{
+    return static_cast<unsigned>(nodes_.size());
+}
+
+float MeshBVH::getBuildMs() const
+{
+    return build_ms_;
+}
+
+void SceneBVH::computeInstanceBounds(const std::vector<InstanceData>& instances)
+{
+    inverse_models_.resize(instances.size());
+    instance_min_.resize(instances.size());
+    instance_max_.resize(instances.size());
+
+    for (size_t i = 0; i < instances.size(); ++i)
+    {
+        const glm::mat4& model = instances[i].model;
+        const MeshBVH* mesh = mesh_bvhs_[instance_mesh_[i]];
+        const glm::vec3 localCenter = (mesh->getBoundsMin() + mesh->getBoundsMax()) * 0.5f;
+        const glm::vec3 localExtent = (mesh->getBoundsMax() - mesh->getBoundsMin()) * 0.5f;
+
+        const glm::vec3 center = glm::vec3(model * glm::vec4(localCenter, 1.f));
+        const glm::mat3 absModel = glm::mat3(glm::abs(glm::vec3(model[0])), glm::abs(glm::vec3(model[1])),
+                                             glm::abs(glm::vec3(model[2])));
+        const glm::vec3 extent = absModel * localExtent;
+
+        instance_min_[i] = center - extent;
+        instance_max_[i] = center + extent;
+        inverse_models_[i] = glm::inverse(model);
+    }
+}
+
+void SceneBVH::build(const std::vector<const MeshBVH*>& meshes, const std::vector<InstanceData>& instances)
+{
+    mesh_bvhs_ = meshes;
+    instance_mesh_.resize(instances.size());
+    for (size_t i = 0; i < instances.size(); ++i)
+        instance_mesh_[i] = instances[i].mesh_index;
+
+    computeInstanceBounds(instances);
+
+    std::vector<Bounds> bounds(instances.size());
+    std::vector<glm::vec3> centroids(instances.size());
+    for (size_t i = 0; i < instances.size(); ++i)
+    {
+        bounds[i].min = instance_min_[i];
+        bounds[i].max = instance_max_[i];
+        centroids[i] = (instance_min_[i] + instance_max_[i]) * 0.5f;
+    }
+
+    buildTree(bounds, centroids, 4, nodes_, order_);
+}
+
+void SceneBVH::refit(const std::vector<InstanceData>& instances)
+{
+    if (instances.size() != instance_mesh_.size())
+        return;
+
+    computeInstanceBounds(instances);
+
+    // Children always follow their parent, so a reverse sweep is bottom-up
+    for (size_t n = nodes_.size(); n-- > 0;)
+    {
+        BVHNode& node = nodes_[n];
+        Bounds bounds;
+        if (node.isLeaf())
+        {
+            for (GLuint i = node.offset; i < node.offset + node.count; ++i)
+            {
+                bounds.grow(instance_min_[order_[i]]);
+                bounds.grow(instance_max_[order_[i]]);
+            }
+        }
+        else
+        {
+            bounds.grow(nodes_[n + 1].bounds_min);
+            bounds.grow(nodes_[n + 1].bounds_max);
+            bounds.grow(nodes_[node.offset].bounds_min);
+            bounds.grow(nodes_[node.offset].bounds_max);
+        }
+        node.bounds_min = bounds.min;
+        node.bounds_max = bounds.max;
+    }
+}
+
+bool SceneBVH::intersect(const Ray& ray, RayHit& hit) const
+{
+    return traverse(nodes_, ray, hit, [&](const BVHNode& leaf)
+    {
+        bool found = false;
+        for (GLuint i = leaf.offset; i < leaf.offset + leaf.count; ++i)
+        {
+            // Affine transform keeps t, so the object-space hit is directly comparable
+            const GLuint instance = order_[i];
+            const glm::mat4& inverse = inverse_models_[instance];
+            const Ray local{ glm::vec3(inverse * glm::vec4(ray.origin, 1.f)), glm::vec3(inverse * glm::vec4(ray.direction, 0.f)) };
+            if (mesh_bvhs_[instance_mesh_[instance]]->intersect(local, hit))
+            {
+                hit.instance = instance;
+                found = true;
+            }
+        }
+        return found;
+    });
+}
+
+unsigned SceneBVH::getNodeCount() const
+{
+    return static_cast<unsigned>(nodes_.size());
+}
@@ -0,0 +1,49 @@
+/* Start Header -------------------------------------------------------
+Copyright (C) 2021 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the prior written
+consent of DigiPen Institute of Technology is prohibited.
+File Name: CommandBuffer.cpp
+Purpose: This file is source for the render thread command buffer.
+Language: c++
+Platform: VS2019 / Window
+Project:  HGraphics
+Author: Elliott Hong <s.hong@digipen.edu>
+Creation date: Oct 19, 2026
+End Header ---------------------------------------------------------*/
+#include "CommandBuffer.h"
+
+CommandBuffer::CommandBuffer(LinearAllocator& memory) : memory_(memory)
+{
+    head_ = nullptr;
+    tail_ = nullptr;
+    count_ = 0;
+}
+
+CommandBuffer::~CommandBuffer()
+{
+    clear();
+}
+
+void CommandBuffer::execute()
+{
+    for (Command* command = head_; command; command = command->next)
+    {
+        command->invoke(command->fn);
+        command->destroy(command->fn);
+    }
+    head_ = tail_ = nullptr;
+    count_ = 0;
+}
+
+void CommandBuffer::clear()
+{
+    for (Command* command = head_; command; command = command->next)
+        command->destroy(command->fn);
+    head_ = tail_ = nullptr;
+    count_ = 0;
+}
+
+unsigned CommandBuffer::getCount() const
+{
+    return count_;
+}
@@ -0,0 +1,183 @@
+/* Start Header -------------------------------------------------------
+Copyright (C) 2021 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the prior written
+consent of DigiPen Institute of Technology is prohibited.
+File Name: CookedTexture.cpp
+Purpose: This file is source for the memory-mapped cooked texture container.
+Language: c++
+Platform: VS2019 / Window
+Project:  HGraphics
+Author: Elliott Hong <s.hong@digipen.edu>
+Creation date: Oct 19, 2026
+End Header ---------------------------------------------------------*/
+#include "CookedTexture.h"
+
+#include <algorithm>
+#include <cstring>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+CookedTexture::CookedTexture() : data_(nullptr), size_(0), file_(INVALID_HANDLE_VALUE), mapping_(nullptr)
+{
+}
+#else
+CookedTexture::CookedTexture() : data_(nullptr), size_(0), file_(-1)
+{
+}
+#endif
+
+CookedTexture::~CookedTexture()
+{
+    close();
+}
+
+bool CookedTexture::open(const std::string& filepath)
+{
+    close();
+
+#ifdef _WIN32
+    file_ = CreateFileA(filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file_ == INVALID_HANDLE_VALUE)
+        return false;
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file_, &fileSize) || fileSize.QuadPart == 0)
+    {
+        close();
+        return false;
+    }
+    size_ = static_cast<size_t>(fileSize.QuadPart);
+    mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping_ != nullptr)
+        data_ = static_cast<const unsigned char*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+#else
+    file_ = ::open(filepath.c_str(), O_RDONLY);
+    if (file_ < 0)
+        return false;
+    struct stat fileStat;
+    if (fstat(file_, &fileStat) != 0 || fileStat.st_size == 0)
+    {
+        close();
+        return false;
+    }
+    size_ = static_cast<size_t>(fileStat.st_size);
+    void* view = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, file_, 0);
+    if (view != MAP_FAILED)
+        data_ = static_cast<const unsigned char*>(view);
+#endif
+
+    if (data_ == nullptr || size_ < sizeof(CookedTextureHeader))
+    {
+        close();
+        return false;
+    }
+
+    const CookedTextureHeader* header = reinterpret_cast<const CookedTextureHeader*>(data_);
+    bool valid = std::memcmp(header->identifier, COOKED_TEXTURE_IDENTIFIER, sizeof(header->identifier)) == 0
+        && header->width > 0 && header->height > 0 && header->levelCount > 0 && header->levelCount <= 32
+        && (header->blockBytes == 8 || header->blockBytes == 16)
+        && sizeof(CookedTextureHeader) + header->levelCount * sizeof(CookedLevel) <= size_;
+    for (uint32_t level = 0; valid && level < header->levelCount; ++level)
+    {
+        const CookedLevel& entry = reinterpret_cast<const CookedLevel*>(header + 1)[level];
+        const uint64_t blocksX = ((std::max(header->width >> level, 1u) + 3) / 4);
+        const uint64_t blocksY = ((std::max(header->height >> level, 1u) + 3) / 4);
+        valid = entry.byteLength == blocksX * blocksY * header->blockBytes
+            && entry.byteOffset <= size_ && entry.byteLength <= size_ - entry.byteOffset;
+    }
+    if (!valid)
+    {
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+void CookedTexture::close()
+{
+#ifdef _WIN32
+    if (data_ != nullptr)
+        UnmapViewOfFile(data_);
+    if (mapping_ != nullptr)
+        CloseHandle(mapping_);
+    if (file_ != INVALID_HANDLE_VALUE)
+        CloseHandle(file_);
+    mapping_ = nullptr;
+    file_ = INVALID_HANDLE_VALUE;
+#else
+    if (data_ != nullptr)
+        munmap(const_cast<unsigned char*>(data_), size_);
+    if (file_ >= 0)
+        ::close(file_);
+    file_ = -1;
+#endif
+    data_ = nullptr;
+    size_ = 0;
+}
+
+bool CookedTexture::isOpen() const
+{
+    return data_ != nullptr;
+}
+
+GLenum CookedTexture::getFormat() const
+{
+    return reinterpret_cast<const CookedTextureHeader*>(data_)->glFormat;
+}
+
+int CookedTexture::getWidth() const
+{
+    return static_cast<int>(reinterpret_cast<const CookedTextureHeader*>(data_)->width);
+}
+
+int CookedTexture::getHeight() const
+{
+    return static_cast<int>(reinterpret_cast<const CookedTextureHeader*>(data_)->height);
+}
+
+int CookedTexture::getLevelCount() const
+{
+    return static_cast<int>(reinterpret_cast<const CookedTextureHeader*>(data_)->levelCount);
+}
+
+int CookedTexture::getBlockBytes() const
+{
+    return static_cast<int>(reinterpret_cast<const CookedTextureHeader*>(data_)->blockBytes);
+}
+
+const unsigned char* CookedTexture::getLevelData(int level) const
+{
+    const CookedLevel* levels = reinterpret_cast<const CookedLevel*>(data_ + sizeof(CookedTextureHeader));
+    return data_ + levels[level].byteOffset;
+}
+
+size_t CookedTexture::getLevelSize(int level) const
+{
+    const CookedLevel* levels = reinterpret_cast<const CookedLevel*>(data_ + sizeof(CookedTextureHeader));
+    return static_cast<size_t>(levels[level].byteLength);
+}
+
+std::string CookedTexture::cookedPath(const std::string& sourcePath)
+{
+    const size_t slash = sourcePath.find_last_of("/\\");
+    const size_t dot = sourcePath.find_last_of('.');
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+        return sourcePath + ".htex";
+    return sourcePath.substr(0, dot) + ".htex";
+}
+
+bool CookedTexture::isCookedPath(const std::string& path)
+{
+    return path.size() >= 5 && path.compare(path.size() - 5, 5, ".htex") == 0;
+}
@@ -14,6 +14,8 @@ End Header ---------------------------------------------------------*/
 
 #define STB_IMAGE_IMPLEMENTATION
 
+#include <algorithm>
+#include <chrono>
 #include <memory>
 #include <queue>
 #include <glm/vec3.hpp>
@@ -21,10 +23,15 @@ End Header ---------------------------------------------------------*/
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+#include "GLStateCache.h"
+#include "JobSystem.h"
 #include "OBJManager.h"
 const unsigned int SHADOW_WIDTH = 1024, SHADOW_HEIGHT = 1024;
+// Shadow maps are filtered, their LODs may be off by more than a pixel
+const float SHADOW_LOD_PIXEL_ERROR = 2.f;
 static const int kernelSize = 64;
 static const int noiseSize = 4;
+static const char* dynamicResolutionSettings = "../assets/dynamicResolution.cfg";
 float lastX;
 float lastY;
 bool firstMouse = true;
@@ -43,11 +50,12 @@ DeferredScene::~DeferredScene()
 
 DeferredScene::DeferredScene(int windowWidth, int windowHeight) :
     Scene(windowWidth, windowHeight), angleOfRotation(0.0f),
-    gBuffer(GBuffer(windowWidth, windowHeight)), ShadowMap_(ShadowMap(2048, 2048)),
+    targets_(), hiZ_(windowWidth, windowHeight), ShadowMap_(ShadowMap(2048, 2048)),
     PointLightShadowMap_(1024,1024)
 {
     initMembers();
     drawBuffer = 0;
+    renderScale = 1.f;
     screen_width = static_cast<float>(windowWidth);
     screen_height = static_cast<float>(windowHeight);
     lastX = screen_width / 2.f;
@@ -70,8 +78,9 @@ void DeferredScene::initMembers()
     bCopyDepth = true;
     normalSize = 0.2f;
     lightNum = 5;
-    AlbedoTexture_ = 0;
     AmbientTexture_ = 0;
+    defaultMaterial_ = -1;
+    silkMaterial_ = -1;
     fogMaxDist = 20.f;
     fogMinDist = 0.1f;
     fogColor = glm::vec3(0.5f, 0.5f, 0.5f);
@@ -81,6 +90,11 @@ void DeferredScene::initMembers()
     currUVPipeline = "GPU";
     UVEntity = { "Position", "Normal" };
     currUVEntity = "Position";
+    instanceGridSize = 1;
+    instanceSpacing = 12.f;
+    lightCullView = -1;
+    bHiZCulling = true;
+    bSoftwareOcclusion = true;
 }
 
 void DeferredScene::initKernel()
@@ -111,15 +125,16 @@ void DeferredScene::initKernel()
     }
 
     glGenTextures(1, &noiseTex);
-    glBindTexture(GL_TEXTURE_2D, noiseTex);
+    GL_STATE.bindTexture(0, GL_TEXTURE_2D, noiseTex);
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, noiseSize, noiseSize, 0, GL_RGBA, GL_FLOAT, &noise[0]);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
     glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
     glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    glBindTexture(GL_TEXTURE_2D, 0);
+    GL_STATE.bindTexture(0, GL_TEXTURE_2D, 0);
 
-    noiseScale = glm::vec2(window_width_ / noiseSize, window_height_ / noiseSize);
+    noiseScale = glm::vec2(static_cast<float>(window_width_) / noiseSize, static_cast<float>(window_height_) / noiseSize);
+    uvScale = glm::vec2(1.f);
 }
 
 int DeferredScene::Init(GLFWwindow* pWwindow)
@@ -137,28 +152,26 @@ int DeferredScene::Init(GLFWwindow* pWwindow)
 
     /*mainShader->loadShader("shader/FSQShading.vert",
         "shader/FSQShading.frag");*/
-    drawNormalShader->loadShader("../assets/shader/normalShader.vert",
+    // Compiled together in the background, each pass draws with the fallback until its program links
+    drawNormalShader->loadShaderAsync("../assets/shader/normalShader.vert",
         "../assets/shader/normalShader.frag");
-    shadowShader->loadShader("../assets/shader/shadow.vert",
+    shadowShader->loadShaderAsync("../assets/shader/shadow.vert",
         "../assets/shader/shadow.frag");
-    geometryShader->loadShader("../assets/shader/geometry.vert",
+    geometryShader->loadShaderAsync("../assets/shader/geometry.vert",
         "../assets/shader/geometry.frag");
-    stencilShader->loadShader("../assets/shader/light.vert",
+    stencilShader->loadShaderAsync("../assets/shader/light.vert",
         "../assets/shader/shadow.frag");
-    lightPassShader->loadShader("../assets/shader/light.vert",
+    lightPassShader->loadShaderAsync("../assets/shader/light.vert",
         "../assets/shader/light.frag");
-    pointLightShader->loadShader("../assets/shader/pointLightShadow.vert",
+    pointLightShader->loadShaderAsync("../assets/shader/pointLightShadow.vert",
         "../assets/shader/pointLightShadow.frag");
-    finalPassShader->loadShader("../assets/shader/finalPass.vert",
+    finalPassShader->loadShaderAsync("../assets/shader/finalPass.vert",
         "../assets/shader/finalPass.frag");
-    ssaoShader->loadShader("../assets/shader/ssao.vert",
+    ssaoShader->loadShaderAsync("../assets/shader/ssao.vert",
         "../assets/shader/ssao.frag");
-    skyboxShader->loadShader("../assets/shader/skybox.vert",
+    skyboxShader->loadShaderAsync("../assets/shader/skybox.vert",
         "../assets/shader/skybox.frag");
 
-    AlbedoTexture_ = OBJ_MANAGER->getTexture("albedoTexture");
-    NormTexture_ = OBJ_MANAGER->getTexture("normTexture");
-
     currentModelName = OBJ_MANAGER->loaded_models[0];
 
     std::vector<std::string> faces
@@ -172,7 +185,9 @@ int DeferredScene::Init(GLFWwindow* pWwindow)
     };
 
     //skyboxTexture = OBJ_MANAGER->load_cubemap(faces);
-    skyboxTexture = OBJ_MANAGER->loadCubemap(faces);
+    OBJ_MANAGER->loadCubemap("skybox", faces);
+    defaultMaterial_ = OBJ_MANAGER->getMaterialLibrary().findMaterial("flatBlue");
+    silkMaterial_ = OBJ_MANAGER->getMaterialLibrary().findMaterial("silkMedieval");
 
     camera_ = std::make_unique<Camera>(glm::vec3(4.8f, 6.6f, 7.1f));
 
@@ -195,9 +210,197 @@ int DeferredScene::Init(GLFWwindow* pWwindow)
 
     initKernel();
 
+    culler_.init();
+    culler_.setClusterCulling(true);
+    rebuildInstances();
+    // Light volumes stay whole, the stencil pass needs their back faces
+    lightCuller_.init();
+    rebuildLightVolumes();
+
+    dynamicResolution_.init();
+    dynamicResolution_.loadSettings(dynamicResolutionSettings);
+    renderScale = dynamicResolution_.getScale();
+
+    buildRenderGraph();
+
     return 0;
 }
 
+void DeferredScene::buildRenderGraph()
+{
+    renderGraph_.clear();
+
+    //position keeps full float precision, the rest are normalized or light sums
+    targets_.position = renderGraph_.createTexture("position", GL_RGBA32F);
+    targets_.normal = renderGraph_.createTexture("normal", GL_RGBA16F);
+    targets_.color = renderGraph_.createTexture("color", GL_RGBA8);
+    targets_.depth = renderGraph_.createTexture("depth", GL_DEPTH24_STENCIL8);
+    targets_.light = renderGraph_.createTexture("light", GL_RGBA16F);
+    targets_.ssao = renderGraph_.createTexture("ssao", GL_R16F);
+    targets_.sceneColor = renderGraph_.createTexture("sceneColor", GL_RGBA8);
+    targets_.shadowMap = renderGraph_.importTexture("shadowMap", ShadowMap_.depth);
+    targets_.hiZ = renderGraph_.importTexture("hiZ", hiZ_.texture);
+    targets_.backbuffer = renderGraph_.importTexture("backbuffer", 0);
+    //a resize recreates the Hi-Z texture and repoints its import, so the imports go first
+    updateRenderSize();
+
+    //culling reads last frame's Hi-Z, so the geometry pass goes before the Hi-Z rebuild
+    const int geometry = renderGraph_.addPass("Geometry", [this]() { geometryPass(); });
+    renderGraph_.read(geometry, targets_.hiZ);
+    renderGraph_.write(geometry, targets_.position);
+    renderGraph_.write(geometry, targets_.normal);
+    renderGraph_.write(geometry, targets_.color);
+    renderGraph_.write(geometry, targets_.depth);
+
+    const int hiZ = renderGraph_.addPass("Hi-Z", [this]() { hiZPass(); });
+    renderGraph_.read(hiZ, targets_.depth);
+    renderGraph_.write(hiZ, targets_.hiZ);
+
+    const int shadow = renderGraph_.addPass("Shadow", [this]() { shadowPass(); });
+    renderGraph_.write(shadow, targets_.shadowMap);
+
+    //light volumes are culled against this frame's Hi-Z, the stencil lives in the depth target
+    const int lighting = renderGraph_.addPass("Lighting", [this]() { lightingPass(); });
+    renderGraph_.read(lighting, targets_.hiZ);
+    renderGraph_.read(lighting, targets_.position);
+    renderGraph_.read(lighting, targets_.normal);
+    renderGraph_.read(lighting, targets_.color);
+    renderGraph_.write(lighting, targets_.light);
+    renderGraph_.write(lighting, targets_.depth);
+
+    const int ssao = renderGraph_.addPass("SSAO", [this]() { ssaoPass(); });
+    renderGraph_.read(ssao, targets_.position);
+    renderGraph_.read(ssao, targets_.normal);
+    renderGraph_.write(ssao, targets_.ssao);
+
+    const int composite = renderGraph_.addPass("Composite", [this]() { compositePass(); });
+    renderGraph_.read(composite, targets_.position);
+    renderGraph_.read(composite, targets_.normal);
+    renderGraph_.read(composite, targets_.color);
+    renderGraph_.read(composite, targets_.light);
+    renderGraph_.read(composite, targets_.ssao);
+    renderGraph_.read(composite, targets_.shadowMap);
+    renderGraph_.write(composite, targets_.sceneColor);
+
+    const int upscale = renderGraph_.addPass("Upscale", [this]() { upscalePass(); });
+    renderGraph_.read(upscale, targets_.sceneColor);
+    renderGraph_.write(upscale, targets_.backbuffer);
+
+    const int skybox = renderGraph_.addPass("Skybox", [this]() { skyboxPass(); });
+    renderGraph_.read(skybox, targets_.depth);
+    renderGraph_.write(skybox, targets_.backbuffer);
+
+    renderGraph_.compile();
+}
+
+void DeferredScene::updateRenderSize()
+{
+    //targets are allocated once for the largest scale, a scale change only moves the viewport
+    const float maxScale = std::max(dynamicResolution_.getSettings().maxScale, renderScale);
+    const int targetWidth = std::max(static_cast<int>(window_width_ * maxScale), 1);
+    const int targetHeight = std::max(static_cast<int>(window_height_ * maxScale), 1);
+    const int width = std::min(std::max(static_cast<int>(window_width_ * renderScale), 1), targetWidth);
+    const int height = std::min(std::max(static_cast<int>(window_height_ * renderScale), 1), targetHeight);
+    renderGraph_.setSize(targetWidth, targetHeight);
+    renderGraph_.setRenderSize(width, height);
+
+    //Hi-Z level 0 is copied texel for texel from the drawn area of the depth target
+    if (hiZ_.resize(targetWidth, targetHeight))
+        renderGraph_.setImportedTexture(targets_.hiZ, hiZ_.texture);
+    hiZ_.setActiveSize(width, height);
+
+    //quad coordinates span the drawn area, one noise tile per noiseSize pixels of the SSAO target
+    uvScale = glm::vec2(static_cast<float>(width) / targetWidth, static_cast<float>(height) / targetHeight);
+    noiseScale = glm::vec2(static_cast<float>(targetWidth) / noiseSize, static_cast<float>(targetHeight) / noiseSize);
+}
+
+void DeferredScene::Resize(int width, int height)
+{
+    Scene::Resize(width, height);
+    updateRenderSize();
+}
+
+glm::mat4 DeferredScene::gridInstanceModel(int x, int z) const
+{
+    const float gridOffset = (static_cast<float>(instanceGridSize) - 1.f) * 0.5f;
+    const glm::vec3 offset = glm::vec3(static_cast<float>(x) - gridOffset, 0.f,
+                                       static_cast<float>(z) - gridOffset) * instanceSpacing;
+    return glm::translate(offset) * glm::scale(glm::vec3(10.f)) * glm::rotate(glm::radians(180.f), glm::vec3(0.0f, 1.0f, 0.0f));
+}
+
+void DeferredScene::rebuildInstances()
+{
+    std::vector<Mesh*> meshes;
+    std::vector<const MeshBVH*> meshBVHs;
+    for (auto& name : OBJ_MANAGER->loaded_models)
+    {
+        meshes.push_back(OBJ_MANAGER->GetMesh(name));
+        meshBVHs.push_back(&meshes.back()->getBVH());
+    }
+
+    instances_.clear();
+    for (int x = 0; x < instanceGridSize; ++x)
+    {
+        for (int z = 0; z < instanceGridSize; ++z)
+        {
+            for (size_t m = 0; m < meshes.size(); ++m)
+            {
+                InstanceData instance{};
+                instance.model = gridInstanceModel(x, z);
+                instance.bounds_min = glm::vec4(meshes[m]->getAABBMin(), 1.f);
+                instance.bounds_max = glm::vec4(meshes[m]->getAABBMax(), 1.f);
+                instance.mesh_index = static_cast<GLuint>(m);
+                instances_.push_back(instance);
+            }
+        }
+    }
+
+    culler_.setInstances(meshes, instances_);
+    occlusionRasterizer_.setOccluders(meshes, instances_);
+    sceneBVH_.build(meshBVHs, instances_);
+    //moved instances would be tested against depth they never wrote
+    hiZ_.invalidate();
+}
+
+void DeferredScene::updateInstanceTransforms()
+{
+    //same grid layout as rebuildInstances, only the spacing changed; one grid row per job
+    const size_t meshCount = OBJ_MANAGER->loaded_models.size();
+    JOB_SYSTEM.parallelFor(0, instanceGridSize, 1, [this, meshCount](size_t first, size_t last)
+    {
+        for (size_t x = first; x < last; ++x)
+        {
+            size_t i = x * instanceGridSize * meshCount;
+            for (int z = 0; z < instanceGridSize; ++z)
+                for (size_t m = 0; m < meshCount; ++m)
+                    instances_[i++].model = gridInstanceModel(static_cast<int>(x), z);
+        }
+    });
+
+    culler_.updateTransforms(instances_);
+    occlusionRasterizer_.updateTransforms(instances_);
+    sceneBVH_.refit(instances_);
+    hiZ_.invalidate();
+}
+
+void DeferredScene::rebuildLightVolumes()
+{
+    std::vector<Mesh*> meshes;
+    std::vector<InstanceData> volumes;
+    for (size_t i = 0; i < Lights_.size(); ++i)
+    {
+        InstanceData volume{};
+        volume.model = glm::mat4(1.f);
+        volume.bounds_min = glm::vec4(Lights_[i].position - glm::vec3(Lights_[i].radius), 1.f);
+        volume.bounds_max = glm::vec4(Lights_[i].position + glm::vec3(Lights_[i].radius), 1.f);
+        volume.mesh_index = static_cast<GLuint>(i);
+        volumes.push_back(volume);
+        meshes.push_back(OBJ_MANAGER->GetMesh("plane"));
+    }
+
+    lightCuller_.setInstances(meshes, volumes);
+}
+
 unsigned int quadVAO = 0;
 unsigned int quadVBO;
 void renderQuad()
@@ -212,25 +415,27 @@ void renderQuad()
         };
         glGenVertexArrays(1, &quadVAO);
         glGenBuffers(1, &quadVBO);
-        glBindVertexArray(quadVAO);
-        glBindBuffer(GL_ARRAY_BUFFER, quadVBO);
+        GL_STATE.bindVertexArray(quadVAO);
+        GL_STATE.bindBuffer(GL_ARRAY_BUFFER, quadVBO);
         glBufferData(GL_ARRAY_BUFFER, sizeof(quadVertices), &quadVertices, GL_STATIC_DRAW);
         glEnableVertexAttribArray(0);
         glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
         glEnableVertexAttribArray(1);
         glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
     }
-    glBindVertexArray(quadVAO);
+    GL_STATE.bindVertexArray(quadVAO);
     glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-    glBindVertexArray(0);
 }
 
 int DeferredScene::Render()
 {
     glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
 
+    // Streamed textures replace their placeholders once resident
+    skyboxTexture = OBJ_MANAGER->getTexture("skybox");
+
     view = camera_->GetViewMatrix();
-    projection = glm::perspective(glm::radians(camera_->zoom_), (float)screen_width / (float)screen_height, 0.1f,
+    projection = glm::perspective(glm::radians(camera_->zoom_), (float)window_width_ / (float)window_height_, 0.1f,
         100.0f);
 
     glm::vec3 lightPos(0.0f, 10.0f, 0.0f);
@@ -241,30 +446,19 @@ int DeferredScene::Render()
     lightView = glm::lookAt(Lights_[0].position, glm::vec3(0.0f), glm::vec3(0.0, 1.0, 0.0));
     lightSpaceMatrix = lightProjection * lightView;
 
-    geometryPass();
-
-    shadowPass();
-
-    gBuffer.bindDraw();
-    gBuffer.setDrawLight();
-    glClear(GL_COLOR_BUFFER_BIT);
-    gBuffer.unbindDraw();
+    culler_.beginFrame();
+    lightCuller_.beginFrame();
 
-    for(auto& light : Lights_)
+    //timings of earlier frames pick this frame's size, only the drawn area of the targets changes
+    const float scale = dynamicResolution_.update();
+    if (scale != renderScale)
     {
-        glViewport(0, 0, 1024, 1024);
-        plShadowPass(light);
-        glViewport(0, 0, window_width_, window_height_);
-        glEnable(GL_STENCIL_TEST);
-        stencilPass(light);
-        pointLightPass(light);
-        glDisable(GL_STENCIL_TEST);
+        renderScale = scale;
+        updateRenderSize();
     }
-    ssaoPass();
 
-    compositePass();
-
-    skyboxPass();
+    renderGraph_.execute();
+    dynamicResolution_.endFrame();
     /*if(bCopyDepth)
         glBlitFramebuffer(0, 0, (GLint)screen_width, (GLint)screen_height, 0, 0, (GLint)screen_width, (GLint)screen_height, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
     glBindFramebuffer(GL_FRAMEBUFFER, 0);*/
@@ -330,6 +524,8 @@ int DeferredScene::RenderImGUI()
     ImGui::Begin("Controls");
     ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.0f / ImGui::GetIO().Framerate,
         ImGui::GetIO().Framerate);
+    const GLStateCache::Counters& stateCounters = GL_STATE.getFrameCounters();
+    ImGui::Text("GL state: %u calls issued, %u elided", stateCounters.issued, stateCounters.elided);
 
     //Model config
     if (ImGui::CollapsingHeader("Model"))
@@ -356,15 +552,85 @@ int DeferredScene::RenderImGUI()
         ImGui::Checkbox("Draw Vertex Normal", &bShowVNormal);
         ImGui::Checkbox("Draw Face Normal", &bShowFNormal);
     }
+    if (ImGui::CollapsingHeader("Culling"))
+    {
+        int cullMode = static_cast<int>(culler_.getMode());
+        const char* cullModes[] = { "GPU (compute)", "CPU fallback" };
+        if (ImGui::Combo("Cull Mode", &cullMode, cullModes, IM_ARRAYSIZE(cullModes)))
+        {
+            culler_.setMode(static_cast<GPUCuller::Mode>(cullMode));
+            lightCuller_.setMode(static_cast<GPUCuller::Mode>(cullMode));
+        }
+        ImGui::Checkbox("Hi-Z Occlusion (GPU mode)", &bHiZCulling);
+        ImGui::Checkbox("Software Occlusion (CPU mode)", &bSoftwareOcclusion);
+        const OcclusionRasterizer::Stats& occlusionStats = occlusionRasterizer_.getStats();
+        ImGui::Text("Occluders: %u (%u triangles)", occlusionStats.occluders, occlusionStats.triangles);
+        ImGui::Text("Setup %.3f ms, raster %.3f ms", occlusionStats.setupMs, occlusionStats.rasterMs);
+
+        if (ImGui::SliderInt("Instance Grid", &instanceGridSize, 1, 64))
+            rebuildInstances();
+        if (ImGui::DragFloat("Instance Spacing", &instanceSpacing, 0.1f, 1.f, 100.f))
+            updateInstanceTransforms();
+
+        bool bClusterCulling = culler_.isClusterCulling();
+        bool bConeCulling = culler_.isConeCulling();
+        const bool bClusterChanged = ImGui::Checkbox("Cluster Culling", &bClusterCulling);
+        if (ImGui::Checkbox("Normal Cone Culling", &bConeCulling) || bClusterChanged)
+            culler_.setClusterCulling(bClusterCulling, bConeCulling);
+
+        ImGui::Text("Instances: %u, meshlet clusters: %u", culler_.getInstanceCount(), culler_.getClusterCount());
+        if (culler_.getMode() == GPUCuller::Mode::CPU)
+        {
+            ImGui::Text("Visible (all views): %u", culler_.getLastVisibleCount());
+            ImGui::Text("Meshlets (all views): %u of %u drawn", culler_.getLastClusterVisibleCount(),
+                culler_.getLastClusterTestedCount());
+        }
+    }
+    if (ImGui::CollapsingHeader("Render Graph"))
+    {
+        const RenderGraph::Stats& graphStats = renderGraph_.getStats();
+        ImGui::Text("Passes: %u (%u culled)", graphStats.passes, graphStats.culledPasses);
+        ImGui::Text("Targets: %u in %u textures, %.1f MB (%.1f MB without aliasing)", graphStats.textures,
+            graphStats.allocations, graphStats.bytes / (1024.f * 1024.f), graphStats.unaliasedBytes / (1024.f * 1024.f));
+        for (int pass : renderGraph_.getOrder())
+            ImGui::BulletText("%s", renderGraph_.getPassName(pass).c_str());
+    }
+    if (ImGui::CollapsingHeader("Dynamic Resolution"))
+    {
+        DynamicResolution::Settings& settings = dynamicResolution_.getSettings();
+        ImGui::Checkbox("Enabled##DynamicResolution", &settings.bEnabled);
+        if (!settings.bEnabled)
+        {
+            float scale = renderScale;
+            if (ImGui::SliderFloat("Render Scale", &scale, settings.minScale, settings.maxScale))
+                dynamicResolution_.setScale(scale);
+        }
+        ImGui::DragFloatRange2("Scale Range", &settings.minScale, &settings.maxScale, 0.01f, 0.25f, 1.f);
+        ImGui::SliderFloat("Target ms", &settings.targetMs, 2.f, 33.f);
+        ImGui::SliderFloat("Dead Band", &settings.deadBand, 0.f, 0.5f);
+        ImGui::SliderFloat("Response", &settings.response, 0.05f, 1.f);
+        ImGui::SliderFloat("Curve", &settings.curve, 0.25f, 1.f);
+        ImGui::SliderFloat("Step", &settings.step, 0.f, 0.1f);
+        ImGui::SliderInt("Cooldown Frames", &settings.cooldownFrames, 0, 60);
+        ImGui::Text("Scaled passes: %.2f ms (smoothed %.2f ms)", dynamicResolution_.getGPUMs(), dynamicResolution_.getSmoothedMs());
+        ImGui::Text("Internal: %dx%d (%.0f%%), output: %dx%d", renderGraph_.getRenderWidth(), renderGraph_.getRenderHeight(),
+            renderScale * 100.f, window_width_, window_height_);
+        if (ImGui::Button("Save Settings"))
+            dynamicResolution_.saveSettings(dynamicResolutionSettings);
+        ImGui::SameLine();
+        if (ImGui::Button("Load Settings"))
+            dynamicResolution_.loadSettings(dynamicResolutionSettings);
+    }
+    renderGLCallsImGUI();
     ImGui::Checkbox("Copy Depth", &bCopyDepth);
     ImGui::End();
 
 
     ImGui::Begin("FBOs");   // Pass a pointer to our bool variable (the window will have a closing button that will clear the bool when clicked)
-    ImGui::Image((ImTextureID)(intptr_t)gBuffer.position, ImVec2(400,250), ImVec2(0, 1), ImVec2(1, 0));
-    ImGui::Image((ImTextureID)(intptr_t)gBuffer.normal, ImVec2(400, 250), ImVec2(0, 1), ImVec2(1, 0));
-    ImGui::Image((ImTextureID)(intptr_t)gBuffer.color, ImVec2(400, 250), ImVec2(0, 1), ImVec2(1, 0));
-    ImGui::Image((ImTextureID)(intptr_t)gBuffer.light, ImVec2(400, 250), ImVec2(0, 1), ImVec2(1, 0));
+    ImGui::Image((ImTextureID)(intptr_t)renderGraph_.getTexture(targets_.position), ImVec2(400,250), ImVec2(0, 1), ImVec2(1, 0));
+    ImGui::Image((ImTextureID)(intptr_t)renderGraph_.getTexture(targets_.normal), ImVec2(400, 250), ImVec2(0, 1), ImVec2(1, 0));
+    ImGui::Image((ImTextureID)(intptr_t)renderGraph_.getTexture(targets_.color), ImVec2(400, 250), ImVec2(0, 1), ImVec2(1, 0));
+    ImGui::Image((ImTextureID)(intptr_t)renderGraph_.getTexture(targets_.light), ImVec2(400, 250), ImVec2(0, 1), ImVec2(1, 0));
     ImGui::End();
 
     return Scene::RenderImGUI();
@@ -372,16 +638,22 @@ int DeferredScene::RenderImGUI()
 
 void DeferredScene::geometryPass()
 {
+    //CPU culling gets same-frame occlusion from the software rasterizer instead
+    const bool softwareOcclusion = bSoftwareOcclusion && culler_.getMode() == GPUCuller::Mode::CPU;
+    if (softwareOcclusion)
+        occlusionRasterizer_.render(projection * view);
+
+    //instances are reprojected into last frame's Hi-Z; back faces are culled, so the cone test may run
+    const LODView lod = LODView::fromProjection(camera_->GetPosition(), projection, window_height_ * renderScale);
+    const int cullView = culler_.cullView(projection * view, &hiZ_, softwareOcclusion ? &occlusionRasterizer_ : nullptr,
+                                          &lod, true);
+
+    //culling runs at the same cost whatever the scale, only the draws are timed
+    dynamicResolution_.beginTiming();
     geometryShader->use();
-    gBuffer.bindDraw();
-    gBuffer.setDrawBuffers();
 
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, AlbedoTexture_);
-    geometryShader->SetUniform("texture_diff", 0);
-    glActiveTexture(GL_TEXTURE1);
-    glBindTexture(GL_TEXTURE_2D, NormTexture_);
-    geometryShader->SetUniform("texture_normal", 1);
+    // Draws index the material table, nothing is rebound per draw
+    OBJ_MANAGER->getMaterialLibrary().bind();
 
     model = glm::mat4(1.f);
     model = glm::scale(glm::vec3(10.f)) * glm::rotate(glm::radians(180.f), glm::vec3(0.0f, 1.0f, 0.0f));
@@ -392,49 +664,93 @@ void DeferredScene::geometryPass()
 
     geometryShader->SetUniform("view", view);
     geometryShader->SetUniform("projection", projection);
-    geometryShader->SetUniform("isWithTexture", 0);
-    geometryShader->SetUniform("diffColor", glm::vec3(0, 0, 1));
+    geometryShader->SetUniform("materialIndex", defaultMaterial_);
+    geometryShader->SetUniform("bInstanced", true);
 
-    glDepthMask(GL_TRUE);
-    glEnable(GL_DEPTH_TEST);
+    GL_STATE.depthMask(GL_TRUE);
+    GL_STATE.enable(GL_DEPTH_TEST);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-    for (auto& i : OBJ_MANAGER->loaded_models)
-        OBJ_MANAGER->GetMesh(i)->render();
+    GL_STATE.enable(GL_CULL_FACE);
+    GL_STATE.cullFace(GL_BACK);
+    culler_.bindInstances();
+    culler_.drawView(cullView);
+    GL_STATE.disable(GL_CULL_FACE);
+    geometryShader->SetUniform("bInstanced", false);
 
     model = glm::mat4(1.f);
     model = glm::translate(glm::vec3(0, -0.5f, 0)) * glm::rotate(glm::radians(90.f), glm::vec3(1.f, 0.f, 0.f))
         * glm::scale(glm::vec3(5, 5, 1));
     geometryShader->SetUniform("model", model);
-    geometryShader->SetUniform("isWithTexture", 1);
+    geometryShader->SetUniform("materialIndex", silkMaterial_);
     //OBJ_MANAGER->GetMesh("plane")->render();
 
-    glDisable(GL_DEPTH_TEST);
-    glDepthMask(GL_FALSE);
+    GL_STATE.disable(GL_DEPTH_TEST);
+    GL_STATE.depthMask(GL_FALSE);
+
+    dynamicResolution_.endTiming();
+}
+
+void DeferredScene::hiZPass()
+{
+    //Depth is final after the geometry pass: lights test against it now, instances next frame
+    if (bHiZCulling)
+        hiZ_.build(renderGraph_.getTexture(targets_.depth), projection * view);
+    else
+        hiZ_.invalidate();
+    lightCullView = lightCuller_.cullView(projection * view, &hiZ_);
 }
 
 void DeferredScene::shadowPass()
 {
-    glViewport(0, 0, SHADOW_WIDTH, SHADOW_HEIGHT);
+    const LODView lod = LODView::fromProjection(Lights_[0].position, lightProjection, static_cast<float>(SHADOW_HEIGHT),
+                                                SHADOW_LOD_PIXEL_ERROR);
+    const int cullView = culler_.cullView(lightSpaceMatrix, nullptr, nullptr, &lod);
+
+    GL_STATE.viewport(0, 0, SHADOW_WIDTH, SHADOW_HEIGHT);
     shadowShader->use();
     ShadowMap_.bindDraw();
     shadowShader->SetUniform("lightSpaceMatrix", lightSpaceMatrix);
 
-    glDepthMask(GL_TRUE);
-    glEnable(GL_DEPTH_TEST);
+    GL_STATE.depthMask(GL_TRUE);
+    GL_STATE.enable(GL_DEPTH_TEST);
     glClear(GL_DEPTH_BUFFER_BIT);
 
-    for (auto& i : OBJ_MANAGER->loaded_models)
-    {
-        OBJ_MANAGER->GetMesh(i)->render();
-    }
+    shadowShader->SetUniform("bInstanced", true);
+    culler_.bindInstances();
+    culler_.drawView(cullView);
+
+    shadowShader->SetUniform("bInstanced", false);
+    shadowShader->SetUniform("model", glm::translate(glm::vec3(0, -0.5f, 0)) *
+        glm::rotate(glm::radians(90.f), glm::vec3(1.f, 0.f, 0.f)) * glm::scale(glm::vec3(5, 5, 1)));
     OBJ_MANAGER->GetMesh("plane")->render();
 
-    glDisable(GL_DEPTH_TEST);
-    glDepthMask(GL_FALSE);
+    GL_STATE.disable(GL_DEPTH_TEST);
+    GL_STATE.depthMask(GL_FALSE);
 
     ShadowMap_.unbindDraw();
-    glViewport(0, 0, (int)screen_width, (int)screen_height);
+}
+
+void DeferredScene::lightingPass()
+{
+    //only the light target is drawn, the depth target carries the stencil
+    dynamicResolution_.beginTiming();
+    glClear(GL_COLOR_BUFFER_BIT);
+    dynamicResolution_.endTiming();
+
+    for (int i = 0; i < static_cast<int>(Lights_.size()); ++i)
+    {
+        //the cube shadow is a fixed size, only the light volume is timed
+        GL_STATE.viewport(0, 0, 1024, 1024);
+        plShadowPass(Lights_[i]);
+        renderGraph_.bindTarget();
+        dynamicResolution_.beginTiming();
+        GL_STATE.enable(GL_STENCIL_TEST);
+        stencilPass(Lights_[i], i);
+        pointLightPass(Lights_[i], i);
+        GL_STATE.disable(GL_STENCIL_TEST);
+        dynamicResolution_.endTiming();
+    }
 }
 
 void DeferredScene::plShadowPass(PointLight pl)
@@ -448,49 +764,56 @@ void DeferredScene::plShadowPass(PointLight pl)
     stencilShader->SetUniform("worldPos", pl.position);
     stencilShader->SetUniform("radius", pl.radius);
 
-    glDepthMask(GL_TRUE);
-    glEnable(GL_DEPTH_TEST);
+    GL_STATE.depthMask(GL_TRUE);
+    GL_STATE.enable(GL_DEPTH_TEST);
 
     glClear(GL_DEPTH_BUFFER_BIT);
     OBJ_MANAGER->GetMesh("plane")->render();
 
-    glDisable(GL_DEPTH_TEST);
-    glDepthMask(GL_FALSE);
+    GL_STATE.disable(GL_DEPTH_TEST);
+    GL_STATE.depthMask(GL_FALSE);
 
     PointLightShadowMap_.unbindDraw();
 
+    // Cull all six faces up front so the compute dispatches don't interleave with the face draws
+    glm::mat4 faceViewProj[6];
+    int faceCullView[6];
+    const LODView lod = LODView::fromProjection(pl.position, projection, 1024.f, SHADOW_LOD_PIXEL_ERROR);
+    for (int i = 0; i < 6; i++) {
+        faceViewProj[i] = projection * glm::lookAt(pl.position, pl.position + directions[i].target, directions[i].up);
+        faceCullView[i] = culler_.cullView(faceViewProj[i], nullptr, nullptr, &lod);
+    }
+
     pointLightShader->use();
     PointLightShadowMap_.bindDraw();
     glDrawBuffer(GL_COLOR_ATTACHMENT0);
 
     pointLightShader->SetUniform("worldPos", pl.position);
+    pointLightShader->SetUniform("bInstanced", true);
+    culler_.bindInstances();
 
     for (int i = 0; i < 6; i++) {
         glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, directions[i].face, PointLightShadowMap_.cubeMap, 0);
         glClear(GL_COLOR_BUFFER_BIT);
-        pointLightShader->SetUniform("mvp", projection * glm::lookAt(pl.position, pl.position + directions[i].target, directions[i].up));
-        for (auto& i : OBJ_MANAGER->loaded_models)
-        {
-            OBJ_MANAGER->GetMesh(i)->render();
-        }
+        pointLightShader->SetUniform("mvp", faceViewProj[i]);
+        culler_.drawView(faceCullView[i]);
     }
 
     PointLightShadowMap_.unbindDraw();
 }
 
-void DeferredScene::stencilPass(PointLight pl)
+void DeferredScene::stencilPass(PointLight pl, int lightIndex)
 {
     stencilShader->use();
-    gBuffer.bindDraw();
-    gBuffer.setDrawNone();
+    glDrawBuffer(GL_NONE);
 
     stencilShader->SetUniform("mView", view);
     stencilShader->SetUniform("projection", projection);
     stencilShader->SetUniform("worldPos", pl.position);
     stencilShader->SetUniform("radius", pl.radius);
 
-    glEnable(GL_DEPTH_TEST);
-    glStencilFunc(GL_ALWAYS, 0, 0);
+    GL_STATE.enable(GL_DEPTH_TEST);
+    GL_STATE.stencilFunc(GL_ALWAYS, 0, 0);
     glStencilOpSeparate(GL_BACK, GL_KEEP, GL_INCR_WRAP, GL_KEEP);
     glStencilOpSeparate(GL_FRONT, GL_KEEP, GL_DECR_WRAP, GL_KEEP);
 
@@ -498,27 +821,21 @@ void DeferredScene::stencilPass(PointLight pl)
 
     //sphere.render();
 
-    OBJ_MANAGER->GetMesh("plane")->render();
-
-    glDisable(GL_DEPTH_TEST);
+    //occluded volumes draw nothing, which leaves the stencil empty for the light pass
+    lightCuller_.drawMesh(lightCullView, lightIndex);
 
-    gBuffer.unbindDraw();
+    GL_STATE.disable(GL_DEPTH_TEST);
 }
 
-void DeferredScene::pointLightPass(PointLight pl)
+void DeferredScene::pointLightPass(PointLight pl, int lightIndex)
 {
     lightPassShader->use();
-    gBuffer.bindDraw();
-    gBuffer.setDrawLight();
-
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, gBuffer.position);
-    glActiveTexture(GL_TEXTURE1);
-    glBindTexture(GL_TEXTURE_2D, gBuffer.normal);
-    glActiveTexture(GL_TEXTURE2);
-    glBindTexture(GL_TEXTURE_2D, gBuffer.color);
-    glActiveTexture(GL_TEXTURE3);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, PointLightShadowMap_.cubeMap);
+    glDrawBuffer(renderGraph_.getAttachment(targets_.light));
+
+    GL_STATE.bindTexture(0, GL_TEXTURE_2D, renderGraph_.getTexture(targets_.position));
+    GL_STATE.bindTexture(1, GL_TEXTURE_2D, renderGraph_.getTexture(targets_.normal));
+    GL_STATE.bindTexture(2, GL_TEXTURE_2D, renderGraph_.getTexture(targets_.color));
+    GL_STATE.bindTexture(3, GL_TEXTURE_CUBE_MAP, PointLightShadowMap_.cubeMap);
 
     lightPassShader->SetUniform("positionMap", 0);
     lightPassShader->SetUniform("normalMap", 1);
@@ -533,48 +850,43 @@ void DeferredScene::pointLightPass(PointLight pl)
     lightPassShader->SetUniform("lPos", pl.position);
     lightPassShader->SetUniform("lightColor", pl.color);
     //lightPassShader->SetUniform("lightAttenuation", pl.attenuation);
-    lightPassShader->SetUniform("screenSize", glm::vec2(window_width_, window_height_));
+    //target size, not the drawn area: fragment coordinates address the targets directly
+    lightPassShader->SetUniform("screenSize", glm::vec2(renderGraph_.getWidth(), renderGraph_.getHeight()));
 
-    glStencilFunc(GL_NOTEQUAL, 0, 0xFF);
-    glEnable(GL_BLEND);
-    glBlendEquation(GL_FUNC_ADD);
-    glBlendFunc(GL_ONE, GL_ONE);
-    glEnable(GL_CULL_FACE);
+    GL_STATE.stencilFunc(GL_NOTEQUAL, 0, 0xFF);
+    GL_STATE.enable(GL_BLEND);
+    GL_STATE.blendEquation(GL_FUNC_ADD);
+    GL_STATE.blendFunc(GL_ONE, GL_ONE);
+    GL_STATE.enable(GL_CULL_FACE);
 
     //sphere.render();
-    OBJ_MANAGER->GetMesh("plane")->render();
-
-    glDisable(GL_CULL_FACE);
-    glDisable(GL_BLEND);
+    lightCuller_.drawMesh(lightCullView, lightIndex);
 
-    gBuffer.unbindDraw();
+    GL_STATE.disable(GL_CULL_FACE);
+    GL_STATE.disable(GL_BLEND);
 }
 
 void DeferredScene::ssaoPass()
 {
+    dynamicResolution_.beginTiming();
     ssaoShader->use();
-    gBuffer.bindDraw();
-    gBuffer.setDrawEffect();
 
     ssaoShader->SetUniform("projection", projection);
     ssaoShader->SetUniform("kernelSize", kernelSize);
     ssaoShader->SetUniform("noiseScale", noiseScale);
+    ssaoShader->SetUniform("uvScale", uvScale);
     ssaoShader->SetUniform("kernel", kernelSize, &kernel[0]);
 
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, gBuffer.position);
-    glActiveTexture(GL_TEXTURE1);
-    glBindTexture(GL_TEXTURE_2D, gBuffer.normal);
-    glActiveTexture(GL_TEXTURE2);
-    glBindTexture(GL_TEXTURE_2D, noiseTex);
+    GL_STATE.bindTexture(0, GL_TEXTURE_2D, renderGraph_.getTexture(targets_.position));
+    GL_STATE.bindTexture(1, GL_TEXTURE_2D, renderGraph_.getTexture(targets_.normal));
+    GL_STATE.bindTexture(2, GL_TEXTURE_2D, noiseTex);
 
     ssaoShader->SetUniform("positionMap", 0);
     ssaoShader->SetUniform("normalMap", 1);
     ssaoShader->SetUniform("noiseMap", 2);
 
     renderQuad();
-
-    gBuffer.unbindDraw();
+    dynamicResolution_.endTiming();
 }
 
 void DeferredScene::blurPass()
@@ -583,23 +895,18 @@ void DeferredScene::blurPass()
 
 void DeferredScene::compositePass()
 {
+    dynamicResolution_.beginTiming();
     finalPassShader->use();
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
     finalPassShader->SetUniform("inverseMView", glm::inverse(view));
+    finalPassShader->SetUniform("uvScale", uvScale);
 
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, gBuffer.position);
-    glActiveTexture(GL_TEXTURE1);
-    glBindTexture(GL_TEXTURE_2D, gBuffer.normal);
-    glActiveTexture(GL_TEXTURE2);
-    glBindTexture(GL_TEXTURE_2D, gBuffer.color);
-    glActiveTexture(GL_TEXTURE3);
-    glBindTexture(GL_TEXTURE_2D, gBuffer.light);
-    glActiveTexture(GL_TEXTURE4);
-    glBindTexture(GL_TEXTURE_2D, gBuffer.effect1);
-    glActiveTexture(GL_TEXTURE5);
-    glBindTexture(GL_TEXTURE_2D, ShadowMap_.depth);
+    GL_STATE.bindTexture(0, GL_TEXTURE_2D, renderGraph_.getTexture(targets_.position));
+    GL_STATE.bindTexture(1, GL_TEXTURE_2D, renderGraph_.getTexture(targets_.normal));
+    GL_STATE.bindTexture(2, GL_TEXTURE_2D, renderGraph_.getTexture(targets_.color));
+    GL_STATE.bindTexture(3, GL_TEXTURE_2D, renderGraph_.getTexture(targets_.light));
+    GL_STATE.bindTexture(4, GL_TEXTURE_2D, renderGraph_.getTexture(targets_.ssao));
+    GL_STATE.bindTexture(5, GL_TEXTURE_2D, renderGraph_.getTexture(targets_.shadowMap));
 
     finalPassShader->SetUniform("positionMap", 0);
     finalPassShader->SetUniform("normalMap", 1);
@@ -620,29 +927,40 @@ void DeferredScene::compositePass()
 
     renderQuad();
     //glDisable(GL_FRAMEBUFFER_SRGB);
+
+    dynamicResolution_.endTiming();
+}
+
+void DeferredScene::upscalePass()
+{
+    renderGraph_.bindRead(targets_.sceneColor);
+    GL_STATE.bindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+    glBlitFramebuffer(0, 0, renderGraph_.getRenderWidth(), renderGraph_.getRenderHeight(), 0, 0, window_width_,
+        window_height_, GL_COLOR_BUFFER_BIT, GL_LINEAR);
 }
 
 void DeferredScene::skyboxPass()
 {
-    glBindFramebuffer(GL_READ_FRAMEBUFFER, gBuffer.getFBO());
-    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
-    glBlitFramebuffer(0, 0, window_width_, window_height_, 0, 0, window_width_, window_height_, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+    renderGraph_.bindRead(targets_.depth);
+    GL_STATE.bindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+    glBlitFramebuffer(0, 0, renderGraph_.getRenderWidth(), renderGraph_.getRenderHeight(), 0, 0, window_width_,
+        window_height_, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
 
     skyboxShader->use();
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    GL_STATE.bindFramebuffer(GL_FRAMEBUFFER, 0);
+    GL_STATE.viewport(0, 0, window_width_, window_height_);
 
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, skyboxTexture);
+    GL_STATE.bindTexture(0, GL_TEXTURE_CUBE_MAP, skyboxTexture);
 
     skyboxShader->SetUniform("skybox", 0);
 
     skyboxShader->SetUniform("inverseVP", glm::inverse(projection * glm::mat4(glm::mat3(view))));
 
-    glEnable(GL_DEPTH_TEST);
-    glDepthFunc(GL_LEQUAL);
+    GL_STATE.enable(GL_DEPTH_TEST);
+    GL_STATE.depthFunc(GL_LEQUAL);
 
     renderQuad();
-    glDisable(GL_DEPTH_TEST);
+    GL_STATE.disable(GL_DEPTH_TEST);
 }
 
 void DeferredScene::ProcessInput(GLFWwindow* pWwindow, double dt)
@@ -0,0 +1,287 @@
+/* Start Header -------------------------------------------------------
+Copyright (C) 2021 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the prior written
+consent of DigiPen Institute of Technology is prohibited.
+File Name: DynamicResolution.cpp
+Purpose: This file is source for the dynamic resolution controller.
+Language: c++
+Platform: VS2019 / Window
+Project:  HGraphics
+Author: Elliott Hong <s.hong@digipen.edu>
+Creation date: Oct 19, 2026
+End Header ---------------------------------------------------------*/
+#include "DynamicResolution.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+
+// Weight of a new sample in the smoothed time, damps single slow frames
+static const float SMOOTHING = 0.2f;
+
+DynamicResolution::DynamicResolution()
+{
+    settings_.bEnabled = true;
+    settings_.minScale = 0.5f;
+    settings_.maxScale = 1.f;
+    settings_.targetMs = 14.f;
+    settings_.deadBand = 0.1f;
+    settings_.response = 0.5f;
+    settings_.curve = 0.5f;
+    settings_.step = 0.05f;
+    settings_.cooldownFrames = 8;
+
+    for (Timing& timing : timings_)
+    {
+        std::fill(std::begin(timing.begin), std::end(timing.begin), 0u);
+        std::fill(std::begin(timing.end), std::end(timing.end), 0u);
+        timing.sectionCount = 0;
+        timing.scale = 1.f;
+        timing.bPending = false;
+    }
+    next_timing_ = 0;
+    section_open_ = false;
+
+    scale_ = 1.f;
+    gpu_ms_ = 0.f;
+    smoothed_ms_ = 0.f;
+    has_sample_ = false;
+    cooldown_ = 0;
+}
+
+DynamicResolution::~DynamicResolution()
+{
+    for (Timing& timing : timings_)
+    {
+        if (glIsQuery(timing.begin[0]))
+            glDeleteQueries(MAX_SECTIONS, timing.begin);
+        if (glIsQuery(timing.end[0]))
+            glDeleteQueries(MAX_SECTIONS, timing.end);
+    }
+}
+
+void DynamicResolution::init()
+{
+    for (Timing& timing : timings_)
+    {
+        glGenQueries(MAX_SECTIONS, timing.begin);
+        glGenQueries(MAX_SECTIONS, timing.end);
+    }
+}
+
+void DynamicResolution::beginTiming()
+{
+    // Every record still in flight, skip this frame rather than wait
+    Timing& timing = timings_[next_timing_];
+    if (timing.begin[0] == 0 || timing.bPending || section_open_)
+        return;
+
+    // Out of pairs, the last section's end moves on and it takes in the gap before this one
+    if (timing.sectionCount < MAX_SECTIONS)
+    {
+        glQueryCounter(timing.begin[timing.sectionCount], GL_TIMESTAMP);
+        ++timing.sectionCount;
+    }
+    section_open_ = true;
+}
+
+void DynamicResolution::endTiming()
+{
+    if (!section_open_)
+        return;
+
+    Timing& timing = timings_[next_timing_];
+    glQueryCounter(timing.end[timing.sectionCount - 1], GL_TIMESTAMP);
+    section_open_ = false;
+}
+
+void DynamicResolution::endFrame()
+{
+    endTiming();
+
+    Timing& timing = timings_[next_timing_];
+    if (timing.sectionCount == 0 || timing.bPending)
+        return;
+
+    timing.scale = scale_;
+    timing.bPending = true;
+    next_timing_ = (next_timing_ + 1) % QUERY_COUNT;
+}
+
+void DynamicResolution::readTimings()
+{
+    // Oldest first; queries complete in order, so stop at the first one not done
+    for (int i = 0; i < QUERY_COUNT; ++i)
+    {
+        Timing& timing = timings_[(next_timing_ + i) % QUERY_COUNT];
+        if (!timing.bPending)
+            continue;
+
+        GLint available = GL_FALSE;
+        glGetQueryObjectiv(timing.end[timing.sectionCount - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available == GL_FALSE)
+            break;
+
+        GLuint64 elapsed = 0;
+        for (int section = 0; section < timing.sectionCount; ++section)
+        {
+            GLuint64 begin = 0, end = 0;
+            glGetQueryObjectui64v(timing.begin[section], GL_QUERY_RESULT, &begin);
+            glGetQueryObjectui64v(timing.end[section], GL_QUERY_RESULT, &end);
+            elapsed += end - begin;
+        }
+        timing.sectionCount = 0;
+        timing.bPending = false;
+
+        // Frames rendered before the last change say nothing about the current scale
+        if (timing.scale != scale_)
+            continue;
+
+        gpu_ms_ = static_cast<float>(elapsed) / 1000000.f;
+        smoothed_ms_ = has_sample_ ? smoothed_ms_ + (gpu_ms_ - smoothed_ms_) * SMOOTHING : gpu_ms_;
+        has_sample_ = true;
+    }
+}
+
+float DynamicResolution::update()
+{
+    readTimings();
+    if (!settings_.bEnabled || !has_sample_ || settings_.targetMs <= 0.f || smoothed_ms_ <= 0.f)
+        return scale_;
+
+    if (cooldown_ > 0)
+    {
+        --cooldown_;
+        return scale_;
+    }
+
+    if (std::abs(smoothed_ms_ / settings_.targetMs - 1.f) <= settings_.deadBand)
+        return scale_;
+
+    const float ideal = scale_ * std::pow(settings_.targetMs / smoothed_ms_, settings_.curve);
+    float next = scale_ + (ideal - scale_) * settings_.response;
+    if (settings_.step > 0.f)
+    {
+        next = std::round(next / settings_.step) * settings_.step;
+        // A small response can round back to the current scale, still take one step
+        if (next == scale_)
+            next += ideal > scale_ ? settings_.step : -settings_.step;
+    }
+    next = clampScale(next);
+
+    if (next != scale_)
+    {
+        scale_ = next;
+        has_sample_ = false;
+        cooldown_ = settings_.cooldownFrames;
+    }
+    return scale_;
+}
+
+float DynamicResolution::getScale() const
+{
+    return scale_;
+}
+
+void DynamicResolution::setScale(float scale)
+{
+    scale = clampScale(scale);
+    if (scale == scale_)
+        return;
+
+    scale_ = scale;
+    has_sample_ = false;
+    cooldown_ = settings_.cooldownFrames;
+}
+
+float DynamicResolution::getGPUMs() const
+{
+    return gpu_ms_;
+}
+
+float DynamicResolution::getSmoothedMs() const
+{
+    return smoothed_ms_;
+}
+
+DynamicResolution::Settings& DynamicResolution::getSettings()
+{
+    return settings_;
+}
+
+bool DynamicResolution::loadSettings(const std::string& path)
+{
+    std::ifstream file(path);
+    if (!file.is_open())
+        return false;
+
+    std::string line;
+    while (std::getline(file, line))
+    {
+        std::istringstream stream(line);
+        std::string key;
+        float value;
+        if (!(stream >> key) || key[0] == '#')
+            continue;
+        if (!(stream >> value))
+        {
+            std::cout << "DynamicResolution: missing value for " << key << " in " << path << std::endl;
+            continue;
+        }
+
+        if (key == "enabled")
+            settings_.bEnabled = value != 0.f;
+        else if (key == "minScale")
+            settings_.minScale = value;
+        else if (key == "maxScale")
+            settings_.maxScale = value;
+        else if (key == "targetMs")
+            settings_.targetMs = value;
+        else if (key == "deadBand")
+            settings_.deadBand = value;
+        else if (key == "response")
+            settings_.response = value;
+        else if (key == "curve")
+            settings_.curve = value;
+        else if (key == "step")
+            settings_.step = value;
+        else if (key == "cooldownFrames")
+            settings_.cooldownFrames = static_cast<int>(value);
+        else
+            std::cout << "DynamicResolution: unknown setting " << key << " in " << path << std::endl;
+    }
+
+    settings_.minScale = std::max(settings_.minScale, 0.1f);
+    settings_.maxScale = std::max(settings_.maxScale, settings_.minScale);
+    setScale(scale_);
+    return true;
+}
+
+bool DynamicResolution::saveSettings(const std::string& path) const
+{
+    std::ofstream file(path);
+    if (!file.is_open())
+    {
+        std::cout << "DynamicResolution: can't write " << path << std::endl;
+        return false;
+    }
+
+    file << "enabled " << (settings_.bEnabled ? 1 : 0) << "\n";
+    file << "minScale " << settings_.minScale << "\n";
+    file << "maxScale " << settings_.maxScale << "\n";
+    file << "targetMs " << settings_.targetMs << "\n";
+    file << "deadBand " << settings_.deadBand << "\n";
+    file << "response " << settings_.response << "\n";
+    file << "curve " << settings_.curve << "\n";
+    file << "step " << settings_.step << "\n";
+    file << "cooldownFrames " << settings_.cooldownFrames << "\n";
+    return true;
+}
+
+float DynamicResolution::clampScale(float scale) const
+{
+    return std::min(std::max(scale, settings_.minScale), settings_.maxScale);
+}
@@ -0,0 +1,78 @@
+/* Start Header -------------------------------------------------------
+Copyright (C) 2021 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the prior written
+consent of DigiPen Institute of Technology is prohibited.
+File Name: FrameArena.cpp
+Purpose: This file is source for the per frame arena of the render thread.
+Language: c++
+Platform: VS2019 / Window
+Project:  HGraphics
+Author: Elliott Hong <s.hong@digipen.edu>
+Creation date: Oct 19, 2026
+End Header ---------------------------------------------------------*/
+#include "FrameArena.h"
+
+#include <algorithm>
+#include <cstdarg>
+#include <cstdio>
+
+FrameArena FRAME_ARENA;
+
+FrameArena::FrameArena(unsigned frameCount, size_t blockSize)
+{
+    frameCount = std::max(frameCount, 1u);
+    frames_.reserve(frameCount);
+    for (unsigned i = 0; i < frameCount; ++i)
+        frames_.emplace_back(blockSize);
+    current_ = 0;
+}
+
+void FrameArena::beginFrame()
+{
+    current_ = (current_ + 1) % static_cast<unsigned>(frames_.size());
+    frames_[current_].reset();
+}
+
+LinearAllocator& FrameArena::get()
+{
+    return frames_[current_];
+}
+
+const char* FrameArena::format(const char* fmt, ...)
+{
+    va_list args;
+    va_start(args, fmt);
+    va_list measure;
+    va_copy(measure, args);
+    const int length = std::vsnprintf(nullptr, 0, fmt, measure);
+    va_end(measure);
+
+    if (length < 0)
+    {
+        va_end(args);
+        return "";
+    }
+
+    char* text = static_cast<char*>(get().allocate(static_cast<size_t>(length) + 1, 1));
+    std::vsnprintf(text, static_cast<size_t>(length) + 1, fmt, args);
+    va_end(args);
+    return text;
+}
+
+unsigned FrameArena::getFrameCount() const
+{
+    return static_cast<unsigned>(frames_.size());
+}
+
+size_t FrameArena::getUsedBytes() const
+{
+    return frames_[current_].getUsedBytes();
+}
+
+size_t FrameArena::getReservedBytes() const
+{
+    size_t bytes = 0;
+    for (const LinearAllocator& frame : frames_)
+        bytes += frame.getReservedBytes();
+    return bytes;
+}
@@ -0,0 +1,92 @@
+/* Start Header -------------------------------------------------------
+Copyright (C) 2021 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the prior written
+consent of DigiPen Institute of Technology is prohibited.
+File Name: FramePacket.cpp
+Purpose: This file is source for the frame packet handed to the render thread.
+Language: c++
+Platform: VS2019 / Window
+Project:  HGraphics
+Author: Elliott Hong <s.hong@digipen.edu>
+Creation date: Oct 19, 2026
+End Header ---------------------------------------------------------*/
+#include "FramePacket.h"
+
+#include <imgui.h>
+
+void FramePacket::Stats::read()
+{
+    state = GL_STATE.getFrameCounters();
+    calls = GL_INSTRUMENTATION.getFrameStats();
+    entries = GL_INSTRUMENTATION.getEntryStats();
+    lastCapture = GL_INSTRUMENTATION.getLastCapture();
+    bCapturePending = GL_INSTRUMENTATION.isCapturePending();
+    bJsonLogging = GL_INSTRUMENTATION.isJsonLogging();
+}
+
+FramePacket::FramePacket() : commands(memory)
+{
+    index = 0;
+    frame = 0;
+    width = height = 0;
+    time = 0.0;
+    deltaTime = 0.0;
+    camera = FrameCamera{ glm::mat4(1.f), glm::mat4(1.f), glm::vec3(0.f), 0.1f, 100.f };
+    pick = FramePick{};
+    draws = nullptr;
+    drawCount = 0;
+    sceneData = nullptr;
+    ui = nullptr;
+
+    stats.state = GLStateCache::Counters{ 0, 0 };
+    stats.calls = GLInstrumentation::FrameStats{};
+    stats.bCapturePending = false;
+    stats.bJsonLogging = false;
+    stats.renderMs = 0.f;
+    stats.waitMs = 0.f;
+    stats.renderAllocations = 0;
+    stats.buildAllocations = 0;
+}
+
+void FramePacket::reset()
+{
+    commands.clear();
+    memory.reset();
+    draws = nullptr;
+    drawCount = 0;
+    sceneData = nullptr;
+    ui = nullptr;
+}
+
+void FramePacket::copyDrawData(const ImDrawData* drawData)
+{
+    ui = nullptr;
+    if (drawData == nullptr || !drawData->Valid)
+        return;
+
+    ui = memory.create<ImDrawData>();
+    ui->Valid = true;
+    ui->CmdListsCount = drawData->CmdListsCount;
+    ui->TotalIdxCount = drawData->TotalIdxCount;
+    ui->TotalVtxCount = drawData->TotalVtxCount;
+    ui->DisplayPos = drawData->DisplayPos;
+    ui->DisplaySize = drawData->DisplaySize;
+    ui->FramebufferScale = drawData->FramebufferScale;
+    ui->CmdLists = memory.createArray<ImDrawList*>(drawData->CmdListsCount);
+
+    // Only the buffers the GL backend reads; the vectors point into the packet
+    // and are never grown or freed, the lists are dropped with the memory
+    for (int i = 0; i < drawData->CmdListsCount; ++i)
+    {
+        const ImDrawList* source = drawData->CmdLists[i];
+        ImDrawList* list = memory.create<ImDrawList>(nullptr);
+        list->Flags = source->Flags;
+        list->CmdBuffer.Data = memory.copyArray(source->CmdBuffer.Data, source->CmdBuffer.Size);
+        list->CmdBuffer.Size = list->CmdBuffer.Capacity = source->CmdBuffer.Size;
+        list->IdxBuffer.Data = memory.copyArray(source->IdxBuffer.Data, source->IdxBuffer.Size);
+        list->IdxBuffer.Size = list->IdxBuffer.Capacity = source->IdxBuffer.Size;
+        list->VtxBuffer.Data = memory.copyArray(source->VtxBuffer.Data, source->VtxBuffer.Size);
+        list->VtxBuffer.Size = list->VtxBuffer.Capacity = source->VtxBuffer.Size;
+        ui->CmdLists[i] = list;
+    }
+}
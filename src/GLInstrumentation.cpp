@@ -0,0 +1,575 @@
+/* Start Header -------------------------------------------------------
+Copyright (C) 2021 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the prior written
+consent of DigiPen Institute of Technology is prohibited.
+File Name: GLInstrumentation.cpp
+Purpose: This file is source for the GL call counting and frame capture layer.
+Language: c++
+Platform: VS2019 / Window
+Project:  HGraphics
+Author: Elliott Hong <s.hong@digipen.edu>
+Creation date: Oct 19, 2026
+End Header ---------------------------------------------------------*/
+#include "GLInstrumentation.h"
+
+#include <algorithm>
+#include <iostream>
+#include <type_traits>
+
+GLInstrumentation GL_INSTRUMENTATION;
+
+// Every entry point the renderer, its loaders and the ImGui backend call
+#define INSTRUMENTED_CALLS(X) \
+    X(glActiveTexture) X(glAttachShader) X(glBindBuffer) X(glBindBufferBase) X(glBindFramebuffer) \
+    X(glBindImageTexture) X(glBindRenderbuffer) X(glBindSampler) X(glBindTexture) X(glBindVertexArray) X(glBindVertexBuffer) \
+    X(glBlendEquation) X(glBlendEquationSeparate) X(glBlendFunc) X(glBlendFuncSeparate) X(glBlitFramebuffer) \
+    X(glBufferData) X(glBufferStorage) X(glBufferSubData) X(glCheckFramebufferStatus) X(glClear) \
+    X(glClearColor) X(glClientWaitSync) X(glClipControl) X(glCompileShader) X(glCompressedTexImage2D) \
+    X(glCompressedTexSubImage2D) X(glCompressedTexSubImage3D) X(glCopyBufferSubData) X(glCopyImageSubData) \
+    X(glCreateProgram) X(glCreateShader) X(glCullFace) X(glDeleteBuffers) X(glDeleteFramebuffers) \
+    X(glDeleteProgram) X(glDeleteShader) X(glDeleteSync) X(glDeleteTextures) X(glDeleteVertexArrays) \
+    X(glDepthFunc) X(glDepthMask) X(glDetachShader) X(glDisable) X(glDispatchCompute) X(glDrawArrays) \
+    X(glDrawArraysInstanced) X(glDrawBuffer) X(glDrawBuffers) X(glDrawElements) X(glDrawElementsBaseVertex) \
+    X(glDrawElementsIndirect) X(glDrawElementsInstanced) X(glEnable) X(glEnableVertexAttribArray) \
+    X(glFenceSync) X(glFramebufferRenderbuffer) X(glFramebufferTexture2D) X(glFramebufferTextureLayer) \
+    X(glGenBuffers) X(glGenFramebuffers) X(glGenRenderbuffers) X(glGenTextures) X(glGenVertexArrays) \
+    X(glGetAttribLocation) X(glGetError) X(glGetIntegerv) X(glGetProgramInfoLog) X(glGetProgramiv) \
+    X(glGetShaderInfoLog) X(glGetShaderiv) X(glGetString) X(glGetUniformLocation) X(glIsBuffer) X(glIsEnabled) \
+    X(glIsTexture) X(glLinkProgram) X(glMapBufferRange) X(glMemoryBarrier) X(glMultiDrawElementsIndirect) \
+    X(glPixelStorei) X(glPolygonMode) X(glReadBuffer) X(glReadPixels) X(glRenderbufferStorage) X(glScissor) \
+    X(glShaderSource) X(glStencilFunc) X(glStencilOpSeparate) X(glTexImage2D) X(glTexImage3D) \
+    X(glTexParameterf) X(glTexParameteri) X(glTexStorage2D) X(glTexStorage3D) X(glTexSubImage2D) \
+    X(glTexSubImage3D) X(glUniform1d) X(glUniform1f) X(glUniform1i) X(glUniform1ui) X(glUniform2f) \
+    X(glUniform3f) X(glUniform3fv) X(glUniform4f) X(glUniform4fv) X(glUniformMatrix3fv) X(glUniformMatrix4fv) \
+    X(glUseProgram) X(glVertexAttribBinding) X(glVertexAttribDivisor) X(glVertexAttribFormat) X(glVertexAttribIPointer) \
+    X(glVertexAttribPointer) X(glViewport) \
+    X(glGetTextureHandleARB) X(glMakeTextureHandleResidentARB) X(glMakeTextureHandleNonResidentARB)
+
+namespace
+{
+    enum CallId
+    {
+#define CALL_ID(name) CALL_##name,
+        INSTRUMENTED_CALLS(CALL_ID)
+#undef CALL_ID
+        CALL_COUNT
+    };
+
+    const char* CALL_NAMES[CALL_COUNT] = {
+#define CALL_NAME(name) #name,
+        INSTRUMENTED_CALLS(CALL_NAME)
+#undef CALL_NAME
+    };
+
+    GLint getBytesPerPixel(GLenum format, GLenum type)
+    {
+        switch (type)
+        {
+        case GL_UNSIGNED_INT_24_8:
+        case GL_UNSIGNED_INT_8_8_8_8:
+        case GL_UNSIGNED_INT_8_8_8_8_REV:
+        case GL_UNSIGNED_INT_2_10_10_10_REV:
+        case GL_UNSIGNED_INT_10F_11F_11F_REV:
+            return 4;
+        case GL_UNSIGNED_SHORT_5_6_5:
+        case GL_UNSIGNED_SHORT_4_4_4_4:
+        case GL_UNSIGNED_SHORT_5_5_5_1:
+            return 2;
+        default:
+            break;
+        }
+
+        GLint components;
+        switch (format)
+        {
+        case GL_RG:
+        case GL_RG_INTEGER:
+            components = 2;
+            break;
+        case GL_RGB:
+        case GL_BGR:
+        case GL_RGB_INTEGER:
+            components = 3;
+            break;
+        case GL_RGBA:
+        case GL_BGRA:
+        case GL_RGBA_INTEGER:
+            components = 4;
+            break;
+        default:
+            components = 1;
+            break;
+        }
+
+        switch (type)
+        {
+        case GL_SHORT:
+        case GL_UNSIGNED_SHORT:
+        case GL_HALF_FLOAT:
+            return components * 2;
+        case GL_INT:
+        case GL_UNSIGNED_INT:
+        case GL_FLOAT:
+            return components * 4;
+        default:
+            return components;
+        }
+    }
+
+    void addPixels(GLsizei width, GLsizei height, GLsizei depth, GLenum format, GLenum type, const void* pixels)
+    {
+        // A null pointer only allocates, unless a pixel unpack buffer is the source
+        if (pixels == nullptr && !GL_INSTRUMENTATION.hasUnpackBuffer())
+            return;
+        GL_INSTRUMENTATION.addTextureBytes(static_cast<GLsizeiptr>(width) * height * depth * getBytesPerPixel(format, type));
+    }
+
+    // Capture formatting. Pointers below 64K are buffer offsets and printed,
+    // real addresses change every run and would only add noise to a diff
+    template <typename T>
+    void writeArg(std::ostream& out, T value)
+    {
+        if constexpr (std::is_pointer<T>::value)
+        {
+            const uintptr_t address = reinterpret_cast<uintptr_t>(value);
+            if (address < 0x10000)
+                out << "0x" << std::hex << address << std::dec;
+            else
+                out << "ptr";
+        }
+        else if constexpr (std::is_same<T, GLboolean>::value)
+        {
+            out << static_cast<int>(value);
+        }
+        else
+        {
+            out << value;
+        }
+    }
+
+    void writeArg(std::ostream& out, const GLchar* value)
+    {
+        if (value)
+            out << '"' << value << '"';
+        else
+            out << "null";
+    }
+
+    // Per entry point side effects on the frame counters; most entry points only count
+    template <int Id>
+    struct Observer
+    {
+        template <typename... Args>
+        static void observe(Args...)
+        {
+        }
+    };
+
+    template <>
+    struct Observer<CALL_glDrawArrays>
+    {
+        static void observe(GLenum mode, GLint, GLsizei count)
+        {
+            GL_INSTRUMENTATION.addDraw(mode, count, 1);
+        }
+    };
+
+    template <>
+    struct Observer<CALL_glDrawArraysInstanced>
+    {
+        static void observe(GLenum mode, GLint, GLsizei count, GLsizei instances)
+        {
+            GL_INSTRUMENTATION.addDraw(mode, count, instances);
+        }
+    };
+
+    template <>
+    struct Observer<CALL_glDrawElements>
+    {
+        static void observe(GLenum mode, GLsizei count, GLenum, const void*)
+        {
+            GL_INSTRUMENTATION.addDraw(mode, count, 1);
+        }
+    };
+
+    template <>
+    struct Observer<CALL_glDrawElementsBaseVertex>
+    {
+        static void observe(GLenum mode, GLsizei count, GLenum, const void*, GLint)
+        {
+            GL_INSTRUMENTATION.addDraw(mode, count, 1);
+        }
+    };
+
+    template <>
+    struct Observer<CALL_glDrawElementsInstanced>
+    {
+        static void observe(GLenum mode, GLsizei count, GLenum, const void*, GLsizei instances)
+        {
+            GL_INSTRUMENTATION.addDraw(mode, count, instances);
+        }
+    };
+
+    template <>
+    struct Observer<CALL_glDrawElementsIndirect>
+    {
+        static void observe(GLenum, GLenum, const void*)
+        {
+            GL_INSTRUMENTATION.addIndirectDraw(1);
+        }
+    };
+
+    template <>
+    struct Observer<CALL_glMultiDrawElementsIndirect>
+    {
+        static void observe(GLenum, GLenum, const void*, GLsizei drawCount, GLsizei)
+        {
+            GL_INSTRUMENTATION.addIndirectDraw(drawCount);
+        }
+    };
+
+    template <>
+    struct Observer<CALL_glDispatchCompute>
+    {
+        static void observe(GLuint, GLuint, GLuint)
+        {
+            GL_INSTRUMENTATION.addDispatch();
+        }
+    };
+
+    template <>
+    struct Observer<CALL_glBindBuffer>
+    {
+        static void observe(GLenum target, GLuint buffer)
+        {
+            if (target == GL_PIXEL_UNPACK_BUFFER)
+                GL_INSTRUMENTATION.setUnpackBuffer(buffer);
+        }
+    };
+
+    template <>
+    struct Observer<CALL_glBufferData>
+    {
+        static void observe(GLenum, GLsizeiptr size, const void* data, GLenum)
+        {
+            if (data)
+                GL_INSTRUMENTATION.addBufferBytes(size);
+        }
+    };
+
+    template <>
+    struct Observer<CALL_glBufferStorage>
+    {
+        static void observe(GLenum, GLsizeiptr size, const void* data, GLbitfield)
+        {
+            if (data)
+                GL_INSTRUMENTATION.addBufferBytes(size);
+        }
+    };
+
+    template <>
+    struct Observer<CALL_glBufferSubData>
+    {
+        static void observe(GLenum, GLintptr, GLsizeiptr size, const void*)
+        {
+            GL_INSTRUMENTATION.addBufferBytes(size);
+        }
+    };
+
+    template <>
+    struct Observer<CALL_glTexImage2D>
+    {
+        static void observe(GLenum, GLint, GLint, GLsizei width, GLsizei height, GLint, GLenum format, GLenum type,
+                            const void* pixels)
+        {
+            addPixels(width, height, 1, format, type, pixels);
+        }
+    };
+
+    template <>
+    struct Observer<CALL_glTexImage3D>
+    {
+        static void observe(GLenum, GLint, GLint, GLsizei width, GLsizei height, GLsizei depth, GLint, GLenum format,
+                            GLenum type, const void* pixels)
+        {
+            addPixels(width, height, depth, format, type, pixels);
+        }
+    };
+
+    template <>
+    struct Observer<CALL_glTexSubImage2D>
+    {
+        static void observe(GLenum, GLint, GLint, GLint, GLsizei width, GLsizei height, GLenum format, GLenum type,
+                            const void* pixels)
+        {
+            addPixels(width, height, 1, format, type, pixels);
+        }
+    };
+
+    template <>
+    struct Observer<CALL_glTexSubImage3D>
+    {
+        static void observe(GLenum, GLint, GLint, GLint, GLint, GLsizei width, GLsizei height, GLsizei depth,
+                            GLenum format, GLenum type, const void* pixels)
+        {
+            addPixels(width, height, depth, format, type, pixels);
+        }
+    };
+
+    template <>
+    struct Observer<CALL_glCompressedTexImage2D>
+    {
+        static void observe(GLenum, GLint, GLenum, GLsizei, GLsizei, GLint, GLsizei imageSize, const void*)
+        {
+            GL_INSTRUMENTATION.addTextureBytes(imageSize);
+        }
+    };
+
+    template <>
+    struct Observer<CALL_glCompressedTexSubImage2D>
+    {
+        static void observe(GLenum, GLint, GLint, GLint, GLsizei, GLsizei, GLenum, GLsizei imageSize, const void*)
+        {
+            GL_INSTRUMENTATION.addTextureBytes(imageSize);
+        }
+    };
+
+    template <>
+    struct Observer<CALL_glCompressedTexSubImage3D>
+    {
+        static void observe(GLenum, GLint, GLint, GLint, GLint, GLsizei, GLsizei, GLsizei, GLenum, GLsizei imageSize,
+                            const void*)
+        {
+            GL_INSTRUMENTATION.addTextureBytes(imageSize);
+        }
+    };
+
+#ifdef HGRAPHICS_GL_INSTRUMENTATION
+    // Driver entry points the wrappers forward to
+    void* originals[CALL_COUNT] = {};
+
+    template <int Id, typename F>
+    struct Hook;
+
+    template <int Id, typename R, typename... Args>
+    struct Hook<Id, R (APIENTRYP)(Args...)>
+    {
+        static R APIENTRY call(Args... args)
+        {
+            GL_INSTRUMENTATION.onCall(Id);
+            Observer<Id>::observe(args...);
+            if (GL_INSTRUMENTATION.isCapturing())
+            {
+                std::ofstream& out = GL_INSTRUMENTATION.getCaptureStream();
+                out << CALL_NAMES[Id] << '(';
+                const char* separator = "";
+                ((out << separator, writeArg(out, args), separator = ", "), ...);
+                (void)separator;
+                out << ")\n";
+            }
+            return reinterpret_cast<R (APIENTRYP)(Args...)>(originals[Id])(args...);
+        }
+    };
+#endif
+}
+
+GLInstrumentation::GLInstrumentation()
+    : installed_(false), calls_(CALL_COUNT, 0), frame_{}, last_frame_{}, unpack_buffer_(0)
+{
+}
+
+GLInstrumentation::~GLInstrumentation()
+{
+    if (capture_.is_open())
+        capture_.close();
+    if (json_.is_open())
+        json_.close();
+}
+
+bool GLInstrumentation::isCompiledIn()
+{
+#ifdef HGRAPHICS_GL_INSTRUMENTATION
+    return true;
+#else
+    return false;
+#endif
+}
+
+void GLInstrumentation::install()
+{
+#ifdef HGRAPHICS_GL_INSTRUMENTATION
+    if (installed_)
+        return;
+
+    // Extensions the driver lacks stay null and are not wrapped
+#define INSTALL_HOOK(name) \
+    if (glad_##name != nullptr) \
+    { \
+        originals[CALL_##name] = reinterpret_cast<void*>(glad_##name); \
+        glad_##name = &Hook<CALL_##name, decltype(glad_##name)>::call; \
+    }
+    INSTRUMENTED_CALLS(INSTALL_HOOK)
+#undef INSTALL_HOOK
+
+    installed_ = true;
+#endif
+}
+
+bool GLInstrumentation::isInstalled() const
+{
+    return installed_;
+}
+
+void GLInstrumentation::endFrame()
+{
+    if (!installed_)
+        return;
+
+    last_frame_ = frame_;
+    last_entries_.clear();
+    for (int i = 0; i < CALL_COUNT; ++i)
+    {
+        if (calls_[i] != 0)
+            last_entries_.push_back({ CALL_NAMES[i], calls_[i] });
+    }
+    std::sort(last_entries_.begin(), last_entries_.end(),
+              [](const EntryStats& a, const EntryStats& b) { return a.calls > b.calls; });
+
+    if (json_.is_open())
+        writeJson();
+
+    if (capture_.is_open())
+    {
+        capture_.close();
+        std::cout << "GL frame " << last_frame_.frame << " captured to " << last_capture_ << std::endl;
+    }
+    if (!capture_path_.empty())
+    {
+        capture_.open(capture_path_);
+        if (!capture_.is_open())
+            std::cout << "GLInstrumentation: can't open " << capture_path_ << std::endl;
+        last_capture_ = capture_path_;
+        capture_path_.clear();
+    }
+
+    std::fill(calls_.begin(), calls_.end(), 0);
+    const unsigned frame = frame_.frame + 1;
+    frame_ = FrameStats{};
+    frame_.frame = frame;
+}
+
+const GLInstrumentation::FrameStats& GLInstrumentation::getFrameStats() const
+{
+    return last_frame_;
+}
+
+const std::vector<GLInstrumentation::EntryStats>& GLInstrumentation::getEntryStats() const
+{
+    return last_entries_;
+}
+
+void GLInstrumentation::captureNextFrame(const std::string& path)
+{
+    capture_path_ = path;
+}
+
+bool GLInstrumentation::isCapturePending() const
+{
+    return !capture_path_.empty() || capture_.is_open();
+}
+
+const std::string& GLInstrumentation::getLastCapture() const
+{
+    return last_capture_;
+}
+
+void GLInstrumentation::setJsonLog(const std::string& path)
+{
+    if (json_.is_open())
+        json_.close();
+    if (path.empty())
+        return;
+
+    json_.open(path, std::ios::app);
+    if (!json_.is_open())
+        std::cout << "GLInstrumentation: can't open " << path << std::endl;
+}
+
+bool GLInstrumentation::isJsonLogging() const
+{
+    return json_.is_open();
+}
+
+void GLInstrumentation::writeJson()
+{
+    json_ << "{\"frame\":" << last_frame_.frame
+          << ",\"calls\":" << last_frame_.calls
+          << ",\"draws\":" << last_frame_.draws
+          << ",\"indirectDraws\":" << last_frame_.indirectDraws
+          << ",\"dispatches\":" << last_frame_.dispatches
+          << ",\"triangles\":" << last_frame_.triangles
+          << ",\"bufferBytes\":" << last_frame_.bufferBytes
+          << ",\"textureBytes\":" << last_frame_.textureBytes
+          << ",\"entries\":{";
+    for (size_t i = 0; i < last_entries_.size(); ++i)
+        json_ << (i == 0 ? "" : ",") << '"' << last_entries_[i].name << "\":" << last_entries_[i].calls;
+    json_ << "}}\n";
+}
+
+void GLInstrumentation::onCall(int entry)
+{
+    ++calls_[entry];
+    ++frame_.calls;
+}
+
+bool GLInstrumentation::isCapturing() const
+{
+    return capture_.is_open();
+}
+
+std::ofstream& GLInstrumentation::getCaptureStream()
+{
+    return capture_;
+}
+
+void GLInstrumentation::addDraw(GLenum mode, GLsizei count, GLsizei instances)
+{
+    ++frame_.draws;
+
+    uint64_t triangles = 0;
+    if (mode == GL_TRIANGLES)
+        triangles = count / 3;
+    else if ((mode == GL_TRIANGLE_STRIP || mode == GL_TRIANGLE_FAN) && count > 2)
+        triangles = count - 2;
+    frame_.triangles += triangles * std::max(instances, 0);
+}
+
+void GLInstrumentation::addIndirectDraw(GLsizei drawCount)
+{
+    frame_.indirectDraws += std::max(drawCount, 0);
+}
+
+void GLInstrumentation::addDispatch()
+{
+    ++frame_.dispatches;
+}
+
+void GLInstrumentation::addBufferBytes(GLsizeiptr bytes)
+{
+    frame_.bufferBytes += std::max<GLsizeiptr>(bytes, 0);
+}
+
+void GLInstrumentation::addTextureBytes(GLsizeiptr bytes)
+{
+    frame_.textureBytes += std::max<GLsizeiptr>(bytes, 0);
+}
+
+void GLInstrumentation::setUnpackBuffer(GLuint buffer)
+{
+    unpack_buffer_ = buffer;
+}
+
+bool GLInstrumentation::hasUnpackBuffer() const
+{
+    return unpack_buffer_ != 0;
+}
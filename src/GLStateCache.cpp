@@ -0,0 +1,399 @@
+/* Start Header -------------------------------------------------------
+Copyright (C) 2021 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the prior written
+consent of DigiPen Institute of Technology is prohibited.
+File Name: GLStateCache.cpp
+Purpose: This file is source for the OpenGL state cache.
+Language: c++
+Platform: VS2019 / Window
+Project:  HGraphics
+Author: Elliott Hong <s.hong@digipen.edu>
+Creation date: Oct 19, 2026
+End Header ---------------------------------------------------------*/
+#include "GLStateCache.h"
+
+GLStateCache GL_STATE;
+
+namespace
+{
+    // No object or enum uses this value, so it never matches a real call
+    const GLuint UNKNOWN = 0xFFFFFFFF;
+}
+
+GLStateCache::GLStateCache()
+    : frame_{ 0, 0 }, last_frame_{ 0, 0 }
+{
+    invalidate();
+}
+
+void GLStateCache::beginFrame()
+{
+    last_frame_ = frame_;
+    frame_ = { 0, 0 };
+    invalidate();
+}
+
+void GLStateCache::invalidate()
+{
+    program_ = UNKNOWN;
+    vao_ = UNKNOWN;
+    for (GLuint& buffer : buffers_)
+        buffer = UNKNOWN;
+    for (int i = 0; i < MAX_BUFFER_INDICES; ++i)
+    {
+        storage_bindings_[i] = UNKNOWN;
+        uniform_bindings_[i] = UNKNOWN;
+    }
+    active_unit_ = UNKNOWN;
+    for (auto& unit : textures_)
+    {
+        for (GLuint& texture : unit)
+            texture = UNKNOWN;
+    }
+    draw_framebuffer_ = UNKNOWN;
+    read_framebuffer_ = UNKNOWN;
+
+    for (int& capability : capabilities_)
+        capability = -1;
+    depth_mask_ = -1;
+    depth_func_ = UNKNOWN;
+    blend_src_ = UNKNOWN;
+    blend_dst_ = UNKNOWN;
+    blend_equation_ = UNKNOWN;
+    cull_face_ = UNKNOWN;
+    stencil_func_ = UNKNOWN;
+    stencil_ref_ = 0;
+    stencil_mask_ = 0;
+    viewport_[0] = viewport_[1] = 0;
+    viewport_[2] = viewport_[3] = -1;
+}
+
+bool GLStateCache::check(bool bChanged)
+{
+    if (bChanged)
+        ++frame_.issued;
+    else
+        ++frame_.elided;
+    return bChanged;
+}
+
+void GLStateCache::useProgram(GLuint program)
+{
+    if (!check(program_ != program))
+        return;
+    program_ = program;
+    glUseProgram(program);
+}
+
+void GLStateCache::bindVertexArray(GLuint vao)
+{
+    if (!check(vao_ != vao))
+        return;
+    vao_ = vao;
+    buffers_[ELEMENT_ARRAY_BUFFER] = UNKNOWN;
+    glBindVertexArray(vao);
+}
+
+void GLStateCache::bindBuffer(GLenum target, GLuint buffer)
+{
+    const int index = getBufferTarget(target);
+    if (index < 0)
+    {
+        check(true);
+        glBindBuffer(target, buffer);
+        return;
+    }
+
+    if (!check(buffers_[index] != buffer))
+        return;
+    buffers_[index] = buffer;
+    glBindBuffer(target, buffer);
+}
+
+void GLStateCache::bindBufferBase(GLenum target, GLuint index, GLuint buffer)
+{
+    GLuint* bindings = nullptr;
+    if (index < MAX_BUFFER_INDICES)
+    {
+        if (target == GL_SHADER_STORAGE_BUFFER)
+            bindings = storage_bindings_;
+        else if (target == GL_UNIFORM_BUFFER)
+            bindings = uniform_bindings_;
+    }
+
+    if (!check(bindings == nullptr || bindings[index] != buffer))
+        return;
+    if (bindings)
+        bindings[index] = buffer;
+    const int generic = getBufferTarget(target);
+    if (generic >= 0)
+        buffers_[generic] = buffer;
+    glBindBufferBase(target, index, buffer);
+}
+
+void GLStateCache::activeTexture(GLuint unit)
+{
+    if (!check(active_unit_ != unit))
+        return;
+    active_unit_ = unit;
+    glActiveTexture(GL_TEXTURE0 + unit);
+}
+
+void GLStateCache::bindTexture(GLuint unit, GLenum target, GLuint texture)
+{
+    const int index = getTextureTarget(target);
+    if (unit < MAX_TEXTURE_UNITS && index >= 0)
+    {
+        if (textures_[unit][index] == texture)
+        {
+            check(false);
+            return;
+        }
+        textures_[unit][index] = texture;
+    }
+
+    activeTexture(unit);
+    check(true);
+    glBindTexture(target, texture);
+}
+
+void GLStateCache::bindFramebuffer(GLenum target, GLuint framebuffer)
+{
+    bool bChanged;
+    if (target == GL_DRAW_FRAMEBUFFER)
+    {
+        bChanged = draw_framebuffer_ != framebuffer;
+        draw_framebuffer_ = framebuffer;
+    }
+    else if (target == GL_READ_FRAMEBUFFER)
+    {
+        bChanged = read_framebuffer_ != framebuffer;
+        read_framebuffer_ = framebuffer;
+    }
+    else
+    {
+        bChanged = draw_framebuffer_ != framebuffer || read_framebuffer_ != framebuffer;
+        draw_framebuffer_ = framebuffer;
+        read_framebuffer_ = framebuffer;
+    }
+
+    if (check(bChanged))
+        glBindFramebuffer(target, framebuffer);
+}
+
+void GLStateCache::enable(GLenum cap)
+{
+    setEnabled(cap, true);
+}
+
+void GLStateCache::disable(GLenum cap)
+{
+    setEnabled(cap, false);
+}
+
+void GLStateCache::setEnabled(GLenum cap, bool bEnabled)
+{
+    const int index = getCapability(cap);
+    if (index >= 0)
+    {
+        if (!check(capabilities_[index] != static_cast<int>(bEnabled)))
+            return;
+        capabilities_[index] = bEnabled;
+    }
+    else
+    {
+        check(true);
+    }
+
+    if (bEnabled)
+        glEnable(cap);
+    else
+        glDisable(cap);
+}
+
+void GLStateCache::depthMask(GLboolean bWrite)
+{
+    if (!check(depth_mask_ != static_cast<int>(bWrite)))
+        return;
+    depth_mask_ = bWrite;
+    glDepthMask(bWrite);
+}
+
+void GLStateCache::depthFunc(GLenum func)
+{
+    if (!check(depth_func_ != func))
+        return;
+    depth_func_ = func;
+    glDepthFunc(func);
+}
+
+void GLStateCache::blendFunc(GLenum src, GLenum dst)
+{
+    if (!check(blend_src_ != src || blend_dst_ != dst))
+        return;
+    blend_src_ = src;
+    blend_dst_ = dst;
+    glBlendFunc(src, dst);
+}
+
+void GLStateCache::blendEquation(GLenum mode)
+{
+    if (!check(blend_equation_ != mode))
+        return;
+    blend_equation_ = mode;
+    glBlendEquation(mode);
+}
+
+void GLStateCache::cullFace(GLenum mode)
+{
+    if (!check(cull_face_ != mode))
+        return;
+    cull_face_ = mode;
+    glCullFace(mode);
+}
+
+void GLStateCache::stencilFunc(GLenum func, GLint ref, GLuint mask)
+{
+    if (!check(stencil_func_ != func || stencil_ref_ != ref || stencil_mask_ != mask))
+        return;
+    stencil_func_ = func;
+    stencil_ref_ = ref;
+    stencil_mask_ = mask;
+    glStencilFunc(func, ref, mask);
+}
+
+void GLStateCache::viewport(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+    if (!check(viewport_[0] != x || viewport_[1] != y || viewport_[2] != width || viewport_[3] != height))
+        return;
+    viewport_[0] = x;
+    viewport_[1] = y;
+    viewport_[2] = width;
+    viewport_[3] = height;
+    glViewport(x, y, width, height);
+}
+
+void GLStateCache::deleteBuffers(GLsizei count, const GLuint* buffers)
+{
+    for (GLsizei i = 0; i < count; ++i)
+    {
+        for (GLuint& buffer : buffers_)
+        {
+            if (buffer == buffers[i])
+                buffer = 0;
+        }
+        for (int j = 0; j < MAX_BUFFER_INDICES; ++j)
+        {
+            if (storage_bindings_[j] == buffers[i])
+                storage_bindings_[j] = 0;
+            if (uniform_bindings_[j] == buffers[i])
+                uniform_bindings_[j] = 0;
+        }
+    }
+    glDeleteBuffers(count, buffers);
+}
+
+void GLStateCache::deleteTextures(GLsizei count, const GLuint* textures)
+{
+    for (GLsizei i = 0; i < count; ++i)
+    {
+        for (auto& unit : textures_)
+        {
+            for (GLuint& texture : unit)
+            {
+                if (texture == textures[i])
+                    texture = 0;
+            }
+        }
+    }
+    glDeleteTextures(count, textures);
+}
+
+void GLStateCache::deleteFramebuffers(GLsizei count, const GLuint* framebuffers)
+{
+    for (GLsizei i = 0; i < count; ++i)
+    {
+        if (draw_framebuffer_ == framebuffers[i])
+            draw_framebuffer_ = 0;
+        if (read_framebuffer_ == framebuffers[i])
+            read_framebuffer_ = 0;
+    }
+    glDeleteFramebuffers(count, framebuffers);
+}
+
+void GLStateCache::deleteVertexArrays(GLsizei count, const GLuint* vaos)
+{
+    for (GLsizei i = 0; i < count; ++i)
+    {
+        if (vao_ == vaos[i])
+        {
+            vao_ = 0;
+            buffers_[ELEMENT_ARRAY_BUFFER] = UNKNOWN;
+        }
+    }
+    glDeleteVertexArrays(count, vaos);
+}
+
+const GLStateCache::Counters& GLStateCache::getFrameCounters() const
+{
+    return last_frame_;
+}
+
+int GLStateCache::getBufferTarget(GLenum target)
+{
+    switch (target)
+    {
+    case GL_ARRAY_BUFFER:
+        return ARRAY_BUFFER;
+    case GL_ELEMENT_ARRAY_BUFFER:
+        return ELEMENT_ARRAY_BUFFER;
+    case GL_DRAW_INDIRECT_BUFFER:
+        return DRAW_INDIRECT_BUFFER;
+    case GL_SHADER_STORAGE_BUFFER:
+        return SHADER_STORAGE_BUFFER;
+    case GL_UNIFORM_BUFFER:
+        return UNIFORM_BUFFER;
+    case GL_COPY_READ_BUFFER:
+        return COPY_READ_BUFFER;
+    case GL_COPY_WRITE_BUFFER:
+        return COPY_WRITE_BUFFER;
+    case GL_PIXEL_UNPACK_BUFFER:
+        return PIXEL_UNPACK_BUFFER;
+    default:
+        return -1;
+    }
+}
+
+int GLStateCache::getTextureTarget(GLenum target)
+{
+    switch (target)
+    {
+    case GL_TEXTURE_2D:
+        return TEXTURE_2D;
+    case GL_TEXTURE_2D_ARRAY:
+        return TEXTURE_2D_ARRAY;
+    case GL_TEXTURE_CUBE_MAP:
+        return TEXTURE_CUBE_MAP;
+    default:
+        return -1;
+    }
+}
+
+int GLStateCache::getCapability(GLenum cap)
+{
+    switch (cap)
+    {
+    case GL_DEPTH_TEST:
+        return DEPTH_TEST;
+    case GL_STENCIL_TEST:
+        return STENCIL_TEST;
+    case GL_BLEND:
+        return BLEND;
+    case GL_CULL_FACE:
+        return CULL_FACE;
+    case GL_SCISSOR_TEST:
+        return SCISSOR_TEST;
+    default:
+        return -1;
+    }
+}
@@ -0,0 +1,662 @@
+/* Start Header -------------------------------------------------------
+Copyright (C) 2021 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the prior written
+consent of DigiPen Institute of Technology is prohibited.
+File Name: GPUCuller.cpp
+Purpose: This file culls instances in a compute shader and writes indirect draw commands.
+Language: c++
+Platform: VS2019 / Window
+Project:  HGraphics
+Author: Elliott Hong <s.hong@digipen.edu>
+Creation date: Oct 19, 2026
+End Header ---------------------------------------------------------*/
+#include "GPUCuller.h"
+#include "FrameArena.h"
+#include "GLStateCache.h"
+#include "JobSystem.h"
+#include "OcclusionRasterizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+static constexpr GLuint CULL_GROUP_SIZE = 64;
+
+GPUCuller::GPUCuller()
+{
+    instance_buffer_ = 0;
+    command_buffer_ = 0;
+    command_template_buffer_ = 0;
+    instance_id_buffer_ = 0;
+    visibility_buffer_ = 0;
+    meshlet_buffer_ = 0;
+    cluster_buffer_ = 0;
+    cluster_command_buffer_ = 0;
+    view_count_ = 0;
+    view_capacity_ = 0;
+    last_visible_count_ = 0;
+    last_cluster_tested_count_ = 0;
+    last_cluster_visible_count_ = 0;
+    mode_ = Mode::GPU;
+    b_cluster_culling_ = false;
+    b_cone_culling_ = true;
+}
+
+GPUCuller::~GPUCuller()
+{
+    if (glIsBuffer(instance_buffer_))
+        glDeleteBuffers(1, &instance_buffer_);
+    if (glIsBuffer(command_buffer_))
+        glDeleteBuffers(1, &command_buffer_);
+    if (glIsBuffer(command_template_buffer_))
+        glDeleteBuffers(1, &command_template_buffer_);
+    if (glIsBuffer(instance_id_buffer_))
+        glDeleteBuffers(1, &instance_id_buffer_);
+    if (glIsBuffer(visibility_buffer_))
+        glDeleteBuffers(1, &visibility_buffer_);
+    if (glIsBuffer(meshlet_buffer_))
+        glDeleteBuffers(1, &meshlet_buffer_);
+    if (glIsBuffer(cluster_buffer_))
+        glDeleteBuffers(1, &cluster_buffer_);
+    if (glIsBuffer(cluster_command_buffer_))
+        glDeleteBuffers(1, &cluster_command_buffer_);
+}
+
+void GPUCuller::init()
+{
+    cull_shader_ = std::make_unique<Shader>();
+    cull_shader_->loadComputeShader("../assets/shader/cull.comp");
+    cluster_shader_ = std::make_unique<Shader>();
+    cluster_shader_->loadComputeShader("../assets/shader/clusterCull.comp");
+
+    glGenBuffers(1, &instance_buffer_);
+    glGenBuffers(1, &command_buffer_);
+    glGenBuffers(1, &command_template_buffer_);
+    glGenBuffers(1, &instance_id_buffer_);
+    glGenBuffers(1, &visibility_buffer_);
+    glGenBuffers(1, &meshlet_buffer_);
+    glGenBuffers(1, &cluster_buffer_);
+    glGenBuffers(1, &cluster_command_buffer_);
+
+    // Software rasterizers run compute on the CPU anyway, cull there directly
+    const char* renderer = reinterpret_cast<const char*>(glGetString(GL_RENDERER));
+    if (renderer && (strstr(renderer, "llvmpipe") || strstr(renderer, "softpipe") || strstr(renderer, "SwiftShader")))
+        mode_ = Mode::CPU;
+}
+
+void GPUCuller::setInstances(const std::vector<Mesh*>& meshes, const std::vector<InstanceData>& instances)
+{
+    meshes_ = meshes;
+    instances_ = instances;
+
+    // Instances of the same mesh get a contiguous range in every view's instance-ID block
+    std::vector<GLuint> perMesh(meshes_.size(), 0);
+    for (const auto& instance : instances_)
+        ++perMesh[instance.mesh_index];
+
+    mesh_instance_offset_.assign(meshes_.size(), 0);
+    GLuint offset = 0;
+    for (size_t i = 0; i < meshes_.size(); ++i)
+    {
+        mesh_instance_offset_[i] = offset;
+        offset += perMesh[i];
+    }
+
+    // Every meshlet of every instance, instances of one mesh next to each other like their IDs
+    meshlets_.clear();
+    clusters_.clear();
+    mesh_cluster_offset_.assign(meshes_.size(), 0);
+    mesh_cluster_count_.assign(meshes_.size(), 0);
+    for (size_t m = 0; m < meshes_.size(); ++m)
+    {
+        const std::vector<Meshlet>& meshlets = meshes_[m]->getMeshlets();
+        const GLuint firstMeshlet = static_cast<GLuint>(meshlets_.size());
+        meshlets_.insert(meshlets_.end(), meshlets.begin(), meshlets.end());
+
+        mesh_cluster_offset_[m] = static_cast<GLuint>(clusters_.size());
+        for (size_t i = 0; i < instances_.size(); ++i)
+        {
+            if (instances_[i].mesh_index != m)
+                continue;
+            for (size_t k = 0; k < meshlets.size(); ++k)
+                clusters_.emplace_back(static_cast<GLuint>(i), firstMeshlet + static_cast<GLuint>(k));
+        }
+        mesh_cluster_count_[m] = static_cast<GLuint>(clusters_.size()) - mesh_cluster_offset_[m];
+    }
+
+    GL_STATE.bindBuffer(GL_SHADER_STORAGE_BUFFER, instance_buffer_);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, std::max<size_t>(instances_.size(), 1) * sizeof(InstanceData),
+                 instances_.data(), GL_DYNAMIC_DRAW);
+    GL_STATE.bindBuffer(GL_SHADER_STORAGE_BUFFER, visibility_buffer_);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, std::max<size_t>(instances_.size(), 1) * sizeof(GLuint), nullptr,
+                 GL_DYNAMIC_COPY);
+    GL_STATE.bindBuffer(GL_SHADER_STORAGE_BUFFER, meshlet_buffer_);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, std::max<size_t>(meshlets_.size(), 1) * sizeof(Meshlet), meshlets_.data(),
+                 GL_STATIC_DRAW);
+    GL_STATE.bindBuffer(GL_SHADER_STORAGE_BUFFER, cluster_buffer_);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, std::max<size_t>(clusters_.size(), 1) * sizeof(glm::uvec2),
+                 clusters_.data(), GL_STATIC_DRAW);
+    GL_STATE.bindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    // Force the per-view buffers to be rebuilt for the new instance count
+    const int capacity = std::max(view_capacity_, 1);
+    view_capacity_ = 0;
+    ensureViewCapacity(capacity);
+
+    for (auto* mesh : meshes_)
+        mesh->setInstanceBuffer(instance_id_buffer_);
+}
+
+void GPUCuller::updateTransforms(const std::vector<InstanceData>& instances)
+{
+    if (instances.size() != instances_.size())
+        return;
+
+    instances_ = instances;
+    GL_STATE.bindBuffer(GL_SHADER_STORAGE_BUFFER, instance_buffer_);
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, instances_.size() * sizeof(InstanceData), instances_.data());
+    GL_STATE.bindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+void GPUCuller::ensureViewCapacity(int viewCount)
+{
+    if (viewCount <= view_capacity_)
+        return;
+
+    const int oldCapacity = view_capacity_;
+    const int newCapacity = std::max(viewCount, view_capacity_ * 2);
+    const GLsizeiptr commandsPerView = static_cast<GLsizeiptr>(meshes_.size());
+    const GLsizeiptr idsPerView = static_cast<GLsizeiptr>(getIdsPerView());
+    const GLsizeiptr clustersPerView = static_cast<GLsizeiptr>(clusters_.size());
+
+    command_template_.resize(newCapacity * commandsPerView);
+    for (int view = 0; view < newCapacity; ++view)
+    {
+        for (size_t m = 0; m < meshes_.size(); ++m)
+        {
+            DrawElementsIndirectCommand& cmd = command_template_[view * commandsPerView + m];
+            cmd.count = meshes_[m]->getIndexBufferSize();
+            cmd.instanceCount = 0;
+            cmd.firstIndex = 0;
+            cmd.baseVertex = 0;
+            cmd.baseInstance = static_cast<GLuint>(view * idsPerView) + mesh_instance_offset_[m];
+        }
+    }
+
+    const GLsizeiptr commandBytes = std::max<GLsizeiptr>(command_template_.size() * sizeof(DrawElementsIndirectCommand), 1);
+    const GLsizeiptr idBytes = std::max<GLsizeiptr>(newCapacity * idsPerView * sizeof(GLuint), 1);
+    const GLsizeiptr clusterCommandBytes =
+        std::max<GLsizeiptr>(newCapacity * clustersPerView * sizeof(DrawElementsIndirectCommand), 1);
+    view_cluster_draws_.resize(newCapacity * commandsPerView, -1);
+
+    GL_STATE.bindBuffer(GL_COPY_WRITE_BUFFER, command_template_buffer_);
+    glBufferData(GL_COPY_WRITE_BUFFER, commandBytes, command_template_.data(), GL_STATIC_DRAW);
+
+    // Growing in the middle of a frame must keep the views already culled
+    if (oldCapacity > 0 && view_count_ > 0)
+    {
+        GLuint newCommands, newIds, newClusterCommands;
+        glGenBuffers(1, &newCommands);
+        glGenBuffers(1, &newIds);
+        glGenBuffers(1, &newClusterCommands);
+
+        GL_STATE.bindBuffer(GL_COPY_WRITE_BUFFER, newCommands);
+        glBufferData(GL_COPY_WRITE_BUFFER, commandBytes, nullptr, GL_DYNAMIC_COPY);
+        GL_STATE.bindBuffer(GL_COPY_READ_BUFFER, command_buffer_);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0,
+                            view_count_ * commandsPerView * sizeof(DrawElementsIndirectCommand));
+
+        GL_STATE.bindBuffer(GL_COPY_WRITE_BUFFER, newIds);
+        glBufferData(GL_COPY_WRITE_BUFFER, idBytes, nullptr, GL_DYNAMIC_COPY);
+        if (idsPerView > 0)
+        {
+            GL_STATE.bindBuffer(GL_COPY_READ_BUFFER, instance_id_buffer_);
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0,
+                                view_count_ * idsPerView * sizeof(GLuint));
+        }
+
+        GL_STATE.bindBuffer(GL_COPY_WRITE_BUFFER, newClusterCommands);
+        glBufferData(GL_COPY_WRITE_BUFFER, clusterCommandBytes, nullptr, GL_DYNAMIC_COPY);
+        if (clustersPerView > 0)
+        {
+            GL_STATE.bindBuffer(GL_COPY_READ_BUFFER, cluster_command_buffer_);
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0,
+                                view_count_ * clustersPerView * sizeof(DrawElementsIndirectCommand));
+        }
+
+        GL_STATE.deleteBuffers(1, &command_buffer_);
+        GL_STATE.deleteBuffers(1, &instance_id_buffer_);
+        GL_STATE.deleteBuffers(1, &cluster_command_buffer_);
+        command_buffer_ = newCommands;
+        instance_id_buffer_ = newIds;
+        cluster_command_buffer_ = newClusterCommands;
+
+        for (auto* mesh : meshes_)
+            mesh->setInstanceBuffer(instance_id_buffer_);
+    }
+    else
+    {
+        GL_STATE.bindBuffer(GL_COPY_WRITE_BUFFER, command_buffer_);
+        glBufferData(GL_COPY_WRITE_BUFFER, commandBytes, nullptr, GL_DYNAMIC_COPY);
+        GL_STATE.bindBuffer(GL_COPY_WRITE_BUFFER, instance_id_buffer_);
+        glBufferData(GL_COPY_WRITE_BUFFER, idBytes, nullptr, GL_DYNAMIC_COPY);
+        GL_STATE.bindBuffer(GL_COPY_WRITE_BUFFER, cluster_command_buffer_);
+        glBufferData(GL_COPY_WRITE_BUFFER, clusterCommandBytes, nullptr, GL_DYNAMIC_COPY);
+    }
+
+    GL_STATE.bindBuffer(GL_COPY_READ_BUFFER, 0);
+    GL_STATE.bindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    view_capacity_ = newCapacity;
+}
+
+size_t GPUCuller::getIdsPerView() const
+{
+    return instances_.size() + clusters_.size();
+}
+
+void GPUCuller::beginFrame()
+{
+    view_count_ = 0;
+    last_visible_count_ = 0;
+    last_cluster_tested_count_ = 0;
+    last_cluster_visible_count_ = 0;
+}
+
+int GPUCuller::cullView(const glm::mat4& viewProj, const HiZBuffer* occluder, const OcclusionRasterizer* rasterizer,
+                        const LODView* lod, bool bBackFaceCulled)
+{
+    const int view = view_count_;
+    ensureViewCapacity(view + 1);
+    ++view_count_;
+
+    glm::vec4 planes[6];
+    extractFrustumPlanes(viewProj, planes);
+
+    // Clip space (0, 0, -1, 0) is where every view ray starts: the eye, or at infinity behind an orthographic view
+    glm::vec4 eye = glm::inverse(viewProj) * glm::vec4(0.f, 0.f, -1.f, 0.f);
+    if (std::abs(eye.w) > 1e-6f * glm::length(glm::vec3(eye)))
+        eye /= eye.w;
+    else
+        eye = glm::vec4(glm::normalize(glm::vec3(eye)), 0.f);
+
+    if (occluder && !occluder->isValid())
+        occluder = nullptr;
+
+    // Without back face culling the faces the cone test drops are still drawn
+    const bool bCones = b_cone_culling_ && bBackFaceCulled;
+    if (mode_ == Mode::GPU)
+        cullViewGPU(view, planes, eye, occluder, lod, bCones);
+    else
+        cullViewCPU(view, planes, eye, rasterizer, lod, bCones);
+
+    return view;
+}
+
+void GPUCuller::applyLOD(int view, DrawElementsIndirectCommand* commands, const LODView* lod)
+{
+    // One command per mesh, so the nearest instance decides for all of them
+    ArenaVector<unsigned> meshLOD(FRAME_ARENA.get());
+    meshLOD.assign(meshes_.size(), lod ? ~0u : 0u);
+    if (lod)
+    {
+        for (const InstanceData& instance : instances_)
+        {
+            unsigned& level = meshLOD[instance.mesh_index];
+            if (level != 0)
+                level = std::min(level, meshes_[instance.mesh_index]->selectLOD(*lod, instance.model));
+        }
+    }
+
+    for (size_t m = 0; m < meshes_.size(); ++m)
+    {
+        const unsigned level = meshLOD[m] == ~0u ? 0 : meshLOD[m];
+        if (lod)
+        {
+            const Mesh::LOD range = meshes_[m]->getLOD(level);
+            commands[m].count = range.indexCount;
+            commands[m].firstIndex = range.firstIndex;
+        }
+
+        // Meshlets only cover LOD 0; the culling passes fill in how many draw
+        const bool bClusters = b_cluster_culling_ && level == 0 && mesh_cluster_count_[m] > 0;
+        view_cluster_draws_[view * meshes_.size() + m] = bClusters ? 0 : -1;
+    }
+}
+
+void GPUCuller::cullViewGPU(int view, const glm::vec4 planes[6], const glm::vec4& eye, const HiZBuffer* occluder,
+                            const LODView* lod, bool bCones)
+{
+    const size_t meshCount = meshes_.size();
+    const GLsizeiptr commandStride = static_cast<GLsizeiptr>(meshCount * sizeof(DrawElementsIndirectCommand));
+
+    // Reset this view's instance counts from the template, with LODs the index ranges change too
+    ArenaVector<DrawElementsIndirectCommand> commands(FRAME_ARENA.get());
+    commands.assign(command_template_.data() + view * meshCount, command_template_.data() + (view + 1) * meshCount);
+    applyLOD(view, commands.data(), lod);
+    if (lod && meshCount > 0)
+    {
+        GL_STATE.bindBuffer(GL_COPY_WRITE_BUFFER, command_buffer_);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, view * commandStride, commandStride, commands.data());
+    }
+    else
+    {
+        GL_STATE.bindBuffer(GL_COPY_READ_BUFFER, command_template_buffer_);
+        GL_STATE.bindBuffer(GL_COPY_WRITE_BUFFER, command_buffer_);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, view * commandStride, view * commandStride, commandStride);
+        GL_STATE.bindBuffer(GL_COPY_READ_BUFFER, 0);
+    }
+    GL_STATE.bindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    if (instances_.empty())
+        return;
+
+    cull_shader_->use();
+    GL_STATE.bindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, instance_buffer_);
+    GL_STATE.bindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, command_buffer_);
+    GL_STATE.bindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, instance_id_buffer_);
+    GL_STATE.bindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, visibility_buffer_);
+
+    cull_shader_->SetUniform("frustumPlanes", 6, planes);
+    cull_shader_->SetUniform("instanceCount", static_cast<GLuint>(instances_.size()));
+    cull_shader_->SetUniform("commandOffset", static_cast<GLuint>(view * meshes_.size()));
+
+    cull_shader_->SetUniform("useHiZ", static_cast<GLboolean>(occluder != nullptr));
+    if (occluder)
+    {
+        GL_STATE.bindTexture(0, GL_TEXTURE_2D, occluder->texture);
+        cull_shader_->SetUniform("hiZMap", 0);
+        cull_shader_->SetUniform("hiZViewProj", occluder->getViewProj());
+        cull_shader_->SetUniform("hiZSize", glm::vec2(occluder->getWidth(), occluder->getHeight()));
+        cull_shader_->SetUniform("hiZLevels", occluder->getLevelCount());
+    }
+
+    const GLuint groups = (static_cast<GLuint>(instances_.size()) + CULL_GROUP_SIZE - 1) / CULL_GROUP_SIZE;
+    glDispatchCompute(groups, 1, 1);
+
+    glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
+
+    // No readback, so every cluster keeps its slot and the multi-draw walks them all
+    bool bClusters = false;
+    for (size_t m = 0; m < meshCount; ++m)
+    {
+        int& draws = view_cluster_draws_[view * meshCount + m];
+        if (draws >= 0)
+        {
+            draws = static_cast<int>(mesh_cluster_count_[m]);
+            bClusters = true;
+        }
+    }
+    if (!bClusters)
+        return;
+
+    cluster_shader_->use();
+    GL_STATE.bindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, cluster_command_buffer_);
+    GL_STATE.bindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, meshlet_buffer_);
+    GL_STATE.bindBufferBase(GL_SHADER_STORAGE_BUFFER, 5, cluster_buffer_);
+
+    cluster_shader_->SetUniform("frustumPlanes", 6, planes);
+    cluster_shader_->SetUniform("eye", eye);
+    cluster_shader_->SetUniform("clusterCount", static_cast<GLuint>(clusters_.size()));
+    cluster_shader_->SetUniform("commandOffset", static_cast<GLuint>(view * clusters_.size()));
+    cluster_shader_->SetUniform("idOffset", static_cast<GLuint>(view * getIdsPerView() + instances_.size()));
+    cluster_shader_->SetUniform("useCones", static_cast<GLboolean>(bCones));
+
+    const GLuint clusterGroups = (static_cast<GLuint>(clusters_.size()) + CULL_GROUP_SIZE - 1) / CULL_GROUP_SIZE;
+    glDispatchCompute(clusterGroups, 1, 1);
+
+    glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT);
+}
+
+void GPUCuller::cullViewCPU(int view, const glm::vec4 planes[6], const glm::vec4& eye,
+                            const OcclusionRasterizer* rasterizer, const LODView* lod, bool bCones)
+{
+    const size_t meshCount = meshes_.size();
+    const size_t idsPerView = getIdsPerView();
+
+    LinearAllocator& memory = FRAME_ARENA.get();
+    cpu_commands_.reset(memory);
+    cpu_instance_ids_.reset(memory);
+    cpu_visible_.reset(memory);
+    cpu_commands_.assign(command_template_.data() + view * meshCount,
+                         command_template_.data() + (view + 1) * meshCount);
+    cpu_instance_ids_.assign(idsPerView, 0);
+    applyLOD(view, cpu_commands_.data(), lod);
+
+    // Same frustum test and compaction as cull.comp. Hi-Z would need a readback of
+    // the pyramid; occlusion here comes from the software rasterizer.
+    // The tests run as jobs, the compaction stays serial so it keeps instance order
+    cpu_visible_.resize(instances_.size());
+    JOB_SYSTEM.parallelFor(0, instances_.size(), 256, [this, planes, rasterizer](size_t first, size_t last)
+    {
+        for (size_t i = first; i < last; ++i)
+        {
+            const InstanceData& instance = instances_[i];
+            const glm::vec3 localCenter = glm::vec3(instance.bounds_min + instance.bounds_max) * 0.5f;
+            const glm::vec3 localExtent = glm::vec3(instance.bounds_max - instance.bounds_min) * 0.5f;
+
+            const glm::vec3 center = glm::vec3(instance.model * glm::vec4(localCenter, 1.f));
+            const glm::mat3 absModel = glm::mat3(glm::abs(glm::vec3(instance.model[0])), glm::abs(glm::vec3(instance.model[1])),
+                                                 glm::abs(glm::vec3(instance.model[2])));
+            const glm::vec3 extent = absModel * localExtent;
+
+            cpu_visible_[i] = isAABBVisible(planes, center, extent) && (!rasterizer || rasterizer->isVisible(center, extent));
+        }
+    });
+
+    for (size_t i = 0; i < instances_.size(); ++i)
+    {
+        if (!cpu_visible_[i])
+            continue;
+
+        const InstanceData& instance = instances_[i];
+        DrawElementsIndirectCommand& cmd = cpu_commands_[instance.mesh_index];
+        const GLuint slot = cmd.instanceCount++;
+        cpu_instance_ids_[cmd.baseInstance - view * idsPerView + slot] = static_cast<GLuint>(i);
+        ++last_visible_count_;
+    }
+
+    // Meshlets of the visible instances, compacted per mesh so the multi-draw only walks the survivors
+    cpu_cluster_commands_.reset(memory);
+    cpu_cluster_visible_.reset(memory);
+    cpu_cluster_commands_.resize(clusters_.size());
+    cpu_cluster_visible_.assign(clusters_.size(), 0);
+    for (size_t m = 0; m < meshCount; ++m)
+    {
+        int& draws = view_cluster_draws_[view * meshCount + m];
+        if (draws < 0)
+            continue;
+
+        const size_t first = mesh_cluster_offset_[m];
+        const size_t last = first + mesh_cluster_count_[m];
+        JOB_SYSTEM.parallelFor(first, last, 256, [this, planes, &eye, bCones](size_t begin, size_t end)
+        {
+            for (size_t k = begin; k < end; ++k)
+            {
+                const glm::uvec2 cluster = clusters_[k];
+                cpu_cluster_visible_[k] = cpu_visible_[cluster.x] &&
+                    isMeshletVisible(planes, eye, instances_[cluster.x].model, meshlets_[cluster.y], bCones);
+            }
+        });
+
+        const GLuint firstId = static_cast<GLuint>(view * idsPerView + instances_.size());
+        GLuint slot = static_cast<GLuint>(first);
+        for (size_t k = first; k < last; ++k)
+        {
+            if (cpu_visible_[clusters_[k].x])
+                ++last_cluster_tested_count_;
+            if (!cpu_cluster_visible_[k])
+                continue;
+
+            const Meshlet& meshlet = meshlets_[clusters_[k].y];
+            cpu_cluster_commands_[slot] = DrawElementsIndirectCommand{ meshlet.indexCount, 1, meshlet.firstIndex, 0,
+                                                                       firstId + slot };
+            cpu_instance_ids_[instances_.size() + slot] = clusters_[k].x;
+            ++slot;
+        }
+        draws = static_cast<int>(slot - first);
+        last_cluster_visible_count_ += slot - static_cast<GLuint>(first);
+    }
+
+    GL_STATE.bindBuffer(GL_DRAW_INDIRECT_BUFFER, command_buffer_);
+    glBufferSubData(GL_DRAW_INDIRECT_BUFFER, view * meshCount * sizeof(DrawElementsIndirectCommand),
+                    meshCount * sizeof(DrawElementsIndirectCommand), cpu_commands_.data());
+
+    if (!clusters_.empty())
+    {
+        GL_STATE.bindBuffer(GL_DRAW_INDIRECT_BUFFER, cluster_command_buffer_);
+        glBufferSubData(GL_DRAW_INDIRECT_BUFFER, view * clusters_.size() * sizeof(DrawElementsIndirectCommand),
+                        clusters_.size() * sizeof(DrawElementsIndirectCommand), cpu_cluster_commands_.data());
+    }
+
+    if (idsPerView > 0)
+    {
+        GL_STATE.bindBuffer(GL_ARRAY_BUFFER, instance_id_buffer_);
+        glBufferSubData(GL_ARRAY_BUFFER, view * idsPerView * sizeof(GLuint), idsPerView * sizeof(GLuint),
+                        cpu_instance_ids_.data());
+        GL_STATE.bindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+}
+
+void GPUCuller::drawView(int view) const
+{
+    if (view < 0 || view >= view_count_)
+        return;
+
+    for (size_t m = 0; m < meshes_.size(); ++m)
+        drawMesh(view, static_cast<int>(m));
+}
+
+void GPUCuller::drawMesh(int view, int mesh) const
+{
+    if (view < 0 || view >= view_count_ || mesh < 0 || mesh >= static_cast<int>(meshes_.size()))
+        return;
+
+    const int clusterDraws = view_cluster_draws_[view * meshes_.size() + mesh];
+    if (clusterDraws >= 0)
+    {
+        GL_STATE.bindBuffer(GL_DRAW_INDIRECT_BUFFER, cluster_command_buffer_);
+        meshes_[mesh]->renderMultiIndirect(
+            (view * clusters_.size() + mesh_cluster_offset_[mesh]) * sizeof(DrawElementsIndirectCommand), clusterDraws);
+        return;
+    }
+
+    GL_STATE.bindBuffer(GL_DRAW_INDIRECT_BUFFER, command_buffer_);
+    meshes_[mesh]->renderIndirect((view * meshes_.size() + mesh) * sizeof(DrawElementsIndirectCommand));
+}
+
+void GPUCuller::bindInstances() const
+{
+    GL_STATE.bindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, instance_buffer_);
+}
+
+void GPUCuller::setMode(Mode mode)
+{
+    mode_ = mode;
+}
+
+GPUCuller::Mode GPUCuller::getMode() const
+{
+    return mode_;
+}
+
+void GPUCuller::setClusterCulling(bool bEnabled, bool bConeCulling)
+{
+    b_cluster_culling_ = bEnabled;
+    b_cone_culling_ = bConeCulling;
+}
+
+bool GPUCuller::isClusterCulling() const
+{
+    return b_cluster_culling_;
+}
+
+bool GPUCuller::isConeCulling() const
+{
+    return b_cone_culling_;
+}
+
+unsigned GPUCuller::getClusterCount() const
+{
+    return static_cast<unsigned>(clusters_.size());
+}
+
+unsigned GPUCuller::getLastClusterTestedCount() const
+{
+    return last_cluster_tested_count_;
+}
+
+unsigned GPUCuller::getLastClusterVisibleCount() const
+{
+    return last_cluster_visible_count_;
+}
+
+unsigned GPUCuller::getInstanceCount() const
+{
+    return static_cast<unsigned>(instances_.size());
+}
+
+unsigned GPUCuller::getLastVisibleCount() const
+{
+    return last_visible_count_;
+}
+
+void GPUCuller::extractFrustumPlanes(const glm::mat4& viewProj, glm::vec4 planes[6])
+{
+    // Gribb/Hartmann: rows of the clip matrix, glm is column major
+    const glm::vec4 row0(viewProj[0][0], viewProj[1][0], viewProj[2][0], viewProj[3][0]);
+    const glm::vec4 row1(viewProj[0][1], viewProj[1][1], viewProj[2][1], viewProj[3][1]);
+    const glm::vec4 row2(viewProj[0][2], viewProj[1][2], viewProj[2][2], viewProj[3][2]);
+    const glm::vec4 row3(viewProj[0][3], viewProj[1][3], viewProj[2][3], viewProj[3][3]);
+
+    planes[0] = row3 + row0; // left
+    planes[1] = row3 - row0; // right
+    planes[2] = row3 + row1; // bottom
+    planes[3] = row3 - row1; // top
+    planes[4] = row3 + row2; // near
+    planes[5] = row3 - row2; // far
+
+    for (int i = 0; i < 6; ++i)
+        planes[i] /= glm::length(glm::vec3(planes[i]));
+}
+
+bool GPUCuller::isAABBVisible(const glm::vec4 planes[6], const glm::vec3& center, const glm::vec3& extent)
+{
+    for (int i = 0; i < 6; ++i)
+    {
+        const glm::vec3 n = glm::vec3(planes[i]);
+        const float d = glm::dot(n, center) + planes[i].w;
+        const float r = glm::dot(extent, glm::abs(n));
+        if (d + r < 0.f)
+            return false;
+    }
+    return true;
+}
+
+bool GPUCuller::isMeshletVisible(const glm::vec4 planes[6], const glm::vec4& eye, const glm::mat4& model,
+                                 const Meshlet& meshlet, bool bConeCulling)
+{
+    const glm::vec3 center = glm::vec3(model * glm::vec4(glm::vec3(meshlet.sphere), 1.f));
+    const glm::vec3 scale(glm::length(glm::vec3(model[0])), glm::length(glm::vec3(model[1])),
+                          glm::length(glm::vec3(model[2])));
+    const float maxScale = std::max(std::max(scale.x, scale.y), scale.z);
+    const float radius = meshlet.sphere.w * maxScale;
+
+    for (int i = 0; i < 6; ++i)
+    {
+        if (glm::dot(glm::vec3(planes[i]), center) + planes[i].w < -radius)
+            return false;
+    }
+
+    // Angles only survive a uniform scale
+    const float minScale = std::min(std::min(scale.x, scale.y), scale.z);
+    if (!bConeCulling || meshlet.cone.w >= 1.f || maxScale > minScale * 1.01f)
+        return true;
+
+    // Same test as clusterCull.comp: the view direction to every point of the
+    // sphere is within the cone's complement, so every triangle faces away
+    const glm::vec3 axis = glm::normalize(glm::mat3(model) * glm::vec3(meshlet.cone));
+    const glm::vec3 toCenter = center * eye.w - glm::vec3(eye);
+    return glm::dot(toCenter, axis) < meshlet.cone.w * glm::length(toCenter) + radius * eye.w;
+}
@@ -0,0 +1,128 @@
+#include "HiZBuffer.h"
+#include "GLStateCache.h"
+
+#include <algorithm>
+#include <cmath>
+
+static const GLuint HIZ_GROUP_SIZE = 8;
+
+static int getMipCount(int width, int height) {
+    return 1 + static_cast<int>(std::floor(std::log2(static_cast<float>(std::max(width, height)))));
+}
+
+HiZBuffer::HiZBuffer(int width, int height) : texture(0), viewProj(1.f), width(width), height(height),
+    activeWidth(0), activeHeight(0), activeLevelCount(1), valid(false) {
+    createTexture();
+    setActiveSize(width, height);
+
+    copyShader = std::make_unique<Shader>();
+    copyShader->loadComputeShader("../assets/shader/hiZCopy.comp");
+    reduceShader = std::make_unique<Shader>();
+    reduceShader->loadComputeShader("../assets/shader/hiZReduce.comp");
+}
+
+HiZBuffer::~HiZBuffer() {
+    if (glIsTexture(texture))
+        glDeleteTextures(1, &texture);
+}
+
+bool HiZBuffer::resize(int widthIn, int heightIn) {
+    if (widthIn == width && heightIn == height)
+        return false;
+
+    //Storage is immutable, the pyramid is rebuilt from scratch
+    GL_STATE.deleteTextures(1, &texture);
+    width = widthIn;
+    height = heightIn;
+    createTexture();
+    setActiveSize(activeWidth, activeHeight);
+    valid = false;
+    return true;
+}
+
+void HiZBuffer::setActiveSize(int widthIn, int heightIn) {
+    widthIn = std::clamp(widthIn, 1, width);
+    heightIn = std::clamp(heightIn, 1, height);
+    if (widthIn == activeWidth && heightIn == activeHeight)
+        return;
+
+    //Texels of a pyramid built at another size map to other pixels
+    activeWidth = widthIn;
+    activeHeight = heightIn;
+    activeLevelCount = getMipCount(activeWidth, activeHeight);
+    valid = false;
+}
+
+void HiZBuffer::createTexture() {
+    levelCount = getMipCount(width, height);
+
+    glGenTextures(1, &texture);
+    GL_STATE.bindTexture(0, GL_TEXTURE_2D, texture);
+    glTexStorage2D(GL_TEXTURE_2D, levelCount, GL_R32F, width, height);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levelCount - 1);
+    GL_STATE.bindTexture(0, GL_TEXTURE_2D, 0);
+}
+
+void HiZBuffer::build(GLuint depthTexture, const glm::mat4& viewProjIn) {
+    //Level 0: copy depth, depth-stencil textures can't be bound as images
+    copyShader->use();
+    GL_STATE.bindTexture(0, GL_TEXTURE_2D, depthTexture);
+    copyShader->SetUniform("depthMap", 0);
+    copyShader->SetUniform("dstSize", glm::vec2(activeWidth, activeHeight));
+    glBindImageTexture(1, texture, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+    glDispatchCompute((activeWidth + HIZ_GROUP_SIZE - 1) / HIZ_GROUP_SIZE, (activeHeight + HIZ_GROUP_SIZE - 1) / HIZ_GROUP_SIZE, 1);
+
+    //Remaining levels: farthest depth of each 2x2 footprint
+    reduceShader->use();
+    int srcWidth = activeWidth;
+    int srcHeight = activeHeight;
+    for (int level = 1; level < activeLevelCount; ++level) {
+        const int dstWidth = std::max(srcWidth / 2, 1);
+        const int dstHeight = std::max(srcHeight / 2, 1);
+
+        glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+        glBindImageTexture(0, texture, level - 1, GL_FALSE, 0, GL_READ_ONLY, GL_R32F);
+        glBindImageTexture(1, texture, level, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+        reduceShader->SetUniform("srcSize", glm::vec2(srcWidth, srcHeight));
+        reduceShader->SetUniform("dstSize", glm::vec2(dstWidth, dstHeight));
+        glDispatchCompute((dstWidth + HIZ_GROUP_SIZE - 1) / HIZ_GROUP_SIZE, (dstHeight + HIZ_GROUP_SIZE - 1) / HIZ_GROUP_SIZE, 1);
+
+        srcWidth = dstWidth;
+        srcHeight = dstHeight;
+    }
+
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+    GL_STATE.bindTexture(0, GL_TEXTURE_2D, 0);
+
+    viewProj = viewProjIn;
+    valid = true;
+}
+
+void HiZBuffer::invalidate() {
+    valid = false;
+}
+
+bool HiZBuffer::isValid() const {
+    return valid;
+}
+
+const glm::mat4& HiZBuffer::getViewProj() const {
+    return viewProj;
+}
+
+int HiZBuffer::getWidth() const {
+    return activeWidth;
+}
+
+int HiZBuffer::getHeight() const {
+    return activeHeight;
+}
+
+int HiZBuffer::getLevelCount() const {
+    return activeLevelCount;
+}
@@ -0,0 +1,562 @@
+/* Start Header -------------------------------------------------------
+Copyright (C) 2021 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the prior written
+consent of DigiPen Institute of Technology is prohibited.
+File Name: IndexCodec.cpp
+Purpose: This file compresses triangle lists with delta coding and Huffman coding
+Language: c++
+Platform: VS2019 / Window
+Project:  HGraphics
+Author: Elliott Hong <s.hong@digipen.edu>
+Creation date: Oct 19, 2026
+End Header ---------------------------------------------------------*/
+#include "IndexCodec.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <queue>
+
+namespace
+{
+    const int SYMBOL_COUNT = 256;
+    // Longest Huffman code; keeps a code and a partial byte in 32 bits
+    const int MAX_CODE_LENGTH = 24;
+    // Codes up to this long decode with one table lookup
+    const int LOOKUP_BITS = 11;
+
+    void writeVarint(std::vector<unsigned char>& out, uint32_t value)
+    {
+        while (value >= 0x80)
+        {
+            out.push_back(static_cast<unsigned char>(value | 0x80));
+            value >>= 7;
+        }
+        out.push_back(static_cast<unsigned char>(value));
+    }
+
+    bool readVarint(const unsigned char*& data, const unsigned char* end, uint32_t& value)
+    {
+        value = 0;
+        for (int shift = 0; shift < 35 && data < end; shift += 7)
+        {
+            const unsigned char byte = *data++;
+            value |= static_cast<uint32_t>(byte & 0x7f) << shift;
+            if ((byte & 0x80) == 0)
+                return true;
+        }
+        return false;
+    }
+
+    // Small magnitudes of either sign become small unsigned numbers
+    uint32_t zigzag(int32_t value)
+    {
+        return (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31);
+    }
+
+    int32_t unzigzag(uint32_t value)
+    {
+        return static_cast<int32_t>(value >> 1) ^ -static_cast<int32_t>(value & 1);
+    }
+
+    // Huffman code lengths of freq; rare symbols are flattened until no code is too long
+    void buildCodeLengths(const uint32_t freq[SYMBOL_COUNT], unsigned char lengths[SYMBOL_COUNT])
+    {
+        std::vector<uint32_t> weights(freq, freq + SYMBOL_COUNT);
+        for (;;)
+        {
+            struct Node
+            {
+                uint64_t weight;
+                int parent;
+            };
+            std::vector<Node> nodes;
+            using Entry = std::pair<uint64_t, int>;
+            std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue;
+            for (int s = 0; s < SYMBOL_COUNT; ++s)
+            {
+                lengths[s] = 0;
+                if (weights[s] > 0)
+                {
+                    queue.push({ weights[s], static_cast<int>(nodes.size()) });
+                    nodes.push_back({ weights[s], -1 });
+                }
+            }
+            if (nodes.size() == 1)
+            {
+                for (int s = 0; s < SYMBOL_COUNT; ++s)
+                    lengths[s] = weights[s] > 0 ? 1 : 0;
+                return;
+            }
+            while (queue.size() > 1)
+            {
+                const Entry a = queue.top();
+                queue.pop();
+                const Entry b = queue.top();
+                queue.pop();
+                const int parent = static_cast<int>(nodes.size());
+                nodes.push_back({ a.first + b.first, -1 });
+                nodes[a.second].parent = parent;
+                nodes[b.second].parent = parent;
+                queue.push({ a.first + b.first, parent });
+            }
+
+            int maxLength = 0;
+            size_t leaf = 0;
+            for (int s = 0; s < SYMBOL_COUNT; ++s)
+            {
+                if (weights[s] == 0)
+                    continue;
+                int length = 0;
+                for (int n = static_cast<int>(leaf++); nodes[n].parent >= 0; n = nodes[n].parent)
+                    ++length;
+                lengths[s] = static_cast<unsigned char>(std::min(length, 255));
+                maxLength = std::max(maxLength, length);
+            }
+            if (maxLength <= MAX_CODE_LENGTH)
+                return;
+            for (uint32_t& weight : weights)
+                weight = weight > 0 ? (weight >> 1) | 1 : 0;
+        }
+    }
+
+    // Canonical codes: shorter first, then by symbol
+    struct CanonicalCode
+    {
+        uint32_t count[MAX_CODE_LENGTH + 1];
+        uint32_t firstCode[MAX_CODE_LENGTH + 1];
+        uint32_t firstSymbol[MAX_CODE_LENGTH + 1];
+        unsigned char sortedSymbols[SYMBOL_COUNT];
+
+        bool build(const unsigned char lengths[SYMBOL_COUNT])
+        {
+            std::fill(count, count + MAX_CODE_LENGTH + 1, 0u);
+            for (int s = 0; s < SYMBOL_COUNT; ++s)
+            {
+                if (lengths[s] > MAX_CODE_LENGTH)
+                    return false;
+                ++count[lengths[s]];
+            }
+            count[0] = 0;
+
+            uint32_t code = 0;
+            uint32_t symbol = 0;
+            for (int length = 1; length <= MAX_CODE_LENGTH; ++length)
+            {
+                code = (code + count[length - 1]) << 1;
+                firstCode[length] = code;
+                firstSymbol[length] = symbol;
+                symbol += count[length];
+                // More codes than the length can hold, the lengths came from a broken stream
+                if (count[length] > (1u << length) || code + count[length] > (1u << length))
+                    return false;
+            }
+
+            uint32_t next[MAX_CODE_LENGTH + 1];
+            std::copy(firstSymbol, firstSymbol + MAX_CODE_LENGTH + 1, next);
+            for (int s = 0; s < SYMBOL_COUNT; ++s)
+            {
+                if (lengths[s] > 0)
+                    sortedSymbols[next[lengths[s]]++] = static_cast<unsigned char>(s);
+            }
+            return true;
+        }
+    };
+
+    // MSB first bit reader that pads the end with zeros and remembers running past it
+    class BitReader
+    {
+    public:
+        BitReader(const unsigned char* data, const unsigned char* end) : data_(data), end_(end), buffer_(0), bits_(0),
+            padding_(0)
+        {
+            refill();
+        }
+
+        uint32_t peek(int count) const
+        {
+            return static_cast<uint32_t>(buffer_ >> (64 - count));
+        }
+
+        void consume(int count)
+        {
+            buffer_ <<= count;
+            bits_ -= count;
+            refill();
+        }
+
+        bool isOverrun() const
+        {
+            return padding_ * 8 > bits_;
+        }
+
+    private:
+        void refill()
+        {
+            while (bits_ <= 56)
+            {
+                uint64_t byte = 0;
+                if (data_ < end_)
+                    byte = *data_++;
+                else
+                    ++padding_;
+                buffer_ |= byte << (56 - bits_);
+                bits_ += 8;
+            }
+        }
+
+        const unsigned char* data_;
+        const unsigned char* end_;
+        uint64_t buffer_;
+        int bits_;
+        int padding_;
+    };
+
+    const int RECENT_VERTICES = 32;
+
+    // Move to front list of the last vertices used: a vertex shared with the
+    // triangles just before is usually one of the first few slots
+    class RecentVertices
+    {
+    public:
+        RecentVertices() : size_(0)
+        {
+        }
+
+        int find(uint32_t vertex) const
+        {
+            for (int i = 0; i < size_; ++i)
+            {
+                if (vertices_[i] == vertex)
+                    return i;
+            }
+            return -1;
+        }
+
+        bool isValid(int slot) const
+        {
+            return slot < size_;
+        }
+
+        uint32_t get(int slot) const
+        {
+            return vertices_[slot];
+        }
+
+        // slot is where find found vertex, or -1
+        void use(uint32_t vertex, int slot)
+        {
+            if (slot < 0)
+            {
+                slot = size_ < RECENT_VERTICES ? size_++ : RECENT_VERTICES - 1;
+            }
+            for (int i = slot; i > 0; --i)
+                vertices_[i] = vertices_[i - 1];
+            vertices_[0] = vertex;
+        }
+
+    private:
+        uint32_t vertices_[RECENT_VERTICES];
+        int size_;
+    };
+
+    // Appends a length prefixed entropy coded block
+    void appendBlock(std::vector<unsigned char>& out, const std::vector<unsigned char>& bytes)
+    {
+        std::vector<unsigned char> block;
+        IndexCodec::entropyEncode(bytes, block);
+        writeVarint(out, static_cast<uint32_t>(block.size()));
+        out.insert(out.end(), block.begin(), block.end());
+    }
+
+    bool readBlock(const unsigned char*& data, const unsigned char* end, std::vector<unsigned char>& bytes)
+    {
+        uint32_t size = 0;
+        if (!readVarint(data, end, size) || size > static_cast<size_t>(end - data))
+            return false;
+        const bool bDecoded = IndexCodec::entropyDecode(data, size, bytes);
+        data += size;
+        return bDecoded;
+    }
+}
+
+void IndexCodec::encodeIndices(const GLuint* indices, size_t indexCount, std::vector<unsigned char>& out)
+{
+    std::vector<unsigned char> bytes;
+    bytes.reserve(indexCount * 2);
+    RecentVertices recent;
+    uint32_t next = 0;
+    uint32_t previous = 0;
+    for (size_t i = 0; i < indexCount; ++i)
+    {
+        const uint32_t index = indices[i];
+        const int slot = recent.find(index);
+        if (index == next)
+            writeVarint(bytes, 0);
+        else if (slot >= 0)
+            writeVarint(bytes, 1 + slot);
+        else
+            writeVarint(bytes, 1 + RECENT_VERTICES + zigzag(static_cast<int32_t>(index - previous)));
+
+        recent.use(index, slot);
+        if (index >= next)
+            next = index + 1;
+        previous = index;
+    }
+
+    out.clear();
+    appendBlock(out, bytes);
+}
+
+bool IndexCodec::decodeIndices(const unsigned char* data, size_t size, GLuint* indices, size_t indexCount)
+{
+    const unsigned char* end = data + size;
+    std::vector<unsigned char> bytes;
+    if (!readBlock(data, end, bytes))
+        return false;
+
+    const unsigned char* cursor = bytes.data();
+    const unsigned char* bytesEnd = cursor + bytes.size();
+    RecentVertices recent;
+    uint32_t next = 0;
+    uint32_t previous = 0;
+    for (size_t i = 0; i < indexCount; ++i)
+    {
+        uint32_t value = 0;
+        if (!readVarint(cursor, bytesEnd, value))
+            return false;
+
+        uint32_t index = next;
+        int slot = -1;
+        if (value > RECENT_VERTICES)
+            index = previous + static_cast<uint32_t>(unzigzag(value - 1 - RECENT_VERTICES));
+        else if (value > 0)
+        {
+            slot = static_cast<int>(value - 1);
+            if (!recent.isValid(slot))
+                return false;
+            index = recent.get(slot);
+        }
+        else
+            slot = recent.find(index);
+
+        indices[i] = index;
+        recent.use(index, slot);
+        if (index >= next)
+            next = index + 1;
+        previous = index;
+    }
+    return cursor == bytesEnd;
+}
+
+void IndexCodec::encodeMeshlets(const GLuint* indices, const std::vector<Meshlet>& meshlets,
+                                std::vector<unsigned char>& out)
+{
+    // Vertex lists and local triangles have nothing in common, they get a block each
+    std::vector<unsigned char> vertexBytes;
+    std::vector<unsigned char> triangleBytes;
+    std::vector<GLuint> vertices;
+    RecentVertices recent;
+    uint32_t next = 0;
+    uint32_t previous = 0;
+
+    for (const Meshlet& meshlet : meshlets)
+    {
+        vertices.clear();
+        recent = RecentVertices();
+        for (GLuint i = 0; i < meshlet.indexCount; ++i)
+        {
+            const GLuint index = indices[meshlet.firstIndex + i];
+            const uint32_t seen = static_cast<uint32_t>(vertices.size());
+            const uint32_t local = static_cast<uint32_t>(std::find(vertices.begin(), vertices.end(), index) -
+                                                         vertices.begin());
+            // 0 is the meshlet's next new vertex, then the recently used ones; a byte either way
+            const int slot = recent.find(local);
+            if (local == seen)
+                vertices.push_back(index);
+            writeVarint(triangleBytes, local == seen ? 0 : 1 + (slot >= 0 ? slot : RECENT_VERTICES + local));
+            recent.use(local, slot);
+        }
+
+        writeVarint(vertexBytes, static_cast<uint32_t>(vertices.size()));
+        for (const GLuint vertex : vertices)
+        {
+            writeVarint(vertexBytes, vertex == next ? 0 : 1 + zigzag(static_cast<int32_t>(vertex - previous)));
+            if (vertex >= next)
+                next = vertex + 1;
+            previous = vertex;
+        }
+    }
+
+    out.clear();
+    appendBlock(out, vertexBytes);
+    appendBlock(out, triangleBytes);
+}
+
+bool IndexCodec::decodeMeshlets(const unsigned char* data, size_t size, const std::vector<Meshlet>& meshlets,
+                                GLuint* indices, size_t indexCount)
+{
+    const unsigned char* end = data + size;
+    std::vector<unsigned char> vertexBytes;
+    std::vector<unsigned char> triangleBytes;
+    if (!readBlock(data, end, vertexBytes) || !readBlock(data, end, triangleBytes))
+        return false;
+
+    const unsigned char* vertexCursor = vertexBytes.data();
+    const unsigned char* vertexEnd = vertexCursor + vertexBytes.size();
+    const unsigned char* triangleCursor = triangleBytes.data();
+    const unsigned char* triangleEnd = triangleCursor + triangleBytes.size();
+    std::vector<GLuint> vertices;
+    RecentVertices recent;
+    uint32_t next = 0;
+    uint32_t previous = 0;
+
+    for (const Meshlet& meshlet : meshlets)
+    {
+        uint32_t vertexCount = 0;
+        if (!readVarint(vertexCursor, vertexEnd, vertexCount) || vertexCount > meshlet.indexCount)
+            return false;
+        vertices.resize(vertexCount);
+        for (uint32_t v = 0; v < vertexCount; ++v)
+        {
+            uint32_t value = 0;
+            if (!readVarint(vertexCursor, vertexEnd, value))
+                return false;
+            const uint32_t vertex = value == 0 ? next : previous + static_cast<uint32_t>(unzigzag(value - 1));
+            vertices[v] = vertex;
+            if (vertex >= next)
+                next = vertex + 1;
+            previous = vertex;
+        }
+
+        if (static_cast<size_t>(meshlet.firstIndex) + meshlet.indexCount > indexCount)
+            return false;
+        recent = RecentVertices();
+        uint32_t seen = 0;
+        for (GLuint i = 0; i < meshlet.indexCount; ++i)
+        {
+            uint32_t value = 0;
+            if (!readVarint(triangleCursor, triangleEnd, value))
+                return false;
+
+            uint32_t local = seen;
+            int slot = -1;
+            if (value > RECENT_VERTICES)
+                local = value - 1 - RECENT_VERTICES;
+            else if (value > 0)
+            {
+                slot = static_cast<int>(value - 1);
+                if (!recent.isValid(slot))
+                    return false;
+                local = recent.get(slot);
+            }
+            else
+                ++seen;
+            if (local >= vertexCount)
+                return false;
+
+            indices[meshlet.firstIndex + i] = vertices[local];
+            recent.use(local, slot);
+        }
+    }
+    return vertexCursor == vertexEnd && triangleCursor == triangleEnd;
+}
+
+void IndexCodec::entropyEncode(const std::vector<unsigned char>& in, std::vector<unsigned char>& out)
+{
+    out.clear();
+    writeVarint(out, static_cast<uint32_t>(in.size()));
+    if (in.empty())
+        return;
+
+    uint32_t freq[SYMBOL_COUNT] = {};
+    for (const unsigned char byte : in)
+        ++freq[byte];
+    unsigned char lengths[SYMBOL_COUNT];
+    buildCodeLengths(freq, lengths);
+    out.insert(out.end(), lengths, lengths + SYMBOL_COUNT);
+
+    CanonicalCode canonical;
+    canonical.build(lengths);
+    uint32_t codes[SYMBOL_COUNT] = {};
+    for (int length = 1; length <= MAX_CODE_LENGTH; ++length)
+    {
+        for (uint32_t i = 0; i < canonical.count[length]; ++i)
+            codes[canonical.sortedSymbols[canonical.firstSymbol[length] + i]] = canonical.firstCode[length] + i;
+    }
+
+    uint64_t buffer = 0;
+    int bits = 0;
+    for (const unsigned char byte : in)
+    {
+        buffer = (buffer << lengths[byte]) | codes[byte];
+        bits += lengths[byte];
+        while (bits >= 8)
+        {
+            bits -= 8;
+            out.push_back(static_cast<unsigned char>(buffer >> bits));
+        }
+        buffer &= (1ull << bits) - 1;
+    }
+    if (bits > 0)
+        out.push_back(static_cast<unsigned char>(buffer << (8 - bits)));
+}
+
+bool IndexCodec::entropyDecode(const unsigned char* data, size_t size, std::vector<unsigned char>& out)
+{
+    const unsigned char* end = data + size;
+    uint32_t count = 0;
+    if (!readVarint(data, end, count))
+        return false;
+    out.resize(count);
+    if (count == 0)
+        return true;
+    if (static_cast<size_t>(end - data) < SYMBOL_COUNT)
+        return false;
+
+    const unsigned char* lengths = data;
+    data += SYMBOL_COUNT;
+    CanonicalCode canonical;
+    if (!canonical.build(lengths))
+        return false;
+
+    // One entry per LOOKUP_BITS prefix: the symbol of a short code and its length, 0 for longer codes
+    std::vector<uint16_t> lookup(1u << LOOKUP_BITS, 0);
+    for (int length = 1; length <= LOOKUP_BITS; ++length)
+    {
+        for (uint32_t i = 0; i < canonical.count[length]; ++i)
+        {
+            const uint32_t code = canonical.firstCode[length] + i;
+            const uint16_t entry = static_cast<uint16_t>((canonical.sortedSymbols[canonical.firstSymbol[length] + i] << 8) |
+                                                         length);
+            const uint32_t first = code << (LOOKUP_BITS - length);
+            std::fill(lookup.begin() + first, lookup.begin() + first + (1u << (LOOKUP_BITS - length)), entry);
+        }
+    }
+
+    BitReader reader(data, end);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        const uint16_t entry = lookup[reader.peek(LOOKUP_BITS)];
+        if (entry != 0)
+        {
+            out[i] = static_cast<unsigned char>(entry >> 8);
+            reader.consume(entry & 0xff);
+            continue;
+        }
+
+        int length = LOOKUP_BITS + 1;
+        for (; length <= MAX_CODE_LENGTH; ++length)
+        {
+            const uint32_t offset = reader.peek(length) - canonical.firstCode[length];
+            if (offset < canonical.count[length])
+            {
+                out[i] = canonical.sortedSymbols[canonical.firstSymbol[length] + offset];
+                reader.consume(length);
+                break;
+            }
+        }
+        if (length > MAX_CODE_LENGTH)
+            return false;
+    }
+    return !reader.isOverrun();
+}
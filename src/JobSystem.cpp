@@ -0,0 +1,200 @@
+/* Start Header -------------------------------------------------------
+Copyright (C) 2021 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the prior written
+consent of DigiPen Institute of Technology is prohibited.
+File Name: JobSystem.cpp
+Purpose: This file is source for the work-stealing job system.
+Language: c++
+Platform: VS2019 / Window
+Project:  HGraphics
+Author: Elliott Hong <s.hong@digipen.edu>
+Creation date: Oct 19, 2026
+End Header ---------------------------------------------------------*/
+#include "JobSystem.h"
+
+JobSystem JOB_SYSTEM;
+
+// Queue of the running thread; only meaningful for the system that started it
+static thread_local const JobSystem* t_owner = nullptr;
+static thread_local unsigned t_queue = 0;
+
+// Rounds an idle worker looks for work before it goes to sleep
+static const int SPIN_COUNT = 64;
+// Tasks each queue holds, a power of two
+static const size_t QUEUE_CAPACITY = 4096;
+
+JobSystem::JobSystem()
+{
+    queued_ = 0;
+    sleeping_ = 0;
+    stop_ = false;
+}
+
+JobSystem::~JobSystem()
+{
+    shutdown();
+}
+
+void JobSystem::init(unsigned threadCount)
+{
+    shutdown();
+
+    if (threadCount == 0)
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+    stop_ = false;
+    for (unsigned i = 0; i < threadCount; ++i)
+    {
+        queues_.push_back(std::make_unique<Queue>());
+        queues_.back()->tasks.resize(QUEUE_CAPACITY);
+    }
+    for (unsigned i = 1; i < threadCount; ++i)
+        workers_.emplace_back(&JobSystem::workerLoop, this, i);
+}
+
+void JobSystem::shutdown()
+{
+    if (queues_.empty())
+        return;
+
+    // Whatever is still queued runs here, nothing waits forever on a dropped job
+    while (runOne(getQueueIndex()))
+    {
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    for (std::thread& worker : workers_)
+        worker.join();
+
+    workers_.clear();
+    queues_.clear();
+    queued_ = 0;
+}
+
+unsigned JobSystem::getThreadCount() const
+{
+    return std::max(1u, static_cast<unsigned>(queues_.size()));
+}
+
+void JobSystem::run(const Job& job, Counter* counter)
+{
+    // Not started, behaves like a plain call
+    if (queues_.empty())
+    {
+        job();
+        return;
+    }
+
+    Queue& queue = *queues_[getQueueIndex()];
+    {
+        std::unique_lock<std::mutex> lock(queue.mutex);
+        if (queue.tail - queue.head == queue.tasks.size())
+        {
+            lock.unlock();
+            job();
+            return;
+        }
+
+        if (counter)
+            counter->pending.fetch_add(1);
+        queue.tasks[queue.tail++ & (queue.tasks.size() - 1)] = { job, counter };
+    }
+
+    // A worker publishes sleeping_ before it checks queued_, and we bump queued_
+    // before we check sleeping_, so one of the two always sees the other
+    queued_.fetch_add(1);
+    if (sleeping_.load() > 0)
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+        wake_.notify_one();
+    }
+}
+
+void JobSystem::wait(Counter& counter)
+{
+    const unsigned self = getQueueIndex();
+    while (counter.pending.load(std::memory_order_acquire) > 0)
+    {
+        if (!runOne(self))
+            std::this_thread::yield();
+    }
+}
+
+bool JobSystem::runOne(unsigned self)
+{
+    if (queues_.empty() || queued_.load(std::memory_order_relaxed) == 0)
+        return false;
+
+    Task task;
+    bool found = false;
+
+    // Own queue newest first
+    {
+        Queue& queue = *queues_[self];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.head != queue.tail)
+        {
+            task = queue.tasks[--queue.tail & (queue.tasks.size() - 1)];
+            found = true;
+        }
+    }
+
+    // Then the oldest job of the next queue that has one
+    const unsigned count = static_cast<unsigned>(queues_.size());
+    for (unsigned i = 1; i < count && !found; ++i)
+    {
+        Queue& queue = *queues_[(self + i) % count];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.head != queue.tail)
+        {
+            task = queue.tasks[queue.head++ & (queue.tasks.size() - 1)];
+            found = true;
+        }
+    }
+
+    if (!found)
+        return false;
+
+    queued_.fetch_sub(1);
+    task.job();
+    if (task.counter)
+        task.counter->pending.fetch_sub(1, std::memory_order_release);
+    return true;
+}
+
+void JobSystem::workerLoop(unsigned index)
+{
+    t_owner = this;
+    t_queue = index;
+
+    while (!stop_)
+    {
+        if (runOne(index))
+            continue;
+
+        bool bFound = false;
+        for (int spin = 0; spin < SPIN_COUNT && !bFound; ++spin)
+        {
+            std::this_thread::yield();
+            bFound = queued_.load(std::memory_order_relaxed) > 0;
+        }
+        if (bFound)
+            continue;
+
+        std::unique_lock<std::mutex> lock(sleep_mutex_);
+        sleeping_.fetch_add(1);
+        wake_.wait(lock, [this]() { return stop_ || queued_.load() > 0; });
+        sleeping_.fetch_sub(1);
+    }
+
+    t_owner = nullptr;
+}
+
+unsigned JobSystem::getQueueIndex() const
+{
+    return t_owner == this ? t_queue : 0;
+}
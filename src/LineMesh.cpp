@@ -12,12 +12,15 @@ Creation date: Sep 29, 2021
 End Header ---------------------------------------------------------*/
 #include "LineMesh.h"
 
+#include "GLStateCache.h"
+
 LineMesh::LineMesh()
 {
     vao_ = 0;
     vbo_pos_ = 0;
     vertex_count_ = 0;
     ebo_ = 0;
+    decode_buffer_ = 0;
 }
 
 LineMesh::~LineMesh()
@@ -25,15 +28,15 @@ LineMesh::~LineMesh()
     vertex_buffer_.clear();
     glDeleteBuffers(1, &vbo_pos_);
     glDeleteBuffers(1, &ebo_);
+    glDeleteBuffers(1, &decode_buffer_);
 }
 
 void LineMesh::render(int bFlag) const
 {
     if (vao_ == 0) return;
 
-    glBindVertexArray(vao_);
+    GL_STATE.bindVertexArray(vao_);
     glDrawArrays(GL_LINE_LOOP, 0, vertex_count_);
-    glBindVertexArray(0);
 }
 
 void LineMesh::setupLineMesh()
@@ -43,15 +46,19 @@ void LineMesh::setupLineMesh()
     glGenVertexArrays(1, &vao_);
     glGenBuffers(1, &vbo_pos_);
 
-    glBindVertexArray(vao_);
+    GL_STATE.bindVertexArray(vao_);
 
-    glBindBuffer(GL_ARRAY_BUFFER, vbo_pos_);
+    GL_STATE.bindBuffer(GL_ARRAY_BUFFER, vbo_pos_);
     glBufferData(GL_ARRAY_BUFFER, vertex_buffer_.size() * sizeof(GLfloat) * 3, vertex_buffer_.data(), GL_STATIC_DRAW);
 
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(GLfloat) * 3, static_cast<void*>(0));
     glEnableVertexAttribArray(0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    // Drawn with the mesh shaders, which decode every position
+    decode_buffer_ = VertexQuantizer::createDecodeBuffer(VertexQuantizer::identityDecode());
+    VertexQuantizer::bindDecodeBuffer(decode_buffer_);
+    GL_STATE.bindBuffer(GL_ARRAY_BUFFER, 0);
 
 
-    glBindVertexArray(0);
+    GL_STATE.bindVertexArray(0);
 }
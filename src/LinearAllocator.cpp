@@ -0,0 +1,86 @@
+/* Start Header -------------------------------------------------------
+Copyright (C) 2021 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the prior written
+consent of DigiPen Institute of Technology is prohibited.
+File Name: LinearAllocator.cpp
+Purpose: This file is source for the linear allocator of per frame data.
+Language: c++
+Platform: VS2019 / Window
+Project:  HGraphics
+Author: Elliott Hong <s.hong@digipen.edu>
+Creation date: Oct 19, 2026
+End Header ---------------------------------------------------------*/
+#include "LinearAllocator.h"
+
+#include "AllocationCounter.h"
+
+#include <algorithm>
+#include <cstdint>
+
+LinearAllocator::LinearAllocator(size_t blockSize)
+{
+    block_size_ = std::max<size_t>(blockSize, 1024);
+    block_ = 0;
+    offset_ = 0;
+    used_ = 0;
+}
+
+void* LinearAllocator::allocate(size_t size, size_t alignment)
+{
+    size = std::max<size_t>(size, 1);
+    while (true)
+    {
+        if (block_ < blocks_.size())
+        {
+            Block& block = blocks_[block_];
+            const uintptr_t base = reinterpret_cast<uintptr_t>(block.memory.get());
+            const uintptr_t aligned = (base + offset_ + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1);
+            const size_t end = static_cast<size_t>(aligned - base) + size;
+            if (end <= block.size)
+            {
+                used_ += end - offset_;
+                offset_ = end;
+                return reinterpret_cast<void*>(aligned);
+            }
+
+            // Too small for this one, move on; a later block may be a big one from an earlier frame
+            if (block_ + 1 < blocks_.size() && blocks_[block_ + 1].size >= size + alignment)
+            {
+                ++block_;
+                offset_ = 0;
+                continue;
+            }
+        }
+
+        // Nothing left that fits, a request bigger than the block size gets a block of its own.
+        // Growth happens once per new high of the frame's memory, it is kept for every frame after
+        const AllocationCounter::AllowScope allow;
+        Block block;
+        block.size = std::max(block_size_, size + alignment);
+        block.memory.reset(new char[block.size]);
+        const size_t index = blocks_.empty() ? 0 : std::min(block_ + 1, blocks_.size());
+        blocks_.insert(blocks_.begin() + index, std::move(block));
+        block_ = index;
+        offset_ = 0;
+    }
+}
+
+void LinearAllocator::reset()
+{
+    block_ = 0;
+    offset_ = 0;
+    used_ = 0;
+}
+
+size_t LinearAllocator::getUsedBytes() const
+{
+    return used_;
+}
+
+size_t LinearAllocator::getReservedBytes() const
+{
+    size_t bytes = 0;
+    for (const Block& block : blocks_)
+        bytes += block.size;
+    return bytes;
+}
@@ -0,0 +1,323 @@
+/* Start Header -------------------------------------------------------
+Copyright (C) 2021 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the prior written
+consent of DigiPen Institute of Technology is prohibited.
+File Name: MaterialLibrary.cpp
+Purpose: This file is source for the material table and texture array pools.
+Language: c++
+Platform: VS2019 / Window
+Project:  HGraphics
+Author: Elliott Hong <s.hong@digipen.edu>
+Creation date: Oct 19, 2026
+End Header ---------------------------------------------------------*/
+#include "MaterialLibrary.h"
+
+#include "GLStateCache.h"
+
+#include <algorithm>
+#include <iostream>
+
+namespace
+{
+    const int MIN_POOL_CAPACITY = 4;
+    // GL 4.5 guarantees 2048 array layers, which also fits the 16 bit layer field
+    const int MAX_POOL_LAYERS = 2048;
+
+    // Block edge in texels and bytes per block of the formats the streamer creates
+    void getBlockSize(GLenum internalFormat, int& blockSize, int& blockBytes)
+    {
+        blockSize = 4;
+        switch (internalFormat)
+        {
+        case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+            blockBytes = 8;
+            return;
+        case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+        case GL_COMPRESSED_RG_RGTC2:
+        case GL_COMPRESSED_RGBA_BPTC_UNORM:
+            blockBytes = 16;
+            return;
+        case GL_R8:
+            blockBytes = 1;
+            break;
+        case GL_RG8:
+            blockBytes = 2;
+            break;
+        case GL_RGB8:
+            blockBytes = 3;
+            break;
+        default:
+            blockBytes = 4;
+            break;
+        }
+        blockSize = 1;
+    }
+}
+
+MaterialLibrary::MaterialLibrary()
+    : material_ssbo_(0), handle_ssbo_(0), bindless_(false), dirty_(true), stats_{ 0, 0, 0 }
+{
+}
+
+MaterialLibrary::~MaterialLibrary()
+{
+    for (Pool& pool : pools_)
+    {
+        if (pool.handle != 0)
+            glMakeTextureHandleNonResidentARB(pool.handle);
+        glDeleteTextures(1, &pool.texture);
+    }
+    if (material_ssbo_ != 0)
+        glDeleteBuffers(1, &material_ssbo_);
+    if (handle_ssbo_ != 0)
+        glDeleteBuffers(1, &handle_ssbo_);
+}
+
+void MaterialLibrary::createResources()
+{
+    bindless_ = GLAD_GL_ARB_bindless_texture != 0;
+    glGenBuffers(1, &material_ssbo_);
+    if (bindless_)
+        glGenBuffers(1, &handle_ssbo_);
+}
+
+int MaterialLibrary::addMaterial(const std::string& name, const Material& material)
+{
+    const auto it = material_ids_.find(name);
+    if (it != material_ids_.end())
+    {
+        materials_[it->second] = material;
+        dirty_ = true;
+        return it->second;
+    }
+
+    const int id = static_cast<int>(materials_.size());
+    materials_.push_back(material);
+    material_ids_[name] = id;
+    dirty_ = true;
+    return id;
+}
+
+int MaterialLibrary::findMaterial(const std::string& name) const
+{
+    const auto it = material_ids_.find(name);
+    return it == material_ids_.end() ? -1 : it->second;
+}
+
+const MaterialLibrary::Material& MaterialLibrary::getMaterial(int id) const
+{
+    return materials_[id];
+}
+
+void MaterialLibrary::setMaterial(int id, const Material& material)
+{
+    materials_[id] = material;
+    dirty_ = true;
+}
+
+unsigned MaterialLibrary::getMaterialCount() const
+{
+    return static_cast<unsigned>(materials_.size());
+}
+
+void MaterialLibrary::update(TextureStreamer& streamer)
+{
+    if (material_ssbo_ == 0)
+        createResources();
+
+    // Pull textures in as they become resident
+    for (const Material& material : materials_)
+    {
+        for (const std::string* texture : { &material.diffuse, &material.specular, &material.normal })
+        {
+            if (texture->empty() || texture_refs_.count(*texture) != 0)
+                continue;
+            TextureStreamer::TextureInfo info;
+            if (!streamer.getTextureInfo(*texture, info))
+                continue;
+            const GLint ref = info.target == GL_TEXTURE_2D ? adopt(info) : -1;
+            texture_refs_[*texture] = ref;
+            //the pool holds a copy, a second one would only take memory
+            if (ref >= 0)
+                streamer.release(*texture);
+            dirty_ = true;
+        }
+    }
+
+    if (!dirty_)
+        return;
+    dirty_ = false;
+
+    std::vector<GPUMaterial> table;
+    table.reserve(std::max<size_t>(materials_.size(), 1));
+    for (const Material& material : materials_)
+    {
+        GPUMaterial entry;
+        entry.diffuse = resolve(material.diffuse);
+        entry.specular = resolve(material.specular);
+        entry.normal = resolve(material.normal);
+        entry.flags = material.diffuse.empty() ? 0 : FLAG_TEXTURED;
+        entry.color = glm::vec4(material.color, 1.f);
+        entry.emissive = glm::vec4(material.emissive, 0.f);
+        entry.ka = glm::vec4(material.ka, 0.f);
+        entry.kd = glm::vec4(material.kd, 0.f);
+        entry.ks = glm::vec4(material.ks, 0.f);
+        table.push_back(entry);
+    }
+    if (table.empty())
+        table.push_back(GPUMaterial{});
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, material_ssbo_);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, table.size() * sizeof(GPUMaterial), table.data(), GL_DYNAMIC_DRAW);
+
+    if (bindless_)
+    {
+        std::vector<GLuint64> handles;
+        for (const Pool& pool : pools_)
+            handles.push_back(pool.handle);
+        if (handles.empty())
+            handles.push_back(0);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, handle_ssbo_);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, handles.size() * sizeof(GLuint64), handles.data(), GL_DYNAMIC_DRAW);
+    }
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+void MaterialLibrary::bind() const
+{
+    if (material_ssbo_ == 0)
+        return;
+
+    GL_STATE.bindBufferBase(GL_SHADER_STORAGE_BUFFER, MATERIAL_BINDING, material_ssbo_);
+    if (bindless_)
+    {
+        GL_STATE.bindBufferBase(GL_SHADER_STORAGE_BUFFER, POOL_HANDLE_BINDING, handle_ssbo_);
+        return;
+    }
+
+    for (size_t i = 0; i < pools_.size(); ++i)
+        GL_STATE.bindTexture(POOL_TEXTURE_UNIT + static_cast<GLuint>(i), GL_TEXTURE_2D_ARRAY, pools_[i].texture);
+}
+
+GLint MaterialLibrary::adopt(const TextureStreamer::TextureInfo& info)
+{
+    const int index = findPool(info);
+    if (index < 0)
+        return -1;
+
+    Pool& pool = pools_[index];
+    if (pool.layers == pool.capacity)
+        grow(pool);
+
+    for (int level = 0; level < pool.levels; ++level)
+    {
+        glCopyImageSubData(info.texture, GL_TEXTURE_2D, level, 0, 0, 0,
+                           pool.texture, GL_TEXTURE_2D_ARRAY, level, 0, 0, pool.layers,
+                           std::max(pool.width >> level, 1), std::max(pool.height >> level, 1), 1);
+    }
+
+    ++stats_.layers;
+    return (index << 16) | pool.layers++;
+}
+
+int MaterialLibrary::findPool(const TextureStreamer::TextureInfo& info)
+{
+    for (size_t i = 0; i < pools_.size(); ++i)
+    {
+        const Pool& pool = pools_[i];
+        if (pool.internalFormat == info.internalFormat && pool.width == info.width && pool.height == info.height
+            && pool.levels == info.levels && pool.layers < MAX_POOL_LAYERS)
+            return static_cast<int>(i);
+    }
+
+    if (!bindless_ && pools_.size() >= MAX_BOUND_POOLS)
+    {
+        std::cout << "MaterialLibrary: out of texture pools for " << info.width << "x" << info.height << std::endl;
+        return -1;
+    }
+
+    Pool pool;
+    pool.texture = 0;
+    pool.handle = 0;
+    pool.internalFormat = info.internalFormat;
+    pool.width = info.width;
+    pool.height = info.height;
+    pool.levels = info.levels;
+    pool.layers = 0;
+    pool.capacity = 0;
+    pools_.push_back(pool);
+    ++stats_.pools;
+    return static_cast<int>(pools_.size()) - 1;
+}
+
+void MaterialLibrary::grow(Pool& pool)
+{
+    const int capacity = std::min(std::max(pool.capacity * 2, MIN_POOL_CAPACITY), MAX_POOL_LAYERS);
+
+    GLuint texture;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+    glTexStorage3D(GL_TEXTURE_2D_ARRAY, pool.levels, pool.internalFormat, pool.width, pool.height, capacity);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, pool.levels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+    // Layers already in the pool move over on the GPU
+    if (pool.texture != 0)
+    {
+        for (int level = 0; level < pool.levels && pool.layers > 0; ++level)
+        {
+            glCopyImageSubData(pool.texture, GL_TEXTURE_2D_ARRAY, level, 0, 0, 0,
+                               texture, GL_TEXTURE_2D_ARRAY, level, 0, 0, 0,
+                               std::max(pool.width >> level, 1), std::max(pool.height >> level, 1), pool.layers);
+        }
+        if (pool.handle != 0)
+            glMakeTextureHandleNonResidentARB(pool.handle);
+        glDeleteTextures(1, &pool.texture);
+        stats_.poolBytes -= getLayerBytes(pool) * pool.capacity;
+    }
+
+    pool.texture = texture;
+    pool.capacity = capacity;
+    pool.handle = 0;
+    if (bindless_)
+    {
+        pool.handle = glGetTextureHandleARB(texture);
+        glMakeTextureHandleResidentARB(pool.handle);
+    }
+    stats_.poolBytes += getLayerBytes(pool) * pool.capacity;
+    dirty_ = true;
+}
+
+GLint MaterialLibrary::resolve(const std::string& texture) const
+{
+    const auto it = texture_refs_.find(texture);
+    return it == texture_refs_.end() ? -1 : it->second;
+}
+
+size_t MaterialLibrary::getLayerBytes(const Pool& pool)
+{
+    int blockSize, blockBytes;
+    getBlockSize(pool.internalFormat, blockSize, blockBytes);
+
+    size_t bytes = 0;
+    for (int level = 0; level < pool.levels; ++level)
+    {
+        const int width = std::max(pool.width >> level, 1);
+        const int height = std::max(pool.height >> level, 1);
+        bytes += static_cast<size_t>((width + blockSize - 1) / blockSize) * ((height + blockSize - 1) / blockSize) * blockBytes;
+    }
+    return bytes;
+}
+
+bool MaterialLibrary::isBindless() const
+{
+    return bindless_;
+}
+
+const MaterialLibrary::Stats& MaterialLibrary::getStats() const
+{
+    return stats_;
+}
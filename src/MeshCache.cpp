@@ -0,0 +1,204 @@
+/* Start Header -------------------------------------------------------
+Copyright (C) 2021 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the prior written
+consent of DigiPen Institute of Technology is prohibited.
+File Name: MeshCache.cpp
+Purpose: This file reads and writes the on-disk cache of imported meshes
+Language: c++
+Platform: VS2019 / Window
+Project:  HGraphics
+Author: Elliott Hong <s.hong@digipen.edu>
+Creation date: Oct 19, 2026
+End Header ---------------------------------------------------------*/
+#include "MeshCache.h"
+
+#include "IndexCodec.h"
+#include "mesh.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+    const uint32_t FLAG_FLIP_NORMALS = 1;
+
+    template <typename T>
+    bool readArray(const unsigned char*& data, const unsigned char* end, std::vector<T>& values, size_t count)
+    {
+        if (count > static_cast<size_t>(end - data) / sizeof(T))
+            return false;
+        values.resize(count);
+        if (count > 0)
+            std::memcpy(values.data(), data, count * sizeof(T));
+        data += count * sizeof(T);
+        return true;
+    }
+
+    template <typename T>
+    void writeArray(std::ofstream& outFile, const std::vector<T>& values)
+    {
+        outFile.write(reinterpret_cast<const char*>(values.data()), static_cast<std::streamsize>(values.size() * sizeof(T)));
+    }
+}
+
+std::string MeshCache::cachePath(const std::string& sourcePath)
+{
+    const size_t slash = sourcePath.find_last_of("/\\");
+    const size_t dot = sourcePath.find_last_of('.');
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+        return sourcePath + ".hmesh";
+    return sourcePath.substr(0, dot) + ".hmesh";
+}
+
+bool MeshCache::getSourceStamp(const std::string& sourcePath, uint64_t& size, int64_t& time)
+{
+    std::error_code error;
+    size = std::filesystem::file_size(sourcePath, error);
+    if (error)
+        return false;
+    time = static_cast<int64_t>(std::filesystem::last_write_time(sourcePath, error).time_since_epoch().count());
+    return !error;
+}
+
+bool MeshCache::load(const std::string& sourcePath, Mesh* mesh, bool bFlipNormals)
+{
+    uint64_t sourceSize = 0;
+    int64_t sourceTime = 0;
+    if (!getSourceStamp(sourcePath, sourceSize, sourceTime))
+        return false;
+
+    std::ifstream inFile(cachePath(sourcePath), std::ios::binary | std::ios::ate);
+    if (!inFile)
+        return false;
+    std::vector<unsigned char> file(static_cast<size_t>(inFile.tellg()));
+    inFile.seekg(0);
+    if (!inFile.read(reinterpret_cast<char*>(file.data()), static_cast<std::streamsize>(file.size())))
+        return false;
+
+    MeshCacheHeader header;
+    if (file.size() < sizeof(header))
+        return false;
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (std::memcmp(header.identifier, MESH_CACHE_IDENTIFIER, sizeof(header.identifier)) != 0 ||
+        header.version != MESH_CACHE_VERSION || header.sourceSize != sourceSize || header.sourceTime != sourceTime ||
+        header.flags != (bFlipNormals ? FLAG_FLIP_NORMALS : 0))
+        return false;
+
+    const unsigned char* data = file.data() + sizeof(header);
+    const unsigned char* end = file.data() + file.size();
+    std::vector<glm::vec3> positions;
+    std::vector<Mesh::LOD> lods;
+    std::vector<Meshlet> meshlets;
+    if (!readArray(data, end, positions, header.vertexCount) || !readArray(data, end, lods, header.lodCount) ||
+        !readArray(data, end, meshlets, header.meshletCount) ||
+        static_cast<size_t>(end - data) != static_cast<size_t>(header.indexBytes) + header.lodIndexBytes)
+        return false;
+
+    std::vector<GLuint> indices(header.indexCount);
+    std::vector<GLuint> lodIndices(header.lodIndexCount);
+    bool bDecoded = false;
+    if (header.indexEncoding == static_cast<uint32_t>(IndexEncoding::MESHLETS))
+        bDecoded = IndexCodec::decodeMeshlets(data, header.indexBytes, meshlets, indices.data(), indices.size());
+    else if (header.indexEncoding == static_cast<uint32_t>(IndexEncoding::TRIANGLES))
+        bDecoded = IndexCodec::decodeIndices(data, header.indexBytes, indices.data(), indices.size());
+    data += header.indexBytes;
+    if (!bDecoded || !IndexCodec::decodeIndices(data, header.lodIndexBytes, lodIndices.data(), lodIndices.size()))
+        return false;
+
+    for (const GLuint index : indices)
+    {
+        if (index >= header.vertexCount)
+            return false;
+    }
+    for (const GLuint index : lodIndices)
+    {
+        if (index >= header.vertexCount)
+            return false;
+    }
+    for (const Mesh::LOD& lod : lods)
+    {
+        if (static_cast<size_t>(lod.firstIndex) + lod.indexCount > lodIndices.size())
+            return false;
+    }
+
+    mesh->vertex_buffer_.swap(positions);
+    mesh->vertex_indices_.swap(indices);
+    mesh->lod_indices_.swap(lodIndices);
+    mesh->lods_.swap(lods);
+    mesh->meshlets_.swap(meshlets);
+    mesh->bounding_box_[0] = glm::vec3(header.boundingBox[0], header.boundingBox[1], header.boundingBox[2]);
+    mesh->bounding_box_[1] = glm::vec3(header.boundingBox[3], header.boundingBox[4], header.boundingBox[5]);
+    mesh->index_order_stats_.before = MeshOptimizer::CacheStats{ header.cacheStats[0], header.cacheStats[1] };
+    mesh->index_order_stats_.after = MeshOptimizer::CacheStats{ header.cacheStats[2], header.cacheStats[3] };
+    mesh->index_order_stats_.bOptimized = header.bOptimized != 0;
+    return true;
+}
+
+bool MeshCache::save(const std::string& sourcePath, const Mesh& mesh, bool bFlipNormals)
+{
+    MeshCacheHeader header;
+    std::memset(&header, 0, sizeof(header));
+    if (mesh.vertex_buffer_.empty() || !getSourceStamp(sourcePath, header.sourceSize, header.sourceTime))
+        return false;
+
+    // The meshlet form pays for vertices repeated across meshlets, it is kept only when smaller
+    std::vector<unsigned char> indexBytes;
+    std::vector<unsigned char> lodIndexBytes;
+    IndexCodec::encodeIndices(mesh.vertex_indices_.data(), mesh.vertex_indices_.size(), indexBytes);
+    header.indexEncoding = static_cast<uint32_t>(IndexEncoding::TRIANGLES);
+    if (!mesh.meshlets_.empty())
+    {
+        std::vector<unsigned char> meshletBytes;
+        IndexCodec::encodeMeshlets(mesh.vertex_indices_.data(), mesh.meshlets_, meshletBytes);
+        if (meshletBytes.size() < indexBytes.size())
+        {
+            indexBytes.swap(meshletBytes);
+            header.indexEncoding = static_cast<uint32_t>(IndexEncoding::MESHLETS);
+        }
+    }
+    IndexCodec::encodeIndices(mesh.lod_indices_.data(), mesh.lod_indices_.size(), lodIndexBytes);
+
+    std::memcpy(header.identifier, MESH_CACHE_IDENTIFIER, sizeof(header.identifier));
+    header.flags = bFlipNormals ? FLAG_FLIP_NORMALS : 0;
+    header.version = MESH_CACHE_VERSION;
+    header.vertexCount = static_cast<uint32_t>(mesh.vertex_buffer_.size());
+    header.indexCount = static_cast<uint32_t>(mesh.vertex_indices_.size());
+    header.lodIndexCount = static_cast<uint32_t>(mesh.lod_indices_.size());
+    header.lodCount = static_cast<uint32_t>(mesh.lods_.size());
+    header.meshletCount = static_cast<uint32_t>(mesh.meshlets_.size());
+    header.indexBytes = static_cast<uint32_t>(indexBytes.size());
+    header.lodIndexBytes = static_cast<uint32_t>(lodIndexBytes.size());
+    header.bOptimized = mesh.index_order_stats_.bOptimized ? 1 : 0;
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        header.boundingBox[axis] = mesh.bounding_box_[0][axis];
+        header.boundingBox[3 + axis] = mesh.bounding_box_[1][axis];
+    }
+    header.cacheStats[0] = mesh.index_order_stats_.before.acmr;
+    header.cacheStats[1] = mesh.index_order_stats_.before.atvr;
+    header.cacheStats[2] = mesh.index_order_stats_.after.acmr;
+    header.cacheStats[3] = mesh.index_order_stats_.after.atvr;
+
+    const std::string output = cachePath(sourcePath);
+    std::ofstream outFile(output, std::ios::binary | std::ios::trunc);
+    if (!outFile)
+    {
+        std::cout << "MeshCache: failed to open " << output << " for writing" << std::endl;
+        return false;
+    }
+    outFile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    writeArray(outFile, mesh.vertex_buffer_);
+    writeArray(outFile, mesh.lods_);
+    writeArray(outFile, mesh.meshlets_);
+    writeArray(outFile, indexBytes);
+    writeArray(outFile, lodIndexBytes);
+    if (!outFile)
+    {
+        std::cout << "MeshCache: failed to write " << output << std::endl;
+        return false;
+    }
+    return true;
+}
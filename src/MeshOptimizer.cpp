@@ -0,0 +1,498 @@
+/* Start Header -------------------------------------------------------
+Copyright (C) 2021 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the prior written
+consent of DigiPen Institute of Technology is prohibited.
+File Name: MeshOptimizer.cpp
+Purpose: This file is source for the import time index and vertex reordering.
+Language: c++
+Platform: VS2019 / Window
+Project:  HGraphics
+Author: Elliott Hong <s.hong@digipen.edu>
+Creation date: Oct 19, 2026
+End Header ---------------------------------------------------------*/
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace
+{
+    const GLuint INVALID_INDEX = ~0u;
+
+    // Forsyth's scoring; the modelled LRU cache is larger than the real one
+    // so the order still holds up on hardware with a bigger cache
+    const int FORSYTH_CACHE_SIZE = 32;
+    const float CACHE_DECAY_POWER = 1.5f;
+    const float LAST_TRIANGLE_SCORE = 0.75f;
+    const float VALENCE_BOOST_SCALE = 2.f;
+    const float VALENCE_BOOST_POWER = 0.5f;
+
+    // Normal cones wider than this (about 84 degrees from the axis) never cull enough to test
+    const float MIN_CONE_DOT = 0.1f;
+
+    float vertexScore(int cachePosition, unsigned remainingTriangles)
+    {
+        if (remainingTriangles == 0)
+            return -1.f;
+
+        float score = 0.f;
+        if (cachePosition >= 0)
+        {
+            // The last triangle's vertices score a bit lower so the strip does not turn back on itself
+            if (cachePosition < 3)
+                score = LAST_TRIANGLE_SCORE;
+            else
+                score = std::pow(1.f - static_cast<float>(cachePosition - 3) / (FORSYTH_CACHE_SIZE - 3),
+                                 CACHE_DECAY_POWER);
+        }
+        // Vertices with few triangles left are finished first, they would leave holes otherwise
+        score += VALENCE_BOOST_SCALE * std::pow(static_cast<float>(remainingTriangles), -VALENCE_BOOST_POWER);
+        return score;
+    }
+
+    // FIFO cache simulation; a vertex is cached while fewer than cacheSize misses happened since its own
+    class FIFOCache
+    {
+    public:
+        FIFOCache(size_t vertexCount, unsigned cacheSize) : stamps_(vertexCount, 0), size_(cacheSize), time_(cacheSize + 1)
+        {
+        }
+
+        // Returns 1 on a miss
+        unsigned access(GLuint vertex)
+        {
+            if (time_ - stamps_[vertex] <= size_)
+                return 0;
+            stamps_[vertex] = time_++;
+            return 1;
+        }
+
+        void flush()
+        {
+            time_ += size_ + 1;
+        }
+
+    private:
+        std::vector<size_t> stamps_;
+        size_t size_;
+        size_t time_;
+    };
+}
+
+void MeshOptimizer::optimizeVertexCache(GLuint* indices, size_t indexCount, size_t vertexCount)
+{
+    const size_t triangleCount = indexCount / 3;
+    if (triangleCount == 0)
+        return;
+
+    // Triangles around every vertex; the first live[v] entries are the ones not emitted yet
+    std::vector<GLuint> live(vertexCount, 0);
+    for (size_t i = 0; i < triangleCount * 3; ++i)
+        ++live[indices[i]];
+    std::vector<GLuint> adjacencyStart(vertexCount + 1, 0);
+    for (size_t v = 0; v < vertexCount; ++v)
+        adjacencyStart[v + 1] = adjacencyStart[v] + live[v];
+    std::vector<GLuint> adjacency(triangleCount * 3);
+    {
+        std::vector<GLuint> cursor(adjacencyStart.begin(), adjacencyStart.end() - 1);
+        for (size_t i = 0; i < triangleCount * 3; ++i)
+            adjacency[cursor[indices[i]]++] = static_cast<GLuint>(i / 3);
+    }
+
+    std::vector<float> scores(vertexCount);
+    for (size_t v = 0; v < vertexCount; ++v)
+        scores[v] = vertexScore(-1, live[v]);
+
+    const auto triangleScore = [indices, &scores](size_t t)
+    {
+        return scores[indices[3 * t]] + scores[indices[3 * t + 1]] + scores[indices[3 * t + 2]];
+    };
+
+    std::vector<bool> emitted(triangleCount, false);
+    std::vector<GLuint> result(triangleCount * 3);
+    std::vector<GLuint> cache, nextCache;
+    cache.reserve(FORSYTH_CACHE_SIZE + 3);
+    nextCache.reserve(FORSYTH_CACHE_SIZE + 3);
+
+    GLuint best = 0;
+    for (size_t t = 1; t < triangleCount; ++t)
+        if (triangleScore(t) > triangleScore(best))
+            best = static_cast<GLuint>(t);
+    GLuint scan = 0;
+    for (size_t output = 0; output < triangleCount; ++output)
+    {
+        if (best == INVALID_INDEX)
+        {
+            // Dead end, nothing in the cache has triangles left; go on with the next one in input order
+            while (emitted[scan])
+                ++scan;
+            best = scan;
+        }
+
+        emitted[best] = true;
+        const GLuint* triangle = indices + 3 * best;
+        for (int k = 0; k < 3; ++k)
+        {
+            const GLuint v = triangle[k];
+            result[3 * output + k] = v;
+
+            GLuint* around = adjacency.data() + adjacencyStart[v];
+            const GLuint* found = std::find(around, around + live[v], best);
+            std::swap(around[found - around], around[live[v] - 1]);
+            --live[v];
+        }
+
+        // The triangle's vertices move to the front, the rest shift back and the last ones drop out
+        nextCache.assign(triangle, triangle + 3);
+        for (GLuint v : cache)
+            if (v != triangle[0] && v != triangle[1] && v != triangle[2])
+                nextCache.push_back(v);
+        for (size_t i = FORSYTH_CACHE_SIZE; i < nextCache.size(); ++i)
+            scores[nextCache[i]] = vertexScore(-1, live[nextCache[i]]);
+        if (nextCache.size() > static_cast<size_t>(FORSYTH_CACHE_SIZE))
+            nextCache.resize(FORSYTH_CACHE_SIZE);
+        cache.swap(nextCache);
+
+        for (size_t i = 0; i < cache.size(); ++i)
+            scores[cache[i]] = vertexScore(static_cast<int>(i), live[cache[i]]);
+
+        // Only triangles around cached vertices changed score, the next one is picked among them
+        best = INVALID_INDEX;
+        float bestScore = -1.f;
+        for (GLuint v : cache)
+        {
+            for (GLuint a = adjacencyStart[v]; a < adjacencyStart[v] + live[v]; ++a)
+            {
+                const GLuint t = adjacency[a];
+                const float score = triangleScore(t);
+                if (score > bestScore)
+                {
+                    bestScore = score;
+                    best = t;
+                }
+            }
+        }
+    }
+
+    std::copy(result.begin(), result.end(), indices);
+}
+
+void MeshOptimizer::optimizeOverdraw(GLuint* indices, size_t indexCount, const glm::vec3* positions,
+                                     size_t vertexCount, float threshold)
+{
+    const size_t triangleCount = indexCount / 3;
+    if (triangleCount == 0)
+        return;
+
+    // Hard boundaries: triangles that miss on all three vertices start over anyway
+    std::vector<size_t> hardStarts;
+    std::vector<unsigned> misses(triangleCount);
+    {
+        FIFOCache cache(vertexCount, CACHE_SIZE);
+        for (size_t t = 0; t < triangleCount; ++t)
+        {
+            misses[t] = cache.access(indices[3 * t]) + cache.access(indices[3 * t + 1]) +
+                        cache.access(indices[3 * t + 2]);
+            if (misses[t] == 3)
+                hardStarts.push_back(t);
+        }
+    }
+    if (hardStarts.empty() || hardStarts[0] != 0)
+        hardStarts.insert(hardStarts.begin(), 0);
+    hardStarts.push_back(triangleCount);
+
+    // Soft boundaries: inside a hard cluster, cut once the part since the last
+    // cut, drawn from a cold cache, is about as cheap as the cluster itself
+    std::vector<size_t> clusterStarts;
+    {
+        FIFOCache cache(vertexCount, CACHE_SIZE);
+        for (size_t h = 0; h + 1 < hardStarts.size(); ++h)
+        {
+            const size_t first = hardStarts[h];
+            const size_t last = hardStarts[h + 1];
+            unsigned clusterMisses = 0;
+            for (size_t t = first; t < last; ++t)
+                clusterMisses += misses[t];
+            const float limit = threshold * static_cast<float>(clusterMisses) / static_cast<float>(last - first);
+
+            cache.flush();
+            clusterStarts.push_back(first);
+            unsigned segmentMisses = 0;
+            for (size_t t = first; t < last; ++t)
+            {
+                segmentMisses += cache.access(indices[3 * t]) + cache.access(indices[3 * t + 1]) +
+                                 cache.access(indices[3 * t + 2]);
+                const size_t segmentTriangles = t + 1 - clusterStarts.back();
+                if (t + 1 < last && static_cast<float>(segmentMisses) <= limit * static_cast<float>(segmentTriangles))
+                {
+                    cache.flush();
+                    clusterStarts.push_back(t + 1);
+                    segmentMisses = 0;
+                }
+            }
+        }
+    }
+    clusterStarts.push_back(triangleCount);
+
+    // Area weighted centroid and normal of every cluster and of the whole mesh
+    const size_t clusterCount = clusterStarts.size() - 1;
+    std::vector<glm::vec3> centroids(clusterCount, glm::vec3(0.f));
+    std::vector<glm::vec3> normals(clusterCount, glm::vec3(0.f));
+    glm::vec3 meshCentroid(0.f);
+    float meshArea = 0.f;
+    for (size_t c = 0; c < clusterCount; ++c)
+    {
+        float area = 0.f;
+        for (size_t t = clusterStarts[c]; t < clusterStarts[c + 1]; ++t)
+        {
+            const glm::vec3& a = positions[indices[3 * t]];
+            const glm::vec3& b = positions[indices[3 * t + 1]];
+            const glm::vec3& d = positions[indices[3 * t + 2]];
+            const glm::vec3 n = glm::cross(b - a, d - a);
+            const float triangleArea = glm::length(n);
+            centroids[c] += (a + b + d) * (triangleArea / 3.f);
+            normals[c] += n;
+            area += triangleArea;
+        }
+        meshCentroid += centroids[c];
+        meshArea += area;
+        if (area > 0.f)
+            centroids[c] /= area;
+    }
+    if (meshArea > 0.f)
+        meshCentroid /= meshArea;
+
+    // Clusters that face away from the middle occlude the rest, they go first
+    std::vector<float> keys(clusterCount);
+    for (size_t c = 0; c < clusterCount; ++c)
+    {
+        const float length = glm::length(normals[c]);
+        keys[c] = length > 0.f ? glm::dot(centroids[c] - meshCentroid, normals[c] / length) : 0.f;
+    }
+    std::vector<GLuint> order(clusterCount);
+    for (size_t c = 0; c < clusterCount; ++c)
+        order[c] = static_cast<GLuint>(c);
+    std::stable_sort(order.begin(), order.end(), [&keys](GLuint lhs, GLuint rhs) { return keys[lhs] > keys[rhs]; });
+
+    std::vector<GLuint> result;
+    result.reserve(triangleCount * 3);
+    for (GLuint c : order)
+        result.insert(result.end(), indices + 3 * clusterStarts[c], indices + 3 * clusterStarts[c + 1]);
+    std::copy(result.begin(), result.end(), indices);
+}
+
+void MeshOptimizer::optimizeVertexFetch(GLuint* indices, size_t indexCount, size_t vertexCount,
+                                        std::vector<GLuint>& remap)
+{
+    remap.assign(vertexCount, INVALID_INDEX);
+
+    GLuint next = 0;
+    for (size_t i = 0; i < indexCount; ++i)
+    {
+        GLuint& mapped = remap[indices[i]];
+        if (mapped == INVALID_INDEX)
+            mapped = next++;
+        indices[i] = mapped;
+    }
+
+    for (GLuint& mapped : remap)
+        if (mapped == INVALID_INDEX)
+            mapped = next++;
+}
+
+void MeshOptimizer::buildMeshlets(GLuint* indices, size_t indexCount, const glm::vec3* positions,
+                                  const glm::vec3* normals, size_t vertexCount, unsigned maxVertices,
+                                  unsigned maxTriangles, std::vector<Meshlet>& meshlets)
+{
+    meshlets.clear();
+    const size_t triangleCount = indexCount / 3;
+    if (triangleCount == 0)
+        return;
+
+    std::vector<GLuint> adjacencyStart(vertexCount + 1, 0);
+    for (size_t i = 0; i < triangleCount * 3; ++i)
+        ++adjacencyStart[indices[i] + 1];
+    for (size_t v = 0; v < vertexCount; ++v)
+        adjacencyStart[v + 1] += adjacencyStart[v];
+    std::vector<GLuint> adjacency(triangleCount * 3);
+    {
+        std::vector<GLuint> cursor(adjacencyStart.begin(), adjacencyStart.end() - 1);
+        for (size_t i = 0; i < triangleCount * 3; ++i)
+            adjacency[cursor[indices[i]]++] = static_cast<GLuint>(i / 3);
+    }
+
+    // Unit face normals, turned to agree with the vertex normals where the winding doesn't
+    std::vector<glm::vec3> faceNormals(triangleCount);
+    for (size_t t = 0; t < triangleCount; ++t)
+    {
+        const GLuint* triangle = indices + 3 * t;
+        const glm::vec3 n = glm::cross(positions[triangle[1]] - positions[triangle[0]],
+                                       positions[triangle[2]] - positions[triangle[0]]);
+        const float length = glm::length(n);
+        faceNormals[t] = length > 0.f ? n / length : glm::vec3(0.f);
+        if (normals && glm::dot(faceNormals[t], normals[triangle[0]] + normals[triangle[1]] + normals[triangle[2]]) < 0.f)
+            faceNormals[t] = -faceNormals[t];
+    }
+
+    std::vector<bool> used(triangleCount, false);
+    // Triangles around every vertex not in a meshlet yet
+    std::vector<GLuint> live(vertexCount);
+    for (size_t v = 0; v < vertexCount; ++v)
+        live[v] = adjacencyStart[v + 1] - adjacencyStart[v];
+    // Meshlet a vertex was last added to, plus one
+    std::vector<GLuint> vertexMeshlet(vertexCount, 0);
+    std::vector<GLuint> result;
+    result.reserve(triangleCount * 3);
+    // Face normal of every triangle of result
+    std::vector<glm::vec3> resultNormals;
+    resultNormals.reserve(triangleCount);
+    std::vector<GLuint> candidates;
+
+    size_t scan = 0;
+    while (true)
+    {
+        // Seed next to the last meshlet so no scattered leftovers build up behind it,
+        // else the next triangle in input order
+        GLuint seed = INVALID_INDEX;
+        for (GLuint t : candidates)
+        {
+            if (!used[t])
+            {
+                seed = t;
+                break;
+            }
+        }
+        if (seed == INVALID_INDEX)
+        {
+            while (scan < triangleCount && used[scan])
+                ++scan;
+            if (scan == triangleCount)
+                break;
+            seed = static_cast<GLuint>(scan);
+        }
+
+        const GLuint stamp = static_cast<GLuint>(meshlets.size()) + 1;
+        Meshlet meshlet{};
+        meshlet.firstIndex = static_cast<GLuint>(result.size());
+        glm::vec3 normalSum(0.f);
+        candidates.clear();
+
+        GLuint next = seed;
+        while (next != INVALID_INDEX)
+        {
+            used[next] = true;
+            const GLuint* triangle = indices + 3 * next;
+            --live[triangle[0]];
+            --live[triangle[1]];
+            --live[triangle[2]];
+            result.insert(result.end(), triangle, triangle + 3);
+            resultNormals.push_back(faceNormals[next]);
+            normalSum += faceNormals[next];
+            for (int k = 0; k < 3; ++k)
+            {
+                const GLuint v = triangle[k];
+                if (vertexMeshlet[v] == stamp)
+                    continue;
+                vertexMeshlet[v] = stamp;
+                ++meshlet.vertexCount;
+                for (GLuint a = adjacencyStart[v]; a < adjacencyStart[v + 1]; ++a)
+                    if (!used[adjacency[a]])
+                        candidates.push_back(adjacency[a]);
+            }
+            if (result.size() - meshlet.firstIndex == 3 * static_cast<size_t>(maxTriangles))
+                break;
+
+            // Fewest new vertices first, then the one with the fewest triangles left
+            // around it so no small pockets are left behind, then the one closest
+            // to the meshlet's normal
+            const float normalLength = glm::length(normalSum);
+            const glm::vec3 axis = normalLength > 0.f ? normalSum / normalLength : glm::vec3(0.f);
+            next = INVALID_INDEX;
+            unsigned bestNew = 4;
+            GLuint bestLive = 0;
+            float bestDot = -2.f;
+            size_t liveCandidates = 0;
+            for (GLuint t : candidates)
+            {
+                if (used[t])
+                    continue;
+                candidates[liveCandidates++] = t;
+
+                const GLuint* candidate = indices + 3 * t;
+                const unsigned added = (vertexMeshlet[candidate[0]] != stamp) + (vertexMeshlet[candidate[1]] != stamp) +
+                                       (vertexMeshlet[candidate[2]] != stamp);
+                if (meshlet.vertexCount + added > maxVertices)
+                    continue;
+                const GLuint around = live[candidate[0]] + live[candidate[1]] + live[candidate[2]];
+                const float facing = glm::dot(faceNormals[t], axis);
+                if (added < bestNew || (added == bestNew && (around < bestLive || (around == bestLive && facing > bestDot))))
+                {
+                    bestNew = added;
+                    bestLive = around;
+                    bestDot = facing;
+                    next = t;
+                }
+            }
+            candidates.resize(liveCandidates);
+        }
+        meshlet.indexCount = static_cast<GLuint>(result.size()) - meshlet.firstIndex;
+
+        // Sphere around the box of the vertices
+        glm::vec3 boundsMin(FLT_MAX), boundsMax(-FLT_MAX);
+        for (size_t i = meshlet.firstIndex; i < result.size(); ++i)
+        {
+            boundsMin = glm::min(boundsMin, positions[result[i]]);
+            boundsMax = glm::max(boundsMax, positions[result[i]]);
+        }
+        const glm::vec3 center = (boundsMin + boundsMax) * 0.5f;
+        float radius = 0.f;
+        for (size_t i = meshlet.firstIndex; i < result.size(); ++i)
+            radius = std::max(radius, glm::length(positions[result[i]] - center));
+        meshlet.sphere = glm::vec4(center, radius);
+
+        // Every normal lies within acos(minDot) of the axis, so the meshlet faces
+        // away from any viewer whose direction is within acos(cutoff) of it
+        const float normalLength = glm::length(normalSum);
+        const glm::vec3 axis = normalLength > 0.f ? normalSum / normalLength : glm::vec3(0.f, 0.f, 1.f);
+        float minDot = normalLength > 0.f ? 1.f : -1.f;
+        for (size_t t = meshlet.firstIndex / 3; t < result.size() / 3; ++t)
+        {
+            // Degenerate triangles are never seen, they don't widen the cone
+            if (resultNormals[t] != glm::vec3(0.f))
+                minDot = std::min(minDot, glm::dot(resultNormals[t], axis));
+        }
+        const float coneCutoff = minDot > MIN_CONE_DOT ? std::sqrt(1.f - minDot * minDot) : 1.f;
+        meshlet.cone = glm::vec4(axis, coneCutoff);
+        meshlets.push_back(meshlet);
+    }
+
+    std::copy(result.begin(), result.end(), indices);
+}
+
+MeshOptimizer::CacheStats MeshOptimizer::analyzeVertexCache(const GLuint* indices, size_t indexCount,
+                                                            size_t vertexCount, unsigned cacheSize)
+{
+    CacheStats stats{ 0.f, 0.f };
+    const size_t triangleCount = indexCount / 3;
+    if (triangleCount == 0)
+        return stats;
+
+    FIFOCache cache(vertexCount, cacheSize);
+    std::vector<bool> used(vertexCount, false);
+    size_t misses = 0;
+    size_t usedCount = 0;
+    for (size_t i = 0; i < triangleCount * 3; ++i)
+    {
+        misses += cache.access(indices[i]);
+        if (!used[indices[i]])
+        {
+            used[indices[i]] = true;
+            ++usedCount;
+        }
+    }
+
+    stats.acmr = static_cast<float>(misses) / static_cast<float>(triangleCount);
+    stats.atvr = static_cast<float>(misses) / static_cast<float>(usedCount);
+    return stats;
+}
@@ -0,0 +1,278 @@
+/* Start Header -------------------------------------------------------
+Copyright (C) 2021 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the prior written
+consent of DigiPen Institute of Technology is prohibited.
+File Name: MeshSimplifier.cpp
+Purpose: This file is source for the quadric error mesh simplifier.
+Language: c++
+Platform: VS2019 / Window
+Project:  HGraphics
+Author: Elliott Hong <s.hong@digipen.edu>
+Creation date: Oct 19, 2026
+End Header ---------------------------------------------------------*/
+#include "MeshSimplifier.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace
+{
+    // Area weighted sum of squared plane distances; the symmetric 3x3 part,
+    // the linear part, the constant and the total weight
+    struct Quadric
+    {
+        double a00, a01, a02, a11, a12, a22;
+        double b0, b1, b2;
+        double c;
+        double w;
+    };
+
+    Quadric makePlaneQuadric(const glm::dvec3& n, double d, double weight)
+    {
+        Quadric q;
+        q.a00 = n.x * n.x * weight;
+        q.a01 = n.x * n.y * weight;
+        q.a02 = n.x * n.z * weight;
+        q.a11 = n.y * n.y * weight;
+        q.a12 = n.y * n.z * weight;
+        q.a22 = n.z * n.z * weight;
+        q.b0 = n.x * d * weight;
+        q.b1 = n.y * d * weight;
+        q.b2 = n.z * d * weight;
+        q.c = d * d * weight;
+        q.w = weight;
+        return q;
+    }
+
+    void addQuadric(Quadric& q, const Quadric& r)
+    {
+        q.a00 += r.a00;
+        q.a01 += r.a01;
+        q.a02 += r.a02;
+        q.a11 += r.a11;
+        q.a12 += r.a12;
+        q.a22 += r.a22;
+        q.b0 += r.b0;
+        q.b1 += r.b1;
+        q.b2 += r.b2;
+        q.c += r.c;
+        q.w += r.w;
+    }
+
+    // Root mean square distance of p to the planes of q and r together
+    float getCollapseError(const Quadric& q, const Quadric& r, const glm::vec3& p)
+    {
+        const double x = p.x, y = p.y, z = p.z;
+        const double a00 = q.a00 + r.a00, a01 = q.a01 + r.a01, a02 = q.a02 + r.a02;
+        const double a11 = q.a11 + r.a11, a12 = q.a12 + r.a12, a22 = q.a22 + r.a22;
+        const double b0 = q.b0 + r.b0, b1 = q.b1 + r.b1, b2 = q.b2 + r.b2;
+        const double c = q.c + r.c, w = q.w + r.w;
+
+        const double cost = a00 * x * x + 2.0 * a01 * x * y + 2.0 * a02 * x * z + a11 * y * y + 2.0 * a12 * y * z +
+                            a22 * z * z + 2.0 * (b0 * x + b1 * y + b2 * z) + c;
+        if (w <= 0.0)
+            return 0.f;
+        return static_cast<float>(std::sqrt(std::max(cost, 0.0) / w));
+    }
+
+    struct Collapse
+    {
+        GLuint from;
+        GLuint to;
+        float error;
+    };
+
+    bool lessPosition(const glm::vec3& a, const glm::vec3& b)
+    {
+        if (a.x != b.x)
+            return a.x < b.x;
+        if (a.y != b.y)
+            return a.y < b.y;
+        return a.z < b.z;
+    }
+}
+
+float MeshSimplifier::simplify(const glm::vec3* positions, size_t vertexCount, const GLuint* indices,
+                               size_t indexCount, size_t targetIndexCount, float maxError, std::vector<GLuint>& result)
+{
+    result.assign(indices, indices + indexCount);
+    if (vertexCount == 0 || indexCount < 3)
+        return 0.f;
+
+    // Vertices at the same position share a position id, the first of them
+    std::vector<GLuint> order(vertexCount);
+    for (size_t i = 0; i < vertexCount; ++i)
+        order[i] = static_cast<GLuint>(i);
+    std::sort(order.begin(), order.end(),
+              [positions](GLuint a, GLuint b) { return lessPosition(positions[a], positions[b]); });
+
+    std::vector<GLuint> positionId(vertexCount);
+    std::vector<uint8_t> locked(vertexCount, 0);
+    for (size_t begin = 0; begin < vertexCount;)
+    {
+        size_t end = begin + 1;
+        while (end < vertexCount && positions[order[end]] == positions[order[begin]])
+            ++end;
+        for (size_t i = begin; i < end; ++i)
+        {
+            positionId[order[i]] = order[begin];
+            // A seam: the vertices differ in some other attribute
+            if (end - begin > 1)
+                locked[order[i]] = 1;
+        }
+        begin = end;
+    }
+
+    // Border and non-manifold edges: a directed edge without exactly one opposite
+    std::vector<uint64_t> edges;
+    edges.reserve(indexCount);
+    for (size_t t = 0; t + 2 < indexCount; t += 3)
+    {
+        for (int e = 0; e < 3; ++e)
+        {
+            const uint64_t a = positionId[indices[t + e]];
+            const uint64_t b = positionId[indices[t + (e + 1) % 3]];
+            edges.push_back(a << 32 | b);
+        }
+    }
+    std::sort(edges.begin(), edges.end());
+    std::vector<uint8_t> lockedPosition(vertexCount, 0);
+    for (size_t i = 0; i < edges.size(); ++i)
+    {
+        const uint64_t edge = edges[i];
+        const uint64_t opposite = (edge & 0xFFFFFFFFull) << 32 | edge >> 32;
+        const bool bRepeated = (i > 0 && edges[i - 1] == edge) || (i + 1 < edges.size() && edges[i + 1] == edge);
+        const auto range = std::equal_range(edges.begin(), edges.end(), opposite);
+        if (bRepeated || range.second - range.first != 1)
+        {
+            lockedPosition[edge >> 32] = 1;
+            lockedPosition[edge & 0xFFFFFFFFull] = 1;
+        }
+    }
+    for (size_t i = 0; i < vertexCount; ++i)
+        locked[i] |= lockedPosition[positionId[i]];
+
+    std::vector<Quadric> quadrics(vertexCount, Quadric{});
+    for (size_t t = 0; t + 2 < indexCount; t += 3)
+    {
+        const glm::dvec3 p0 = positions[indices[t]];
+        const glm::dvec3 p1 = positions[indices[t + 1]];
+        const glm::dvec3 p2 = positions[indices[t + 2]];
+        glm::dvec3 n = glm::cross(p1 - p0, p2 - p0);
+        const double length = glm::length(n);
+        if (length <= 0.0)
+            continue;
+        n /= length;
+        const Quadric plane = makePlaneQuadric(n, -glm::dot(n, p0), length * 0.5);
+        for (int k = 0; k < 3; ++k)
+            addQuadric(quadrics[indices[t + k]], plane);
+    }
+
+    float error = 0.f;
+    std::vector<GLuint> remap(vertexCount);
+    std::vector<GLuint> triangleStart(vertexCount + 1);
+    std::vector<GLuint> vertexTriangles;
+    std::vector<uint8_t> touched(vertexCount);
+    std::vector<Collapse> collapses;
+
+    while (result.size() > targetIndexCount)
+    {
+        const size_t triangleCount = result.size() / 3;
+
+        // Triangles around every vertex, grouped by a counting sort
+        std::fill(triangleStart.begin(), triangleStart.end(), 0);
+        for (GLuint index : result)
+            ++triangleStart[index + 1];
+        for (size_t i = 0; i < vertexCount; ++i)
+            triangleStart[i + 1] += triangleStart[i];
+        vertexTriangles.resize(result.size());
+        std::vector<GLuint> cursor(triangleStart.begin(), triangleStart.end() - 1);
+        for (size_t i = 0; i < result.size(); ++i)
+            vertexTriangles[cursor[result[i]]++] = static_cast<GLuint>(i / 3);
+
+        collapses.clear();
+        for (size_t t = 0; t < triangleCount; ++t)
+        {
+            for (int e = 0; e < 3; ++e)
+            {
+                const GLuint a = result[t * 3 + e];
+                const GLuint b = result[t * 3 + (e + 1) % 3];
+                if (!locked[a])
+                    collapses.push_back({ a, b, getCollapseError(quadrics[a], quadrics[b], positions[b]) });
+                if (!locked[b])
+                    collapses.push_back({ b, a, getCollapseError(quadrics[a], quadrics[b], positions[a]) });
+            }
+        }
+        if (collapses.empty())
+            break;
+        std::sort(collapses.begin(), collapses.end(),
+                  [](const Collapse& x, const Collapse& y) { return x.error < y.error; });
+
+        // A collapse removes about two triangles; stop the pass once that reaches the target
+        const size_t budget = (result.size() - targetIndexCount) / 6 + 1;
+        size_t collapsed = 0;
+        std::fill(touched.begin(), touched.end(), 0);
+        for (size_t i = 0; i < vertexCount; ++i)
+            remap[i] = static_cast<GLuint>(i);
+
+        for (const Collapse& collapse : collapses)
+        {
+            if (collapsed >= budget || collapse.error > maxError)
+                break;
+            const GLuint from = collapse.from, to = collapse.to;
+            if (touched[from] || touched[to])
+                continue;
+
+            // Moving from onto to must not fold any triangle that stays over
+            bool bFlips = false;
+            for (GLuint k = triangleStart[from]; k < triangleStart[from + 1] && !bFlips; ++k)
+            {
+                const GLuint* triangle = &result[vertexTriangles[k] * 3];
+                if (triangle[0] == to || triangle[1] == to || triangle[2] == to)
+                    continue;
+
+                glm::vec3 p[3], q[3];
+                for (int v = 0; v < 3; ++v)
+                {
+                    p[v] = positions[triangle[v]];
+                    q[v] = triangle[v] == from ? positions[to] : p[v];
+                }
+                const glm::vec3 before = glm::cross(p[1] - p[0], p[2] - p[0]);
+                const glm::vec3 after = glm::cross(q[1] - q[0], q[2] - q[0]);
+                bFlips = glm::dot(before, after) <= 0.25f * glm::length(before) * glm::length(after);
+            }
+            if (bFlips)
+                continue;
+
+            remap[from] = to;
+            addQuadric(quadrics[to], quadrics[from]);
+            // The triangles around from change, their vertices wait for the next pass
+            for (GLuint k = triangleStart[from]; k < triangleStart[from + 1]; ++k)
+            {
+                const GLuint* triangle = &result[vertexTriangles[k] * 3];
+                touched[triangle[0]] = touched[triangle[1]] = touched[triangle[2]] = 1;
+            }
+            error = std::max(error, collapse.error);
+            ++collapsed;
+        }
+        if (collapsed == 0)
+            break;
+
+        size_t write = 0;
+        for (size_t t = 0; t < triangleCount; ++t)
+        {
+            const GLuint a = remap[result[t * 3]];
+            const GLuint b = remap[result[t * 3 + 1]];
+            const GLuint c = remap[result[t * 3 + 2]];
+            if (a == b || b == c || c == a)
+                continue;
+            result[write++] = a;
+            result[write++] = b;
+            result[write++] = c;
+        }
+        result.resize(write);
+    }
+
+    return error;
+}
@@ -0,0 +1,298 @@
+/* Start Header -------------------------------------------------------
+Copyright (C) 2021 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the prior written
+consent of DigiPen Institute of Technology is prohibited.
+File Name: MipGenerator.cpp
+Purpose: This file is source for the CPU mip chain generator.
+Language: c++
+Platform: VS2019 / Window
+Project:  HGraphics
+Author: Elliott Hong <s.hong@digipen.edu>
+Creation date: Oct 19, 2026
+End Header ---------------------------------------------------------*/
+#include "MipGenerator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <xmmintrin.h>
+
+#include "JobSystem.h"
+
+namespace
+{
+    // Filter radius in destination pixels and Kaiser shape
+    const float KERNEL_RADIUS = 2.f;
+    const float KAISER_ALPHA = 4.f;
+    const int SRGB_ENCODE_SIZE = 4096;
+    const int PARALLEL_MIN_ROWS = 64;
+
+    float besselI0(float x)
+    {
+        float sum = 1.f, term = 1.f;
+        const float halfSquared = x * x * 0.25f;
+        for (int k = 1; k < 20; ++k)
+        {
+            term *= halfSquared / static_cast<float>(k * k);
+            sum += term;
+        }
+        return sum;
+    }
+
+    float kaiserSinc(float x)
+    {
+        const float t = x / KERNEL_RADIUS;
+        if (t <= -1.f || t >= 1.f)
+            return 0.f;
+        const float window = besselI0(KAISER_ALPHA * std::sqrt(1.f - t * t)) / besselI0(KAISER_ALPHA);
+        const float pix = 3.14159265f * x;
+        const float sinc = std::fabs(x) < 1e-5f ? 1.f : std::sin(pix) / pix;
+        return sinc * window;
+    }
+
+    struct SrgbTables
+    {
+        float decode[256];
+        unsigned char encode[SRGB_ENCODE_SIZE];
+
+        SrgbTables()
+        {
+            for (int i = 0; i < 256; ++i)
+            {
+                const float c = i / 255.f;
+                decode[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+            }
+            for (int i = 0; i < SRGB_ENCODE_SIZE; ++i)
+            {
+                const float l = (i + 0.5f) / SRGB_ENCODE_SIZE;
+                const float c = l <= 0.0031308f ? l * 12.92f : 1.055f * std::pow(l, 1.f / 2.4f) - 0.055f;
+                encode[i] = static_cast<unsigned char>(std::min(std::max(c * 255.f + 0.5f, 0.f), 255.f));
+            }
+        }
+    };
+
+    const SrgbTables& srgbTables()
+    {
+        static const SrgbTables tables;
+        return tables;
+    }
+
+    // About threadCount chunks of rows, so the jobs stay large and the pass
+    // takes no more of JOB_SYSTEM than asked
+    void parallelRows(int rows, unsigned threadCount, const std::function<void(int, int)>& task)
+    {
+        const unsigned chunks = rows < PARALLEL_MIN_ROWS ? 1u : std::min(threadCount, static_cast<unsigned>(rows));
+        if (chunks <= 1)
+        {
+            task(0, rows);
+            return;
+        }
+
+        const size_t grain = (static_cast<size_t>(rows) + chunks - 1) / chunks;
+        JOB_SYSTEM.parallelFor(0, static_cast<size_t>(rows), grain, [&task](size_t first, size_t last)
+        {
+            task(static_cast<int>(first), static_cast<int>(last));
+        });
+    }
+
+    // Grey + alpha images keep their second channel as alpha
+    int colorChannels(int channels)
+    {
+        return channels == 2 ? 1 : std::min(channels, 3);
+    }
+
+    void decodeRows(const unsigned char* pixels, int width, int channels, MipContent content, float* out, int begin, int end)
+    {
+        const float* toLinear = srgbTables().decode;
+        const int color = colorChannels(channels);
+        for (int y = begin; y < end; ++y)
+        {
+            const unsigned char* src = pixels + static_cast<size_t>(y) * width * channels;
+            float* dst = out + static_cast<size_t>(y) * width * 4;
+            for (int x = 0; x < width; ++x, src += channels, dst += 4)
+            {
+                float c[4] = { 0.f, 0.f, 0.f, 1.f };
+                for (int k = 0; k < channels; ++k)
+                    c[k] = src[k] / 255.f;
+                if (content == MipContent::COLOR_SRGB)
+                {
+                    for (int k = 0; k < color; ++k)
+                        c[k] = toLinear[src[k]];
+                }
+                else if (content == MipContent::NORMAL)
+                {
+                    for (int k = 0; k < color; ++k)
+                        c[k] = c[k] * 2.f - 1.f;
+                }
+                _mm_storeu_ps(dst, _mm_loadu_ps(c));
+            }
+        }
+    }
+
+    void encodeRows(float* level, int width, int channels, MipContent content, unsigned char* out, int begin, int end)
+    {
+        const unsigned char* toSrgb = srgbTables().encode;
+        const int color = colorChannels(channels);
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 one = _mm_set1_ps(1.f);
+        for (int y = begin; y < end; ++y)
+        {
+            float* src = level + static_cast<size_t>(y) * width * 4;
+            unsigned char* dst = out + static_cast<size_t>(y) * width * channels;
+            for (int x = 0; x < width; ++x, src += 4, dst += channels)
+            {
+                __m128 c = _mm_loadu_ps(src);
+                if (content == MipContent::NORMAL)
+                {
+                    //Renormalize xyz and keep the unit vector as the source of the next level
+                    alignas(16) float n[4];
+                    _mm_store_ps(n, c);
+                    const float length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+                    if (length > 1e-6f)
+                    {
+                        n[0] /= length;
+                        n[1] /= length;
+                        n[2] /= length;
+                    }
+                    else
+                    {
+                        n[0] = n[1] = 0.f;
+                        n[2] = 1.f;
+                    }
+                    _mm_storeu_ps(src, _mm_load_ps(n));
+                    c = _mm_add_ps(_mm_mul_ps(_mm_load_ps(n), _mm_set_ps(1.f, 0.5f, 0.5f, 0.5f)), _mm_set_ps(0.f, 0.5f, 0.5f, 0.5f));
+                }
+
+                alignas(16) float v[4];
+                _mm_store_ps(v, _mm_min_ps(_mm_max_ps(c, zero), one));
+                for (int k = 0; k < channels; ++k)
+                {
+                    if (content == MipContent::COLOR_SRGB && k < color)
+                        dst[k] = toSrgb[std::min(static_cast<int>(v[k] * SRGB_ENCODE_SIZE), SRGB_ENCODE_SIZE - 1)];
+                    else
+                        dst[k] = static_cast<unsigned char>(v[k] * 255.f + 0.5f);
+                }
+            }
+        }
+    }
+}
+
+int MipGenerator::getLevelCount(int width, int height)
+{
+    return 1 + static_cast<int>(std::floor(std::log2(static_cast<float>(std::max(width, height)))));
+}
+
+MipGenerator::Kernel MipGenerator::buildKernel(int srcSize, int dstSize, bool wrap)
+{
+    Kernel kernel;
+    kernel.first.resize(dstSize);
+    kernel.count.resize(dstSize);
+
+    const float scale = static_cast<float>(srcSize) / static_cast<float>(dstSize);
+    const float support = KERNEL_RADIUS * scale;
+    for (int i = 0; i < dstSize; ++i)
+    {
+        //Source pixel s covers [s, s + 1); weights are evaluated in destination pixels
+        const float center = (i + 0.5f) * scale;
+        const int begin = static_cast<int>(std::floor(center - support));
+        const int end = static_cast<int>(std::ceil(center + support));
+
+        kernel.first[i] = static_cast<int>(kernel.taps.size());
+        float sum = 0.f;
+        for (int s = begin; s < end; ++s)
+        {
+            const float weight = kaiserSinc((s + 0.5f - center) / scale);
+            if (weight == 0.f)
+                continue;
+            int tap = s;
+            if (wrap)
+                tap = ((s % srcSize) + srcSize) % srcSize;
+            else
+                tap = std::min(std::max(s, 0), srcSize - 1);
+            kernel.taps.push_back(tap);
+            kernel.weights.push_back(weight);
+            sum += weight;
+        }
+        for (int t = kernel.first[i]; t < static_cast<int>(kernel.taps.size()); ++t)
+            kernel.weights[t] /= sum;
+        kernel.count[i] = static_cast<int>(kernel.taps.size()) - kernel.first[i];
+    }
+    return kernel;
+}
+
+void MipGenerator::generate(const unsigned char* pixels, int width, int height, int channels, MipContent content,
+                            bool wrap, std::vector<Level>& levels, unsigned threadCount)
+{
+    levels.clear();
+    if (threadCount == 0)
+        threadCount = JOB_SYSTEM.getThreadCount();
+
+    std::vector<float> current(static_cast<size_t>(width) * height * 4);
+    parallelRows(height, threadCount, [&](int begin, int end)
+    {
+        decodeRows(pixels, width, channels, content, current.data(), begin, end);
+    });
+
+    std::vector<float> horizontal, next;
+    int srcWidth = width, srcHeight = height;
+    for (int level = 1; level < getLevelCount(width, height); ++level)
+    {
+        const int dstWidth = std::max(srcWidth / 2, 1);
+        const int dstHeight = std::max(srcHeight / 2, 1);
+
+        //Horizontal pass: srcWidth x srcHeight -> dstWidth x srcHeight
+        const Kernel columns = buildKernel(srcWidth, dstWidth, wrap);
+        horizontal.resize(static_cast<size_t>(dstWidth) * srcHeight * 4);
+        parallelRows(srcHeight, threadCount, [&](int begin, int end)
+        {
+            for (int y = begin; y < end; ++y)
+            {
+                const float* src = current.data() + static_cast<size_t>(y) * srcWidth * 4;
+                float* dst = horizontal.data() + static_cast<size_t>(y) * dstWidth * 4;
+                for (int x = 0; x < dstWidth; ++x)
+                {
+                    __m128 sum = _mm_setzero_ps();
+                    const int first = columns.first[x];
+                    for (int t = first; t < first + columns.count[x]; ++t)
+                        sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(columns.weights[t]), _mm_loadu_ps(src + columns.taps[t] * 4)));
+                    _mm_storeu_ps(dst + x * 4, sum);
+                }
+            }
+        });
+
+        //Vertical pass: whole rows scaled and accumulated, contiguous in memory
+        const Kernel rows = buildKernel(srcHeight, dstHeight, wrap);
+        next.resize(static_cast<size_t>(dstWidth) * dstHeight * 4);
+        const int rowFloats = dstWidth * 4;
+        parallelRows(dstHeight, threadCount, [&](int begin, int end)
+        {
+            for (int y = begin; y < end; ++y)
+            {
+                float* dst = next.data() + static_cast<size_t>(y) * rowFloats;
+                std::fill(dst, dst + rowFloats, 0.f);
+                const int first = rows.first[y];
+                for (int t = first; t < first + rows.count[y]; ++t)
+                {
+                    const __m128 weight = _mm_set1_ps(rows.weights[t]);
+                    const float* src = horizontal.data() + static_cast<size_t>(rows.taps[t]) * rowFloats;
+                    for (int i = 0; i < rowFloats; i += 4)
+                        _mm_storeu_ps(dst + i, _mm_add_ps(_mm_loadu_ps(dst + i), _mm_mul_ps(weight, _mm_loadu_ps(src + i))));
+                }
+            }
+        });
+
+        Level out;
+        out.width = dstWidth;
+        out.height = dstHeight;
+        out.pixels.resize(static_cast<size_t>(dstWidth) * dstHeight * channels);
+        parallelRows(dstHeight, threadCount, [&](int begin, int end)
+        {
+            encodeRows(next.data(), dstWidth, channels, content, out.pixels.data(), begin, end);
+        });
+        levels.push_back(std::move(out));
+
+        current.swap(next);
+        srcWidth = dstWidth;
+        srcHeight = dstHeight;
+    }
+}
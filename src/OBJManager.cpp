@@ -19,10 +19,11 @@ End Header ---------------------------------------------------------*/
 #include <set>
 
 #include "OBJManager.h"
+#include "JobSystem.h"
+#include "MeshCache.h"
 
 #include <glm/gtx/transform.hpp>
 
-#include "stb_image.h"
 
 OBJManager* OBJ_MANAGER = nullptr;
 
@@ -75,15 +76,34 @@ int OBJManager::ReadOBJFile(const std::string& filepath, Mesh* pMesh, Mesh::UVTy
     else
         return rFlag;
 
+    rFlag = readOBJData(filepath, current_mesh_, uvType, r, bFlipNormals);
+    uploadOBJData(current_mesh_);
+
+    return rFlag;
+}
+
+int OBJManager::readOBJData(const std::string& filepath, Mesh* pMesh, Mesh::UVType uvType, ReadMethod r,
+                            GLboolean bFlipNormals) const
+{
+    int rFlag = -1;
+
+    // A current cache holds everything up to the normals, already normalized and reordered
+    if (MeshCache::load(filepath, pMesh, bFlipNormals))
+    {
+        pMesh->calcVertexNormals(bFlipNormals);
+        pMesh->calcUVs(uvType);
+        pMesh->buildBVH();
+        return rFlag;
+    }
 
     switch (r)
     {
     case ReadMethod::LINE_BY_LINE:
-        rFlag = ReadOBJFile_LineByLine(filepath);
+        rFlag = ReadOBJFile_LineByLine(filepath, pMesh);
         break;
 
     case ReadMethod::BLOCK_IO:
-        rFlag = ReadOBJFile_BlockIO(filepath);
+        rFlag = ReadOBJFile_BlockIO(filepath, pMesh);
         break;
 
     default:
@@ -92,70 +112,75 @@ int OBJManager::ReadOBJFile(const std::string& filepath, Mesh* pMesh, Mesh::UVTy
         rFlag = -1;
         break;
     }
-    int size = current_mesh_->getVertexBufferSize();
+    int size = pMesh->getVertexBufferSize();
 
-    glm::vec3 scale = glm::vec3(current_mesh_->getModelScaleRatio());
-    glm::vec3 centroid = glm::vec3(0.f) - current_mesh_->getModelCentroid();
+    glm::vec3 scale = glm::vec3(pMesh->getModelScaleRatio());
+    glm::vec3 centroid = glm::vec3(0.f) - pMesh->getModelCentroid();
     glm::mat4 model = glm::scale(scale) * glm::translate(centroid);
 
-    for (int i = 0; i < size; ++i)
+    JOB_SYSTEM.parallelFor(0, size, 16 * 1024, [pMesh, &model](size_t first, size_t last)
     {
-        current_mesh_->vertex_buffer_[i] = glm::vec3(model * glm::vec4(current_mesh_->vertex_buffer_[i], 1.f));
-    }
+        for (size_t i = first; i < last; ++i)
+            pMesh->vertex_buffer_[i] = glm::vec3(model * glm::vec4(pMesh->vertex_buffer_[i], 1.f));
+    });
+
+    // Reorder for the GPU caches, it renumbers the vertices so it goes before anything per vertex
+    pMesh->optimizeIndexOrder();
 
     // Now calculate vertex normals
-    current_mesh_->calcVertexNormals(bFlipNormals);
-    current_mesh_->calcUVs(uvType);
-    current_mesh_->setupMesh();
-    current_mesh_->setupVNormalMesh();
-    current_mesh_->setupFNormalMesh();
+    pMesh->calcVertexNormals(bFlipNormals);
+    pMesh->calcUVs(uvType);
+    pMesh->buildMeshlets();
+    pMesh->buildBVH();
+    pMesh->buildLODs();
+
+    MeshCache::save(filepath, *pMesh, bFlipNormals);
 
     return rFlag;
 }
 
-void OBJManager::loadTexture(char const* filepath, const std::string& textureName)
+void OBJManager::uploadOBJData(Mesh* pMesh)
 {
-    unsigned int textureID;
-    glGenTextures(1, &textureID);
-
-    int width, height, nrComponents;
-    unsigned char* data = stbi_load(filepath, &width, &height, &nrComponents, 0);
-    if (data)
-    {
-        GLenum format = 0;
-        if (nrComponents == 1)
-            format = GL_RED;
-        else if (nrComponents == 3)
-            format = GL_RGB;
-        else if (nrComponents == 4)
-            format = GL_RGBA;
+    pMesh->setupMesh();
+    pMesh->setupVNormalMesh();
+    pMesh->setupFNormalMesh();
+}
 
-        glBindTexture(GL_TEXTURE_2D, textureID);
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
+void OBJManager::loadTexture(char const* filepath, const std::string& textureName, bool bNormalMap)
+{
+    texture_streamer_.request2D(textureName, resolveTexturePath(filepath), GL_REPEAT, true,
+                                bNormalMap ? MipContent::NORMAL : MipContent::COLOR_SRGB);
+}
 
-        glGenerateMipmap(GL_TEXTURE_2D);
+std::string OBJManager::resolveTexturePath(const std::string& filepath)
+{
+    // Prefer the output of TextureCooker next to the source image
+    const std::string cooked = CookedTexture::cookedPath(filepath);
+    std::ifstream cookedFile(cooked, std::ios::binary);
+    if (cookedFile.good())
+        return cooked;
+    return filepath;
+}
 
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+unsigned int OBJManager::getTexture(const std::string& name)
+{
+    return texture_streamer_.getTexture(name);
+}
 
-        textures.insert(std::pair<std::string, unsigned int>(textureName, textureID));
+void OBJManager::updateTextures()
+{
+    texture_streamer_.update();
+    material_library_.update(texture_streamer_);
+}
 
-        stbi_image_free(data);
-    }
-    else
-    {
-        std::cout << "Texture failed to load at path: " << filepath << std::endl;
-        stbi_image_free(data);
-    }
+const TextureStreamer& OBJManager::getTextureStreamer() const
+{
+    return texture_streamer_;
 }
 
-unsigned int OBJManager::getTexture(const std::string& name)
+MaterialLibrary& OBJManager::getMaterialLibrary()
 {
-    if (textures.find(name) == textures.end())
-        return 0;
-    return textures[name];
+    return material_library_;
 }
 
 int OBJManager::loadOBJFile(const std::string& fileName, const std::string& modelName, bool bNormalFlag, Mesh::UVType uvType)
@@ -175,6 +200,43 @@ int OBJManager::loadOBJFile(const std::string& fileName, const std::string& mode
     return rFlag;
 }
 
+int OBJManager::loadOBJFiles(const std::vector<OBJFile>& files)
+{
+    std::vector<std::unique_ptr<Mesh>> meshes(files.size());
+    std::vector<int> flags(files.size(), -1);
+
+    // Meshes are created here, their destructors and uploads need GL
+    for (auto& mesh : meshes)
+        mesh = std::make_unique<Mesh>();
+
+    JobSystem::Counter parsed;
+    for (size_t i = 0; i < files.size(); ++i)
+    {
+        JOB_SYSTEM.run([this, &files, &meshes, &flags, i]()
+        {
+            flags[i] = readOBJData(files[i].fileName, meshes[i].get(), files[i].uvType, ReadMethod::LINE_BY_LINE,
+                                   files[i].bNormalFlag);
+        }, &parsed);
+    }
+    JOB_SYSTEM.wait(parsed);
+
+    // Same registration as loadOBJFile, in the given order so mesh indices don't depend on timing
+    int loaded = 0;
+    for (size_t i = 0; i < files.size(); ++i)
+    {
+        uploadOBJData(meshes[i].get());
+        if (flags[i] != 1)
+        {
+            scene_mesh_.insert(std::pair<std::string, Mesh*>(files[i].modelName, meshes[i].get()));
+            if (files[i].modelName != "quad")
+                loaded_models.emplace_back(files[i].modelName);
+            meshes[i].release();
+            ++loaded;
+        }
+    }
+
+    return loaded;
+}
 
 int OBJManager::ReadSectionFile(std::string const& filepath)
 {
@@ -206,65 +268,16 @@ int OBJManager::ReadSectionFile(std::string const& filepath)
 
 }
 
-unsigned int OBJManager::loadCubemap(std::vector<std::string> faces)
+void OBJManager::loadCubemap(const std::string& name, std::vector<std::string> faces)
 {
-    unsigned int textureID;
-    glGenTextures(1, &textureID);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, textureID);
-
-    int width, height, nrChannels;
-    for (unsigned int i = 0; i < faces.size(); i++)
-    {
-        unsigned char* data = stbi_load(faces[i].c_str(), &width, &height, &nrChannels, 0);
-        if (data)
-        {
-            glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i,
-                0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data
-            );
-            stbi_image_free(data);
-        }
-        else
-        {
-            std::cout << "Cubemap tex failed to load at path: " << faces[i] << std::endl;
-            stbi_image_free(data);
-        }
-    }
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
-
-    return textureID;
+    for (std::string& face : faces)
+        face = resolveTexturePath(face);
+    texture_streamer_.requestCubemap(name, faces);
 }
 
-unsigned int OBJManager::load_cubemap(const std::string& face)
+void OBJManager::load_cubemap(const std::string& face)
 {
-    unsigned int textureID;
-    glGenTextures(1, &textureID);
-    glBindTexture(GL_TEXTURE_2D, textureID);
-
-    int width, height, nrChannels;
-
-    unsigned char* data = stbi_load(face.c_str(), &width, &height, &nrChannels, 0);
-    if (data)
-    {
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-        stbi_image_free(data);
-    }
-    else
-    {
-        std::cout << "cubemap texture failed to load" << std::endl;
-        stbi_image_free(data);
-    }
-
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-
-    return textureID;
+    texture_streamer_.request2D(face, resolveTexturePath(face), GL_CLAMP_TO_EDGE, false);
 }
 
 void OBJManager::setupSphere(const std::string& modelName)
@@ -317,7 +330,10 @@ void OBJManager::setupSphere(const std::string& modelName)
             }
         }
     }
+    mesh->optimizeIndexOrder();
     mesh->calcVertexNormals(false);
+    mesh->buildBVH();
+    mesh->buildLODs();
     mesh->setupMesh();
     scene_mesh_.insert(std::pair<std::string, Mesh*>(modelName, mesh.release()));
 }
@@ -377,7 +393,7 @@ void OBJManager::setupPlane(const std::string& name)
     scene_mesh_.insert(std::pair<std::string, Mesh*>(name, mesh.release()));
 }
 
-int OBJManager::ReadOBJFile_LineByLine(const std::string& filepath)
+int OBJManager::ReadOBJFile_LineByLine(const std::string& filepath, Mesh* pMesh) const
 {
     int rFlag = -1;
     glm::vec3 min(FLT_MAX, FLT_MAX, FLT_MAX);
@@ -394,16 +410,16 @@ int OBJManager::ReadOBJFile_LineByLine(const std::string& filepath)
         char buffer[256] = "\0";
         inFile.getline(buffer, 256, '\n');
 
-        ParseOBJRecord(buffer, min, max);
+        ParseOBJRecord(buffer, pMesh, min, max);
     }
 
-    current_mesh_->bounding_box_[0] = min;
-    current_mesh_->bounding_box_[1] = max;
+    pMesh->bounding_box_[0] = min;
+    pMesh->bounding_box_[1] = max;
 
     return rFlag;
 }
 
-int OBJManager::ReadOBJFile_BlockIO(const std::string& filepath)
+int OBJManager::ReadOBJFile_BlockIO(const std::string& filepath, Mesh* pMesh) const
 {
     int rFlag = -1;
     long int OneGBinBytes = 1024 * 1024 * 1024 * sizeof(char);
@@ -458,7 +474,7 @@ int OBJManager::ReadOBJFile_BlockIO(const std::string& filepath)
             strncpy(ObjLine, currPtr, numChars);
             ObjLine[numChars] = '\0';
 
-            ParseOBJRecord(ObjLine, min, max);
+            ParseOBJRecord(ObjLine, pMesh, min, max);
 
             currPtr = token + 1;
             token = strpbrk(currPtr, delims);
@@ -466,14 +482,14 @@ int OBJManager::ReadOBJFile_BlockIO(const std::string& filepath)
 
         free(fileContents);
 
-        current_mesh_->bounding_box_[0] = min;
-        current_mesh_->bounding_box_[1] = max;
+        pMesh->bounding_box_[0] = min;
+        pMesh->bounding_box_[1] = max;
     }
 
     return rFlag;
 }
 
-void OBJManager::ParseOBJRecord(char* buffer, glm::vec3& min, glm::vec3& max) const
+void OBJManager::ParseOBJRecord(char* buffer, Mesh* pMesh, glm::vec3& min, glm::vec3& max) const
 {
     const char* delims = " \r\n\t";
     GLfloat x, y, z;
@@ -518,7 +534,7 @@ void OBJManager::ParseOBJRecord(char* buffer, glm::vec3& min, glm::vec3& max) co
                 max.z = temp;
             z = temp;
 
-            current_mesh_->vertex_buffer_.emplace_back(x, y, z);
+            pMesh->vertex_buffer_.emplace_back(x, y, z);
         }
             // vertex normals
         else if (token[1] == 'n')
@@ -540,7 +556,7 @@ void OBJManager::ParseOBJRecord(char* buffer, glm::vec3& min, glm::vec3& max) co
                 break;
 
             vNormal[2] = static_cast<GLfloat&&>(atof(token));
-            current_mesh_->vertex_normals_.emplace_back(glm::normalize(vNormal));
+            pMesh->vertex_normals_.emplace_back(glm::normalize(vNormal));
         }
 
         break;
@@ -562,9 +578,9 @@ void OBJManager::ParseOBJRecord(char* buffer, glm::vec3& min, glm::vec3& max) co
         thirdIndex = static_cast<unsigned int&&>(atoi(token) - 1);
 
         // push back first triangle
-        current_mesh_->vertex_indices_.push_back(firstIndex);
-        current_mesh_->vertex_indices_.push_back(secondIndex);
-        current_mesh_->vertex_indices_.push_back(thirdIndex);
+        pMesh->vertex_indices_.push_back(firstIndex);
+        pMesh->vertex_indices_.push_back(secondIndex);
+        pMesh->vertex_indices_.push_back(thirdIndex);
 
         token = strtok_s(nullptr, delims, &context);
 
@@ -573,9 +589,9 @@ void OBJManager::ParseOBJRecord(char* buffer, glm::vec3& min, glm::vec3& max) co
             secondIndex = thirdIndex;
             thirdIndex = static_cast<unsigned int&&>(atoi(token) - 1);
 
-            current_mesh_->vertex_indices_.push_back(firstIndex);
-            current_mesh_->vertex_indices_.push_back(secondIndex);
-            current_mesh_->vertex_indices_.push_back(thirdIndex);
+            pMesh->vertex_indices_.push_back(firstIndex);
+            pMesh->vertex_indices_.push_back(secondIndex);
+            pMesh->vertex_indices_.push_back(thirdIndex);
 
             token = strtok_s(nullptr, delims, &context);
         }
@@ -669,7 +685,11 @@ void OBJManager::ProcessMesh(aiMesh* mesh, const aiScene* scene)
             current_mesh_->vertex_indices_.emplace_back(face.mIndices[j]);
     }
 
+    current_mesh_->optimizeIndexOrder();
+    current_mesh_->buildMeshlets();
+    current_mesh_->buildLODs();
     current_mesh_->setupMesh();
+    current_mesh_->buildBVH();
 }
 
 
@@ -0,0 +1,698 @@
+/* Start Header -------------------------------------------------------
+Copyright (C) 2021 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the prior written
+consent of DigiPen Institute of Technology is prohibited.
+File Name: OcclusionRasterizer.cpp
+Purpose: This file rasterizes box occluders on the CPU and tests bounds against them.
+Language: c++
+Platform: VS2019 / Window
+Project:  HGraphics
+Author: Elliott Hong <s.hong@digipen.edu>
+Creation date: Oct 19, 2026
+End Header ---------------------------------------------------------*/
+#include "OcclusionRasterizer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <emmintrin.h>
+
+#include "JobSystem.h"
+
+static constexpr int TILE_SIZE = 32;
+static constexpr unsigned MAX_SLICES = 8;
+// Inner boxes kept per occluder mesh, the largest first
+static constexpr size_t MAX_OCCLUDER_BOXES = 16;
+
+OcclusionRasterizer::OcclusionRasterizer(int width, int height)
+{
+    // Rows are rasterized in groups of 4 pixels, keep them whole
+    width_ = (std::max(width, 4) + 3) & ~3;
+    height_ = std::max(height, 1);
+    tiles_x_ = (width_ + TILE_SIZE - 1) / TILE_SIZE;
+    tiles_y_ = (height_ + TILE_SIZE - 1) / TILE_SIZE;
+    max_occluders_ = 256;
+    depth_.assign(static_cast<size_t>(width_) * height_, 1.f);
+    view_proj_ = glm::mat4(1.f);
+    stats_ = Stats{};
+}
+
+void OcclusionRasterizer::setOccluders(const std::vector<Mesh*>& meshes, const std::vector<InstanceData>& instances,
+                                       int cellsPerAxis)
+{
+    instances_ = instances;
+    instance_meshes_.clear();
+    instance_meshes_.reserve(instances_.size());
+
+    for (const auto& instance : instances_)
+    {
+        Mesh* mesh = meshes[instance.mesh_index];
+        auto found = mesh_slots_.find(mesh);
+        if (found == mesh_slots_.end())
+        {
+            found = mesh_slots_.emplace(mesh, static_cast<unsigned>(occluder_meshes_.size())).first;
+            occluder_meshes_.push_back(simplify(mesh, cellsPerAxis));
+        }
+        instance_meshes_.push_back(found->second);
+    }
+}
+
+void OcclusionRasterizer::setOccluders(const std::vector<OccluderMesh>& meshes, const std::vector<InstanceData>& instances)
+{
+    occluder_meshes_ = meshes;
+    mesh_slots_.clear();
+    instances_ = instances;
+    instance_meshes_.clear();
+    instance_meshes_.reserve(instances_.size());
+    for (const auto& instance : instances_)
+        instance_meshes_.push_back(instance.mesh_index);
+}
+
+void OcclusionRasterizer::updateTransforms(const std::vector<InstanceData>& instances)
+{
+    if (instances.size() == instances_.size())
+        instances_ = instances;
+}
+
+void OcclusionRasterizer::setMaxOccluders(unsigned maxOccluders)
+{
+    max_occluders_ = maxOccluders;
+}
+
+OcclusionRasterizer::OccluderMesh OcclusionRasterizer::simplify(Mesh* mesh, int cellsPerAxis)
+{
+    const std::vector<glm::vec3> vertices(reinterpret_cast<const glm::vec3*>(mesh->getVertexBuffer()),
+                                          reinterpret_cast<const glm::vec3*>(mesh->getVertexBuffer()) +
+                                              mesh->getVertexCount());
+    const std::vector<GLuint> indices(mesh->getIndexBuffer(), mesh->getIndexBuffer() + mesh->getIndexBufferSize());
+    return buildOccluder(vertices, indices, cellsPerAxis);
+}
+
+OcclusionRasterizer::OccluderMesh OcclusionRasterizer::buildOccluder(const std::vector<glm::vec3>& vertices,
+                                                                     const std::vector<GLuint>& indices,
+                                                                     int cellsPerAxis)
+{
+    OccluderMesh result;
+    if (vertices.empty() || indices.size() < 3)
+        return result;
+
+    glm::vec3 boundsMin = vertices[0], boundsMax = vertices[0];
+    for (const glm::vec3& v : vertices)
+    {
+        boundsMin = glm::min(boundsMin, v);
+        boundsMax = glm::max(boundsMax, v);
+    }
+
+    // Cubic cells, cellsPerAxis along the longest side
+    VoxelGrid grid;
+    const glm::vec3 extent = boundsMax - boundsMin;
+    const float longest = std::max({ extent.x, extent.y, extent.z });
+    if (!(longest > 0.f))
+        return result;
+    const int cells = std::max(cellsPerAxis, 1);
+    grid.cellSize = longest / static_cast<float>(cells);
+    for (int axis = 0; axis < 3; ++axis)
+        grid.dims[axis] = std::clamp(static_cast<int>(std::ceil(extent[axis] / grid.cellSize)), 1, cells);
+    grid.origin = (boundsMin + boundsMax) * 0.5f - glm::vec3(grid.dims) * grid.cellSize * 0.5f;
+
+    const size_t cellCount = static_cast<size_t>(grid.dims.x) * grid.dims.y * grid.dims.z;
+    std::vector<unsigned char> surface(cellCount, 0);
+    markSurface(grid, vertices, indices, surface);
+
+    // A cell no triangle touches is wholly inside or wholly outside. It counts as inside only
+    // if it can't be reached from the grid's border and rays along all three axes agree
+    std::vector<unsigned char> inside(cellCount, 1);
+    markExterior(grid, surface, inside);
+    for (int axis = 0; axis < 3; ++axis)
+        markParity(grid, vertices, indices, axis, inside);
+    for (size_t i = 0; i < cellCount; ++i)
+        inside[i] = inside[i] && !surface[i];
+
+    // Greedy merge of inside cells into boxes: along x, then rows along y, then slabs along z
+    struct Box
+    {
+        glm::ivec3 lo, hi;
+        int volume;
+    };
+    std::vector<Box> boxes;
+    auto isFree = [&grid, &inside](int x, int y, int z) { return inside[grid.index(x, y, z)] != 0; };
+    for (int z = 0; z < grid.dims.z; ++z)
+    {
+        for (int y = 0; y < grid.dims.y; ++y)
+        {
+            for (int x = 0; x < grid.dims.x; ++x)
+            {
+                if (!isFree(x, y, z))
+                    continue;
+
+                glm::ivec3 hi(x, y, z);
+                while (hi.x + 1 < grid.dims.x && isFree(hi.x + 1, y, z))
+                    ++hi.x;
+                auto rowFree = [&](int ry, int rz) {
+                    for (int rx = x; rx <= hi.x; ++rx)
+                        if (!isFree(rx, ry, rz))
+                            return false;
+                    return true;
+                };
+                while (hi.y + 1 < grid.dims.y && rowFree(hi.y + 1, z))
+                    ++hi.y;
+                auto slabFree = [&](int sz) {
+                    for (int sy = y; sy <= hi.y; ++sy)
+                        if (!rowFree(sy, sz))
+                            return false;
+                    return true;
+                };
+                while (hi.z + 1 < grid.dims.z && slabFree(hi.z + 1))
+                    ++hi.z;
+
+                for (int bz = z; bz <= hi.z; ++bz)
+                    for (int by = y; by <= hi.y; ++by)
+                        for (int bx = x; bx <= hi.x; ++bx)
+                            inside[grid.index(bx, by, bz)] = 0;
+                const glm::ivec3 size = hi - glm::ivec3(x, y, z) + 1;
+                boxes.push_back(Box{ glm::ivec3(x, y, z), hi, size.x * size.y * size.z });
+            }
+        }
+    }
+
+    std::sort(boxes.begin(), boxes.end(), [](const Box& a, const Box& b) { return a.volume > b.volume; });
+    if (boxes.size() > MAX_OCCLUDER_BOXES)
+        boxes.resize(MAX_OCCLUDER_BOXES);
+    for (const Box& box : boxes)
+        appendBox(grid.origin + glm::vec3(box.lo) * grid.cellSize,
+                  grid.origin + glm::vec3(box.hi + 1) * grid.cellSize, result);
+
+    return result;
+}
+
+void OcclusionRasterizer::markSurface(const VoxelGrid& grid, const std::vector<glm::vec3>& vertices,
+                                      const std::vector<GLuint>& indices, std::vector<unsigned char>& surface)
+{
+    // Every cell a triangle's bounds touch, a superset of the cells the triangle crosses
+    const float margin = grid.cellSize * 1e-3f;
+    for (size_t i = 0; i + 2 < indices.size(); i += 3)
+    {
+        const glm::vec3& a = vertices[indices[i]];
+        const glm::vec3& b = vertices[indices[i + 1]];
+        const glm::vec3& c = vertices[indices[i + 2]];
+        const glm::vec3 lo = (glm::min(a, glm::min(b, c)) - margin - grid.origin) / grid.cellSize;
+        const glm::vec3 hi = (glm::max(a, glm::max(b, c)) + margin - grid.origin) / grid.cellSize;
+        const glm::ivec3 first = glm::clamp(glm::ivec3(glm::floor(lo)), glm::ivec3(0), grid.dims - 1);
+        const glm::ivec3 last = glm::clamp(glm::ivec3(glm::floor(hi)), glm::ivec3(0), grid.dims - 1);
+        for (int z = first.z; z <= last.z; ++z)
+            for (int y = first.y; y <= last.y; ++y)
+                for (int x = first.x; x <= last.x; ++x)
+                    surface[grid.index(x, y, z)] = 1;
+    }
+}
+
+void OcclusionRasterizer::markExterior(const VoxelGrid& grid, const std::vector<unsigned char>& surface,
+                                       std::vector<unsigned char>& inside)
+{
+    // Flood fill from the border through cells no triangle touches
+    std::vector<glm::ivec3> stack;
+    auto visit = [&](int x, int y, int z) {
+        const size_t index = grid.index(x, y, z);
+        if (surface[index] || !inside[index])
+            return;
+        inside[index] = 0;
+        stack.emplace_back(x, y, z);
+    };
+    for (int z = 0; z < grid.dims.z; ++z)
+        for (int y = 0; y < grid.dims.y; ++y)
+            for (int x = 0; x < grid.dims.x; ++x)
+                if (x == 0 || y == 0 || z == 0 || x == grid.dims.x - 1 || y == grid.dims.y - 1 || z == grid.dims.z - 1)
+                    visit(x, y, z);
+
+    while (!stack.empty())
+    {
+        const glm::ivec3 cell = stack.back();
+        stack.pop_back();
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            for (int step = -1; step <= 1; step += 2)
+            {
+                glm::ivec3 next = cell;
+                next[axis] += step;
+                if (next[axis] >= 0 && next[axis] < grid.dims[axis])
+                    visit(next.x, next.y, next.z);
+            }
+        }
+    }
+}
+
+void OcclusionRasterizer::markParity(const VoxelGrid& grid, const std::vector<glm::vec3>& vertices,
+                                     const std::vector<GLuint>& indices, int axis, std::vector<unsigned char>& inside)
+{
+    // One ray along axis through every column of cells; a cell is inside if the surface is
+    // crossed an odd number of times before its center. Any point of a cell no triangle touches
+    // gives the same answer, so the rays run off center, away from the diagonals and axis-aligned
+    // edges of regular meshes
+    const int u = (axis + 1) % 3;
+    const int v = (axis + 2) % 3;
+    const float offsetU = 0.1372f, offsetV = 0.2913f;
+    const size_t columnCount = static_cast<size_t>(grid.dims[u]) * grid.dims[v];
+    std::vector<std::vector<float>> hits(columnCount);
+    // A ray through an edge or vertex can't be counted reliably, its column is left outside
+    std::vector<unsigned char> grazed(columnCount, 0);
+    const float epsilon = 1e-5f;
+
+    for (size_t i = 0; i + 2 < indices.size(); i += 3)
+    {
+        const glm::vec3& a = vertices[indices[i]];
+        const glm::vec3& b = vertices[indices[i + 1]];
+        const glm::vec3& c = vertices[indices[i + 2]];
+        const glm::vec2 pa(a[u], a[v]), pb(b[u], b[v]), pc(c[u], c[v]);
+        const glm::vec2 lo = glm::min(pa, glm::min(pb, pc));
+        const glm::vec2 hi = glm::max(pa, glm::max(pb, pc));
+        const int firstU =
+            std::max(static_cast<int>(std::ceil((lo.x - grid.origin[u]) / grid.cellSize - 0.5f - offsetU)), 0);
+        const int firstV =
+            std::max(static_cast<int>(std::ceil((lo.y - grid.origin[v]) / grid.cellSize - 0.5f - offsetV)), 0);
+        const int lastU = std::min(
+            static_cast<int>(std::floor((hi.x - grid.origin[u]) / grid.cellSize - 0.5f - offsetU)), grid.dims[u] - 1);
+        const int lastV = std::min(
+            static_cast<int>(std::floor((hi.y - grid.origin[v]) / grid.cellSize - 0.5f - offsetV)), grid.dims[v] - 1);
+
+        const float area = (pb.x - pa.x) * (pc.y - pa.y) - (pc.x - pa.x) * (pb.y - pa.y);
+        for (int cv = firstV; cv <= lastV; ++cv)
+        {
+            for (int cu = firstU; cu <= lastU; ++cu)
+            {
+                const size_t column = static_cast<size_t>(cv) * grid.dims[u] + cu;
+                const glm::vec2 q(grid.center(u, cu) + offsetU * grid.cellSize,
+                                  grid.center(v, cv) + offsetV * grid.cellSize);
+                // Seen edge on, the ray misses unless it runs along the triangle
+                if (std::abs(area) <= epsilon * glm::dot(hi - lo, hi - lo))
+                {
+                    grazed[column] = 1;
+                    continue;
+                }
+                const float w0 = ((pb.x - q.x) * (pc.y - q.y) - (pc.x - q.x) * (pb.y - q.y)) / area;
+                const float w1 = ((pc.x - q.x) * (pa.y - q.y) - (pa.x - q.x) * (pc.y - q.y)) / area;
+                const float w2 = 1.f - w0 - w1;
+                const float nearest = std::min({ w0, w1, w2 });
+                if (nearest > epsilon)
+                    hits[column].push_back(w0 * a[axis] + w1 * b[axis] + w2 * c[axis]);
+                else if (nearest > -epsilon)
+                    grazed[column] = 1;
+            }
+        }
+    }
+
+    for (int cv = 0; cv < grid.dims[v]; ++cv)
+    {
+        for (int cu = 0; cu < grid.dims[u]; ++cu)
+        {
+            const size_t column = static_cast<size_t>(cv) * grid.dims[u] + cu;
+            std::vector<float>& columnHits = hits[column];
+            std::sort(columnHits.begin(), columnHits.end());
+            size_t crossed = 0;
+            for (int i = 0; i < grid.dims[axis]; ++i)
+            {
+                const float center = grid.center(axis, i);
+                while (crossed < columnHits.size() && columnHits[crossed] < center)
+                    ++crossed;
+                glm::ivec3 cell;
+                cell[axis] = i;
+                cell[u] = cu;
+                cell[v] = cv;
+                if (grazed[column] || (crossed & 1) == 0)
+                    inside[grid.index(cell.x, cell.y, cell.z)] = 0;
+            }
+        }
+    }
+}
+
+void OcclusionRasterizer::appendBox(const glm::vec3& lo, const glm::vec3& hi, OccluderMesh& mesh)
+{
+    const GLuint base = static_cast<GLuint>(mesh.vertices.size());
+    for (int i = 0; i < 8; ++i)
+        mesh.vertices.emplace_back((i & 1) ? hi.x : lo.x, (i & 2) ? hi.y : lo.y, (i & 4) ? hi.z : lo.z);
+
+    // Corner bits are x, y, z; each face is a loop of its corners, turned to face outward
+    static const GLuint faces[6][4] = {
+        { 0, 2, 6, 4 }, { 1, 3, 7, 5 }, { 0, 1, 5, 4 }, { 2, 3, 7, 6 }, { 0, 1, 3, 2 }, { 4, 5, 7, 6 }
+    };
+    const glm::vec3 center = (lo + hi) * 0.5f;
+    for (const auto& face : faces)
+    {
+        GLuint loop[4] = { base + face[0], base + face[1], base + face[2], base + face[3] };
+        const glm::vec3& p0 = mesh.vertices[loop[0]];
+        const glm::vec3 normal = glm::cross(mesh.vertices[loop[1]] - p0, mesh.vertices[loop[2]] - p0);
+        if (glm::dot(normal, p0 - center) < 0.f)
+            std::swap(loop[1], loop[3]);
+        mesh.indices.insert(mesh.indices.end(), { loop[0], loop[1], loop[2], loop[0], loop[2], loop[3] });
+    }
+}
+
+bool OcclusionRasterizer::setupTriangle(const glm::vec4& c0, const glm::vec4& c1, const glm::vec4& c2, int width,
+                                        int height, ScreenTriangle& tri)
+{
+    // Anything crossing the near plane is clipped in the real render; leaving it
+    // out only loses occlusion, never hides something visible
+    const glm::vec4* clip[3] = { &c0, &c1, &c2 };
+    float x[3], y[3], z[3];
+    for (int i = 0; i < 3; ++i)
+    {
+        const glm::vec4& c = *clip[i];
+        if (c.w <= 1e-5f || c.z < -c.w)
+            return false;
+        const float invW = 1.f / c.w;
+        x[i] = (c.x * invW * 0.5f + 0.5f) * static_cast<float>(width);
+        y[i] = (c.y * invW * 0.5f + 0.5f) * static_cast<float>(height);
+        z[i] = c.z * invW * 0.5f + 0.5f;
+    }
+
+    // Counter-clockwise is front facing; back faces of a closed occluder are hidden anyway
+    const float area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+    if (!(area > 0.f))
+        return false;
+
+    tri.min_x = std::max(static_cast<int>(std::floor(std::min({ x[0], x[1], x[2] }))), 0);
+    tri.min_y = std::max(static_cast<int>(std::floor(std::min({ y[0], y[1], y[2] }))), 0);
+    tri.max_x = std::min(static_cast<int>(std::floor(std::max({ x[0], x[1], x[2] }))), width - 1);
+    tri.max_y = std::min(static_cast<int>(std::floor(std::max({ y[0], y[1], y[2] }))), height - 1);
+    if (tri.min_x > tri.max_x || tri.min_y > tri.max_y)
+        return false;
+
+    for (int i = 0; i < 3; ++i)
+    {
+        const int j = (i + 1) % 3;
+        const int k = (i + 2) % 3;
+        // Edge j->k, positive on the side of vertex i
+        tri.edge_a[i] = y[j] - y[k];
+        tri.edge_b[i] = x[k] - x[j];
+        tri.edge_c[i] = x[j] * y[k] - x[k] * y[j];
+    }
+
+    const float invArea = 1.f / area;
+    tri.z_a = ((z[1] - z[0]) * (y[2] - y[0]) - (z[2] - z[0]) * (y[1] - y[0])) * invArea;
+    tri.z_b = ((x[1] - x[0]) * (z[2] - z[0]) - (x[2] - x[0]) * (z[1] - z[0])) * invArea;
+    tri.z_c = z[0] - tri.z_a * x[0] - tri.z_b * y[0];
+    return true;
+}
+
+void OcclusionRasterizer::rasterizeTriangleScalar(const ScreenTriangle& tri, int x0, int y0, int x1, int y1,
+                                                  float* depth, int pitch)
+{
+    for (int y = y0; y <= y1; ++y)
+    {
+        const float py = static_cast<float>(y) + 0.5f;
+        const float row0 = tri.edge_b[0] * py + tri.edge_c[0];
+        const float row1 = tri.edge_b[1] * py + tri.edge_c[1];
+        const float row2 = tri.edge_b[2] * py + tri.edge_c[2];
+        const float rowZ = tri.z_b * py + tri.z_c;
+        float* row = depth + static_cast<size_t>(y) * pitch;
+
+        for (int x = x0; x <= x1; ++x)
+        {
+            const float px = static_cast<float>(x) + 0.5f;
+            if (tri.edge_a[0] * px + row0 > 0.f && tri.edge_a[1] * px + row1 > 0.f && tri.edge_a[2] * px + row2 > 0.f)
+                row[x] = std::min(row[x], tri.z_a * px + rowZ);
+        }
+    }
+}
+
+void OcclusionRasterizer::rasterizeTriangle(const ScreenTriangle& tri, int x0, int y0, int x1, int y1)
+{
+    const __m128 laneOffset = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 edgeA0 = _mm_set1_ps(tri.edge_a[0]);
+    const __m128 edgeA1 = _mm_set1_ps(tri.edge_a[1]);
+    const __m128 edgeA2 = _mm_set1_ps(tri.edge_a[2]);
+    const __m128 zA = _mm_set1_ps(tri.z_a);
+    // Lanes outside [x0, x1] belong to neighbouring tiles or lie outside the bounds
+    const __m128 firstCenter = _mm_set1_ps(static_cast<float>(x0) + 0.5f);
+    const __m128 lastCenter = _mm_set1_ps(static_cast<float>(x1) + 0.5f);
+
+    const int quadStart = x0 & ~3;
+    for (int y = y0; y <= y1; ++y)
+    {
+        const float py = static_cast<float>(y) + 0.5f;
+        const __m128 row0 = _mm_set1_ps(tri.edge_b[0] * py + tri.edge_c[0]);
+        const __m128 row1 = _mm_set1_ps(tri.edge_b[1] * py + tri.edge_c[1]);
+        const __m128 row2 = _mm_set1_ps(tri.edge_b[2] * py + tri.edge_c[2]);
+        const __m128 rowZ = _mm_set1_ps(tri.z_b * py + tri.z_c);
+        float* row = depth_.data() + static_cast<size_t>(y) * width_;
+
+        for (int x = quadStart; x <= x1; x += 4)
+        {
+            const __m128 px = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), laneOffset);
+            __m128 mask = _mm_and_ps(_mm_cmpge_ps(px, firstCenter), _mm_cmple_ps(px, lastCenter));
+            mask = _mm_and_ps(mask, _mm_cmpgt_ps(_mm_add_ps(_mm_mul_ps(edgeA0, px), row0), zero));
+            mask = _mm_and_ps(mask, _mm_cmpgt_ps(_mm_add_ps(_mm_mul_ps(edgeA1, px), row1), zero));
+            mask = _mm_and_ps(mask, _mm_cmpgt_ps(_mm_add_ps(_mm_mul_ps(edgeA2, px), row2), zero));
+            if (_mm_movemask_ps(mask) == 0)
+                continue;
+
+            const __m128 z = _mm_add_ps(_mm_mul_ps(zA, px), rowZ);
+            const __m128 old = _mm_loadu_ps(row + x);
+            const __m128 result = _mm_or_ps(_mm_and_ps(mask, _mm_min_ps(old, z)), _mm_andnot_ps(mask, old));
+            _mm_storeu_ps(row + x, result);
+        }
+    }
+}
+
+void OcclusionRasterizer::selectOccluders(const glm::mat4& viewProj, std::vector<unsigned>& selected) const
+{
+    glm::vec4 planes[6];
+    GPUCuller::extractFrustumPlanes(viewProj, planes);
+
+    // Rank visible occluders by their approximate projected size
+    std::vector<std::pair<float, unsigned>> ranked;
+    for (unsigned i = 0; i < instances_.size(); ++i)
+    {
+        const InstanceData& instance = instances_[i];
+        const glm::vec3 localCenter = glm::vec3(instance.bounds_min + instance.bounds_max) * 0.5f;
+        const glm::vec3 localExtent = glm::vec3(instance.bounds_max - instance.bounds_min) * 0.5f;
+        const glm::vec3 center = glm::vec3(instance.model * glm::vec4(localCenter, 1.f));
+        const glm::mat3 absModel = glm::mat3(glm::abs(glm::vec3(instance.model[0])), glm::abs(glm::vec3(instance.model[1])),
+                                             glm::abs(glm::vec3(instance.model[2])));
+        const glm::vec3 extent = absModel * localExtent;
+
+        if (occluder_meshes_[instance_meshes_[i]].indices.empty() || !GPUCuller::isAABBVisible(planes, center, extent))
+            continue;
+
+        const float w = (viewProj * glm::vec4(center, 1.f)).w;
+        ranked.emplace_back(glm::length(extent) / std::max(w, 1e-3f), i);
+    }
+
+    if (ranked.size() > max_occluders_)
+    {
+        std::nth_element(ranked.begin(), ranked.begin() + max_occluders_, ranked.end(),
+                         [](const auto& a, const auto& b) { return a.first > b.first; });
+        ranked.resize(max_occluders_);
+    }
+
+    selected.clear();
+    for (const auto& entry : ranked)
+        selected.push_back(entry.second);
+    std::sort(selected.begin(), selected.end());
+}
+
+void OcclusionRasterizer::transformAndBin(unsigned slice, const glm::mat4& viewProj)
+{
+    std::vector<ScreenTriangle>& triangles = triangles_[slice];
+    std::vector<std::vector<unsigned>>& bins = bins_[slice];
+    std::vector<glm::vec4>& clip = clip_scratch_[slice];
+
+    triangles.clear();
+    for (auto& bin : bins)
+        bin.clear();
+
+    const size_t sliceCount = triangles_.size();
+    const size_t begin = selected_.size() * slice / sliceCount;
+    const size_t end = selected_.size() * (slice + 1) / sliceCount;
+
+    for (size_t s = begin; s < end; ++s)
+    {
+        const unsigned index = selected_[s];
+        const OccluderMesh& mesh = occluder_meshes_[instance_meshes_[index]];
+        const glm::mat4 mvp = viewProj * instances_[index].model;
+
+        const __m128 col0 = _mm_loadu_ps(&mvp[0][0]);
+        const __m128 col1 = _mm_loadu_ps(&mvp[1][0]);
+        const __m128 col2 = _mm_loadu_ps(&mvp[2][0]);
+        const __m128 col3 = _mm_loadu_ps(&mvp[3][0]);
+
+        clip.resize(mesh.vertices.size());
+        for (size_t v = 0; v < mesh.vertices.size(); ++v)
+        {
+            const glm::vec3& p = mesh.vertices[v];
+            __m128 r = _mm_mul_ps(col0, _mm_set1_ps(p.x));
+            r = _mm_add_ps(r, _mm_mul_ps(col1, _mm_set1_ps(p.y)));
+            r = _mm_add_ps(r, _mm_mul_ps(col2, _mm_set1_ps(p.z)));
+            r = _mm_add_ps(r, col3);
+            _mm_storeu_ps(&clip[v].x, r);
+        }
+
+        for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3)
+        {
+            ScreenTriangle tri;
+            if (!setupTriangle(clip[mesh.indices[i]], clip[mesh.indices[i + 1]], clip[mesh.indices[i + 2]], width_,
+                               height_, tri))
+                continue;
+
+            const unsigned triIndex = static_cast<unsigned>(triangles.size());
+            triangles.push_back(tri);
+            for (int ty = tri.min_y / TILE_SIZE; ty <= tri.max_y / TILE_SIZE; ++ty)
+                for (int tx = tri.min_x / TILE_SIZE; tx <= tri.max_x / TILE_SIZE; ++tx)
+                    bins[ty * tiles_x_ + tx].push_back(triIndex);
+        }
+    }
+}
+
+void OcclusionRasterizer::rasterizeTiles(int firstTile, int lastTile)
+{
+    for (int tile = firstTile; tile < lastTile; ++tile)
+    {
+        const int tileX0 = (tile % tiles_x_) * TILE_SIZE;
+        const int tileY0 = (tile / tiles_x_) * TILE_SIZE;
+        const int tileX1 = std::min(tileX0 + TILE_SIZE, width_) - 1;
+        const int tileY1 = std::min(tileY0 + TILE_SIZE, height_) - 1;
+
+        for (int y = tileY0; y <= tileY1; ++y)
+            std::fill_n(depth_.data() + static_cast<size_t>(y) * width_ + tileX0, tileX1 - tileX0 + 1, 1.f);
+
+        // Slice-major order keeps the result independent of scheduling
+        for (size_t slice = 0; slice < bins_.size(); ++slice)
+        {
+            for (const unsigned triIndex : bins_[slice][tile])
+            {
+                const ScreenTriangle& tri = triangles_[slice][triIndex];
+                rasterizeTriangle(tri, std::max(tri.min_x, tileX0), std::max(tri.min_y, tileY0),
+                                  std::min(tri.max_x, tileX1), std::min(tri.max_y, tileY1));
+            }
+        }
+    }
+}
+
+void OcclusionRasterizer::render(const glm::mat4& viewProj)
+{
+    const auto start = std::chrono::high_resolution_clock::now();
+
+    // One slice of the occluders per job system thread, sized on first use since the
+    // rasterizer may be built before the job system starts
+    const unsigned sliceCount = std::clamp(JOB_SYSTEM.getThreadCount(), 1u, MAX_SLICES);
+    if (triangles_.size() != sliceCount)
+    {
+        triangles_.resize(sliceCount);
+        bins_.assign(sliceCount, std::vector<std::vector<unsigned>>(tiles_x_ * tiles_y_));
+        clip_scratch_.resize(sliceCount);
+    }
+
+    view_proj_ = viewProj;
+    selectOccluders(viewProj, selected_);
+    JOB_SYSTEM.parallelFor(0, sliceCount, 1, [this, &viewProj](size_t first, size_t last) {
+        for (size_t slice = first; slice < last; ++slice)
+            transformAndBin(static_cast<unsigned>(slice), viewProj);
+    });
+
+    const auto binned = std::chrono::high_resolution_clock::now();
+
+    JOB_SYSTEM.parallelFor(0, static_cast<size_t>(tiles_x_) * tiles_y_, 1, [this](size_t first, size_t last) {
+        rasterizeTiles(static_cast<int>(first), static_cast<int>(last));
+    });
+
+    const auto end = std::chrono::high_resolution_clock::now();
+
+    stats_.setupMs = std::chrono::duration<float, std::milli>(binned - start).count();
+    stats_.rasterMs = std::chrono::duration<float, std::milli>(end - binned).count();
+    stats_.occluders = static_cast<unsigned>(selected_.size());
+    stats_.triangles = 0;
+    for (const auto& triangles : triangles_)
+        stats_.triangles += static_cast<unsigned>(triangles.size());
+}
+
+void OcclusionRasterizer::renderReference(const glm::mat4& viewProj, std::vector<float>& depth) const
+{
+    depth.assign(static_cast<size_t>(width_) * height_, 1.f);
+
+    std::vector<unsigned> selected;
+    selectOccluders(viewProj, selected);
+
+    std::vector<glm::vec4> clip;
+    for (const unsigned index : selected)
+    {
+        const OccluderMesh& mesh = occluder_meshes_[instance_meshes_[index]];
+        const glm::mat4 mvp = viewProj * instances_[index].model;
+
+        clip.resize(mesh.vertices.size());
+        for (size_t v = 0; v < mesh.vertices.size(); ++v)
+        {
+            const glm::vec3& p = mesh.vertices[v];
+            clip[v] = mvp[0] * p.x + mvp[1] * p.y + mvp[2] * p.z + mvp[3];
+        }
+
+        for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3)
+        {
+            ScreenTriangle tri;
+            if (setupTriangle(clip[mesh.indices[i]], clip[mesh.indices[i + 1]], clip[mesh.indices[i + 2]], width_,
+                              height_, tri))
+                rasterizeTriangleScalar(tri, tri.min_x, tri.min_y, tri.max_x, tri.max_y, depth.data(), width_);
+        }
+    }
+}
+
+bool OcclusionRasterizer::isVisible(const glm::vec3& center, const glm::vec3& extent) const
+{
+    glm::vec3 ndcMin(1.f), ndcMax(-1.f);
+    for (int i = 0; i < 8; ++i)
+    {
+        const glm::vec3 corner = center + extent * glm::vec3((i & 1) ? 1.f : -1.f, (i & 2) ? 1.f : -1.f,
+                                                             (i & 4) ? 1.f : -1.f);
+        const glm::vec4 clip = view_proj_ * glm::vec4(corner, 1.f);
+        // Reaching the near plane, it may cover the whole screen
+        if (clip.w <= 1e-5f || clip.z < -clip.w)
+            return true;
+        const glm::vec3 ndc = glm::vec3(clip) / clip.w;
+        ndcMin = glm::min(ndcMin, ndc);
+        ndcMax = glm::max(ndcMax, ndc);
+    }
+
+    // Every pixel the screen rectangle touches and one more around it. Depth is sampled at
+    // pixel centers, a pixel is only known to be covered, and no farther than the samples
+    // around it, when its neighbours are too
+    const int x0 = std::max(static_cast<int>(std::floor((ndcMin.x * 0.5f + 0.5f) * width_)) - 1, 0);
+    const int y0 = std::max(static_cast<int>(std::floor((ndcMin.y * 0.5f + 0.5f) * height_)) - 1, 0);
+    const int x1 = std::min(static_cast<int>(std::floor((ndcMax.x * 0.5f + 0.5f) * width_)) + 1, width_ - 1);
+    const int y1 = std::min(static_cast<int>(std::floor((ndcMax.y * 0.5f + 0.5f) * height_)) + 1, height_ - 1);
+    if (x0 > x1 || y0 > y1)
+        return true;
+
+    const float nearest = ndcMin.z * 0.5f + 0.5f;
+    const __m128 nearest4 = _mm_set1_ps(nearest);
+    for (int y = y0; y <= y1; ++y)
+    {
+        const float* row = depth_.data() + static_cast<size_t>(y) * width_;
+        int x = x0;
+        for (; x + 3 <= x1; x += 4)
+            if (_mm_movemask_ps(_mm_cmpge_ps(_mm_loadu_ps(row + x), nearest4)) != 0)
+                return true;
+        for (; x <= x1; ++x)
+            if (row[x] >= nearest)
+                return true;
+    }
+    return false;
+}
+
+const std::vector<float>& OcclusionRasterizer::getDepth() const
+{
+    return depth_;
+}
+
+const OcclusionRasterizer::Stats& OcclusionRasterizer::getStats() const
+{
+    return stats_;
+}
+
+int OcclusionRasterizer::getWidth() const
+{
+    return width_;
+}
+
+int OcclusionRasterizer::getHeight() const
+{
+    return height_;
+}
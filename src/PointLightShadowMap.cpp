@@ -1,11 +1,12 @@
 #include "PointLightShadowMap.h"
+#include "GLStateCache.h"
 
 #include <cstddef>
 
 PointLightShadowMap::PointLightShadowMap(int width, int height) : ShadowMap(width, height) {
     //Create cubemap texture for 6 sided depth map
     glGenTextures(1, &cubeMap);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, cubeMap);
+    GL_STATE.bindTexture(0, GL_TEXTURE_CUBE_MAP, cubeMap);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
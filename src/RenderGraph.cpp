@@ -0,0 +1,615 @@
+/* Start Header -------------------------------------------------------
+Copyright (C) 2021 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the prior written
+consent of DigiPen Institute of Technology is prohibited.
+File Name: RenderGraph.cpp
+Purpose: This file is source for the render graph of the deferred passes.
+Language: c++
+Platform: VS2019 / Window
+Project:  HGraphics
+Author: Elliott Hong <s.hong@digipen.edu>
+Creation date: Oct 19, 2026
+End Header ---------------------------------------------------------*/
+#include "RenderGraph.h"
+
+#include <algorithm>
+#include <iostream>
+
+#include "GLStateCache.h"
+
+RenderGraph::RenderGraph()
+    : width_(1), height_(1), render_width_(0), render_height_(0), dirty_(true), current_pass_(-1), read_fbo_(0), stats_{}
+{
+}
+
+RenderGraph::~RenderGraph()
+{
+    deleteFramebuffers();
+    for (Physical& physical : physicals_)
+        GL_STATE.deleteTextures(1, &physical.texture);
+    if (read_fbo_ != 0)
+        GL_STATE.deleteFramebuffers(1, &read_fbo_);
+}
+
+void RenderGraph::clear()
+{
+    deleteFramebuffers();
+    resources_.clear();
+    passes_.clear();
+    order_.clear();
+    dirty_ = true;
+}
+
+int RenderGraph::createTexture(const std::string& name, GLenum internalFormat, float scale)
+{
+    Resource resource;
+    resource.name = name;
+    resource.format = internalFormat;
+    resource.scale = scale;
+    resource.bImported = false;
+    resource.imported = 0;
+    resource.physical = -1;
+    resource.first = resource.last = -1;
+    resources_.push_back(resource);
+    dirty_ = true;
+    return static_cast<int>(resources_.size()) - 1;
+}
+
+int RenderGraph::importTexture(const std::string& name, GLuint texture)
+{
+    const int index = createTexture(name, GL_NONE, 1.f);
+    resources_[index].bImported = true;
+    resources_[index].imported = texture;
+    return index;
+}
+
+void RenderGraph::setImportedTexture(int resource, GLuint texture)
+{
+    // Imported textures are never attached to the pass framebuffers, nothing to rebuild
+    if (resources_[resource].bImported)
+        resources_[resource].imported = texture;
+}
+
+int RenderGraph::addPass(const std::string& name, std::function<void()> execute)
+{
+    Pass pass;
+    pass.name = name;
+    pass.execute = std::move(execute);
+    pass.bCulled = false;
+    pass.fbo = 0;
+    pass.width = pass.height = 0;
+    pass.scale = 1.f;
+    passes_.push_back(pass);
+    dirty_ = true;
+    return static_cast<int>(passes_.size()) - 1;
+}
+
+void RenderGraph::read(int pass, int resource)
+{
+    std::vector<int>& reads = passes_[pass].reads;
+    if (std::find(reads.begin(), reads.end(), resource) != reads.end())
+        return;
+    reads.push_back(resource);
+    resources_[resource].readers.push_back(pass);
+    dirty_ = true;
+}
+
+void RenderGraph::write(int pass, int resource)
+{
+    std::vector<int>& writes = passes_[pass].writes;
+    if (std::find(writes.begin(), writes.end(), resource) != writes.end())
+        return;
+    writes.push_back(resource);
+    resources_[resource].writers.push_back(pass);
+    dirty_ = true;
+}
+
+void RenderGraph::setSize(int width, int height)
+{
+    width = std::max(width, 1);
+    height = std::max(height, 1);
+    if (width == width_ && height == height_)
+        return;
+    width_ = width;
+    height_ = height;
+    dirty_ = true;
+}
+
+void RenderGraph::setRenderSize(int width, int height)
+{
+    render_width_ = width;
+    render_height_ = height;
+}
+
+void RenderGraph::compile()
+{
+    deleteFramebuffers();
+    cull();
+    sortPasses();
+    assignTextures();
+    createFramebuffers();
+
+    stats_ = Stats{};
+    stats_.passes = static_cast<unsigned>(order_.size());
+    stats_.culledPasses = static_cast<unsigned>(passes_.size() - order_.size());
+    for (const Resource& resource : resources_)
+    {
+        if (resource.bImported || resource.physical < 0)
+            continue;
+        ++stats_.textures;
+        stats_.unaliasedBytes += static_cast<uint64_t>(getScaledSize(width_, resource.scale))
+            * getScaledSize(height_, resource.scale) * getBytesPerPixel(resource.format);
+    }
+    stats_.allocations = static_cast<unsigned>(physicals_.size());
+    for (const Physical& physical : physicals_)
+        stats_.bytes += static_cast<uint64_t>(physical.width) * physical.height * getBytesPerPixel(physical.format);
+
+    dirty_ = false;
+}
+
+void RenderGraph::execute()
+{
+    if (dirty_)
+        compile();
+
+    for (int pass : order_)
+    {
+        current_pass_ = pass;
+        bindTarget();
+        passes_[pass].execute();
+    }
+    current_pass_ = -1;
+}
+
+void RenderGraph::bindTarget()
+{
+    if (current_pass_ < 0 || passes_[current_pass_].fbo == 0)
+        return;
+
+    const Pass& pass = passes_[current_pass_];
+    GL_STATE.bindFramebuffer(GL_FRAMEBUFFER, pass.fbo);
+    // Passes may change the draw buffers, which are framebuffer state
+    if (pass.drawBuffers.empty())
+        glDrawBuffer(GL_NONE);
+    else
+        glDrawBuffers(static_cast<GLsizei>(pass.drawBuffers.size()), pass.drawBuffers.data());
+    GL_STATE.viewport(0, 0, std::min(getScaledSize(getRenderWidth(), pass.scale), pass.width),
+                      std::min(getScaledSize(getRenderHeight(), pass.scale), pass.height));
+}
+
+GLenum RenderGraph::getAttachment(int resource) const
+{
+    if (current_pass_ < 0)
+        return GL_NONE;
+
+    GLenum color = GL_COLOR_ATTACHMENT0;
+    for (int write : passes_[current_pass_].writes)
+    {
+        const Resource& written = resources_[write];
+        if (written.bImported)
+            continue;
+        if (isDepthFormat(written.format))
+        {
+            if (write == resource)
+                return getDepthAttachment(written.format);
+            continue;
+        }
+        if (write == resource)
+            return color;
+        ++color;
+    }
+    return GL_NONE;
+}
+
+void RenderGraph::bindRead(int resource)
+{
+    const Resource& source = resources_[resource];
+    if (source.bImported || source.physical < 0)
+        return;
+
+    if (read_fbo_ == 0)
+        glGenFramebuffers(1, &read_fbo_);
+    GL_STATE.bindFramebuffer(GL_READ_FRAMEBUFFER, read_fbo_);
+
+    const GLuint texture = physicals_[source.physical].texture;
+    if (isDepthFormat(source.format))
+    {
+        glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, 0, 0);
+        glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, 0, 0);
+        glFramebufferTexture2D(GL_READ_FRAMEBUFFER, getDepthAttachment(source.format), GL_TEXTURE_2D, texture, 0);
+        glReadBuffer(GL_NONE);
+    }
+    else
+    {
+        glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, 0, 0);
+        glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0);
+        glReadBuffer(GL_COLOR_ATTACHMENT0);
+    }
+}
+
+GLuint RenderGraph::getTexture(int resource) const
+{
+    const Resource& texture = resources_[resource];
+    if (texture.bImported)
+        return texture.imported;
+    return texture.physical < 0 ? 0 : physicals_[texture.physical].texture;
+}
+
+int RenderGraph::getWidth() const
+{
+    return width_;
+}
+
+int RenderGraph::getHeight() const
+{
+    return height_;
+}
+
+int RenderGraph::getRenderWidth() const
+{
+    return render_width_ > 0 ? std::min(render_width_, width_) : width_;
+}
+
+int RenderGraph::getRenderHeight() const
+{
+    return render_height_ > 0 ? std::min(render_height_, height_) : height_;
+}
+
+const std::vector<int>& RenderGraph::getOrder() const
+{
+    return order_;
+}
+
+const std::string& RenderGraph::getPassName(int pass) const
+{
+    return passes_[pass].name;
+}
+
+const RenderGraph::Stats& RenderGraph::getStats() const
+{
+    return stats_;
+}
+
+void RenderGraph::getDependencies(int pass, std::vector<int>& dependencies) const
+{
+    dependencies.clear();
+
+    // Last pass added before this one that wrote the resource
+    auto lastWriter = [pass](const Resource& resource) {
+        int writer = -1;
+        for (int w : resource.writers)
+        {
+            if (w < pass)
+                writer = std::max(writer, w);
+        }
+        return writer;
+    };
+
+    for (int read : passes_[pass].reads)
+    {
+        const int writer = lastWriter(resources_[read]);
+        if (writer >= 0)
+            dependencies.push_back(writer);
+    }
+
+    for (int write : passes_[pass].writes)
+    {
+        const Resource& resource = resources_[write];
+        const int writer = lastWriter(resource);
+        if (writer >= 0)
+            dependencies.push_back(writer);
+        // Everything that read the previous contents has to run first
+        for (int reader : resource.readers)
+        {
+            if (reader > writer && reader < pass)
+                dependencies.push_back(reader);
+        }
+    }
+}
+
+void RenderGraph::cull()
+{
+    std::vector<int> pending;
+    for (int i = 0; i < static_cast<int>(passes_.size()); ++i)
+    {
+        passes_[i].bCulled = true;
+        for (int write : passes_[i].writes)
+        {
+            if (resources_[write].bImported)
+            {
+                passes_[i].bCulled = false;
+                pending.push_back(i);
+                break;
+            }
+        }
+    }
+
+    std::vector<int> dependencies;
+    while (!pending.empty())
+    {
+        const int pass = pending.back();
+        pending.pop_back();
+        getDependencies(pass, dependencies);
+        for (int dependency : dependencies)
+        {
+            if (passes_[dependency].bCulled)
+            {
+                passes_[dependency].bCulled = false;
+                pending.push_back(dependency);
+            }
+        }
+    }
+}
+
+void RenderGraph::sortPasses()
+{
+    const int count = static_cast<int>(passes_.size());
+    std::vector<std::vector<int>> dependents(count);
+    std::vector<int> remaining(count, 0);
+    std::vector<int> users(resources_.size(), 0);
+    std::vector<int> dependencies;
+    for (int i = 0; i < count; ++i)
+    {
+        if (passes_[i].bCulled)
+            continue;
+        getDependencies(i, dependencies);
+        std::sort(dependencies.begin(), dependencies.end());
+        dependencies.erase(std::unique(dependencies.begin(), dependencies.end()), dependencies.end());
+        remaining[i] = static_cast<int>(dependencies.size());
+        for (int dependency : dependencies)
+            dependents[dependency].push_back(i);
+        for (const std::vector<int>* list : { &passes_[i].reads, &passes_[i].writes })
+        {
+            for (int resource : *list)
+                ++users[resource];
+        }
+    }
+
+    // Kahn's algorithm. Of the passes that are ready, the one that frees the most
+    // transient memory and allocates the least goes first, then the earliest added
+    order_.clear();
+    std::vector<bool> scheduled(count, false);
+    std::vector<bool> touched(resources_.size(), false);
+    for (;;)
+    {
+        int next = -1;
+        int64_t bestScore = 0;
+        for (int i = 0; i < count; ++i)
+        {
+            if (passes_[i].bCulled || scheduled[i] || remaining[i] != 0)
+                continue;
+
+            int64_t score = 0;
+            for (const std::vector<int>* list : { &passes_[i].reads, &passes_[i].writes })
+            {
+                for (int resource : *list)
+                {
+                    const Resource& texture = resources_[resource];
+                    if (texture.bImported)
+                        continue;
+                    const int64_t bytes = static_cast<int64_t>(getScaledSize(width_, texture.scale))
+                        * getScaledSize(height_, texture.scale) * getBytesPerPixel(texture.format);
+                    if (users[resource] == 1)
+                        score += bytes;
+                    if (!touched[resource])
+                        score -= bytes;
+                }
+            }
+            if (next < 0 || score > bestScore)
+            {
+                next = i;
+                bestScore = score;
+            }
+        }
+        if (next < 0)
+            break;
+
+        scheduled[next] = true;
+        order_.push_back(next);
+        for (int dependent : dependents[next])
+            --remaining[dependent];
+        for (const std::vector<int>* list : { &passes_[next].reads, &passes_[next].writes })
+        {
+            for (int resource : *list)
+            {
+                --users[resource];
+                touched[resource] = true;
+            }
+        }
+    }
+}
+
+void RenderGraph::assignTextures()
+{
+    for (Resource& resource : resources_)
+    {
+        resource.physical = -1;
+        resource.first = resource.last = -1;
+    }
+
+    for (int step = 0; step < static_cast<int>(order_.size()); ++step)
+    {
+        const Pass& pass = passes_[order_[step]];
+        for (const std::vector<int>* list : { &pass.reads, &pass.writes })
+        {
+            for (int index : *list)
+            {
+                Resource& resource = resources_[index];
+                if (resource.first < 0)
+                    resource.first = step;
+                resource.last = std::max(resource.last, step);
+            }
+        }
+    }
+
+    std::vector<int> live;
+    for (int i = 0; i < static_cast<int>(resources_.size()); ++i)
+    {
+        if (!resources_[i].bImported && resources_[i].first >= 0)
+            live.push_back(i);
+    }
+    std::stable_sort(live.begin(), live.end(),
+                     [this](int a, int b) { return resources_[a].first < resources_[b].first; });
+
+    for (Physical& physical : physicals_)
+    {
+        physical.bUsed = false;
+        physical.freeAfter = -1;
+    }
+
+    for (int index : live)
+    {
+        Resource& resource = resources_[index];
+        const int width = getScaledSize(width_, resource.scale);
+        const int height = getScaledSize(height_, resource.scale);
+
+        // Textures of an earlier compile are reused as they are, only new sizes are allocated
+        for (int i = 0; i < static_cast<int>(physicals_.size()) && resource.physical < 0; ++i)
+        {
+            const Physical& physical = physicals_[i];
+            if (physical.format == resource.format && physical.width == width && physical.height == height &&
+                physical.freeAfter < resource.first)
+                resource.physical = i;
+        }
+
+        if (resource.physical < 0)
+        {
+            Physical physical;
+            physical.format = resource.format;
+            physical.width = width;
+            physical.height = height;
+            glGenTextures(1, &physical.texture);
+            GL_STATE.bindTexture(0, GL_TEXTURE_2D, physical.texture);
+            glTexStorage2D(GL_TEXTURE_2D, 1, resource.format, width, height);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+            if (isDepthFormat(resource.format))
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_MODE, GL_NONE);
+            physicals_.push_back(physical);
+            resource.physical = static_cast<int>(physicals_.size()) - 1;
+        }
+
+        Physical& physical = physicals_[resource.physical];
+        physical.bUsed = true;
+        physical.freeAfter = resource.last;
+    }
+
+    // Free what no texture uses anymore, e.g. the old sizes after a resize
+    std::vector<int> remap(physicals_.size(), -1);
+    std::vector<Physical> kept;
+    for (size_t i = 0; i < physicals_.size(); ++i)
+    {
+        if (physicals_[i].bUsed)
+        {
+            remap[i] = static_cast<int>(kept.size());
+            kept.push_back(physicals_[i]);
+        }
+        else
+        {
+            GL_STATE.deleteTextures(1, &physicals_[i].texture);
+        }
+    }
+    physicals_.swap(kept);
+    for (int index : live)
+        resources_[index].physical = remap[resources_[index].physical];
+}
+
+void RenderGraph::createFramebuffers()
+{
+    for (int index : order_)
+    {
+        Pass& pass = passes_[index];
+        GLenum color = GL_COLOR_ATTACHMENT0;
+        for (int write : pass.writes)
+        {
+            const Resource& resource = resources_[write];
+            if (resource.bImported)
+                continue;
+
+            if (pass.fbo == 0)
+            {
+                glGenFramebuffers(1, &pass.fbo);
+                GL_STATE.bindFramebuffer(GL_FRAMEBUFFER, pass.fbo);
+                pass.width = physicals_[resource.physical].width;
+                pass.height = physicals_[resource.physical].height;
+                pass.scale = resource.scale;
+            }
+
+            GLenum attachment = color;
+            if (isDepthFormat(resource.format))
+                attachment = getDepthAttachment(resource.format);
+            else
+                pass.drawBuffers.push_back(color++);
+            glFramebufferTexture2D(GL_FRAMEBUFFER, attachment, GL_TEXTURE_2D, physicals_[resource.physical].texture, 0);
+        }
+
+        if (pass.fbo != 0 && glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+            std::cout << "RenderGraph: framebuffer of pass " << pass.name << " is incomplete" << std::endl;
+    }
+    GL_STATE.bindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void RenderGraph::deleteFramebuffers()
+{
+    for (Pass& pass : passes_)
+    {
+        if (pass.fbo != 0)
+            GL_STATE.deleteFramebuffers(1, &pass.fbo);
+        pass.fbo = 0;
+        pass.drawBuffers.clear();
+        pass.width = pass.height = 0;
+        pass.scale = 1.f;
+    }
+}
+
+int RenderGraph::getScaledSize(int size, float scale) const
+{
+    return std::max(static_cast<int>(size * scale + 0.5f), 1);
+}
+
+bool RenderGraph::isDepthFormat(GLenum format)
+{
+    switch (format)
+    {
+    case GL_DEPTH_COMPONENT16:
+    case GL_DEPTH_COMPONENT24:
+    case GL_DEPTH_COMPONENT32:
+    case GL_DEPTH_COMPONENT32F:
+    case GL_DEPTH24_STENCIL8:
+    case GL_DEPTH32F_STENCIL8:
+        return true;
+    default:
+        return false;
+    }
+}
+
+GLenum RenderGraph::getDepthAttachment(GLenum format)
+{
+    if (format == GL_DEPTH24_STENCIL8 || format == GL_DEPTH32F_STENCIL8)
+        return GL_DEPTH_STENCIL_ATTACHMENT;
+    return GL_DEPTH_ATTACHMENT;
+}
+
+unsigned RenderGraph::getBytesPerPixel(GLenum format)
+{
+    switch (format)
+    {
+    case GL_R8:
+        return 1;
+    case GL_R16F:
+    case GL_RG8:
+    case GL_DEPTH_COMPONENT16:
+        return 2;
+    case GL_RGBA16F:
+    case GL_RG32F:
+    case GL_DEPTH32F_STENCIL8:
+        return 8;
+    case GL_RGBA32F:
+        return 16;
+    default:
+        // RGBA8, R32F, RG16F, RGB10_A2, R11F_G11F_B10F and the 24/32-bit depth formats
+        return 4;
+    }
+}
@@ -0,0 +1,219 @@
+/* Start Header -------------------------------------------------------
+Copyright (C) 2021 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the prior written
+consent of DigiPen Institute of Technology is prohibited.
+File Name: RenderQueue.cpp
+Purpose: This file is source for the sort-key render queue.
+Language: c++
+Platform: VS2019 / Window
+Project:  HGraphics
+Author: Elliott Hong <s.hong@digipen.edu>
+Creation date: Oct 19, 2026
+End Header ---------------------------------------------------------*/
+#include "RenderQueue.h"
+
+#include "AllocationCounter.h"
+#include "FrameArena.h"
+#include "GLStateCache.h"
+
+#include <algorithm>
+
+namespace
+{
+    const unsigned SHADER_ID_MASK = 0xFFF;
+    const unsigned MESH_ID_MASK = 0x1FFF;
+    const unsigned LOD_MASK = 0x7;
+    const unsigned FIELD_MASK = 0xFFFF;
+}
+
+RenderQueue::RenderQueue()
+    : view_(1.f), z_near_(0.1f), z_far_(100.f), lod_view_{}, b_lod_(false), instance_buffer_(0),
+      stats_{ 0, 0, 0, 0, 0, 0 }
+{
+}
+
+RenderQueue::~RenderQueue()
+{
+    if (instance_buffer_ != 0)
+        glDeleteBuffers(1, &instance_buffer_);
+}
+
+uint64_t RenderQueue::makeKey(Pass pass, unsigned shader, unsigned material, unsigned mesh, unsigned lod, unsigned depth)
+{
+    const uint64_t p = static_cast<uint64_t>(pass) & 0xF;
+    const uint64_t s = shader & SHADER_ID_MASK;
+    const uint64_t mat = material & FIELD_MASK;
+    const uint64_t m = (mesh & MESH_ID_MASK) << 3 | (lod & LOD_MASK);
+    const uint64_t d = depth & FIELD_MASK;
+
+    // Blended draws must stay in back to front order, so depth outranks state
+    if (pass == Pass::BLENDED)
+        return p << 60 | (FIELD_MASK - d) << 44 | s << 32 | mat << 16 | m;
+    return p << 60 | s << 48 | mat << 32 | m << 16 | d;
+}
+
+void RenderQueue::begin(const glm::mat4& view, float zNear, float zFar, const LODView* lod)
+{
+    view_ = view;
+    z_near_ = zNear;
+    z_far_ = zFar;
+    b_lod_ = lod != nullptr;
+    if (lod)
+        lod_view_ = *lod;
+    LinearAllocator& memory = FRAME_ARENA.get();
+    draws_.reset(memory);
+    items_.reset(memory);
+    scratch_.reset(memory);
+    instances_.reset(memory);
+}
+
+void RenderQueue::submit(Pass pass, Shader* shader, int material, const Mesh* mesh, const glm::mat4& model,
+                         const glm::vec4& color)
+{
+    Draw draw;
+    draw.shader = shader;
+    draw.material = material;
+    draw.mesh = mesh;
+    draw.lod = b_lod_ ? std::min(mesh->selectLOD(lod_view_, model), LOD_MASK) : 0;
+    draw.instance.model = model;
+    draw.instance.normalMatrix = glm::mat4(glm::transpose(glm::inverse(glm::mat3(model))));
+    draw.instance.color = color;
+
+    const float distance = -(view_ * model[3]).z;
+    const float t = std::min(std::max((distance - z_near_) / (z_far_ - z_near_), 0.f), 1.f);
+    const unsigned depth = static_cast<unsigned>(t * FIELD_MASK);
+
+    // -1 (no material) sorts first as 0
+    const uint64_t key = makeKey(pass, getShaderID(shader), static_cast<unsigned>(material + 1), getMeshID(mesh), draw.lod,
+                                 depth);
+    items_.push_back({ key, static_cast<uint32_t>(draws_.size()) });
+    draws_.push_back(draw);
+}
+
+void RenderQueue::sort()
+{
+    // LSD radix sort, 8 bits per pass; digits every key shares are skipped
+    const size_t count = items_.size();
+    scratch_.resize(count);
+    for (int shift = 0; shift < 64; shift += 8)
+    {
+        size_t offsets[256] = {};
+        for (const SortItem& item : items_)
+            ++offsets[(item.key >> shift) & 0xFF];
+        if (offsets[(items_[0].key >> shift) & 0xFF] == count)
+            continue;
+
+        size_t sum = 0;
+        for (size_t& offset : offsets)
+        {
+            const size_t digitCount = offset;
+            offset = sum;
+            sum += digitCount;
+        }
+        for (const SortItem& item : items_)
+            scratch_[offsets[(item.key >> shift) & 0xFF]++] = item;
+        items_.swap(scratch_);
+    }
+}
+
+void RenderQueue::execute()
+{
+    stats_ = { static_cast<unsigned>(draws_.size()), 0, 0, 0, 0, 0 };
+    if (draws_.empty())
+        return;
+
+    sort();
+
+    //Instance records in draw order, so every batch is a contiguous range
+    instances_.clear();
+    instances_.reserve(items_.size());
+    for (const SortItem& item : items_)
+        instances_.push_back(draws_[item.draw].instance);
+
+    if (instance_buffer_ == 0)
+        glGenBuffers(1, &instance_buffer_);
+    GL_STATE.bindBuffer(GL_SHADER_STORAGE_BUFFER, instance_buffer_);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, instances_.size() * sizeof(InstanceData), instances_.data(), GL_STREAM_DRAW);
+    GL_STATE.bindBufferBase(GL_SHADER_STORAGE_BUFFER, INSTANCE_BINDING, instance_buffer_);
+
+    Shader* shader = nullptr;
+    GLint materialLocation = -1, baseLocation = -1;
+    int material = 0;
+    const Mesh* mesh = nullptr;
+    for (size_t begin = 0; begin < items_.size();)
+    {
+        const Draw& first = draws_[items_[begin].draw];
+        size_t end = begin + 1;
+        while (end < items_.size())
+        {
+            const Draw& next = draws_[items_[end].draw];
+            if (next.shader != first.shader || next.material != first.material || next.mesh != first.mesh ||
+                next.lod != first.lod)
+                break;
+            ++end;
+        }
+
+        if (first.shader != shader)
+        {
+            shader = first.shader;
+            shader->use();
+            ++stats_.shaderChanges;
+            //Programs without a material table have no materialIndex
+            materialLocation = glGetUniformLocation(shader->getHandle(), "materialIndex");
+            baseLocation = glGetUniformLocation(shader->getHandle(), "instanceBase");
+            //materialIndex is per program state
+            material = first.material + 1;
+        }
+        if (first.material != material)
+        {
+            material = first.material;
+            if (materialLocation >= 0)
+                glUniform1i(materialLocation, material);
+            ++stats_.materialChanges;
+        }
+        if (first.mesh != mesh)
+        {
+            mesh = first.mesh;
+            mesh->bindVertexArray();
+            ++stats_.meshChanges;
+        }
+
+        glUniform1i(baseLocation, static_cast<GLint>(begin));
+        mesh->renderInstanced(static_cast<GLsizei>(end - begin), first.lod);
+        stats_.triangles += mesh->getLOD(first.lod).indexCount / 3 * static_cast<unsigned>(end - begin);
+        ++stats_.batches;
+        begin = end;
+    }
+
+    draws_.clear();
+    items_.clear();
+}
+
+const RenderQueue::Stats& RenderQueue::getStats() const
+{
+    return stats_;
+}
+
+unsigned RenderQueue::getShaderID(const Shader* shader)
+{
+    const auto it = shader_ids_.find(shader);
+    if (it != shader_ids_.end())
+        return it->second;
+    // Once per shader, not per frame
+    const AllocationCounter::AllowScope allow;
+    const unsigned id = static_cast<unsigned>(shader_ids_.size()) & SHADER_ID_MASK;
+    shader_ids_[shader] = id;
+    return id;
+}
+
+unsigned RenderQueue::getMeshID(const Mesh* mesh)
+{
+    const auto it = mesh_ids_.find(mesh);
+    if (it != mesh_ids_.end())
+        return it->second;
+    // Once per mesh, not per frame
+    const AllocationCounter::AllowScope allow;
+    const unsigned id = static_cast<unsigned>(mesh_ids_.size()) & MESH_ID_MASK;
+    mesh_ids_[mesh] = id;
+    return id;
+}
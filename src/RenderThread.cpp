@@ -0,0 +1,185 @@
+/* Start Header -------------------------------------------------------
+Copyright (C) 2021 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the prior written
+consent of DigiPen Institute of Technology is prohibited.
+File Name: RenderThread.cpp
+Purpose: This file is source for the render thread.
+Language: c++
+Platform: VS2019 / Window
+Project:  HGraphics
+Author: Elliott Hong <s.hong@digipen.edu>
+Creation date: Oct 19, 2026
+End Header ---------------------------------------------------------*/
+#include "RenderThread.h"
+
+#include <cassert>
+#include <chrono>
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <imgui_impl_opengl3.h>
+
+#include "AllocationCounter.h"
+#include "scene.h"
+
+using Clock = std::chrono::steady_clock;
+
+static float elapsedMs(Clock::time_point start)
+{
+    return std::chrono::duration<float, std::milli>(Clock::now() - start).count();
+}
+
+RenderThread::RenderThread()
+{
+    window_ = nullptr;
+    scene_ = nullptr;
+    for (unsigned i = 0; i < PACKET_COUNT; ++i)
+        packets_[i].index = i;
+    submitted_count_ = 0;
+    rendered_count_ = 0;
+    started_ = false;
+    threaded_ = false;
+    stop_ = false;
+}
+
+RenderThread::~RenderThread()
+{
+    stop();
+}
+
+void RenderThread::start(GLFWwindow* window, Scene* scene, bool bThreaded)
+{
+    stop();
+
+    window_ = window;
+    scene_ = scene;
+    started_ = true;
+    threaded_ = bThreaded;
+    stop_ = false;
+
+    // A context is current on one thread at a time, let go of it before the render thread takes it
+    if (threaded_)
+    {
+        glfwMakeContextCurrent(nullptr);
+        thread_ = std::thread(&RenderThread::threadLoop, this);
+    }
+}
+
+void RenderThread::stop()
+{
+    if (!started_)
+        return;
+
+    if (threaded_)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        submitted_.notify_one();
+        thread_.join();
+        glfwMakeContextCurrent(window_);
+    }
+
+    started_ = false;
+    threaded_ = false;
+}
+
+bool RenderThread::isStarted() const
+{
+    return started_;
+}
+
+bool RenderThread::isThreaded() const
+{
+    return threaded_;
+}
+
+FramePacket& RenderThread::beginFrame()
+{
+    const uint64_t frame = submitted_count_;
+    const Clock::time_point start = Clock::now();
+    {
+        // The packet is free once the frame that used it before was drawn
+        std::unique_lock<std::mutex> lock(mutex_);
+        rendered_.wait(lock, [this, frame]() { return rendered_count_ + PACKET_COUNT > frame; });
+    }
+
+    FramePacket& packet = packets_[frame % PACKET_COUNT];
+    packet.reset();
+    packet.frame = frame;
+    packet.stats.waitMs = elapsedMs(start);
+    return packet;
+}
+
+void RenderThread::submit(FramePacket& packet)
+{
+    if (!threaded_)
+    {
+        renderPacket(packet);
+        ++submitted_count_;
+        ++rendered_count_;
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++submitted_count_;
+    }
+    submitted_.notify_one();
+}
+
+void RenderThread::threadLoop()
+{
+    glfwMakeContextCurrent(window_);
+
+    while (true)
+    {
+        uint64_t frame;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            submitted_.wait(lock, [this]() { return stop_ || rendered_count_ < submitted_count_; });
+            // Frames submitted before stop are still drawn
+            if (rendered_count_ == submitted_count_)
+                break;
+            frame = rendered_count_;
+        }
+
+        renderPacket(packets_[frame % PACKET_COUNT]);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            ++rendered_count_;
+        }
+        rendered_.notify_one();
+    }
+
+    glfwMakeContextCurrent(nullptr);
+}
+
+void RenderThread::renderPacket(FramePacket& packet)
+{
+    const Clock::time_point start = Clock::now();
+
+    {
+        // Commands are one-off work, a resize or a reload; they may allocate
+        const AllocationCounter::AllowScope allow;
+        packet.commands.execute();
+    }
+
+    const uint64_t allocations = AllocationCounter::getThreadCount();
+    scene_->RenderFrame(packet);
+    if (packet.ui)
+        ImGui_ImplOpenGL3_RenderDrawData(packet.ui);
+    packet.stats.renderAllocations = static_cast<unsigned>(AllocationCounter::getThreadCount() - allocations);
+    // Caches fill in the first frames, after that drawing a frame allocates nothing. Arena blocks
+    // added when a frame needs more memory than any before are not counted, see LinearAllocator
+    assert((packet.frame < WARM_UP_FRAMES || packet.stats.renderAllocations == 0) &&
+           "The render thread allocated on the heap in a steady frame");
+
+    GL_INSTRUMENTATION.endFrame();
+
+    packet.stats.renderMs = elapsedMs(start);
+    packet.stats.read();
+
+    glfwSwapBuffers(window_);
+}
@@ -0,0 +1,151 @@
+/* Start Header -------------------------------------------------------
+Copyright (C) 2021 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the prior written
+consent of DigiPen Institute of Technology is prohibited.
+File Name: ShaderCache.cpp
+Purpose: This file reads and writes the on-disk cache of linked program binaries
+Language: c++
+Platform: VS2019 / Window
+Project:  HGraphics
+Author: Elliott Hong <s.hong@digipen.edu>
+Creation date: Oct 19, 2026
+End Header ---------------------------------------------------------*/
+#include "ShaderCache.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace
+{
+    const uint64_t FNV_OFFSET = 14695981039346656037ull;
+    const uint64_t FNV_PRIME = 1099511628211ull;
+
+    uint64_t hashBytes(uint64_t hash, const void* data, size_t size)
+    {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; ++i)
+        {
+            hash ^= bytes[i];
+            hash *= FNV_PRIME;
+        }
+        return hash;
+    }
+
+    // Length first so "ab" + "c" and "a" + "bc" differ
+    uint64_t hashString(uint64_t hash, const char* text)
+    {
+        const uint64_t length = text ? std::strlen(text) : 0;
+        hash = hashBytes(hash, &length, sizeof(length));
+        return hashBytes(hash, text, static_cast<size_t>(length));
+    }
+}
+
+std::string ShaderCache::cachePath(const std::vector<std::string>& stagePaths)
+{
+    if (stagePaths.empty())
+        return std::string();
+
+    const std::filesystem::path first(stagePaths.front());
+    std::string name;
+    for (const std::string& stagePath : stagePaths)
+    {
+        if (!name.empty())
+            name += '_';
+        name += std::filesystem::path(stagePath).filename().string();
+    }
+    return (first.parent_path() / "cache" / (name + ".hprog")).string();
+}
+
+uint64_t ShaderCache::makeKey(const std::vector<std::string>& stageSources)
+{
+    uint64_t hash = hashBytes(FNV_OFFSET, &SHADER_CACHE_VERSION, sizeof(SHADER_CACHE_VERSION));
+    for (const std::string& source : stageSources)
+        hash = hashString(hash, source.c_str());
+
+    const GLenum driverStrings[] = { GL_VENDOR, GL_RENDERER, GL_VERSION, GL_SHADING_LANGUAGE_VERSION };
+    for (const GLenum name : driverStrings)
+        hash = hashString(hash, reinterpret_cast<const char*>(glGetString(name)));
+    return hash;
+}
+
+bool ShaderCache::isSupported()
+{
+    GLint formatCount = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+    return formatCount > 0;
+}
+
+GLuint ShaderCache::load(const std::string& cacheFile, uint64_t key)
+{
+    if (cacheFile.empty() || !isSupported())
+        return 0;
+
+    std::ifstream inFile(cacheFile, std::ios::binary);
+    if (!inFile)
+        return 0;
+
+    ShaderCacheHeader header;
+    if (!inFile.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        std::memcmp(header.identifier, SHADER_CACHE_IDENTIFIER, sizeof(header.identifier)) != 0 ||
+        header.key != key || header.binaryBytes == 0)
+        return 0;
+
+    std::vector<char> binary(header.binaryBytes);
+    if (!inFile.read(binary.data(), static_cast<std::streamsize>(binary.size())))
+        return 0;
+
+    // A driver may still turn down a binary it wrote, e.g. after a settings change
+    const GLuint program = glCreateProgram();
+    glProgramBinary(program, header.binaryFormat, binary.data(), static_cast<GLsizei>(binary.size()));
+    GLint success = 0;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success)
+    {
+        glDeleteProgram(program);
+        return 0;
+    }
+    return program;
+}
+
+bool ShaderCache::save(const std::string& cacheFile, uint64_t key, GLuint program)
+{
+    if (cacheFile.empty() || !isSupported())
+        return false;
+
+    GLint binaryBytes = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &binaryBytes);
+    if (binaryBytes <= 0)
+        return false;
+
+    std::vector<char> binary(binaryBytes);
+    GLenum binaryFormat = 0;
+    GLsizei written = 0;
+    glGetProgramBinary(program, binaryBytes, &written, &binaryFormat, binary.data());
+    if (written <= 0)
+        return false;
+
+    std::error_code error;
+    std::filesystem::create_directories(std::filesystem::path(cacheFile).parent_path(), error);
+    std::ofstream outFile(cacheFile, std::ios::binary | std::ios::trunc);
+    if (!outFile)
+    {
+        std::cout << "ShaderCache: failed to open " << cacheFile << " for writing" << std::endl;
+        return false;
+    }
+
+    ShaderCacheHeader header;
+    std::memcpy(header.identifier, SHADER_CACHE_IDENTIFIER, sizeof(header.identifier));
+    header.key = key;
+    header.binaryFormat = binaryFormat;
+    header.binaryBytes = static_cast<uint32_t>(written);
+    outFile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    outFile.write(binary.data(), written);
+    if (!outFile)
+    {
+        std::cout << "ShaderCache: failed to write " << cacheFile << std::endl;
+        return false;
+    }
+    return true;
+}
@@ -1,13 +1,15 @@
 #include "ShadowMap.h"
 
+#include "GLStateCache.h"
+
 ShadowMap::ShadowMap(int width, int height) : width(width), height(height) {
     //Create FBO
     glGenFramebuffers(1, &fbo);
-    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    GL_STATE.bindFramebuffer(GL_FRAMEBUFFER, fbo);
 
     //Create depth texture
     glGenTextures(1, &depth);
-    glBindTexture(GL_TEXTURE_2D, depth);
+    GL_STATE.bindTexture(0, GL_TEXTURE_2D, depth);
     glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT16, width, height, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
@@ -22,7 +24,7 @@ ShadowMap::ShadowMap(int width, int height) : width(width), height(height) {
     glReadBuffer(GL_NONE);
 
     //Unbind
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    GL_STATE.bindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
 ShadowMap::~ShadowMap() {
@@ -33,25 +35,25 @@ ShadowMap::~ShadowMap() {
 }
 
 void ShadowMap::bind() {
-    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    GL_STATE.bindFramebuffer(GL_FRAMEBUFFER, fbo);
 }
 
 void ShadowMap::bindDraw() {
-    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, fbo);
+    GL_STATE.bindFramebuffer(GL_DRAW_FRAMEBUFFER, fbo);
 }
 
 void ShadowMap::bindRead() {
-    glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo);
+    GL_STATE.bindFramebuffer(GL_READ_FRAMEBUFFER, fbo);
 }
 
 void ShadowMap::unbind() {
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    GL_STATE.bindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
 void ShadowMap::unbindDraw() {
-    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+    GL_STATE.bindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
 }
 
 void ShadowMap::unbindRead() {
-    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+    GL_STATE.bindFramebuffer(GL_READ_FRAMEBUFFER, 0);
 }
\ No newline at end of file
@@ -0,0 +1,584 @@
+/* Start Header -------------------------------------------------------
+Copyright (C) 2021 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the prior written
+consent of DigiPen Institute of Technology is prohibited.
+File Name: TextureCooker.cpp
+Purpose: This file is source for the offline BCn texture cooker.
+Language: c++
+Platform: VS2019 / Window
+Project:  HGraphics
+Author: Elliott Hong <s.hong@digipen.edu>
+Creation date: Oct 19, 2026
+End Header ---------------------------------------------------------*/
+#include "TextureCooker.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#include "CookedTexture.h"
+#include "JobSystem.h"
+#include "MipGenerator.h"
+#include "stb_image.h"
+
+namespace
+{
+    const int BC7_WEIGHTS4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+    // Mean and principal axis of channels [0, n) of a 4x4 block
+    void principalAxis(const unsigned char block[64], int n, float mean[4], float axis[4])
+    {
+        for (int c = 0; c < 4; ++c)
+        {
+            mean[c] = 0.f;
+            axis[c] = 0.f;
+        }
+        for (int i = 0; i < 16; ++i)
+            for (int c = 0; c < n; ++c)
+                mean[c] += block[i * 4 + c];
+        for (int c = 0; c < n; ++c)
+            mean[c] /= 16.f;
+
+        float cov[4][4] = {};
+        for (int i = 0; i < 16; ++i)
+        {
+            float d[4];
+            for (int c = 0; c < n; ++c)
+                d[c] = block[i * 4 + c] - mean[c];
+            for (int a = 0; a < n; ++a)
+                for (int b = 0; b < n; ++b)
+                    cov[a][b] += d[a] * d[b];
+        }
+
+        //Power iteration, seeded with the row of the widest channel
+        int widest = 0;
+        for (int c = 1; c < n; ++c)
+            if (cov[c][c] > cov[widest][widest])
+                widest = c;
+        for (int c = 0; c < n; ++c)
+            axis[c] = cov[widest][c];
+
+        for (int iteration = 0; iteration < 8; ++iteration)
+        {
+            float next[4] = {};
+            float length = 0.f;
+            for (int a = 0; a < n; ++a)
+            {
+                for (int b = 0; b < n; ++b)
+                    next[a] += cov[a][b] * axis[b];
+                length += next[a] * next[a];
+            }
+            if (length < 1e-12f)
+                break;
+            length = 1.f / std::sqrt(length);
+            for (int c = 0; c < n; ++c)
+                axis[c] = next[c] * length;
+        }
+    }
+
+    // Endpoints at the extremes of the block projected onto its axis; e0 is the high end
+    void axisEndpoints(const unsigned char block[64], int n, float e0[4], float e1[4])
+    {
+        float mean[4], axis[4];
+        principalAxis(block, n, mean, axis);
+
+        float tMin = 0.f, tMax = 0.f;
+        for (int i = 0; i < 16; ++i)
+        {
+            float t = 0.f;
+            for (int c = 0; c < n; ++c)
+                t += (block[i * 4 + c] - mean[c]) * axis[c];
+            tMin = std::min(tMin, t);
+            tMax = std::max(tMax, t);
+        }
+        for (int c = 0; c < 4; ++c)
+        {
+            e0[c] = std::min(std::max(mean[c] + axis[c] * tMax, 0.f), 255.f);
+            e1[c] = std::min(std::max(mean[c] + axis[c] * tMin, 0.f), 255.f);
+        }
+    }
+
+    // Least squares endpoints for fixed per-pixel weights of e1 (e0 gets 1 - w)
+    bool solveEndpoints(const unsigned char block[64], int n, const float weights[16], float e0[4], float e1[4])
+    {
+        float aa = 0.f, ab = 0.f, bb = 0.f;
+        float ax[4] = {}, bx[4] = {};
+        for (int i = 0; i < 16; ++i)
+        {
+            const float b = weights[i];
+            const float a = 1.f - b;
+            aa += a * a;
+            ab += a * b;
+            bb += b * b;
+            for (int c = 0; c < n; ++c)
+            {
+                ax[c] += a * block[i * 4 + c];
+                bx[c] += b * block[i * 4 + c];
+            }
+        }
+
+        const float det = aa * bb - ab * ab;
+        if (std::fabs(det) < 1e-6f)
+            return false;
+        for (int c = 0; c < n; ++c)
+        {
+            e0[c] = std::min(std::max((ax[c] * bb - bx[c] * ab) / det, 0.f), 255.f);
+            e1[c] = std::min(std::max((bx[c] * aa - ax[c] * ab) / det, 0.f), 255.f);
+        }
+        return true;
+    }
+
+    uint16_t pack565(const float c[3])
+    {
+        const int r = static_cast<int>(std::lround(c[0] * 31.f / 255.f));
+        const int g = static_cast<int>(std::lround(c[1] * 63.f / 255.f));
+        const int b = static_cast<int>(std::lround(c[2] * 31.f / 255.f));
+        return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+    }
+
+    void unpack565(uint16_t v, int c[3])
+    {
+        const int r = (v >> 11) & 31;
+        const int g = (v >> 5) & 63;
+        const int b = v & 31;
+        c[0] = (r << 3) | (r >> 2);
+        c[1] = (g << 2) | (g >> 4);
+        c[2] = (b << 3) | (b >> 2);
+    }
+
+    // Orders the endpoints for four-color mode and picks the nearest palette entry per pixel
+    int evaluateBC1(const unsigned char block[64], uint16_t& c0, uint16_t& c1, uint32_t& indices)
+    {
+        if (c0 < c1)
+            std::swap(c0, c1);
+
+        int palette[4][3];
+        unpack565(c0, palette[0]);
+        unpack565(c1, palette[1]);
+        for (int c = 0; c < 3; ++c)
+        {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        }
+        //Equal endpoints decode in three-color mode; index 0 is still exact
+        const int paletteSize = c0 == c1 ? 1 : 4;
+
+        int error = 0;
+        indices = 0;
+        for (int i = 0; i < 16; ++i)
+        {
+            int best = 0, bestError = INT32_MAX;
+            for (int p = 0; p < paletteSize; ++p)
+            {
+                int e = 0;
+                for (int c = 0; c < 3; ++c)
+                {
+                    const int d = block[i * 4 + c] - palette[p][c];
+                    e += d * d;
+                }
+                if (e < bestError)
+                {
+                    bestError = e;
+                    best = p;
+                }
+            }
+            indices |= static_cast<uint32_t>(best) << (2 * i);
+            error += bestError;
+        }
+        return error;
+    }
+
+    void quantizeBC7(const float e[4], int q[4], int& pBit)
+    {
+        float bestError = FLT_MAX;
+        for (int p = 0; p < 2; ++p)
+        {
+            int candidate[4];
+            float error = 0.f;
+            for (int c = 0; c < 4; ++c)
+            {
+                candidate[c] = std::min(std::max(static_cast<int>(std::lround((e[c] - p) * 0.5f)), 0), 127);
+                const float d = static_cast<float>((candidate[c] << 1) | p) - e[c];
+                error += d * d;
+            }
+            if (error < bestError)
+            {
+                bestError = error;
+                pBit = p;
+                std::memcpy(q, candidate, sizeof(candidate));
+            }
+        }
+    }
+
+    int evaluateBC7(const unsigned char block[64], const int q0[4], int p0, const int q1[4], int p1, int indices[16])
+    {
+        int palette[16][4];
+        for (int c = 0; c < 4; ++c)
+        {
+            const int a = (q0[c] << 1) | p0;
+            const int b = (q1[c] << 1) | p1;
+            for (int k = 0; k < 16; ++k)
+                palette[k][c] = ((64 - BC7_WEIGHTS4[k]) * a + BC7_WEIGHTS4[k] * b + 32) >> 6;
+        }
+
+        int error = 0;
+        for (int i = 0; i < 16; ++i)
+        {
+            int best = 0, bestError = INT32_MAX;
+            for (int k = 0; k < 16; ++k)
+            {
+                int e = 0;
+                for (int c = 0; c < 4; ++c)
+                {
+                    const int d = block[i * 4 + c] - palette[k][c];
+                    e += d * d;
+                }
+                if (e < bestError)
+                {
+                    bestError = e;
+                    best = k;
+                }
+            }
+            indices[i] = best;
+            error += bestError;
+        }
+        return error;
+    }
+
+    struct BitWriter
+    {
+        unsigned char* out;
+        int position;
+
+        void write(unsigned value, int bits)
+        {
+            for (int b = 0; b < bits; ++b, ++position)
+                if ((value >> b) & 1u)
+                    out[position >> 3] |= static_cast<unsigned char>(1u << (position & 7));
+        }
+    };
+}
+
+void TextureCooker::encodeBC1(const unsigned char block[64], unsigned char out[8])
+{
+    float e0[4], e1[4];
+    axisEndpoints(block, 3, e0, e1);
+
+    uint16_t c0 = pack565(e0), c1 = pack565(e1);
+    uint32_t indices;
+    int error = evaluateBC1(block, c0, c1, indices);
+
+    //One least squares pass over the chosen indices
+    static const float weightOfIndex[4] = { 0.f, 1.f, 1.f / 3.f, 2.f / 3.f };
+    float weights[16];
+    for (int i = 0; i < 16; ++i)
+        weights[i] = weightOfIndex[(indices >> (2 * i)) & 3u];
+    if (error > 0 && solveEndpoints(block, 3, weights, e0, e1))
+    {
+        uint16_t r0 = pack565(e0), r1 = pack565(e1);
+        uint32_t refined;
+        const int refinedError = evaluateBC1(block, r0, r1, refined);
+        if (refinedError < error)
+        {
+            c0 = r0;
+            c1 = r1;
+            indices = refined;
+        }
+    }
+
+    out[0] = static_cast<unsigned char>(c0 & 0xFF);
+    out[1] = static_cast<unsigned char>(c0 >> 8);
+    out[2] = static_cast<unsigned char>(c1 & 0xFF);
+    out[3] = static_cast<unsigned char>(c1 >> 8);
+    for (int b = 0; b < 4; ++b)
+        out[4 + b] = static_cast<unsigned char>(indices >> (8 * b));
+}
+
+void TextureCooker::encodeBC4(const unsigned char block[64], int channel, unsigned char out[8])
+{
+    int lo = 255, hi = 0;
+    for (int i = 0; i < 16; ++i)
+    {
+        lo = std::min(lo, static_cast<int>(block[i * 4 + channel]));
+        hi = std::max(hi, static_cast<int>(block[i * 4 + channel]));
+    }
+
+    std::memset(out, 0, 8);
+    out[0] = static_cast<unsigned char>(hi);
+    out[1] = static_cast<unsigned char>(lo);
+    if (hi == lo)
+        return;
+
+    //hi > lo selects the eight value mode
+    float palette[8];
+    palette[0] = static_cast<float>(hi);
+    palette[1] = static_cast<float>(lo);
+    for (int p = 2; p < 8; ++p)
+        palette[p] = ((8 - p) * hi + (p - 1) * lo) / 7.f;
+
+    uint64_t bits = 0;
+    for (int i = 0; i < 16; ++i)
+    {
+        const float value = block[i * 4 + channel];
+        int best = 0;
+        for (int p = 1; p < 8; ++p)
+            if (std::fabs(palette[p] - value) < std::fabs(palette[best] - value))
+                best = p;
+        bits |= static_cast<uint64_t>(best) << (3 * i);
+    }
+    for (int b = 0; b < 6; ++b)
+        out[2 + b] = static_cast<unsigned char>(bits >> (8 * b));
+}
+
+void TextureCooker::encodeBC3(const unsigned char block[64], unsigned char out[16])
+{
+    encodeBC4(block, 3, out);
+    encodeBC1(block, out + 8);
+}
+
+void TextureCooker::encodeBC5(const unsigned char block[64], unsigned char out[16])
+{
+    encodeBC4(block, 0, out);
+    encodeBC4(block, 1, out + 8);
+}
+
+// Mode 6 only: one subset, RGBA 7.7.7.7 endpoints with a p-bit each and 4-bit indices
+void TextureCooker::encodeBC7(const unsigned char block[64], unsigned char out[16])
+{
+    float e0[4], e1[4];
+    axisEndpoints(block, 4, e1, e0);
+
+    int q0[4], q1[4], p0, p1;
+    quantizeBC7(e0, q0, p0);
+    quantizeBC7(e1, q1, p1);
+    int indices[16];
+    int error = evaluateBC7(block, q0, p0, q1, p1, indices);
+
+    float weights[16];
+    for (int i = 0; i < 16; ++i)
+        weights[i] = BC7_WEIGHTS4[indices[i]] / 64.f;
+    if (error > 0 && solveEndpoints(block, 4, weights, e0, e1))
+    {
+        int r0[4], r1[4], rp0, rp1, refined[16];
+        quantizeBC7(e0, r0, rp0);
+        quantizeBC7(e1, r1, rp1);
+        const int refinedError = evaluateBC7(block, r0, rp0, r1, rp1, refined);
+        if (refinedError < error)
+        {
+            std::memcpy(q0, r0, sizeof(q0));
+            std::memcpy(q1, r1, sizeof(q1));
+            std::memcpy(indices, refined, sizeof(indices));
+            p0 = rp0;
+            p1 = rp1;
+        }
+    }
+
+    //The first index is stored with an implicit zero high bit
+    if (indices[0] & 8)
+    {
+        std::swap(q0, q1);
+        std::swap(p0, p1);
+        for (int i = 0; i < 16; ++i)
+            indices[i] = 15 - indices[i];
+    }
+
+    std::memset(out, 0, 16);
+    BitWriter writer = { out, 0 };
+    writer.write(1u << 6, 7);
+    for (int c = 0; c < 4; ++c)
+    {
+        writer.write(static_cast<unsigned>(q0[c]), 7);
+        writer.write(static_cast<unsigned>(q1[c]), 7);
+    }
+    writer.write(static_cast<unsigned>(p0), 1);
+    writer.write(static_cast<unsigned>(p1), 1);
+    writer.write(static_cast<unsigned>(indices[0]), 3);
+    for (int i = 1; i < 16; ++i)
+        writer.write(static_cast<unsigned>(indices[i]), 4);
+}
+
+void TextureCooker::compressLevel(const unsigned char* rgba, int width, int height, CookFormat format,
+                                  std::vector<unsigned char>& blocks)
+{
+    const int blocksX = (width + 3) / 4;
+    const int blocksY = (height + 3) / 4;
+    const int blockBytes = getBlockBytes(format);
+    blocks.assign(static_cast<size_t>(blocksX) * blocksY * blockBytes, 0);
+
+    //a few block rows per job, the encoders cost about the same for every block
+    JOB_SYSTEM.parallelFor(0, static_cast<size_t>(blocksY), 4, [&](size_t first, size_t last)
+    {
+        unsigned char block[64];
+        for (int by = static_cast<int>(first); by < static_cast<int>(last); ++by)
+        {
+            for (int bx = 0; bx < blocksX; ++bx)
+            {
+                //Partial blocks at the edges repeat the last row/column
+                for (int y = 0; y < 4; ++y)
+                {
+                    const int py = std::min(by * 4 + y, height - 1);
+                    for (int x = 0; x < 4; ++x)
+                    {
+                        const int px = std::min(bx * 4 + x, width - 1);
+                        std::memcpy(block + (y * 4 + x) * 4, rgba + (static_cast<size_t>(py) * width + px) * 4, 4);
+                    }
+                }
+
+                unsigned char* out = blocks.data() + (static_cast<size_t>(by) * blocksX + bx) * blockBytes;
+                switch (format)
+                {
+                case CookFormat::BC3:
+                    encodeBC3(block, out);
+                    break;
+                case CookFormat::BC5:
+                    encodeBC5(block, out);
+                    break;
+                case CookFormat::BC7:
+                    encodeBC7(block, out);
+                    break;
+                default:
+                    encodeBC1(block, out);
+                    break;
+                }
+            }
+        }
+    });
+}
+
+CookFormat TextureCooker::chooseFormat(const unsigned char* rgba, int pixelCount, int channels)
+{
+    if (channels == 4)
+    {
+        for (int i = 0; i < pixelCount; ++i)
+            if (rgba[i * 4 + 3] != 255)
+                return CookFormat::BC3;
+    }
+    return CookFormat::BC1;
+}
+
+GLenum TextureCooker::getGLFormat(CookFormat format)
+{
+    switch (format)
+    {
+    case CookFormat::BC3:
+        return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+    case CookFormat::BC5:
+        return GL_COMPRESSED_RG_RGTC2;
+    case CookFormat::BC7:
+        return GL_COMPRESSED_RGBA_BPTC_UNORM;
+    default:
+        return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+    }
+}
+
+int TextureCooker::getBlockBytes(CookFormat format)
+{
+    return format == CookFormat::BC1 ? 8 : 16;
+}
+
+const char* TextureCooker::getName(CookFormat format)
+{
+    switch (format)
+    {
+    case CookFormat::BC1:
+        return "BC1";
+    case CookFormat::BC3:
+        return "BC3";
+    case CookFormat::BC5:
+        return "BC5";
+    case CookFormat::BC7:
+        return "BC7";
+    default:
+        return "auto";
+    }
+}
+
+bool TextureCooker::cook(const std::string& input, const std::string& output, const CookOptions& options,
+                         Result* result)
+{
+    int width, height, channels;
+    unsigned char* data = stbi_load(input.c_str(), &width, &height, &channels, 4);
+    if (data == nullptr)
+    {
+        std::cout << "Texture failed to load at path: " << input << std::endl;
+        return false;
+    }
+    const std::vector<unsigned char> base(data, data + static_cast<size_t>(width) * height * 4);
+    stbi_image_free(data);
+
+    CookFormat format = options.format;
+    if (format == CookFormat::AUTO)
+        format = options.content == MipContent::NORMAL ? CookFormat::BC5 : chooseFormat(base.data(), width * height, channels);
+
+    std::vector<MipGenerator::Level> mips;
+    if (options.mipmaps)
+        MipGenerator::generate(base.data(), width, height, 4, options.content, options.wrap, mips);
+
+    const int levelCount = 1 + static_cast<int>(mips.size());
+    std::vector<std::vector<unsigned char>> blocks(levelCount);
+    size_t sourceBytes = 0;
+    for (int l = 0; l < levelCount; ++l)
+    {
+        const int levelWidth = l == 0 ? width : mips[l - 1].width;
+        const int levelHeight = l == 0 ? height : mips[l - 1].height;
+        const unsigned char* pixels = l == 0 ? base.data() : mips[l - 1].pixels.data();
+        compressLevel(pixels, levelWidth, levelHeight, format, blocks[l]);
+        sourceBytes += static_cast<size_t>(levelWidth) * levelHeight * channels;
+    }
+
+    CookedTextureHeader header;
+    std::memcpy(header.identifier, COOKED_TEXTURE_IDENTIFIER, sizeof(header.identifier));
+    header.glFormat = getGLFormat(format);
+    header.width = static_cast<uint32_t>(width);
+    header.height = static_cast<uint32_t>(height);
+    header.levelCount = static_cast<uint32_t>(levelCount);
+    header.blockBytes = static_cast<uint32_t>(getBlockBytes(format));
+    header.reserved = 0;
+
+    auto align16 = [](uint64_t offset) { return (offset + 15) & ~static_cast<uint64_t>(15); };
+    std::vector<CookedLevel> levels(levelCount);
+    uint64_t offset = align16(sizeof(CookedTextureHeader) + levelCount * sizeof(CookedLevel));
+    for (int l = 0; l < levelCount; ++l)
+    {
+        levels[l].byteOffset = offset;
+        levels[l].byteLength = blocks[l].size();
+        offset = align16(offset + blocks[l].size());
+    }
+
+    std::ofstream outFile(output, std::ios::binary | std::ios::trunc);
+    if (!outFile)
+    {
+        std::cout << "Failed to open " << output << " for writing" << std::endl;
+        return false;
+    }
+    outFile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    outFile.write(reinterpret_cast<const char*>(levels.data()), levels.size() * sizeof(CookedLevel));
+    static const char padding[16] = {};
+    uint64_t written = sizeof(header) + levels.size() * sizeof(CookedLevel);
+    for (int l = 0; l < levelCount; ++l)
+    {
+        outFile.write(padding, static_cast<std::streamsize>(levels[l].byteOffset - written));
+        outFile.write(reinterpret_cast<const char*>(blocks[l].data()), static_cast<std::streamsize>(blocks[l].size()));
+        written = levels[l].byteOffset + levels[l].byteLength;
+    }
+    if (!outFile)
+    {
+        std::cout << "Failed to write " << output << std::endl;
+        return false;
+    }
+
+    if (result != nullptr)
+    {
+        result->format = format;
+        result->width = width;
+        result->height = height;
+        result->levelCount = levelCount;
+        result->sourceBytes = sourceBytes;
+        result->cookedBytes = static_cast<size_t>(written);
+    }
+    return true;
+}
@@ -0,0 +1,442 @@
+/* Start Header -------------------------------------------------------
+Copyright (C) 2021 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the prior written
+consent of DigiPen Institute of Technology is prohibited.
+File Name: TextureStreamer.cpp
+Purpose: This file is source for the asynchronous texture streaming service.
+Language: c++
+Platform: VS2019 / Window
+Project:  HGraphics
+Author: Elliott Hong <s.hong@digipen.edu>
+Creation date: Oct 19, 2026
+End Header ---------------------------------------------------------*/
+#include "TextureStreamer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+#include "GLStateCache.h"
+#include "stb_image.h"
+
+TextureStreamer::TextureStreamer(size_t frameBudget, unsigned ringFrames, unsigned decodeThreads)
+    : frame_budget_(frameBudget), ring_frames_(std::max(ringFrames, 2u)), pbo_(0), mapped_(nullptr),
+      fences_(ring_frames_, nullptr), ring_index_(0), placeholder_2d_(0), placeholder_cube_(0), quit_(false),
+      stats_{}
+{
+    decodeThreads = std::max(1u, std::min(decodeThreads, std::thread::hardware_concurrency()));
+    for (unsigned i = 0; i < decodeThreads; ++i)
+        workers_.emplace_back(&TextureStreamer::decodeLoop, this);
+}
+
+TextureStreamer::~TextureStreamer()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        quit_ = true;
+    }
+    wake_.notify_all();
+    for (auto& worker : workers_)
+        worker.join();
+
+    for (auto& request : decode_queue_)
+        freeImages(*request);
+    for (auto& request : decoded_)
+        freeImages(*request);
+    for (auto& request : uploading_)
+        freeImages(*request);
+
+    if (pbo_ == 0)
+        return;
+
+    for (GLsync fence : fences_)
+        if (fence)
+            glDeleteSync(fence);
+    for (auto& request : uploading_)
+        glDeleteTextures(1, &request->texture);
+    for (auto& entry : entries_)
+        if (entry.second.resident)
+            glDeleteTextures(1, &entry.second.texture);
+    glDeleteTextures(1, &placeholder_2d_);
+    glDeleteTextures(1, &placeholder_cube_);
+    glDeleteBuffers(1, &pbo_);
+}
+
+void TextureStreamer::createResources()
+{
+    // One buffer split into ring_frames_ segments; a segment is rewritten
+    // only after the fence of the frame that last used it has signaled
+    const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    glGenBuffers(1, &pbo_);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo_);
+    glBufferStorage(GL_PIXEL_UNPACK_BUFFER, frame_budget_ * ring_frames_, nullptr, flags);
+    mapped_ = static_cast<unsigned char*>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, frame_budget_ * ring_frames_, flags));
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    const unsigned char grey[4] = { 128, 128, 128, 255 };
+
+    glGenTextures(1, &placeholder_2d_);
+    glBindTexture(GL_TEXTURE_2D, placeholder_2d_);
+    glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, 1, 1);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, grey);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glGenTextures(1, &placeholder_cube_);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, placeholder_cube_);
+    glTexStorage2D(GL_TEXTURE_CUBE_MAP, 1, GL_RGBA8, 1, 1);
+    for (unsigned i = 0; i < 6; ++i)
+        glTexSubImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, 0, 0, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, grey);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+}
+
+void TextureStreamer::request2D(const std::string& name, const std::string& filepath, GLenum wrap, bool mipmaps,
+                                MipContent content)
+{
+    std::unique_ptr<Request> request = std::make_unique<Request>();
+    request->name = name;
+    request->target = GL_TEXTURE_2D;
+    request->wrap = wrap;
+    request->mipmaps = mipmaps;
+    request->content = content;
+    request->paths.push_back(filepath);
+    enqueue(std::move(request));
+}
+
+void TextureStreamer::requestCubemap(const std::string& name, const std::vector<std::string>& faces)
+{
+    if (faces.size() != 6)
+    {
+        std::cout << "Cubemap " << name << " needs 6 faces, got " << faces.size() << std::endl;
+        return;
+    }
+
+    std::unique_ptr<Request> request = std::make_unique<Request>();
+    request->name = name;
+    request->target = GL_TEXTURE_CUBE_MAP;
+    request->wrap = GL_CLAMP_TO_EDGE;
+    request->mipmaps = false;
+    request->content = MipContent::COLOR_SRGB;
+    request->paths = faces;
+    enqueue(std::move(request));
+}
+
+void TextureStreamer::enqueue(std::unique_ptr<Request> request)
+{
+    if (pbo_ == 0)
+        createResources();
+
+    if (entries_.find(request->name) != entries_.end())
+        return;
+
+    const GLuint placeholder = request->target == GL_TEXTURE_CUBE_MAP ? placeholder_cube_ : placeholder_2d_;
+    entries_[request->name] = Entry{ placeholder, false, TextureInfo{} };
+    ++stats_.pending;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        decode_queue_.push_back(std::move(request));
+    }
+    wake_.notify_one();
+}
+
+void TextureStreamer::decodeLoop()
+{
+    for (;;)
+    {
+        std::unique_ptr<Request> request;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [this]() { return quit_ || !decode_queue_.empty(); });
+            if (quit_)
+                return;
+            request = std::move(decode_queue_.front());
+            decode_queue_.pop_front();
+        }
+
+        for (const std::string& path : request->paths)
+        {
+            Image image;
+            if (CookedTexture::isCookedPath(path))
+            {
+                image.cooked = std::make_unique<CookedTexture>();
+                if (image.cooked->open(path))
+                {
+                    image.width = image.cooked->getWidth();
+                    image.height = image.cooked->getHeight();
+                }
+                else
+                {
+                    image.cooked.reset();
+                }
+            }
+            else
+            {
+                image.pixels = stbi_load(path.c_str(), &image.width, &image.height, &image.channels, 0);
+                //each decode thread already takes one texture, the mips are built on it alone
+                if (image.pixels != nullptr && request->mipmaps)
+                    MipGenerator::generate(image.pixels, image.width, image.height, image.channels, request->content,
+                                           request->wrap == GL_REPEAT, image.mips, 1);
+            }
+            if (!image.isLoaded())
+                request->failed = true;
+            request->images.push_back(std::move(image));
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        decoded_.push_back(std::move(request));
+    }
+}
+
+bool TextureStreamer::beginUpload(Request& request)
+{
+    for (size_t i = 0; i < request.images.size(); ++i)
+    {
+        if (!request.images[i].isLoaded())
+            std::cout << "Texture failed to load at path: " << request.paths[i] << std::endl;
+    }
+
+    const Image& first = request.images.front();
+    const bool compressed = first.cooked != nullptr;
+    for (const Image& image : request.images)
+    {
+        if (request.failed)
+            break;
+        if (image.width != first.width || image.height != first.height || image.channels != first.channels
+            || (image.cooked != nullptr) != compressed
+            || (compressed && (image.cooked->getFormat() != first.cooked->getFormat()
+                               || image.cooked->getLevelCount() != first.cooked->getLevelCount())))
+        {
+            std::cout << "Cubemap " << request.name << " faces differ in size or format" << std::endl;
+            request.failed = true;
+        }
+    }
+    const size_t rowBytes = compressed
+        ? static_cast<size_t>((first.width + 3) / 4) * first.cooked->getBlockBytes()
+        : static_cast<size_t>(first.width) * first.channels;
+    if (!request.failed && rowBytes > frame_budget_)
+    {
+        std::cout << "Texture " << request.name << " rows exceed the streaming budget" << std::endl;
+        request.failed = true;
+    }
+
+    if (request.failed)
+    {
+        freeImages(request);
+        entries_.erase(request.name);
+        --stats_.pending;
+        return false;
+    }
+
+    if (compressed)
+    {
+        request.format = first.cooked->getFormat();
+        request.internalFormat = request.format;
+        request.levels = request.mipmaps ? first.cooked->getLevelCount() : 1;
+    }
+    else
+    {
+        static const GLenum formats[4] = { GL_RED, GL_RG, GL_RGB, GL_RGBA };
+        static const GLenum internalFormats[4] = { GL_R8, GL_RG8, GL_RGB8, GL_RGBA8 };
+        request.format = formats[first.channels - 1];
+        request.internalFormat = internalFormats[first.channels - 1];
+        request.levels = 1 + static_cast<int>(first.mips.size());
+    }
+
+    glGenTextures(1, &request.texture);
+    glBindTexture(request.target, request.texture);
+    glTexStorage2D(request.target, request.levels, request.internalFormat, first.width, first.height);
+    glTexParameteri(request.target, GL_TEXTURE_WRAP_S, request.wrap);
+    glTexParameteri(request.target, GL_TEXTURE_WRAP_T, request.wrap);
+    if (request.target == GL_TEXTURE_CUBE_MAP)
+        glTexParameteri(request.target, GL_TEXTURE_WRAP_R, request.wrap);
+    glTexParameteri(request.target, GL_TEXTURE_MIN_FILTER, request.levels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+    glTexParameteri(request.target, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glBindTexture(request.target, 0);
+
+    return true;
+}
+
+void TextureStreamer::finishUpload(Request& request)
+{
+    Entry& entry = entries_[request.name];
+    entry.texture = request.texture;
+    entry.resident = true;
+    entry.info.texture = request.texture;
+    entry.info.target = request.target;
+    entry.info.internalFormat = request.internalFormat;
+    entry.info.width = request.images.front().width;
+    entry.info.height = request.images.front().height;
+    entry.info.levels = request.levels;
+    --stats_.pending;
+    ++stats_.resident;
+}
+
+void TextureStreamer::update()
+{
+    if (pbo_ == 0)
+        createResources();
+
+    std::vector<std::unique_ptr<Request>> decoded;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        decoded.swap(decoded_);
+    }
+    for (auto& request : decoded)
+    {
+        if (beginUpload(*request))
+            uploading_.push_back(std::move(request));
+    }
+
+    if (uploading_.empty())
+        return;
+
+    // Skip a frame rather than stall while the GPU still reads this segment
+    GLsync& fence = fences_[ring_index_];
+    if (fence)
+    {
+        if (glClientWaitSync(fence, 0, 0) == GL_TIMEOUT_EXPIRED)
+            return;
+        glDeleteSync(fence);
+        fence = nullptr;
+    }
+
+    const size_t segment = ring_index_ * frame_budget_;
+    size_t used = 0;
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo_);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    //Whole rows (block rows when cooked) at a time, so large images spread over several frames
+    auto it = uploading_.begin();
+    while (it != uploading_.end())
+    {
+        Request& request = **it;
+        Image& image = request.images[request.face];
+        const int levelWidth = std::max(image.width >> request.level, 1);
+        const int levelHeight = std::max(image.height >> request.level, 1);
+
+        const unsigned char* source;
+        size_t rowBytes;
+        int rowCount, rowHeight;
+        if (image.cooked)
+        {
+            source = image.cooked->getLevelData(request.level);
+            rowBytes = static_cast<size_t>((levelWidth + 3) / 4) * image.cooked->getBlockBytes();
+            rowCount = (levelHeight + 3) / 4;
+            rowHeight = 4;
+        }
+        else
+        {
+            source = request.level == 0 ? image.pixels : image.mips[request.level - 1].pixels.data();
+            rowBytes = static_cast<size_t>(levelWidth) * image.channels;
+            rowCount = levelHeight;
+            rowHeight = 1;
+        }
+
+        const int rows = std::min(rowCount - request.row, static_cast<int>((frame_budget_ - used) / rowBytes));
+        if (rows == 0)
+            break;
+
+        const size_t bytes = rows * rowBytes;
+        std::memcpy(mapped_ + segment + used, source + request.row * rowBytes, bytes);
+
+        const GLenum target = request.target == GL_TEXTURE_CUBE_MAP ? GL_TEXTURE_CUBE_MAP_POSITIVE_X + request.face : GL_TEXTURE_2D;
+        const int y = request.row * rowHeight;
+        const int height = std::min(rows * rowHeight, levelHeight - y);
+        glBindTexture(request.target, request.texture);
+        if (image.cooked)
+            glCompressedTexSubImage2D(target, request.level, 0, y, levelWidth, height, request.format,
+                                      static_cast<GLsizei>(bytes), reinterpret_cast<void*>(segment + used));
+        else
+            glTexSubImage2D(target, request.level, 0, y, levelWidth, height, request.format, GL_UNSIGNED_BYTE,
+                            reinterpret_cast<void*>(segment + used));
+
+        used += bytes;
+        stats_.uploadedBytes += bytes;
+        request.row += rows;
+
+        if (request.row == rowCount)
+        {
+            request.row = 0;
+            if (++request.level == request.levels)
+            {
+                stbi_image_free(image.pixels);
+                image.pixels = nullptr;
+                std::vector<MipGenerator::Level>().swap(image.mips);
+                image.cooked.reset();
+                request.level = 0;
+                ++request.face;
+            }
+        }
+        if (request.face == request.images.size())
+        {
+            finishUpload(request);
+            it = uploading_.erase(it);
+        }
+    }
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+
+    if (used > 0)
+    {
+        fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        ring_index_ = (ring_index_ + 1) % ring_frames_;
+    }
+}
+
+GLuint TextureStreamer::getTexture(const std::string& name) const
+{
+    const auto it = entries_.find(name);
+    if (it == entries_.end())
+        return 0;
+    return it->second.texture;
+}
+
+bool TextureStreamer::isResident(const std::string& name) const
+{
+    const auto it = entries_.find(name);
+    return it != entries_.end() && it->second.resident;
+}
+
+bool TextureStreamer::getTextureInfo(const std::string& name, TextureInfo& info) const
+{
+    const auto it = entries_.find(name);
+    if (it == entries_.end() || !it->second.resident)
+        return false;
+    info = it->second.info;
+    return true;
+}
+
+void TextureStreamer::release(const std::string& name)
+{
+    const auto it = entries_.find(name);
+    if (it == entries_.end() || !it->second.resident)
+        return;
+
+    GL_STATE.deleteTextures(1, &it->second.texture);
+    it->second = Entry{ 0, false, TextureInfo{} };
+    --stats_.resident;
+}
+
+const TextureStreamer::Stats& TextureStreamer::getStats() const
+{
+    return stats_;
+}
+
+void TextureStreamer::freeImages(Request& request)
+{
+    for (Image& image : request.images)
+    {
+        stbi_image_free(image.pixels);
+        image.pixels = nullptr;
+        image.mips.clear();
+        image.cooked.reset();
+    }
+}
@@ -0,0 +1,172 @@
+/* Start Header -------------------------------------------------------
+Copyright (C) 2021 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the prior written
+consent of DigiPen Institute of Technology is prohibited.
+File Name: VertexQuantizer.cpp
+Purpose: This file quantizes vertex attributes and sets up their decode constants
+Language: c++
+Platform: VS2019 / Window
+Project:  HGraphics
+Author: Elliott Hong <s.hong@digipen.edu>
+Creation date: Oct 19, 2026
+End Header ---------------------------------------------------------*/
+#include "VertexQuantizer.h"
+
+#include "GLStateCache.h"
+
+#include <cfloat>
+
+namespace
+{
+    const float UNORM16_MAX = 65535.f;
+
+    // Nearest step of [0, 65535] for value in [min, min + extent]
+    GLushort quantizeUnorm16(float value, float min, float extent)
+    {
+        if (extent <= 0.f)
+            return 0;
+        const float t = glm::clamp((value - min) / extent, 0.f, 1.f);
+        return static_cast<GLushort>(std::lround(t * UNORM16_MAX));
+    }
+
+    float decodeUnorm16(GLushort q, float min, float extent)
+    {
+        return min + (static_cast<float>(q) / UNORM16_MAX) * extent;
+    }
+}
+
+VertexDecode VertexQuantizer::identityDecode()
+{
+    return VertexDecode{ glm::vec4(0.f), glm::vec4(1.f), glm::vec4(0.f, 0.f, 1.f, 1.f) };
+}
+
+GLuint VertexQuantizer::createDecodeBuffer(const VertexDecode& decode)
+{
+    GLuint buffer = 0;
+    glGenBuffers(1, &buffer);
+    GL_STATE.bindBuffer(GL_ARRAY_BUFFER, buffer);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(VertexDecode), &decode, GL_STATIC_DRAW);
+    return buffer;
+}
+
+void VertexQuantizer::bindDecodeBuffer(GLuint buffer)
+{
+    // Stride 0 hands every vertex the same three vec4s
+    glBindVertexBuffer(DECODE_BINDING, buffer, 0, 0);
+    for (GLuint i = 0; i < 3; ++i)
+    {
+        glEnableVertexAttribArray(DECODE_ATTRIBUTE + i);
+        glVertexAttribFormat(DECODE_ATTRIBUTE + i, 4, GL_FLOAT, GL_FALSE, i * sizeof(glm::vec4));
+        glVertexAttribBinding(DECODE_ATTRIBUTE + i, DECODE_BINDING);
+    }
+}
+
+void VertexQuantizer::quantizePositions(const std::vector<glm::vec3>& positions, const glm::vec3& min,
+                                        const glm::vec3& max, std::vector<glm::u16vec4>& result,
+                                        VertexDecode& decode, float& maxError)
+{
+    const glm::vec3 extent = glm::max(max - min, glm::vec3(0.f));
+    decode.positionOffset = glm::vec4(min, decode.positionOffset.w);
+    decode.positionScale = glm::vec4(extent, 1.f);
+
+    maxError = 0.f;
+    result.resize(positions.size());
+    for (size_t i = 0; i < positions.size(); ++i)
+    {
+        const glm::vec3& p = positions[i];
+        glm::u16vec4 q(0);
+        glm::vec3 decoded;
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            q[axis] = quantizeUnorm16(p[axis], min[axis], extent[axis]);
+            decoded[axis] = decodeUnorm16(q[axis], min[axis], extent[axis]);
+        }
+        result[i] = q;
+        maxError = glm::max(maxError, glm::length(decoded - p));
+    }
+}
+
+void VertexQuantizer::quantizeUVs(const std::vector<glm::vec2>& uvs, std::vector<glm::u16vec2>& result,
+                                  VertexDecode& decode, float& maxError)
+{
+    glm::vec2 min(FLT_MAX);
+    glm::vec2 max(-FLT_MAX);
+    for (const glm::vec2& uv : uvs)
+    {
+        min = glm::min(min, uv);
+        max = glm::max(max, uv);
+    }
+    if (uvs.empty())
+        min = max = glm::vec2(0.f);
+    const glm::vec2 extent = max - min;
+    decode.uv = glm::vec4(min, extent);
+
+    maxError = 0.f;
+    result.resize(uvs.size());
+    for (size_t i = 0; i < uvs.size(); ++i)
+    {
+        const glm::vec2& uv = uvs[i];
+        const glm::u16vec2 q(quantizeUnorm16(uv.x, min.x, extent.x), quantizeUnorm16(uv.y, min.y, extent.y));
+        const glm::vec2 decoded(decodeUnorm16(q.x, min.x, extent.x), decodeUnorm16(q.y, min.y, extent.y));
+        result[i] = q;
+        maxError = glm::max(maxError, glm::length(decoded - uv));
+    }
+}
+
+glm::vec2 VertexQuantizer::octEncode(const glm::vec3& n)
+{
+    const float l1 = std::abs(n.x) + std::abs(n.y) + std::abs(n.z);
+    if (l1 <= 0.f)
+        return glm::vec2(0.f);
+
+    glm::vec2 p = glm::vec2(n.x, n.y) / l1;
+    // The lower half folds over the diagonals onto the corners
+    if (n.z < 0.f)
+    {
+        const glm::vec2 sign(p.x >= 0.f ? 1.f : -1.f, p.y >= 0.f ? 1.f : -1.f);
+        p = (1.f - glm::abs(glm::vec2(p.y, p.x))) * sign;
+    }
+    return p;
+}
+
+glm::vec3 VertexQuantizer::octDecode(const glm::vec2& e)
+{
+    glm::vec3 n(e.x, e.y, 1.f - std::abs(e.x) - std::abs(e.y));
+    const float t = glm::max(-n.z, 0.f);
+    n.x += n.x >= 0.f ? -t : t;
+    n.y += n.y >= 0.f ? -t : t;
+    return glm::normalize(n);
+}
+
+glm::ivec2 VertexQuantizer::quantizeNormal(const glm::vec3& n, int maxValue)
+{
+    const glm::vec2 scaled = glm::clamp(octEncode(n), -1.f, 1.f) * static_cast<float>(maxValue);
+    const glm::ivec2 base(static_cast<int>(std::floor(scaled.x)), static_cast<int>(std::floor(scaled.y)));
+    const float length = glm::length(n);
+    const glm::vec3 unit = length > 0.f ? n / length : glm::vec3(0.f, 0.f, 1.f);
+
+    // Plain rounding can be a step off in angle near the folds, so try every neighbour.
+    // Distances, as the cosines of angles this small all round to 1 in float
+    glm::ivec2 best = glm::clamp(base, -maxValue, maxValue);
+    float bestDistance = FLT_MAX;
+    for (int dy = 0; dy < 2; ++dy)
+    {
+        for (int dx = 0; dx < 2; ++dx)
+        {
+            const glm::ivec2 q = glm::clamp(base + glm::ivec2(dx, dy), -maxValue, maxValue);
+            const glm::vec3 d = octDecode(decodeSnorm(q, maxValue)) - unit;
+            const float distance = glm::dot(d, d);
+            if (distance < bestDistance)
+            {
+                bestDistance = distance;
+                best = q;
+            }
+        }
+    }
+    return best;
+}
+
+glm::vec2 VertexQuantizer::decodeSnorm(const glm::ivec2& q, int maxValue)
+{
+    return glm::max(glm::vec2(q) / static_cast<float>(maxValue), glm::vec2(-1.f));
+}
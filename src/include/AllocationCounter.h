@@ -0,0 +1,50 @@
+/* Start Header -------------------------------------------------------
+Copyright (C) 2021 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the prior written
+consent of DigiPen Institute of Technology is prohibited.
+File Name: AllocationCounter.h
+Purpose: This file is header for the heap allocation counter.
+Language: c++
+Platform: VS2019 / Window
+Project:  HGraphics
+Author: Elliott Hong <s.hong@digipen.edu>
+Creation date: Oct 19, 2026
+End Header ---------------------------------------------------------*/
+#ifndef ALLOCATION_COUNTER_H
+#define ALLOCATION_COUNTER_H
+
+#include <cstdint>
+
+// Counts the heap allocations each thread makes through operator new.
+// Built only with HGRAPHICS_ALLOCATION_COUNTER, which replaces the global
+// operator new and which CMake defines in Debug builds; otherwise the counts
+// stay zero. ImGui and stb allocate with malloc and are not counted.
+// Work that allocates on purpose when something happens, a texture arriving
+// or a mesh seen for the first time, runs inside an AllowScope so a frame
+// where nothing changed can be checked for zero allocations.
+class AllocationCounter
+{
+public:
+    // Allocations inside are not counted on this thread
+    class AllowScope
+    {
+    public:
+        AllowScope();
+        ~AllowScope();
+
+        AllowScope(const AllowScope&) = delete;
+        AllowScope& operator=(const AllowScope&) = delete;
+    };
+
+    static bool isCompiledIn();
+
+    // Counted allocations of the calling thread so far
+    static uint64_t getThreadCount();
+    // Counted allocations of every thread so far
+    static uint64_t getTotalCount();
+
+    // Called by the replaced operator new
+    static void count();
+};
+
+#endif
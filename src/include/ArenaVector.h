@@ -0,0 +1,128 @@
+/* Start Header -------------------------------------------------------
+Copyright (C) 2021 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the prior written
+consent of DigiPen Institute of Technology is prohibited.
+File Name: ArenaVector.h
+Purpose: This file is header for the vector backed by a linear allocator.
+Language: c++
+Platform: VS2019 / Window
+Project:  HGraphics
+Author: Elliott Hong <s.hong@digipen.edu>
+Creation date: Oct 19, 2026
+End Header ---------------------------------------------------------*/
+#ifndef ARENA_VECTOR_H
+#define ARENA_VECTOR_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+
+#include "LinearAllocator.h"
+
+// A vector whose storage comes from a LinearAllocator. Growing copies the
+// elements to a bigger array and leaves the old one to the allocator's next
+// reset, so only trivially copyable types go in here. The vector must be
+// reset to an allocator before use and again once that allocator was reset.
+template <typename T>
+class ArenaVector
+{
+    static_assert(std::is_trivially_copyable<T>::value, "ArenaVector copies its elements with memcpy");
+
+public:
+    ArenaVector() : memory_(nullptr), data_(nullptr), size_(0), capacity_(0)
+    {
+    }
+
+    explicit ArenaVector(LinearAllocator& memory) : memory_(&memory), data_(nullptr), size_(0), capacity_(0)
+    {
+    }
+
+    // Drops the contents, storage comes from memory from now on
+    void reset(LinearAllocator& memory)
+    {
+        memory_ = &memory;
+        data_ = nullptr;
+        size_ = 0;
+        capacity_ = 0;
+    }
+
+    void reserve(size_t capacity)
+    {
+        if (capacity <= capacity_)
+            return;
+        T* data = static_cast<T*>(memory_->allocate(sizeof(T) * capacity, alignof(T)));
+        if (size_ > 0)
+            std::memcpy(static_cast<void*>(data), data_, sizeof(T) * size_);
+        data_ = data;
+        capacity_ = capacity;
+    }
+
+    // New elements are value initialized
+    void resize(size_t size)
+    {
+        reserve(size);
+        for (size_t i = size_; i < size; ++i)
+            data_[i] = T();
+        size_ = size;
+    }
+
+    void assign(size_t count, const T& value)
+    {
+        size_ = 0;
+        reserve(count);
+        std::fill(data_, data_ + count, value);
+        size_ = count;
+    }
+
+    void assign(const T* first, const T* last)
+    {
+        const size_t count = static_cast<size_t>(last - first);
+        size_ = 0;
+        reserve(count);
+        if (count > 0)
+            std::memcpy(static_cast<void*>(data_), first, sizeof(T) * count);
+        size_ = count;
+    }
+
+    void push_back(const T& value)
+    {
+        if (size_ == capacity_)
+            reserve(std::max<size_t>(capacity_ * 2, 16));
+        data_[size_++] = value;
+    }
+
+    void clear()
+    {
+        size_ = 0;
+    }
+
+    void swap(ArenaVector& other)
+    {
+        std::swap(memory_, other.memory_);
+        std::swap(data_, other.data_);
+        std::swap(size_, other.size_);
+        std::swap(capacity_, other.capacity_);
+    }
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    T* data() { return data_; }
+    const T* data() const { return data_; }
+    T* begin() { return data_; }
+    const T* begin() const { return data_; }
+    T* end() { return data_ + size_; }
+    const T* end() const { return data_ + size_; }
+
+    T& operator[](size_t index) { return data_[index]; }
+    const T& operator[](size_t index) const { return data_[index]; }
+
+private:
+    LinearAllocator* memory_;
+    T* data_;
+    size_t size_;
+    size_t capacity_;
+};
+
+#endif
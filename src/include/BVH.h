@@ -0,0 +1,106 @@
+/* Start Header -------------------------------------------------------
+Copyright (C) 2021 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the prior written
+consent of DigiPen Institute of Technology is prohibited.
+File Name: BVH.h
+Purpose: This file is header for the mesh and scene bounding volume hierarchies.
+Language: c++
+Platform: VS2019 / Window
+Project:  HGraphics
+Author: Elliott Hong <s.hong@digipen.edu>
+Creation date: Oct 19, 2026
+End Header ---------------------------------------------------------*/
+#ifndef BVH_H
+#define BVH_H
+
+#include <cfloat>
+#include <vector>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+struct InstanceData;
+
+struct Ray
+{
+    glm::vec3 origin;
+    glm::vec3 direction;
+};
+
+struct RayHit
+{
+    float t = FLT_MAX;
+    float u = 0.f, v = 0.f;
+    GLuint triangle = ~0u;
+    GLuint instance = ~0u;
+
+    bool isHit() const { return triangle != ~0u; }
+};
+
+// 32 bytes, two per cache line. Nodes are stored depth first: an interior
+// node's left child directly follows it and `offset` is its right child;
+// a leaf's primitives are [offset, offset + count)
+struct BVHNode
+{
+    glm::vec3 bounds_min;
+    GLuint offset;
+    glm::vec3 bounds_max;
+    GLuint count;
+
+    bool isLeaf() const { return count != 0; }
+};
+
+// Bottom level: triangles of one mesh in object space. Leaves hold packets of
+// four triangles in SoA form so one SSE test covers a whole packet
+class MeshBVH
+{
+public:
+    void build(const glm::vec3* vertices, const GLuint* indices, unsigned triangleCount);
+    void clear();
+
+    // Closest hit with t < hit.t; hit.triangle is the index into the source index buffer / 3
+    bool intersect(const Ray& ray, RayHit& hit) const;
+
+    bool empty() const;
+    glm::vec3 getBoundsMin() const;
+    glm::vec3 getBoundsMax() const;
+    unsigned getNodeCount() const;
+    float getBuildMs() const;
+
+private:
+    struct TrianglePacket
+    {
+        float v0[3][4];
+        float e1[3][4];
+        float e2[3][4];
+        GLuint id[4];
+    };
+
+    std::vector<BVHNode> nodes_;
+    std::vector<TrianglePacket> packets_;
+    float build_ms_ = 0.f;
+};
+
+// Top level: instances of mesh BVHs. Refit keeps the topology and only
+// recomputes bounds, which is enough while instances move moderately
+class SceneBVH
+{
+public:
+    void build(const std::vector<const MeshBVH*>& meshes, const std::vector<InstanceData>& instances);
+    void refit(const std::vector<InstanceData>& instances);
+
+    bool intersect(const Ray& ray, RayHit& hit) const;
+
+    unsigned getNodeCount() const;
+
+private:
+    void computeInstanceBounds(const std::vector<InstanceData>& instances);
+
+    std::vector<BVHNode> nodes_;
+    std::vector<GLuint> order_;
+    std::vector<const MeshBVH*> mesh_bvhs_;
+    std::vector<GLuint> instance_mesh_;
+    std::vector<glm::mat4> inverse_models_;
+    std::vector<glm::vec3> instance_min_, instance_max_;
+};
+
+#endif
@@ -0,0 +1,75 @@
+/* Start Header -------------------------------------------------------
+Copyright (C) 2021 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the prior written
+consent of DigiPen Institute of Technology is prohibited.
+File Name: CommandBuffer.h
+Purpose: This file is header for the render thread command buffer.
+Language: c++
+Platform: VS2019 / Window
+Project:  HGraphics
+Author: Elliott Hong <s.hong@digipen.edu>
+Creation date: Oct 19, 2026
+End Header ---------------------------------------------------------*/
+#ifndef COMMAND_BUFFER_H
+#define COMMAND_BUFFER_H
+
+#include <type_traits>
+#include <utility>
+
+#include "LinearAllocator.h"
+
+// Work the main thread hands to the render thread, e.g. GL uploads asked for
+// by the UI. Commands are callables stored in the frame's allocator and run
+// in the order they were pushed, before the frame is drawn. Captures are
+// copies; whatever a command points to must outlive the frame.
+class CommandBuffer
+{
+public:
+    explicit CommandBuffer(LinearAllocator& memory);
+    ~CommandBuffer();
+
+    template <typename Function>
+    void push(Function&& fn);
+
+    // Runs every command once and empties the buffer
+    void execute();
+    // Drops the commands without running them
+    void clear();
+
+    unsigned getCount() const;
+
+private:
+    struct Command
+    {
+        void (*invoke)(void* fn);
+        void (*destroy)(void* fn);
+        void* fn;
+        Command* next;
+    };
+
+    LinearAllocator& memory_;
+    Command* head_;
+    Command* tail_;
+    unsigned count_;
+};
+
+template <typename Function>
+void CommandBuffer::push(Function&& fn)
+{
+    using Stored = typename std::decay<Function>::type;
+
+    Command* command = memory_.create<Command>();
+    command->fn = memory_.create<Stored>(std::forward<Function>(fn));
+    command->invoke = [](void* stored) { (*static_cast<Stored*>(stored))(); };
+    command->destroy = [](void* stored) { static_cast<Stored*>(stored)->~Stored(); };
+    command->next = nullptr;
+
+    if (tail_)
+        tail_->next = command;
+    else
+        head_ = command;
+    tail_ = command;
+    ++count_;
+}
+
+#endif
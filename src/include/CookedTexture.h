@@ -0,0 +1,78 @@
+/* Start Header -------------------------------------------------------
+Copyright (C) 2021 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the prior written
+consent of DigiPen Institute of Technology is prohibited.
+File Name: CookedTexture.h
+Purpose: This file is header for the memory-mapped cooked texture container.
+Language: c++
+Platform: VS2019 / Window
+Project:  HGraphics
+Author: Elliott Hong <s.hong@digipen.edu>
+Creation date: Oct 19, 2026
+End Header ---------------------------------------------------------*/
+#ifndef COOKED_TEXTURE_H
+#define COOKED_TEXTURE_H
+
+#include <cstdint>
+#include <string>
+#include <glad/glad.h>
+
+// File layout, modelled on KTX2: header, one CookedLevel per mip, then the
+// block data of each level at a 16-byte aligned offset. Formats are GL enums
+// so a mapped level can be handed to glCompressedTexSubImage2D as is
+struct CookedTextureHeader
+{
+    char identifier[8];
+    uint32_t glFormat;
+    uint32_t width;
+    uint32_t height;
+    uint32_t levelCount;
+    uint32_t blockBytes;
+    uint32_t reserved;
+};
+
+struct CookedLevel
+{
+    uint64_t byteOffset;
+    uint64_t byteLength;
+};
+
+static const char COOKED_TEXTURE_IDENTIFIER[8] = { 'H', 'T', 'E', 'X', ' ', '1', '0', '\n' };
+
+class CookedTexture
+{
+public:
+    CookedTexture();
+    ~CookedTexture();
+    CookedTexture(const CookedTexture&) = delete;
+    CookedTexture& operator=(const CookedTexture&) = delete;
+
+    // Maps the file read-only and validates the header and level index
+    bool open(const std::string& filepath);
+    void close();
+
+    bool isOpen() const;
+    GLenum getFormat() const;
+    int getWidth() const;
+    int getHeight() const;
+    int getLevelCount() const;
+    int getBlockBytes() const;
+    const unsigned char* getLevelData(int level) const;
+    size_t getLevelSize(int level) const;
+
+    // "dir/name.png" -> "dir/name.htex"
+    static std::string cookedPath(const std::string& sourcePath);
+    static bool isCookedPath(const std::string& path);
+
+private:
+    const unsigned char* data_;
+    size_t size_;
+#ifdef _WIN32
+    void* file_;
+    void* mapping_;
+#else
+    int file_;
+#endif
+};
+
+#endif
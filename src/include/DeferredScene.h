@@ -14,7 +14,6 @@ End Header ---------------------------------------------------------*/
 #define DEFERRED_SCENE_H
 
 #define GLM_ENABLE_EXPERIMENTAL
-#include <GBuffer.h>
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
@@ -24,8 +23,14 @@ End Header ---------------------------------------------------------*/
 #include <imgui_impl_glfw.h>
 #include <imgui_impl_opengl3.h>
 
+#include "BVH.h"
 #include "Camera.h"
+#include "DynamicResolution.h"
+#include "GPUCuller.h"
+#include "HiZBuffer.h"
+#include "OcclusionRasterizer.h"
 #include "PointLightShadowMap.h"
+#include "RenderGraph.h"
 #include "scene.h"
 #include "shader.hpp"
 #include "ShadowMap.h"
@@ -54,21 +59,32 @@ public:
 
     void ProcessInput(GLFWwindow* pWwindow, double dt) override;
 
+    void Resize(int width, int height) override;
+
     int lightNum;
 
 private:
     void initMembers();
 
     void initKernel();
+    void rebuildInstances();
+    void updateInstanceTransforms();
+    glm::mat4 gridInstanceModel(int x, int z) const;
+    void rebuildLightVolumes();
     void loadCubemap();
+    void buildRenderGraph();
+    void updateRenderSize();
     void geometryPass();
+    void hiZPass();
     void shadowPass();
+    void lightingPass();
     void plShadowPass(PointLight pl);
-    void stencilPass(PointLight pl);
-    void pointLightPass(PointLight pl);
+    void stencilPass(PointLight pl, int lightIndex);
+    void pointLightPass(PointLight pl, int lightIndex);
     void ssaoPass();
     void blurPass();
     void compositePass();
+    void upscalePass();
     void skyboxPass();
 
 
@@ -76,6 +92,8 @@ private:
     GLuint noiseTex, skyboxTexture;
     std::vector<float> kernel;
     glm::vec2 noiseScale;
+    //drawn area / target size, full screen quads sample only the drawn part of the targets
+    glm::vec2 uvScale;
 
     std::unique_ptr<Shader> mainShader;
     std::unique_ptr<Shader> drawNormalShader;
@@ -133,9 +151,9 @@ private:
     bool bCopyDepth;
 
     std::string currentModelName;
-    unsigned AlbedoTexture_;
     unsigned AmbientTexture_;
-    unsigned NormTexture_;
+    int defaultMaterial_;
+    int silkMaterial_;
 
     float fogMaxDist;
     float fogMinDist;
@@ -150,7 +168,36 @@ private:
 
     std::vector<PointLight> Lights_;
 
-    GBuffer gBuffer;
+    GPUCuller culler_;
+    std::vector<InstanceData> instances_;
+    int instanceGridSize;
+    float instanceSpacing;
+    SceneBVH sceneBVH_;
+
+    //one single-instance "mesh" per light so each volume keeps its own draw command
+    GPUCuller lightCuller_;
+    int lightCullView;
+    bool bHiZCulling;
+
+    OcclusionRasterizer occlusionRasterizer_;
+    bool bSoftwareOcclusion;
+
+    //graph resources of the deferred passes
+    struct GraphTextures
+    {
+        int position, normal, color, depth, light, ssao, sceneColor;
+        int shadowMap, hiZ, backbuffer;
+    };
+
+    //the deferred passes draw renderScale * window size into targets sized for the max scale,
+    //the upscale pass stretches the drawn area to the window
+    float renderScale;
+    //times geometry through composite, the passes that scale
+    DynamicResolution dynamicResolution_;
+
+    RenderGraph renderGraph_;
+    GraphTextures targets_;
+    HiZBuffer hiZ_;
     ShadowMap ShadowMap_;
     PointLightShadowMap PointLightShadowMap_;
     GLuint gPosition, gNormal, gAlbedo, gDepth;
@@ -0,0 +1,103 @@
+/* Start Header -------------------------------------------------------
+Copyright (C) 2021 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the prior written
+consent of DigiPen Institute of Technology is prohibited.
+File Name: DynamicResolution.h
+Purpose: This file is header for the dynamic resolution controller.
+Language: c++
+Platform: VS2019 / Window
+Project:  HGraphics
+Author: Elliott Hong <s.hong@digipen.edu>
+Creation date: Oct 19, 2026
+End Header ---------------------------------------------------------*/
+#ifndef DYNAMIC_RESOLUTION_H
+#define DYNAMIC_RESOLUTION_H
+
+#include <string>
+#include <glad/glad.h>
+
+// Picks the render scale of the scaled passes from their GPU time. Each frame
+// the passes are bracketed by pairs of timestamp queries, one pair per section
+// so unscaled work between them (shadow maps, Hi-Z) is left out, and the
+// sections are summed; the results are read a few
+// frames later, only once the GPU reports them available, so the CPU never
+// waits on the GPU. Pass cost grows with the pixel count, so the scale that
+// meets the target is scale * sqrt(target / time); the controller moves part
+// of the way there, snapped to a step so the render targets are not
+// reallocated for tiny changes. Times within the dead band of the target and
+// the frames right after a change leave the scale alone.
+class DynamicResolution
+{
+public:
+    struct Settings
+    {
+        bool bEnabled;
+        float minScale;
+        float maxScale;
+        float targetMs;
+        // Fraction of the target the smoothed time may stray before the scale changes
+        float deadBand;
+        // How far toward the ideal scale one change goes, 1 jumps all the way
+        float response;
+        // Exponent on target / time; 0.5 for passes bound by pixel count
+        float curve;
+        float step;
+        int cooldownFrames;
+    };
+
+    DynamicResolution();
+    ~DynamicResolution();
+
+    void init();
+
+    // Bracket one section of scaled work, any number per frame; past
+    // MAX_SECTIONS the last section stretches to the latest endTiming
+    void beginTiming();
+    void endTiming();
+    // Submits the sections bracketed since the last call as this frame's time
+    void endFrame();
+
+    // Reads the available timings and returns the scale for the next frame
+    float update();
+
+    float getScale() const;
+    // Moves the scale directly, e.g. when the controller is off
+    void setScale(float scale);
+
+    float getGPUMs() const;
+    float getSmoothedMs() const;
+
+    Settings& getSettings();
+
+    // Settings files hold one "key value" pair per line, so benchmark runs can pin them
+    bool loadSettings(const std::string& path);
+    bool saveSettings(const std::string& path) const;
+
+private:
+    static const int QUERY_COUNT = 4;
+    static const int MAX_SECTIONS = 16;
+
+    struct Timing
+    {
+        GLuint begin[MAX_SECTIONS], end[MAX_SECTIONS];
+        int sectionCount;
+        float scale;
+        bool bPending;
+    };
+
+    void readTimings();
+    float clampScale(float scale) const;
+
+    Settings settings_;
+    Timing timings_[QUERY_COUNT];
+    int next_timing_;
+    bool section_open_;
+
+    float scale_;
+    float gpu_ms_;
+    float smoothed_ms_;
+    bool has_sample_;
+    int cooldown_;
+};
+
+#endif
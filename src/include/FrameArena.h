@@ -0,0 +1,52 @@
+/* Start Header -------------------------------------------------------
+Copyright (C) 2021 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the prior written
+consent of DigiPen Institute of Technology is prohibited.
+File Name: FrameArena.h
+Purpose: This file is header for the per frame arena of the render thread.
+Language: c++
+Platform: VS2019 / Window
+Project:  HGraphics
+Author: Elliott Hong <s.hong@digipen.edu>
+Creation date: Oct 19, 2026
+End Header ---------------------------------------------------------*/
+#ifndef FRAME_ARENA_H
+#define FRAME_ARENA_H
+
+#include <cstddef>
+#include <vector>
+
+#include "LinearAllocator.h"
+
+// Transient memory of the thread that owns the GL context: sort keys,
+// visibility lists, uniform names, anything that dies with the frame.
+// There is one allocator per frame in flight; beginFrame moves to the
+// oldest one and resets it, so last frame's data is still valid while
+// this frame is built. Scene::preRender calls beginFrame.
+class FrameArena
+{
+public:
+    explicit FrameArena(unsigned frameCount = 2, size_t blockSize = 256 * 1024);
+
+    void beginFrame();
+
+    // Allocator of the current frame
+    LinearAllocator& get();
+
+    // printf into the current frame, for uniform names and other strings of one frame
+    const char* format(const char* fmt, ...);
+
+    unsigned getFrameCount() const;
+    // Of the current frame
+    size_t getUsedBytes() const;
+    // Of every frame
+    size_t getReservedBytes() const;
+
+private:
+    std::vector<LinearAllocator> frames_;
+    unsigned current_;
+};
+
+extern FrameArena FRAME_ARENA;
+
+#endif
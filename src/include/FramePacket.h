@@ -0,0 +1,119 @@
+/* Start Header -------------------------------------------------------
+Copyright (C) 2021 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the prior written
+consent of DigiPen Institute of Technology is prohibited.
+File Name: FramePacket.h
+Purpose: This file is header for the frame packet handed to the render thread.
+Language: c++
+Platform: VS2019 / Window
+Project:  HGraphics
+Author: Elliott Hong <s.hong@digipen.edu>
+Creation date: Oct 19, 2026
+End Header ---------------------------------------------------------*/
+#ifndef FRAME_PACKET_H
+#define FRAME_PACKET_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "BVH.h"
+#include "CommandBuffer.h"
+#include "GLInstrumentation.h"
+#include "GLStateCache.h"
+#include "LinearAllocator.h"
+#include "RenderQueue.h"
+
+struct ImDrawData;
+
+struct FrameCamera
+{
+    glm::mat4 view;
+    glm::mat4 projection;
+    glm::vec3 position;
+    float zNear, zFar;
+};
+
+// Ray cast of the last click into the scene, carried by every packet until the next click
+struct FramePick
+{
+    RayHit hit;
+    // Object the ray hit, empty on a miss
+    char name[32];
+    float distance;
+    float queryMs;
+};
+
+struct FrameDrawItem
+{
+    RenderQueue::Pass pass;
+    Shader* shader;
+    int material;
+    const Mesh* mesh;
+    glm::mat4 model;
+    glm::vec4 color;
+};
+
+// Everything the render thread needs to draw one frame, built by the main
+// thread. The packet owns its memory: draw items, the scene's own frame
+// data, the commands and the copy of the ImGui draw lists all live in the
+// packet's allocator and go away in reset.
+struct FramePacket
+{
+    // Counters the UI shows, copied once the frame is done so the main thread
+    // reads them when it gets the packet back instead of while they change
+    struct Stats
+    {
+        GLStateCache::Counters state;
+        GLInstrumentation::FrameStats calls;
+        std::vector<GLInstrumentation::EntryStats> entries;
+        std::string lastCapture;
+        bool bCapturePending;
+        bool bJsonLogging;
+
+        // CPU time of the render thread for the frame, swap not included
+        float renderMs;
+        // Time the main thread waited for this packet to come back
+        float waitMs;
+        // Heap allocations of the frame, see AllocationCounter; commands and
+        // texture streaming are not counted on the render thread
+        unsigned renderAllocations;
+        unsigned buildAllocations;
+
+        // Copies the current counters of GL_STATE and GL_INSTRUMENTATION
+        void read();
+    };
+
+    FramePacket();
+
+    // Drops last frame's contents and commands that never ran
+    void reset();
+
+    // Copies the lists of ImGui::Render, the next NewFrame reuses ImGui's own buffers
+    void copyDrawData(const ImDrawData* drawData);
+
+    // Slot of the packet; per packet state of a scene is indexed by it
+    unsigned index;
+    uint64_t frame;
+    int width, height;
+    double time;
+    double deltaTime;
+
+    LinearAllocator memory;
+    CommandBuffer commands;
+
+    FrameCamera camera;
+    FramePick pick;
+    FrameDrawItem* draws;
+    unsigned drawCount;
+
+    // Frame data of the scene that built the packet, allocated from memory
+    void* sceneData;
+
+    ImDrawData* ui;
+
+    Stats stats;
+};
+
+#endif
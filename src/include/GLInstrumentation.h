@@ -0,0 +1,107 @@
+/* Start Header -------------------------------------------------------
+Copyright (C) 2021 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the prior written
+consent of DigiPen Institute of Technology is prohibited.
+File Name: GLInstrumentation.h
+Purpose: This file is header for the GL call counting and frame capture layer.
+Language: c++
+Platform: VS2019 / Window
+Project:  HGraphics
+Author: Elliott Hong <s.hong@digipen.edu>
+Creation date: Oct 19, 2026
+End Header ---------------------------------------------------------*/
+#ifndef GL_INSTRUMENTATION_H
+#define GL_INSTRUMENTATION_H
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <glad/glad.h>
+
+// Replaces the glad function pointers of the entry points the renderer uses
+// with wrappers that count every call, add up the triangles of each draw
+// from its index count and the bytes handed to buffer and texture uploads.
+// One frame's command stream can be written to a text file, and every
+// frame's counters can be appended to a JSON lines file.
+// Built only with HGRAPHICS_GL_INSTRUMENTATION, otherwise install does
+// nothing and the counters stay zero. main installs it only for
+// --gl-instrumentation.
+class GLInstrumentation
+{
+public:
+    struct FrameStats
+    {
+        unsigned frame;
+        unsigned calls;
+        unsigned draws;
+        // Multi draw and indirect draws count once each, their triangles are on the GPU
+        unsigned indirectDraws;
+        unsigned dispatches;
+        uint64_t triangles;
+        uint64_t bufferBytes;
+        uint64_t textureBytes;
+    };
+
+    struct EntryStats
+    {
+        const char* name;
+        unsigned calls;
+    };
+
+    GLInstrumentation();
+    ~GLInstrumentation();
+
+    static bool isCompiledIn();
+
+    // Call once after glad has loaded the entry points
+    void install();
+    bool isInstalled() const;
+
+    // Call once per frame before swapping buffers
+    void endFrame();
+
+    // Counters of the last complete frame; entries with calls, most called first
+    const FrameStats& getFrameStats() const;
+    const std::vector<EntryStats>& getEntryStats() const;
+
+    // Writes every call of the next frame with its arguments, one per line
+    void captureNextFrame(const std::string& path);
+    bool isCapturePending() const;
+    const std::string& getLastCapture() const;
+
+    // Appends one JSON object per frame; an empty path closes the log
+    void setJsonLog(const std::string& path);
+    bool isJsonLogging() const;
+
+    // Used by the wrappers
+    void onCall(int entry);
+    bool isCapturing() const;
+    std::ofstream& getCaptureStream();
+    void addDraw(GLenum mode, GLsizei count, GLsizei instances);
+    void addIndirectDraw(GLsizei drawCount);
+    void addDispatch();
+    void addBufferBytes(GLsizeiptr bytes);
+    void addTextureBytes(GLsizeiptr bytes);
+    void setUnpackBuffer(GLuint buffer);
+    bool hasUnpackBuffer() const;
+
+private:
+    void writeJson();
+
+    bool installed_;
+    std::vector<unsigned> calls_;
+    FrameStats frame_;
+    FrameStats last_frame_;
+    std::vector<EntryStats> last_entries_;
+    GLuint unpack_buffer_;
+
+    std::string capture_path_;
+    std::string last_capture_;
+    std::ofstream capture_;
+    std::ofstream json_;
+};
+
+extern GLInstrumentation GL_INSTRUMENTATION;
+
+#endif
@@ -0,0 +1,140 @@
+/* Start Header -------------------------------------------------------
+Copyright (C) 2021 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the prior written
+consent of DigiPen Institute of Technology is prohibited.
+File Name: GLStateCache.h
+Purpose: This file is header for the OpenGL state cache.
+Language: c++
+Platform: VS2019 / Window
+Project:  HGraphics
+Author: Elliott Hong <s.hong@digipen.edu>
+Creation date: Oct 19, 2026
+End Header ---------------------------------------------------------*/
+#ifndef GL_STATE_CACHE_H
+#define GL_STATE_CACHE_H
+
+#include <glad/glad.h>
+
+// Shadows the bind points and fixed function toggles the renderer uses and
+// drops calls that would not change anything.
+// The cache forgets everything in beginFrame, so code that runs between
+// frames (texture streaming, ImGui, the resize callback) may call GL
+// directly. Inside a frame every change of tracked state has to go through
+// here, or be followed by invalidate().
+class GLStateCache
+{
+public:
+    static const int MAX_TEXTURE_UNITS = 16;
+    static const int MAX_BUFFER_INDICES = 16;
+
+    struct Counters
+    {
+        unsigned issued;
+        unsigned elided;
+    };
+
+    GLStateCache();
+
+    // Rolls the counters over and forgets the tracked state
+    void beginFrame();
+    void invalidate();
+
+    void useProgram(GLuint program);
+    // The element buffer is VAO state, so it is forgotten on every VAO change
+    void bindVertexArray(GLuint vao);
+    void bindBuffer(GLenum target, GLuint buffer);
+    // Binds the generic binding point as well, like glBindBufferBase does
+    void bindBufferBase(GLenum target, GLuint index, GLuint buffer);
+    void bindTexture(GLuint unit, GLenum target, GLuint texture);
+    // GL_FRAMEBUFFER sets the draw and the read binding
+    void bindFramebuffer(GLenum target, GLuint framebuffer);
+
+    void enable(GLenum cap);
+    void disable(GLenum cap);
+    void setEnabled(GLenum cap, bool bEnabled);
+    void depthMask(GLboolean bWrite);
+    void depthFunc(GLenum func);
+    void blendFunc(GLenum src, GLenum dst);
+    void blendEquation(GLenum mode);
+    void cullFace(GLenum mode);
+    void stencilFunc(GLenum func, GLint ref, GLuint mask);
+    void viewport(GLint x, GLint y, GLsizei width, GLsizei height);
+
+    // Deleting a bound object resets its binding to 0
+    void deleteBuffers(GLsizei count, const GLuint* buffers);
+    void deleteTextures(GLsizei count, const GLuint* textures);
+    void deleteFramebuffers(GLsizei count, const GLuint* framebuffers);
+    void deleteVertexArrays(GLsizei count, const GLuint* vaos);
+
+    // Counters of the last complete frame
+    const Counters& getFrameCounters() const;
+
+private:
+    enum BufferTarget
+    {
+        ARRAY_BUFFER = 0,
+        ELEMENT_ARRAY_BUFFER,
+        DRAW_INDIRECT_BUFFER,
+        SHADER_STORAGE_BUFFER,
+        UNIFORM_BUFFER,
+        COPY_READ_BUFFER,
+        COPY_WRITE_BUFFER,
+        PIXEL_UNPACK_BUFFER,
+        BUFFER_TARGET_COUNT
+    };
+
+    enum TextureTarget
+    {
+        TEXTURE_2D = 0,
+        TEXTURE_2D_ARRAY,
+        TEXTURE_CUBE_MAP,
+        TEXTURE_TARGET_COUNT
+    };
+
+    enum Capability
+    {
+        DEPTH_TEST = 0,
+        STENCIL_TEST,
+        BLEND,
+        CULL_FACE,
+        SCISSOR_TEST,
+        CAPABILITY_COUNT
+    };
+
+    static int getBufferTarget(GLenum target);
+    static int getTextureTarget(GLenum target);
+    static int getCapability(GLenum cap);
+
+    // Counts the call and returns true when it has to reach the driver
+    bool check(bool bChanged);
+    void activeTexture(GLuint unit);
+
+    GLuint program_;
+    GLuint vao_;
+    GLuint buffers_[BUFFER_TARGET_COUNT];
+    GLuint storage_bindings_[MAX_BUFFER_INDICES];
+    GLuint uniform_bindings_[MAX_BUFFER_INDICES];
+    GLuint active_unit_;
+    GLuint textures_[MAX_TEXTURE_UNITS][TEXTURE_TARGET_COUNT];
+    GLuint draw_framebuffer_;
+    GLuint read_framebuffer_;
+
+    // -1 unknown, otherwise 0 or 1
+    int capabilities_[CAPABILITY_COUNT];
+    int depth_mask_;
+    GLenum depth_func_;
+    GLenum blend_src_, blend_dst_;
+    GLenum blend_equation_;
+    GLenum cull_face_;
+    GLenum stencil_func_;
+    GLint stencil_ref_;
+    GLuint stencil_mask_;
+    GLint viewport_[4];
+
+    Counters frame_;
+    Counters last_frame_;
+};
+
+extern GLStateCache GL_STATE;
+
+#endif
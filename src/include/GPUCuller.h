@@ -0,0 +1,171 @@
+/* Start Header -------------------------------------------------------
+Copyright (C) 2021 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the prior written
+consent of DigiPen Institute of Technology is prohibited.
+File Name: GPUCuller.h
+Purpose: This file is header for GPU-driven instance culling.
+Language: c++
+Platform: VS2019 / Window
+Project:  HGraphics
+Author: Elliott Hong <s.hong@digipen.edu>
+Creation date: Oct 19, 2026
+End Header ---------------------------------------------------------*/
+#ifndef GPU_CULLER_H
+#define GPU_CULLER_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "ArenaVector.h"
+#include "HiZBuffer.h"
+#include "mesh.h"
+#include "shader.hpp"
+
+class OcclusionRasterizer;
+
+// Layout matches the GL indirect draw record (20 bytes, tightly packed)
+struct DrawElementsIndirectCommand
+{
+    GLuint count;
+    GLuint instanceCount;
+    GLuint firstIndex;
+    GLint baseVertex;
+    GLuint baseInstance;
+};
+
+// std430 layout shared with cull.comp and the instanced vertex shaders
+struct InstanceData
+{
+    glm::mat4 model;
+    glm::vec4 bounds_min;
+    glm::vec4 bounds_max;
+    GLuint mesh_index;
+    GLuint pad[3];
+};
+
+// Culls instances against one or more views and writes indirect draw commands.
+// Every registered mesh owns one command per view; its instance IDs are compacted
+// into [baseInstance, baseInstance + instanceCount) of the instance-ID buffer,
+// which the mesh VAOs read through attribute 4 with a divisor of 1.
+// With cluster culling, meshes that have meshlets are culled a second time per
+// meshlet of every visible instance, against the frustum and, unless turned
+// off, the normal cone. Each (instance, meshlet) pair owns one more command
+// per view and one ID slot after the instance IDs; a mesh drawn at LOD 0 then
+// draws its surviving meshlets with a single multi-draw instead of its
+// instance command. The cone test drops meshlets that face away, only right
+// for closed meshes drawn with a depth test, so it runs only for views that
+// are drawn with back faces culled.
+class GPUCuller
+{
+public:
+    enum class Mode { GPU = 0, CPU };
+
+    GPUCuller();
+    ~GPUCuller();
+
+    void init();
+
+    // Rebuild mesh list and instance buffer; call when the instance set changes
+    void setInstances(const std::vector<Mesh*>& meshes, const std::vector<InstanceData>& instances);
+    // Update model matrices without changing the instance set
+    void updateTransforms(const std::vector<InstanceData>& instances);
+
+    // Reset per-frame views; must be called before the first cullView of a frame
+    void beginFrame();
+    // Cull all instances against viewProj and return the view index to draw with.
+    // A valid occluder adds a Hi-Z test against its frame; GPU mode only.
+    // A rasterizer rendered for this viewProj adds a same-frame test; CPU mode only.
+    // With lod every mesh draws the LOD its nearest instance needs in this view.
+    // bBackFaceCulled: the view is drawn with GL_CULL_FACE on GL_BACK, needed for the cone test
+    int cullView(const glm::mat4& viewProj, const HiZBuffer* occluder = nullptr,
+                 const OcclusionRasterizer* rasterizer = nullptr, const LODView* lod = nullptr,
+                 bool bBackFaceCulled = false);
+    // Issue one indirect draw per mesh for the culled view, a multi-draw of its meshlets with cluster culling
+    void drawView(int view) const;
+    // Issue the indirect draw of a single mesh for the culled view
+    void drawMesh(int view, int mesh) const;
+
+    // Bind instance SSBO so instanced vertex shaders can fetch model matrices
+    void bindInstances() const;
+
+    void setMode(Mode mode);
+    Mode getMode() const;
+
+    // Off by default; takes effect from the next cullView
+    void setClusterCulling(bool bEnabled, bool bConeCulling = true);
+    bool isClusterCulling() const;
+    bool isConeCulling() const;
+    unsigned getClusterCount() const;
+    // Meshlets tested and drawn in the last frame, over all views; CPU mode only
+    unsigned getLastClusterTestedCount() const;
+    unsigned getLastClusterVisibleCount() const;
+
+    unsigned getInstanceCount() const;
+    // Only valid in CPU mode; GPU mode never reads results back
+    unsigned getLastVisibleCount() const;
+
+    static void extractFrustumPlanes(const glm::mat4& viewProj, glm::vec4 planes[6]);
+    static bool isAABBVisible(const glm::vec4 planes[6], const glm::vec3& center, const glm::vec3& extent);
+    // eye is homogeneous, a position with w 1 or with w 0 the direction an orthographic view looks back along
+    static bool isMeshletVisible(const glm::vec4 planes[6], const glm::vec4& eye, const glm::mat4& model,
+                                 const Meshlet& meshlet, bool bConeCulling);
+
+private:
+    void ensureViewCapacity(int viewCount);
+    // Instance IDs of every view, then one ID per cluster
+    size_t getIdsPerView() const;
+    void cullViewGPU(int view, const glm::vec4 planes[6], const glm::vec4& eye, const HiZBuffer* occluder,
+                     const LODView* lod, bool bCones);
+    void cullViewCPU(int view, const glm::vec4 planes[6], const glm::vec4& eye, const OcclusionRasterizer* rasterizer,
+                     const LODView* lod, bool bCones);
+    // Points the view's commands at the index range of the LOD each mesh needs
+    // and decides which meshes draw their meshlets in the view
+    void applyLOD(int view, DrawElementsIndirectCommand* commands, const LODView* lod);
+
+    std::unique_ptr<Shader> cluster_shader_;
+
+    std::unique_ptr<Shader> cull_shader_;
+
+    GLuint instance_buffer_;
+    GLuint command_buffer_;
+    GLuint command_template_buffer_;
+    GLuint instance_id_buffer_;
+    GLuint visibility_buffer_;
+    GLuint meshlet_buffer_;
+    GLuint cluster_buffer_;
+    GLuint cluster_command_buffer_;
+
+    std::vector<Mesh*> meshes_;
+    std::vector<InstanceData> instances_;
+    std::vector<GLuint> mesh_instance_offset_;
+    std::vector<DrawElementsIndirectCommand> command_template_;
+
+    // Meshlets of all meshes back to back, the (instance, meshlet) pairs grouped by mesh
+    std::vector<Meshlet> meshlets_;
+    std::vector<glm::uvec2> clusters_;
+    std::vector<GLuint> mesh_cluster_offset_;
+    std::vector<GLuint> mesh_cluster_count_;
+    // Per view and mesh: -1 draws the instance command, otherwise that many meshlet commands
+    std::vector<int> view_cluster_draws_;
+
+    // CPU fallback staging, taken from FRAME_ARENA for every view
+    ArenaVector<DrawElementsIndirectCommand> cpu_commands_;
+    ArenaVector<GLuint> cpu_instance_ids_;
+    ArenaVector<uint8_t> cpu_visible_;
+    ArenaVector<DrawElementsIndirectCommand> cpu_cluster_commands_;
+    ArenaVector<uint8_t> cpu_cluster_visible_;
+
+    int view_count_;
+    int view_capacity_;
+    unsigned last_visible_count_;
+    unsigned last_cluster_tested_count_;
+    unsigned last_cluster_visible_count_;
+    Mode mode_;
+    bool b_cluster_culling_;
+    bool b_cone_culling_;
+};
+
+#endif
@@ -0,0 +1,49 @@
+#pragma once
+#ifndef HIZ_BUFFER_H
+#define HIZ_BUFFER_H
+
+#include <memory>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "shader.hpp"
+
+// Max-depth mip pyramid built from a frame's depth buffer. The view-projection of
+// that frame is kept so bounds of the next frame can be reprojected into it.
+class HiZBuffer
+{
+public:
+    GLuint texture;
+
+    HiZBuffer(int widthIn, int heightIn);
+    ~HiZBuffer();
+
+    void build(GLuint depthTexture, const glm::mat4& viewProj);
+    void invalidate();
+    // Storage for the largest depth buffer; returns whether the texture was recreated
+    bool resize(int width, int height);
+    // Level 0 has to match the drawn area of the depth buffer texel for texel; the
+    // pyramid covers the lower left width x height of the storage
+    void setActiveSize(int width, int height);
+
+    bool isValid() const;
+    const glm::mat4& getViewProj() const;
+    int getWidth() const;
+    int getHeight() const;
+    int getLevelCount() const;
+
+private:
+    void createTexture();
+
+    std::unique_ptr<Shader> copyShader;
+    std::unique_ptr<Shader> reduceShader;
+
+    glm::mat4 viewProj;
+    int width, height;
+    int levelCount;
+    int activeWidth, activeHeight;
+    int activeLevelCount;
+    bool valid;
+};
+
+#endif
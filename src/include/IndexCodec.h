@@ -0,0 +1,46 @@
+/* Start Header -------------------------------------------------------
+Copyright (C) 2021 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the prior written
+consent of DigiPen Institute of Technology is prohibited.
+File Name: IndexCodec.h
+Purpose: This file is header for the lossless index buffer compression of the mesh cache.
+Language: c++
+Platform: VS2019 / Window
+Project:  HGraphics
+Author: Elliott Hong <s.hong@digipen.edu>
+Creation date: Oct 19, 2026
+End Header ---------------------------------------------------------*/
+#ifndef INDEX_CODEC_H
+#define INDEX_CODEC_H
+
+#include <cstddef>
+#include <vector>
+#include <glad/glad.h>
+
+#include "MeshOptimizer.h"
+
+// Lossless triangle list compression in two stages:
+//  1. the indices become small numbers: zigzag deltas to the next vertex not
+//     seen yet, or with meshlets, each meshlet's vertex list as deltas and its
+//     triangles as 8-bit indices into that list
+//  2. the resulting varint bytes are Huffman coded
+// Works best on the order MeshOptimizer leaves, where most indices are a new
+// vertex or one used a few triangles ago.
+class IndexCodec
+{
+public:
+    static void encodeIndices(const GLuint* indices, size_t indexCount, std::vector<unsigned char>& out);
+    static bool decodeIndices(const unsigned char* data, size_t size, GLuint* indices, size_t indexCount);
+
+    // meshlets must cover the indices back to back, as Mesh::buildMeshlets leaves them
+    static void encodeMeshlets(const GLuint* indices, const std::vector<Meshlet>& meshlets,
+                               std::vector<unsigned char>& out);
+    static bool decodeMeshlets(const unsigned char* data, size_t size, const std::vector<Meshlet>& meshlets,
+                               GLuint* indices, size_t indexCount);
+
+    // Order-0 canonical Huffman coding of a byte stream
+    static void entropyEncode(const std::vector<unsigned char>& in, std::vector<unsigned char>& out);
+    static bool entropyDecode(const unsigned char* data, size_t size, std::vector<unsigned char>& out);
+};
+
+#endif
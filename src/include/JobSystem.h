@@ -0,0 +1,154 @@
+/* Start Header -------------------------------------------------------
+Copyright (C) 2021 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the prior written
+consent of DigiPen Institute of Technology is prohibited.
+File Name: JobSystem.h
+Purpose: This file is header for the work-stealing job system.
+Language: c++
+Platform: VS2019 / Window
+Project:  HGraphics
+Author: Elliott Hong <s.hong@digipen.edu>
+Creation date: Oct 19, 2026
+End Header ---------------------------------------------------------*/
+#ifndef JOB_SYSTEM_H
+#define JOB_SYSTEM_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// A fixed set of worker threads, each with its own deque of jobs. A thread
+// pushes and pops its own jobs at the back, so the most recent (cache warm)
+// work runs first, and idle threads steal the oldest jobs from the front of
+// the others. Threads that aren't workers, the main thread included, share
+// queue 0.
+// Jobs never block on each other: a job counts down its counter when done and
+// wait runs other jobs until the counter reaches zero, so waiting inside a job
+// is fine. Jobs must not touch GL, the context belongs to the render thread
+// (or the main thread when there is none).
+// Queuing a job never touches the heap: jobs are stored in place and every
+// queue is a ring sized once by init, so per frame work adds no allocations.
+class JobSystem
+{
+public:
+    struct Counter
+    {
+        std::atomic<int> pending;
+
+        Counter() : pending(0) {}
+    };
+
+    // Bytes a job's captures may take, enough for a handful of references and indices
+    static const size_t JOB_STORAGE_SIZE = 64;
+
+    // A callable copied into the job itself. Capture large state by reference
+    class Job
+    {
+    public:
+        Job() : invoke_(nullptr) {}
+
+        template <typename Function>
+        Job(const Function& fn)
+        {
+            static_assert(sizeof(Function) <= JOB_STORAGE_SIZE, "JobSystem: the job captures too much, capture it by reference");
+            static_assert(alignof(Function) <= alignof(std::max_align_t), "JobSystem: the job is over-aligned");
+            static_assert(std::is_trivially_copyable<Function>::value, "JobSystem: jobs are copied as bytes");
+            new (storage_) Function(fn);
+            invoke_ = [](const void* storage) { (*static_cast<const Function*>(storage))(); };
+        }
+
+        void operator()() const { invoke_(storage_); }
+
+    private:
+        alignas(std::max_align_t) unsigned char storage_[JOB_STORAGE_SIZE];
+        void (*invoke_)(const void*);
+    };
+
+    JobSystem();
+    ~JobSystem();
+
+    // Starts threadCount - 1 workers, the thread that waits makes up the last one.
+    // 0 uses every hardware thread
+    void init(unsigned threadCount = 0);
+    void shutdown();
+    unsigned getThreadCount() const;
+
+    // The counter, if any, is incremented now and decremented once the job ran.
+    // A full queue runs the job right here instead of growing
+    void run(const Job& job, Counter* counter = nullptr);
+    // Runs queued jobs until the counter reaches zero
+    void wait(Counter& counter);
+
+    // Calls fn(first, last) over [begin, end) in chunks of at most grain indices.
+    // Ranges are split in halves so thieves take large pieces; returns when all chunks ran
+    template <typename Function>
+    void parallelFor(size_t begin, size_t end, size_t grain, const Function& fn);
+
+private:
+    struct Task
+    {
+        Job job;
+        Counter* counter;
+    };
+
+    // Ring of tasks, [head, tail) are queued; both only count up and wrap through the mask
+    struct Queue
+    {
+        std::mutex mutex;
+        std::vector<Task> tasks;
+        size_t head = 0;
+        size_t tail = 0;
+    };
+
+    template <typename Function>
+    void splitFor(size_t begin, size_t end, size_t grain, const Function& fn, Counter& counter);
+
+    // Runs one job from the own queue or a stolen one; false when every queue is empty
+    bool runOne(unsigned self);
+    void workerLoop(unsigned index);
+    unsigned getQueueIndex() const;
+
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::vector<std::thread> workers_;
+
+    std::atomic<int> queued_;
+    std::atomic<int> sleeping_;
+    std::atomic<bool> stop_;
+    std::mutex sleep_mutex_;
+    std::condition_variable wake_;
+};
+
+template <typename Function>
+void JobSystem::parallelFor(size_t begin, size_t end, size_t grain, const Function& fn)
+{
+    if (begin >= end)
+        return;
+
+    Counter counter;
+    splitFor(begin, end, std::max<size_t>(grain, 1), fn, counter);
+    wait(counter);
+}
+
+template <typename Function>
+void JobSystem::splitFor(size_t begin, size_t end, size_t grain, const Function& fn, Counter& counter)
+{
+    // Hand the upper half to whoever steals it, keep splitting the lower half here
+    while (end - begin > grain)
+    {
+        const size_t mid = begin + (end - begin) / 2;
+        run([this, mid, end, grain, &fn, &counter]() { splitFor(mid, end, grain, fn, counter); }, &counter);
+        end = mid;
+    }
+    fn(begin, end);
+}
+
+extern JobSystem JOB_SYSTEM;
+
+#endif
@@ -30,6 +30,7 @@ private:
     GLuint vao_;
     GLuint vbo_pos_;
     GLuint ebo_;
+    GLuint decode_buffer_;
     GLuint vertex_count_;
 
     std::vector<glm::vec3> vertex_buffer_;
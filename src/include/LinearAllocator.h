@@ -0,0 +1,85 @@
+/* Start Header -------------------------------------------------------
+Copyright (C) 2021 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the prior written
+consent of DigiPen Institute of Technology is prohibited.
+File Name: LinearAllocator.h
+Purpose: This file is header for the linear allocator of per frame data.
+Language: c++
+Platform: VS2019 / Window
+Project:  HGraphics
+Author: Elliott Hong <s.hong@digipen.edu>
+Creation date: Oct 19, 2026
+End Header ---------------------------------------------------------*/
+#ifndef LINEAR_ALLOCATOR_H
+#define LINEAR_ALLOCATOR_H
+
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+// Hands out memory by bumping an offset and frees everything at once in
+// reset. Blocks are kept across resets, so once the biggest frame has been
+// seen allocating is an add and a compare. Destructors never run; objects
+// put in here must not own memory of their own.
+class LinearAllocator
+{
+public:
+    explicit LinearAllocator(size_t blockSize = 256 * 1024);
+
+    void* allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+    template <typename T, typename... Args>
+    T* create(Args&&... args);
+    // Default constructed elements
+    template <typename T>
+    T* createArray(size_t count);
+    template <typename T>
+    T* copyArray(const T* data, size_t count);
+
+    void reset();
+
+    size_t getUsedBytes() const;
+    size_t getReservedBytes() const;
+
+private:
+    struct Block
+    {
+        std::unique_ptr<char[]> memory;
+        size_t size;
+    };
+
+    std::vector<Block> blocks_;
+    size_t block_size_;
+    size_t block_;
+    size_t offset_;
+    size_t used_;
+};
+
+template <typename T, typename... Args>
+T* LinearAllocator::create(Args&&... args)
+{
+    return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+}
+
+template <typename T>
+T* LinearAllocator::createArray(size_t count)
+{
+    T* array = static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+    for (size_t i = 0; i < count; ++i)
+        new (array + i) T();
+    return array;
+}
+
+template <typename T>
+T* LinearAllocator::copyArray(const T* data, size_t count)
+{
+    T* array = static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+    if (count > 0)
+        std::memcpy(static_cast<void*>(array), data, sizeof(T) * count);
+    return array;
+}
+
+#endif
@@ -0,0 +1,132 @@
+/* Start Header -------------------------------------------------------
+Copyright (C) 2021 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the prior written
+consent of DigiPen Institute of Technology is prohibited.
+File Name: MaterialLibrary.h
+Purpose: This file is header for the material table and texture array pools.
+Language: c++
+Platform: VS2019 / Window
+Project:  HGraphics
+Author: Elliott Hong <s.hong@digipen.edu>
+Creation date: Oct 19, 2026
+End Header ---------------------------------------------------------*/
+#ifndef MATERIAL_LIBRARY_H
+#define MATERIAL_LIBRARY_H
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "TextureStreamer.h"
+
+// Holds every material's textures and shading coefficients in a shader
+// storage buffer table. Resident streamed textures are copied into
+// GL_TEXTURE_2D_ARRAY pools, one pool per format and size.
+// A material reference packs (pool << 16) | layer, or -1 while the texture
+// is not resident. With ARB_bindless_texture the pool handles live in a
+// second storage buffer, otherwise the pools are bound to consecutive units.
+// Either way a pass binds everything once and draws select a material by
+// setting the materialIndex uniform.
+class MaterialLibrary
+{
+public:
+    // Must match the layout bindings in the material shaders
+    static const GLuint MATERIAL_BINDING = 3;
+    static const GLuint POOL_HANDLE_BINDING = 4;
+    static const GLuint POOL_TEXTURE_UNIT = 8;
+    static const int MAX_BOUND_POOLS = 8;
+
+    // Set in the flags word of the material table
+    static const GLint FLAG_TEXTURED = 1;
+
+    struct Material
+    {
+        std::string diffuse;
+        std::string specular;
+        std::string normal;
+
+        // Base color when there is no diffuse texture
+        glm::vec3 color = glm::vec3(1.f);
+        glm::vec3 emissive = glm::vec3(0.f);
+        glm::vec3 ka = glm::vec3(0.f);
+        glm::vec3 kd = glm::vec3(1.f);
+        glm::vec3 ks = glm::vec3(1.f);
+    };
+
+    struct Stats
+    {
+        unsigned pools;
+        unsigned layers;
+        size_t poolBytes;
+    };
+
+    MaterialLibrary();
+    ~MaterialLibrary();
+
+    // Texture names are the ones given to OBJManager::loadTexture; empty for none
+    int addMaterial(const std::string& name, const Material& material);
+    // -1 if unknown
+    int findMaterial(const std::string& name) const;
+    const Material& getMaterial(int id) const;
+    void setMaterial(int id, const Material& material);
+    unsigned getMaterialCount() const;
+
+    // Call once per frame on the GL thread after the streamer has updated;
+    // textures copied into a pool are released from the streamer
+    void update(TextureStreamer& streamer);
+    // Binds the material table and every pool for the pass
+    void bind() const;
+
+    bool isBindless() const;
+    const Stats& getStats() const;
+
+private:
+    // std430 layout shared with the MaterialData struct of the material shaders
+    struct GPUMaterial
+    {
+        GLint diffuse = -1;
+        GLint specular = -1;
+        GLint normal = -1;
+        GLint flags = 0;
+        glm::vec4 color = glm::vec4(1.f);
+        glm::vec4 emissive = glm::vec4(0.f);
+        glm::vec4 ka = glm::vec4(0.f);
+        glm::vec4 kd = glm::vec4(0.f);
+        glm::vec4 ks = glm::vec4(0.f);
+    };
+
+    struct Pool
+    {
+        GLuint texture;
+        GLuint64 handle;
+        GLenum internalFormat;
+        int width, height;
+        int levels;
+        int layers;
+        int capacity;
+    };
+
+    void createResources();
+    GLint adopt(const TextureStreamer::TextureInfo& info);
+    int findPool(const TextureStreamer::TextureInfo& info);
+    void grow(Pool& pool);
+    GLint resolve(const std::string& texture) const;
+
+    static size_t getLayerBytes(const Pool& pool);
+
+    std::vector<Pool> pools_;
+    std::unordered_map<std::string, GLint> texture_refs_;
+    std::unordered_map<std::string, int> material_ids_;
+    std::vector<Material> materials_;
+
+    GLuint material_ssbo_;
+    GLuint handle_ssbo_;
+    bool bindless_;
+    bool dirty_;
+
+    Stats stats_;
+};
+
+#endif
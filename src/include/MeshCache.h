@@ -0,0 +1,76 @@
+/* Start Header -------------------------------------------------------
+Copyright (C) 2021 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the prior written
+consent of DigiPen Institute of Technology is prohibited.
+File Name: MeshCache.h
+Purpose: This file is header for the on-disk cache of imported meshes.
+Language: c++
+Platform: VS2019 / Window
+Project:  HGraphics
+Author: Elliott Hong <s.hong@digipen.edu>
+Creation date: Oct 19, 2026
+End Header ---------------------------------------------------------*/
+#ifndef MESH_CACHE_H
+#define MESH_CACHE_H
+
+#include <cstdint>
+#include <string>
+
+class Mesh;
+
+// File layout: header, the positions, LOD ranges and meshlets as stored in
+// Mesh, then LOD 0's and the coarser LODs' indices compressed by IndexCodec.
+// The source's size and write time, the import flags and MESH_CACHE_VERSION
+// are in the header, a cache that disagrees with them is rebuilt
+struct MeshCacheHeader
+{
+    char identifier[8];
+    uint64_t sourceSize;
+    int64_t sourceTime;
+    uint32_t flags;
+    uint32_t version;
+    uint32_t vertexCount;
+    uint32_t indexCount;
+    uint32_t lodIndexCount;
+    uint32_t lodCount;
+    uint32_t meshletCount;
+    // MeshCache::IndexEncoding of LOD 0
+    uint32_t indexEncoding;
+    uint32_t indexBytes;
+    uint32_t lodIndexBytes;
+    uint32_t bOptimized;
+    float boundingBox[6];
+    // ACMR and ATVR before and after optimizeIndexOrder
+    float cacheStats[4];
+};
+
+static const char MESH_CACHE_IDENTIFIER[8] = { 'H', 'M', 'S', 'H', ' ', '1', '1', '\n' };
+// Bump when the import, MeshOptimizer, the meshlet or LOD builders or IndexCodec
+// change what ends up in the file; the layout itself is covered by the identifier
+static const uint32_t MESH_CACHE_VERSION = 1;
+
+// Caches what OBJManager's import builds before the normals: the normalized
+// and reordered positions, meshlets and LODs. A hit skips the parse and the
+// slowest steps, normals, UVs and the BVH are rebuilt from it
+class MeshCache
+{
+public:
+    enum class IndexEncoding : uint32_t
+    {
+        TRIANGLES = 0,
+        // Per meshlet vertex lists with 8-bit local indices
+        MESHLETS
+    };
+
+    // "dir/name.obj" -> "dir/name.hmesh"
+    static std::string cachePath(const std::string& sourcePath);
+
+    // False when there is no current cache; mesh is left as it was then
+    static bool load(const std::string& sourcePath, Mesh* mesh, bool bFlipNormals);
+    static bool save(const std::string& sourcePath, const Mesh& mesh, bool bFlipNormals);
+
+private:
+    static bool getSourceStamp(const std::string& sourcePath, uint64_t& size, int64_t& time);
+};
+
+#endif
@@ -0,0 +1,97 @@
+/* Start Header -------------------------------------------------------
+Copyright (C) 2021 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the prior written
+consent of DigiPen Institute of Technology is prohibited.
+File Name: MeshOptimizer.h
+Purpose: This file is header for the import time index and vertex reordering.
+Language: c++
+Platform: VS2019 / Window
+Project:  HGraphics
+Author: Elliott Hong <s.hong@digipen.edu>
+Creation date: Oct 19, 2026
+End Header ---------------------------------------------------------*/
+#ifndef MESH_OPTIMIZER_H
+#define MESH_OPTIMIZER_H
+
+#include <cstddef>
+#include <vector>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+// A cluster of neighbouring triangles, a contiguous range of LOD 0's indices.
+// std430 layout shared with clusterCull.comp
+struct Meshlet
+{
+    // Object space bounding sphere, xyz center and w radius
+    glm::vec4 sphere;
+    // Normal cone, xyz axis and w the sine of its spread; 1 when the normals
+    // spread too far for the cone to ever face away
+    glm::vec4 cone;
+    GLuint firstIndex;
+    GLuint indexCount;
+    GLuint vertexCount;
+    GLuint pad;
+};
+
+// Reorders a triangle list so the GPU does less work for the same image, run
+// once at import in this order:
+//  1. optimizeVertexCache, Forsyth's linear speed vertex cache optimisation:
+//     triangles that reuse recently transformed vertices go first
+//  2. optimizeOverdraw, after Sander et al.: the cache friendly order is cut
+//     into clusters where a restart costs little and the clusters facing out
+//     of the mesh are drawn first, so they hide the ones behind them
+//  3. optimizeVertexFetch: vertices are renumbered in the order the indices
+//     first use them so the vertex fetch streams through memory
+// None of them changes which triangles there are or how they wind, and
+// neither does buildMeshlets.
+class MeshOptimizer
+{
+public:
+    // Post-transform cache size of the analysis; small enough for any GPU
+    static const unsigned CACHE_SIZE = 16;
+
+    struct CacheStats
+    {
+        // Average cache miss ratio, transformed vertices per triangle: 0.5 at
+        // best for a large regular grid, 3 with no reuse at all
+        float acmr;
+        // Average transformed vertex ratio, transformed per used vertex: 1 at best
+        float atvr;
+    };
+
+    static void optimizeVertexCache(GLuint* indices, size_t indexCount, size_t vertexCount);
+    // threshold is how much worse than the cache order a cluster's ACMR may get
+    static void optimizeOverdraw(GLuint* indices, size_t indexCount, const glm::vec3* positions, size_t vertexCount,
+                                 float threshold = 1.05f);
+    // Rewrites indices and fills remap with the new number of every old vertex;
+    // vertices no index uses go last in their old order
+    static void optimizeVertexFetch(GLuint* indices, size_t indexCount, size_t vertexCount,
+                                    std::vector<GLuint>& remap);
+
+    // Regroups the triangles into meshlets of at most maxVertices and
+    // maxTriangles, grown from neighbours that add the fewest vertices and
+    // share the meshlet's normal. The seeds follow the input order, so an
+    // overdraw order carries over meshlet by meshlet. normals orient the
+    // cones and may be null, then the winding does
+    static void buildMeshlets(GLuint* indices, size_t indexCount, const glm::vec3* positions,
+                              const glm::vec3* normals, size_t vertexCount, unsigned maxVertices,
+                              unsigned maxTriangles, std::vector<Meshlet>& meshlets);
+
+    // Simulates a FIFO cache of cacheSize entries
+    static CacheStats analyzeVertexCache(const GLuint* indices, size_t indexCount, size_t vertexCount,
+                                         unsigned cacheSize = CACHE_SIZE);
+
+    // Moves every element of values to its number in remap
+    template <typename T>
+    static void remapVertices(std::vector<T>& values, const std::vector<GLuint>& remap)
+    {
+        if (values.size() != remap.size())
+            return;
+        std::vector<T> result(values.size());
+        for (size_t i = 0; i < values.size(); ++i)
+            result[remap[i]] = values[i];
+        values.swap(result);
+    }
+};
+
+#endif
@@ -0,0 +1,39 @@
+/* Start Header -------------------------------------------------------
+Copyright (C) 2021 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the prior written
+consent of DigiPen Institute of Technology is prohibited.
+File Name: MeshSimplifier.h
+Purpose: This file is header for the quadric error mesh simplifier.
+Language: c++
+Platform: VS2019 / Window
+Project:  HGraphics
+Author: Elliott Hong <s.hong@digipen.edu>
+Creation date: Oct 19, 2026
+End Header ---------------------------------------------------------*/
+#ifndef MESH_SIMPLIFIER_H
+#define MESH_SIMPLIFIER_H
+
+#include <cstddef>
+#include <vector>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+// Quadric error metric simplification (Garland and Heckbert) by half-edge
+// collapses: a vertex is merged into a neighbour, nothing is moved or added,
+// so the result indexes the original vertex buffer and every attribute stays
+// valid. Each pass collapses the cheapest edges of an independent set of
+// vertices, then the index list is rewritten.
+// Vertices that share a position with another vertex (UV and normal seams)
+// and vertices on open borders never move, so seams and silhouettes of open
+// meshes keep their shape.
+class MeshSimplifier
+{
+public:
+    // Simplifies towards targetIndexCount, stopping early once the next
+    // collapse would exceed maxError. Returns the error of the result: the
+    // largest collapse error as an object space distance to the original surface
+    static float simplify(const glm::vec3* positions, size_t vertexCount, const GLuint* indices, size_t indexCount,
+                          size_t targetIndexCount, float maxError, std::vector<GLuint>& result);
+};
+
+#endif
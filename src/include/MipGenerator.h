@@ -0,0 +1,58 @@
+/* Start Header -------------------------------------------------------
+Copyright (C) 2021 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the prior written
+consent of DigiPen Institute of Technology is prohibited.
+File Name: MipGenerator.h
+Purpose: This file is header for the CPU mip chain generator.
+Language: c++
+Platform: VS2019 / Window
+Project:  HGraphics
+Author: Elliott Hong <s.hong@digipen.edu>
+Creation date: Oct 19, 2026
+End Header ---------------------------------------------------------*/
+#ifndef MIP_GENERATOR_H
+#define MIP_GENERATOR_H
+
+#include <vector>
+
+enum class MipContent
+{
+    COLOR_SRGB, // rgb filtered in linear light, alpha as is
+    LINEAR,     // every channel filtered as stored
+    NORMAL      // rgb is a [0,1]-encoded vector, renormalized at every level
+};
+
+// Builds a mip chain with a separable Kaiser-windowed sinc. Pixels are
+// widened to linear RGBA floats so one SSE register holds a pixel, and every
+// pass is split across rows as JOB_SYSTEM jobs. Each level is filtered from
+// the previous level's floats, not its 8-bit output.
+class MipGenerator
+{
+public:
+    struct Level
+    {
+        int width, height;
+        std::vector<unsigned char> pixels;
+    };
+
+    // levels[i] is mip i + 1 of the width x height image, in the same channel
+    // count, tightly packed and ready for glTexSubImage2D or block compression.
+    // threadCount chunks of rows per pass, 0 for every JOB_SYSTEM thread and 1 on the calling thread
+    static void generate(const unsigned char* pixels, int width, int height, int channels, MipContent content,
+                         bool wrap, std::vector<Level>& levels, unsigned threadCount = 0);
+
+    static int getLevelCount(int width, int height);
+
+private:
+    struct Kernel
+    {
+        std::vector<int> first;
+        std::vector<int> count;
+        std::vector<int> taps;
+        std::vector<float> weights;
+    };
+
+    static Kernel buildKernel(int srcSize, int dstSize, bool wrap);
+};
+
+#endif
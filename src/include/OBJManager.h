@@ -26,6 +26,8 @@ End Header ---------------------------------------------------------*/
 
 #include "mesh.h"
 #include "LineMesh.h"
+#include "TextureStreamer.h"
+#include "MaterialLibrary.h"
 
 class OBJManager
 {
@@ -46,33 +48,61 @@ public:
                        ReadMethod r = ReadMethod::LINE_BY_LINE,
                        GLboolean bFlipNormals = false);
 
-    void loadTexture(char const* filepath, const std::string& textureName);
+    // Textures stream in asynchronously; getTexture returns a placeholder
+    // until the image is resident, so look it up every frame
+    void loadTexture(char const* filepath, const std::string& textureName, bool bNormalMap = false);
     unsigned int getTexture(const std::string& name);
+    void updateTextures();
+    const TextureStreamer& getTextureStreamer() const;
+    // Materials pick up textures from the streamer as they become resident
+    MaterialLibrary& getMaterialLibrary();
     int ReadSectionFile(std::string const& filepath);
 
     int loadOBJFile(const std::string& fileName, const std::string& modelName, bool bNormalFlag, Mesh::UVType uvType);
-    unsigned int load_cubemap(const std::string& face);
+
+    struct OBJFile
+    {
+        std::string fileName;
+        std::string modelName;
+        bool bNormalFlag;
+        Mesh::UVType uvType;
+    };
+
+    // Parses and prepares the files as parallel jobs, then uploads and registers
+    // them in the given order on the calling thread; returns the number loaded
+    int loadOBJFiles(const std::vector<OBJFile>& files);
+    void load_cubemap(const std::string& face);
     std::unordered_map<std::string, Mesh*> scene_mesh_;
     std::unordered_map<std::string, LineMesh*> scene_line_mesh_;
-    std::unordered_map<std::string, unsigned int> textures;
     std::vector<std::string> loaded_models;
     std::vector<Mesh> meshes;
     
-    unsigned int loadCubemap(std::vector<std::string> faces);
+    void loadCubemap(const std::string& name, std::vector<std::string> faces);
     void setupSphere(const std::string& modelName);
     void setupOrbitLine(const std::string& name, float radius);
     void setupPlane(const std::string& name);
 
 private:
 
+    // Cooked .htex beside the source image if there is one
+    static std::string resolveTexturePath(const std::string& filepath);
+
+    // CPU half of ReadOBJFile: parse, normalize, reorder, normals, UVs, meshlets, BVH and LODs,
+    // or the MeshCache beside the file when it is current. Touches nothing but the mesh and
+    // its cache file, so it can run on a job
+    int readOBJData(const std::string& filepath, Mesh* pMesh, Mesh::UVType uvType, ReadMethod r,
+                    GLboolean bFlipNormals) const;
+    // GL half of ReadOBJFile, main thread only
+    static void uploadOBJData(Mesh* pMesh);
+
     // Read OBJ file line by line
-    int ReadOBJFile_LineByLine(const std::string& filepath);
+    int ReadOBJFile_LineByLine(const std::string& filepath, Mesh* pMesh) const;
 
     // Read the OBJ file in blocks -- works for files smaller than 1GB
-    int ReadOBJFile_BlockIO(const std::string& filepath);
+    int ReadOBJFile_BlockIO(const std::string& filepath, Mesh* pMesh) const;
 
     // Parse individual OBJ record (one line delimited by '\n')
-    void ParseOBJRecord(char* buffer, glm::vec3& min, glm::vec3& max) const;
+    void ParseOBJRecord(char* buffer, Mesh* pMesh, glm::vec3& min, glm::vec3& max) const;
 
     int LoadModel(std::string const& filepath, Mesh* mesh);
 
@@ -84,6 +114,8 @@ private:
     // data members
     Mesh* current_mesh_;
     LineMesh* cuurent_line_mesh_;
+    TextureStreamer texture_streamer_;
+    MaterialLibrary material_library_;
 };
 
 extern OBJManager* OBJ_MANAGER;
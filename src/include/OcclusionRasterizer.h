@@ -0,0 +1,130 @@
+/* Start Header -------------------------------------------------------
+Copyright (C) 2021 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the prior written
+consent of DigiPen Institute of Technology is prohibited.
+File Name: OcclusionRasterizer.h
+Purpose: This file is header for the CPU depth-only occlusion rasterizer.
+Language: c++
+Platform: VS2019 / Window
+Project:  HGraphics
+Author: Elliott Hong <s.hong@digipen.edu>
+Creation date: Oct 19, 2026
+End Header ---------------------------------------------------------*/
+#ifndef OCCLUSION_RASTERIZER_H
+#define OCCLUSION_RASTERIZER_H
+
+#include <unordered_map>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "GPUCuller.h"
+#include "mesh.h"
+
+// Renders occluders into a small depth buffer on the CPU and tests world-space
+// AABBs against it in the same frame. An occluder is a few boxes fitted inside
+// its mesh's closed volume, so it never covers a pixel the mesh doesn't or sits
+// nearer than it; open meshes get no boxes and occlude nothing. Triangles are
+// binned into screen tiles and the tiles are rasterized 4 pixels at a time with
+// SSE, both phases run as jobs on JOB_SYSTEM.
+class OcclusionRasterizer
+{
+public:
+    struct Stats
+    {
+        float setupMs;
+        float rasterMs;
+        unsigned occluders;
+        unsigned triangles;
+    };
+
+    struct OccluderMesh
+    {
+        std::vector<glm::vec3> vertices;
+        std::vector<GLuint> indices;
+    };
+
+    OcclusionRasterizer(int width = 320, int height = 192);
+
+    // Every instance may occlude; each mesh gets inner boxes on a grid of cellsPerAxis
+    // cells along its longest side, cached by mesh
+    void setOccluders(const std::vector<Mesh*>& meshes, const std::vector<InstanceData>& instances, int cellsPerAxis = 16);
+    // Occluder geometry given as is, instance.mesh_index selects from meshes
+    void setOccluders(const std::vector<OccluderMesh>& meshes, const std::vector<InstanceData>& instances);
+    // Update model matrices without changing the instance set
+    void updateTransforms(const std::vector<InstanceData>& instances);
+    void setMaxOccluders(unsigned maxOccluders);
+
+    // Rasterize the largest on-screen occluders for viewProj
+    void render(const glm::mat4& viewProj);
+    // Single-threaded scalar rasterization of the same occluders, for validation
+    void renderReference(const glm::mat4& viewProj, std::vector<float>& depth) const;
+
+    // World-space AABB against the last render; false only if fully hidden
+    bool isVisible(const glm::vec3& center, const glm::vec3& extent) const;
+
+    const std::vector<float>& getDepth() const;
+    const Stats& getStats() const;
+    int getWidth() const;
+    int getHeight() const;
+
+    // Largest boxes inside the closed volume of an indexed triangle list, in its space
+    static OccluderMesh buildOccluder(const std::vector<glm::vec3>& vertices, const std::vector<GLuint>& indices,
+                                      int cellsPerAxis);
+
+private:
+    // Edge functions are positive inside, depth is a screen-space plane
+    struct ScreenTriangle
+    {
+        float edge_a[3], edge_b[3], edge_c[3];
+        float z_a, z_b, z_c;
+        int min_x, min_y, max_x, max_y;
+    };
+
+    struct VoxelGrid
+    {
+        glm::ivec3 dims;
+        glm::vec3 origin;
+        float cellSize;
+
+        size_t index(int x, int y, int z) const { return (static_cast<size_t>(z) * dims.y + y) * dims.x + x; }
+        float center(int axis, int i) const { return origin[axis] + (static_cast<float>(i) + 0.5f) * cellSize; }
+    };
+
+    static OccluderMesh simplify(Mesh* mesh, int cellsPerAxis);
+    static void markSurface(const VoxelGrid& grid, const std::vector<glm::vec3>& vertices,
+                            const std::vector<GLuint>& indices, std::vector<unsigned char>& surface);
+    static void markExterior(const VoxelGrid& grid, const std::vector<unsigned char>& surface,
+                             std::vector<unsigned char>& inside);
+    static void markParity(const VoxelGrid& grid, const std::vector<glm::vec3>& vertices,
+                           const std::vector<GLuint>& indices, int axis, std::vector<unsigned char>& inside);
+    static void appendBox(const glm::vec3& lo, const glm::vec3& hi, OccluderMesh& mesh);
+    static bool setupTriangle(const glm::vec4& c0, const glm::vec4& c1, const glm::vec4& c2, int width, int height,
+                              ScreenTriangle& tri);
+    static void rasterizeTriangleScalar(const ScreenTriangle& tri, int x0, int y0, int x1, int y1, float* depth, int pitch);
+    void rasterizeTriangle(const ScreenTriangle& tri, int x0, int y0, int x1, int y1);
+
+    void selectOccluders(const glm::mat4& viewProj, std::vector<unsigned>& selected) const;
+    void transformAndBin(unsigned slice, const glm::mat4& viewProj);
+    void rasterizeTiles(int firstTile, int lastTile);
+
+    int width_, height_;
+    int tiles_x_, tiles_y_;
+    unsigned max_occluders_;
+    std::vector<float> depth_;
+    glm::mat4 view_proj_;
+
+    std::vector<OccluderMesh> occluder_meshes_;
+    std::unordered_map<Mesh*, unsigned> mesh_slots_;
+    std::vector<unsigned> instance_meshes_;
+    std::vector<InstanceData> instances_;
+    std::vector<unsigned> selected_;
+
+    // Per slice of the selected occluders: triangles it set up and, per tile, indices into them
+    std::vector<std::vector<ScreenTriangle>> triangles_;
+    std::vector<std::vector<std::vector<unsigned>>> bins_;
+    std::vector<std::vector<glm::vec4>> clip_scratch_;
+
+    Stats stats_;
+};
+
+#endif
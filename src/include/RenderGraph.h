@@ -0,0 +1,152 @@
+/* Start Header -------------------------------------------------------
+Copyright (C) 2021 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the prior written
+consent of DigiPen Institute of Technology is prohibited.
+File Name: RenderGraph.h
+Purpose: This file is header for the render graph of the deferred passes.
+Language: c++
+Platform: VS2019 / Window
+Project:  HGraphics
+Author: Elliott Hong <s.hong@digipen.edu>
+Creation date: Oct 19, 2026
+End Header ---------------------------------------------------------*/
+#ifndef RENDER_GRAPH_H
+#define RENDER_GRAPH_H
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include <glad/glad.h>
+
+// Passes declare which textures they read and write. A read sees the writes
+// of the passes added before it; compile derives the dependencies from that,
+// culls passes whose results nothing uses and sorts the rest, running
+// independent passes in the order that keeps the fewest transient textures
+// alive. Each transient texture gets a lifetime over the sorted passes. Textures
+// with the same format and size share one GL texture when their lifetimes
+// don't overlap, so a transient texture holds garbage until its first writer
+// clears or covers it.
+// Passes that write an imported texture (the default framebuffer, shadow maps,
+// Hi-Z) are the outputs of the graph and are never culled.
+class RenderGraph
+{
+public:
+    struct Stats
+    {
+        unsigned passes;
+        unsigned culledPasses;
+        unsigned textures;
+        unsigned allocations;
+        uint64_t bytes;
+        // What the textures would take without aliasing
+        uint64_t unaliasedBytes;
+    };
+
+    RenderGraph();
+    ~RenderGraph();
+
+    // Drops the passes and resources; the GL textures are kept for the next compile
+    void clear();
+
+    // Transient textures are owned by the graph and sized scale * graph size
+    int createTexture(const std::string& name, GLenum internalFormat, float scale = 1.f);
+    int importTexture(const std::string& name, GLuint texture);
+    // For imported textures that were recreated, e.g. on resize
+    void setImportedTexture(int resource, GLuint texture);
+
+    int addPass(const std::string& name, std::function<void()> execute);
+    void read(int pass, int resource);
+    // Written transient textures are attached to the pass framebuffer, colors in
+    // the order they are written. Writing a texture modifies it, earlier writers stay
+    void write(int pass, int resource);
+
+    // Only textures whose size changes are reallocated, on the next execute
+    void setSize(int width, int height);
+    // Passes draw into the lower left width x height of the graph size, so the
+    // drawn area can shrink and grow without reallocating; defaults to the graph size
+    void setRenderSize(int width, int height);
+    void compile();
+    // Binds each pass framebuffer with all its colors drawn and the viewport set to the render size, then runs the pass
+    void execute();
+
+    // For the running pass: rebinds its framebuffer after the pass drew elsewhere
+    void bindTarget();
+    GLenum getAttachment(int resource) const;
+    // Binds a transient texture as read framebuffer, for blits
+    void bindRead(int resource);
+
+    GLuint getTexture(int resource) const;
+    int getWidth() const;
+    int getHeight() const;
+    int getRenderWidth() const;
+    int getRenderHeight() const;
+
+    // Executed passes in order
+    const std::vector<int>& getOrder() const;
+    const std::string& getPassName(int pass) const;
+    const Stats& getStats() const;
+
+private:
+    struct Resource
+    {
+        std::string name;
+        GLenum format;
+        float scale;
+        bool bImported;
+        GLuint imported;
+        std::vector<int> writers;
+        std::vector<int> readers;
+        int physical;
+        int first, last;
+    };
+
+    struct Pass
+    {
+        std::string name;
+        std::function<void()> execute;
+        std::vector<int> reads;
+        std::vector<int> writes;
+        bool bCulled;
+        GLuint fbo;
+        std::vector<GLenum> drawBuffers;
+        int width, height;
+        float scale;
+    };
+
+    struct Physical
+    {
+        GLuint texture;
+        GLenum format;
+        int width, height;
+        int freeAfter;
+        bool bUsed;
+    };
+
+    void getDependencies(int pass, std::vector<int>& dependencies) const;
+    void cull();
+    void sortPasses();
+    void assignTextures();
+    void createFramebuffers();
+    void deleteFramebuffers();
+    int getScaledSize(int size, float scale) const;
+
+    static bool isDepthFormat(GLenum format);
+    static GLenum getDepthAttachment(GLenum format);
+    static unsigned getBytesPerPixel(GLenum format);
+
+    std::vector<Resource> resources_;
+    std::vector<Pass> passes_;
+    std::vector<int> order_;
+    std::vector<Physical> physicals_;
+
+    int width_, height_;
+    int render_width_, render_height_;
+    bool dirty_;
+    int current_pass_;
+    GLuint read_fbo_;
+
+    Stats stats_;
+};
+
+#endif
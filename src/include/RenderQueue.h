@@ -0,0 +1,122 @@
+/* Start Header -------------------------------------------------------
+Copyright (C) 2021 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the prior written
+consent of DigiPen Institute of Technology is prohibited.
+File Name: RenderQueue.h
+Purpose: This file is header for the sort-key render queue.
+Language: c++
+Platform: VS2019 / Window
+Project:  HGraphics
+Author: Elliott Hong <s.hong@digipen.edu>
+Creation date: Oct 19, 2026
+End Header ---------------------------------------------------------*/
+#ifndef RENDER_QUEUE_H
+#define RENDER_QUEUE_H
+
+#include <cstdint>
+#include <unordered_map>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "ArenaVector.h"
+#include "mesh.h"
+#include "shader.hpp"
+
+// Collects the draws of a pass, radix sorts them by a 64-bit key and issues
+// them with as few program, material and VAO changes as possible.
+// Runs of draws with the same shader, material and mesh become one instanced
+// draw. Per-draw data goes to a storage buffer the vertex shaders read as
+// queued[instanceBase + gl_InstanceID].
+//
+// With a LODView every draw picks the mesh LOD for its projected size, the
+// mesh field holds the mesh id and that LOD.
+//
+// Solid key:   pass:4 | shader:12 | material:16 | mesh:13 lod:3 | depth:16 (front to back)
+// Blended key: pass:4 | depth:16 (back to front) | shader:12 | material:16 | mesh:13 lod:3
+class RenderQueue
+{
+public:
+    enum class Pass : unsigned
+    {
+        SOLID = 0,
+        BLENDED
+    };
+
+    // Must match the layout binding of the queued instance buffer in the shaders
+    static const GLuint INSTANCE_BINDING = 6;
+
+    struct Stats
+    {
+        unsigned draws;
+        unsigned batches;
+        unsigned shaderChanges;
+        unsigned materialChanges;
+        unsigned meshChanges;
+        unsigned triangles;
+    };
+
+    RenderQueue();
+    ~RenderQueue();
+
+    // Starts a pass; depth in the sort key is the view distance between zNear and zFar.
+    // The pass lives in FRAME_ARENA, execute it in the frame it was begun.
+    // Without lod every mesh is drawn at full detail
+    void begin(const glm::mat4& view, float zNear, float zFar, const LODView* lod = nullptr);
+    void submit(Pass pass, Shader* shader, int material, const Mesh* mesh, const glm::mat4& model,
+                const glm::vec4& color = glm::vec4(1.f));
+    // Sorts and draws everything submitted since begin. Per-pass uniforms must
+    // already be set on every shader, the queue only sets materialIndex and instanceBase
+    void execute();
+
+    // Counters of the last execute
+    const Stats& getStats() const;
+
+    static uint64_t makeKey(Pass pass, unsigned shader, unsigned material, unsigned mesh, unsigned lod, unsigned depth);
+
+private:
+    // std430 layout shared with the QueuedInstance struct of the queued shaders
+    struct InstanceData
+    {
+        glm::mat4 model;
+        glm::mat4 normalMatrix;
+        glm::vec4 color;
+    };
+
+    struct Draw
+    {
+        Shader* shader;
+        int material;
+        const Mesh* mesh;
+        unsigned lod;
+        InstanceData instance;
+    };
+
+    struct SortItem
+    {
+        uint64_t key;
+        uint32_t draw;
+    };
+
+    void sort();
+    unsigned getShaderID(const Shader* shader);
+    unsigned getMeshID(const Mesh* mesh);
+
+    glm::mat4 view_;
+    float z_near_, z_far_;
+    LODView lod_view_;
+    bool b_lod_;
+
+    // Frame arena memory, taken again in every begin
+    ArenaVector<Draw> draws_;
+    ArenaVector<SortItem> items_;
+    ArenaVector<SortItem> scratch_;
+    ArenaVector<InstanceData> instances_;
+    std::unordered_map<const Shader*, unsigned> shader_ids_;
+    std::unordered_map<const Mesh*, unsigned> mesh_ids_;
+
+    GLuint instance_buffer_;
+
+    Stats stats_;
+};
+
+#endif
@@ -0,0 +1,78 @@
+/* Start Header -------------------------------------------------------
+Copyright (C) 2021 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the prior written
+consent of DigiPen Institute of Technology is prohibited.
+File Name: RenderThread.h
+Purpose: This file is header for the render thread.
+Language: c++
+Platform: VS2019 / Window
+Project:  HGraphics
+Author: Elliott Hong <s.hong@digipen.edu>
+Creation date: Oct 19, 2026
+End Header ---------------------------------------------------------*/
+#ifndef RENDER_THREAD_H
+#define RENDER_THREAD_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+#include "FramePacket.h"
+
+struct GLFWwindow;
+class Scene;
+
+// Owns the GL context from start to stop and draws the frames the main
+// thread submits. A frame is replayed from its packet: the commands run,
+// the scene draws from the packet, then the ImGui lists, and the buffers
+// are swapped. There are two packets, so the main thread builds frame N+1
+// while frame N is submitted and only waits in beginFrame once it is a
+// whole frame ahead.
+// Started without a thread, submit draws the packet right away on the
+// calling thread; the same frames, easier to step through in a debugger.
+// Built with HGRAPHICS_ALLOCATION_COUNTER, a debug build asserts that
+// drawing a frame makes no heap allocations once warmed up.
+class RenderThread
+{
+public:
+    static const unsigned PACKET_COUNT = 2;
+    // Frames allowed to allocate before the allocation check in renderPacket kicks in
+    static const unsigned WARM_UP_FRAMES = 8;
+
+    RenderThread();
+    ~RenderThread();
+
+    // Call on the thread that has the window's context current, with bThreaded it moves to the render thread
+    void start(GLFWwindow* window, Scene* scene, bool bThreaded = true);
+    // Draws what was submitted and makes the context current on the calling thread again
+    void stop();
+    bool isStarted() const;
+    // True while the context belongs to the render thread
+    bool isThreaded() const;
+
+    // Waits until the next packet is free and resets it
+    FramePacket& beginFrame();
+    void submit(FramePacket& packet);
+
+private:
+    void threadLoop();
+    void renderPacket(FramePacket& packet);
+
+    GLFWwindow* window_;
+    Scene* scene_;
+    FramePacket packets_[PACKET_COUNT];
+
+    std::thread thread_;
+    std::mutex mutex_;
+    std::condition_variable submitted_;
+    std::condition_variable rendered_;
+    // Frames handed over and frames drawn; packet i holds frame i % PACKET_COUNT
+    uint64_t submitted_count_;
+    uint64_t rendered_count_;
+    bool started_;
+    bool threaded_;
+    bool stop_;
+};
+
+#endif
@@ -0,0 +1,56 @@
+/* Start Header -------------------------------------------------------
+Copyright (C) 2021 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the prior written
+consent of DigiPen Institute of Technology is prohibited.
+File Name: ShaderCache.h
+Purpose: This file is header for the on-disk cache of linked program binaries.
+Language: c++
+Platform: VS2019 / Window
+Project:  HGraphics
+Author: Elliott Hong <s.hong@digipen.edu>
+Creation date: Oct 19, 2026
+End Header ---------------------------------------------------------*/
+#ifndef SHADER_CACHE_H
+#define SHADER_CACHE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <glad/glad.h>
+
+// File layout: header, then the glGetProgramBinary blob
+struct ShaderCacheHeader
+{
+    char identifier[8];
+    uint64_t key;
+    uint32_t binaryFormat;
+    uint32_t binaryBytes;
+};
+
+static const char SHADER_CACHE_IDENTIFIER[8] = { 'H', 'P', 'R', 'G', ' ', '1', '0', '\n' };
+// Part of the key; bump when Shader changes how it builds a program from the
+// same sources, e.g. text added to a stage or state set before the link
+static const uint32_t SHADER_CACHE_VERSION = 1;
+
+// Keeps one binary per program in a cache directory beside its shaders. The
+// key hashes SHADER_CACHE_VERSION and every stage's source with the driver's
+// vendor, renderer and version strings, so an edited shader, a change to how
+// programs are built or a driver update misses and the program is compiled
+// from source and saved again
+class ShaderCache
+{
+public:
+    // "dir/a.vert", "dir/a.frag" -> "dir/cache/a.vert_a.frag.hprog"
+    static std::string cachePath(const std::vector<std::string>& stagePaths);
+    static uint64_t makeKey(const std::vector<std::string>& stageSources);
+
+    // Linked program, or 0 on a miss or when the driver rejects the binary
+    static GLuint load(const std::string& cacheFile, uint64_t key);
+    // program must have been linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+    static bool save(const std::string& cacheFile, uint64_t key, GLuint program);
+
+private:
+    static bool isSupported();
+};
+
+#endif
@@ -0,0 +1,65 @@
+/* Start Header -------------------------------------------------------
+Copyright (C) 2021 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the prior written
+consent of DigiPen Institute of Technology is prohibited.
+File Name: TextureCooker.h
+Purpose: This file is header for the offline BCn texture cooker.
+Language: c++
+Platform: VS2019 / Window
+Project:  HGraphics
+Author: Elliott Hong <s.hong@digipen.edu>
+Creation date: Oct 19, 2026
+End Header ---------------------------------------------------------*/
+#ifndef TEXTURE_COOKER_H
+#define TEXTURE_COOKER_H
+
+#include <string>
+#include <vector>
+#include <glad/glad.h>
+
+#include "MipGenerator.h"
+
+enum class CookFormat { AUTO, BC1, BC3, BC5, BC7 };
+
+struct CookOptions
+{
+    CookFormat format = CookFormat::AUTO;
+    MipContent content = MipContent::COLOR_SRGB;
+    bool mipmaps = true;
+    bool wrap = true;
+};
+
+// Decodes an image, builds its mip chain with MipGenerator and
+// block-compresses every level into a CookedTexture file. Blocks are 4x4 RGBA8 pixels in row-major order
+class TextureCooker
+{
+public:
+    struct Result
+    {
+        CookFormat format;
+        int width, height;
+        int levelCount;
+        size_t sourceBytes;
+        size_t cookedBytes;
+    };
+
+    static bool cook(const std::string& input, const std::string& output, const CookOptions& options,
+                     Result* result = nullptr);
+
+    // BC1 for opaque color, BC3 when alpha is used. BC7 is opt-in, BC5 is used for normal maps
+    static CookFormat chooseFormat(const unsigned char* rgba, int pixelCount, int channels);
+    static GLenum getGLFormat(CookFormat format);
+    static int getBlockBytes(CookFormat format);
+    static const char* getName(CookFormat format);
+
+    static void compressLevel(const unsigned char* rgba, int width, int height, CookFormat format,
+                              std::vector<unsigned char>& blocks);
+
+    static void encodeBC1(const unsigned char block[64], unsigned char out[8]);
+    static void encodeBC3(const unsigned char block[64], unsigned char out[16]);
+    static void encodeBC4(const unsigned char block[64], int channel, unsigned char out[8]);
+    static void encodeBC5(const unsigned char block[64], unsigned char out[16]);
+    static void encodeBC7(const unsigned char block[64], unsigned char out[16]);
+};
+
+#endif
@@ -0,0 +1,144 @@
+/* Start Header -------------------------------------------------------
+Copyright (C) 2021 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the prior written
+consent of DigiPen Institute of Technology is prohibited.
+File Name: TextureStreamer.h
+Purpose: This file is header for the asynchronous texture streaming service.
+Language: c++
+Platform: VS2019 / Window
+Project:  HGraphics
+Author: Elliott Hong <s.hong@digipen.edu>
+Creation date: Oct 19, 2026
+End Header ---------------------------------------------------------*/
+#ifndef TEXTURE_STREAMER_H
+#define TEXTURE_STREAMER_H
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <glad/glad.h>
+
+#include "CookedTexture.h"
+#include "MipGenerator.h"
+
+// Decodes images on worker threads and uploads them from a ring of
+// persistently mapped pixel unpack buffers, at most one budget per frame.
+// Mips of decoded images are built by MipGenerator on the worker; paths
+// ending in .htex are memory-mapped cooked textures whose blocks and mips are
+// uploaded as they are.
+// Textures are immutable (glTexStorage2D); until one is resident a 1x1
+// placeholder is handed out instead, so look textures up every frame.
+class TextureStreamer
+{
+public:
+    struct Stats
+    {
+        unsigned pending;
+        unsigned resident;
+        size_t uploadedBytes;
+    };
+
+    // Storage of a resident texture, enough to copy it into a texture array
+    struct TextureInfo
+    {
+        GLuint texture;
+        GLenum target;
+        GLenum internalFormat;
+        int width, height;
+        int levels;
+    };
+
+    TextureStreamer(size_t frameBudget = 4u << 20, unsigned ringFrames = 3, unsigned decodeThreads = 2);
+    ~TextureStreamer();
+
+    void request2D(const std::string& name, const std::string& filepath, GLenum wrap = GL_REPEAT, bool mipmaps = true,
+                   MipContent content = MipContent::COLOR_SRGB);
+    // Faces in GL order: +X, -X, +Y, -Y, +Z, -Z
+    void requestCubemap(const std::string& name, const std::vector<std::string>& faces);
+
+    // Call once per frame on the GL thread
+    void update();
+
+    // Placeholder while pending, 0 if unknown or failed to load
+    GLuint getTexture(const std::string& name) const;
+    bool isResident(const std::string& name) const;
+    // False until the texture is resident
+    bool getTextureInfo(const std::string& name, TextureInfo& info) const;
+    // Deletes a resident texture once its contents were copied elsewhere; the
+    // name stays known, so it is not streamed again, and getTexture returns 0
+    void release(const std::string& name);
+    const Stats& getStats() const;
+
+private:
+    struct Image
+    {
+        int width = 0, height = 0, channels = 0;
+        unsigned char* pixels = nullptr;
+        std::vector<MipGenerator::Level> mips;
+        std::unique_ptr<CookedTexture> cooked;
+
+        bool isLoaded() const { return pixels != nullptr || cooked != nullptr; }
+    };
+
+    struct Request
+    {
+        std::string name;
+        GLenum target;
+        GLenum wrap;
+        bool mipmaps;
+        MipContent content;
+        std::vector<std::string> paths;
+        std::vector<Image> images;
+        bool failed = false;
+
+        // Upload progress
+        GLuint texture = 0;
+        GLenum format = 0;
+        GLenum internalFormat = 0;
+        int levels = 1;
+        unsigned face = 0;
+        int level = 0;
+        int row = 0;
+    };
+
+    struct Entry
+    {
+        GLuint texture = 0;
+        bool resident = false;
+        TextureInfo info = {};
+    };
+
+    void createResources();
+    void enqueue(std::unique_ptr<Request> request);
+    void decodeLoop();
+    bool beginUpload(Request& request);
+    void finishUpload(Request& request);
+    static void freeImages(Request& request);
+
+    size_t frame_budget_;
+    unsigned ring_frames_;
+    GLuint pbo_;
+    unsigned char* mapped_;
+    std::vector<GLsync> fences_;
+    unsigned ring_index_;
+    GLuint placeholder_2d_, placeholder_cube_;
+
+    std::unordered_map<std::string, Entry> entries_;
+    std::vector<std::unique_ptr<Request>> uploading_;
+
+    std::deque<std::unique_ptr<Request>> decode_queue_;
+    std::vector<std::unique_ptr<Request>> decoded_;
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    bool quit_;
+
+    Stats stats_;
+};
+
+#endif
@@ -0,0 +1,100 @@
+/* Start Header -------------------------------------------------------
+Copyright (C) 2021 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the prior written
+consent of DigiPen Institute of Technology is prohibited.
+File Name: VertexQuantizer.h
+Purpose: This file is header for the quantized vertex attribute encoding.
+Language: c++
+Platform: VS2019 / Window
+Project:  HGraphics
+Author: Elliott Hong <s.hong@digipen.edu>
+Creation date: Oct 19, 2026
+End Header ---------------------------------------------------------*/
+#ifndef VERTEX_QUANTIZER_H
+#define VERTEX_QUANTIZER_H
+
+#include <cmath>
+#include <limits>
+#include <vector>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/type_precision.hpp>
+
+// Layout of the vertex buffers Mesh::setupMesh uploads
+enum class VertexFormat
+{
+    // 32 bytes: float position, normal and UV
+    FLOAT = 0,
+    // 16 bytes: UNORM16 position in the AABB, octahedral SNORM 2x16 normal, UNORM16 UV in the UV bounds
+    QUANTIZED_OCT16,
+    // 12 bytes: as above with an octahedral SNORM 2x8 normal packed next to the position
+    QUANTIZED_OCT8
+};
+
+// Per mesh constants that turn the stored attributes back into object space.
+// The vertex shaders read them as attributes 5 to 7 from one buffer at stride 0
+struct VertexDecode
+{
+    // xyz the AABB minimum, w 1 when the normals are octahedral
+    glm::vec4 positionOffset;
+    // xyz the AABB extent
+    glm::vec4 positionScale;
+    // xy the UV minimum, zw the UV extent
+    glm::vec4 uv;
+};
+
+class VertexQuantizer
+{
+public:
+    static const GLuint DECODE_ATTRIBUTE = 5;
+    static const GLuint DECODE_BINDING = 5;
+
+    // Leaves float attributes as they are
+    static VertexDecode identityDecode();
+    // Buffer for decode, bound to the current VAO's attributes 5 to 7
+    static GLuint createDecodeBuffer(const VertexDecode& decode);
+    static void bindDecodeBuffer(GLuint buffer);
+
+    // Quantized to 16 bits on each axis of [min, max]; w is free for QUANTIZED_OCT8's normal
+    static void quantizePositions(const std::vector<glm::vec3>& positions, const glm::vec3& min, const glm::vec3& max,
+                                  std::vector<glm::u16vec4>& result, VertexDecode& decode, float& maxError);
+    // Quantized to 16 bits on each axis of the UV bounds
+    static void quantizeUVs(const std::vector<glm::vec2>& uvs, std::vector<glm::u16vec2>& result,
+                            VertexDecode& decode, float& maxError);
+
+    // Octahedral encoding, unit vector to [-1, 1]^2 and back
+    static glm::vec2 octEncode(const glm::vec3& n);
+    static glm::vec3 octDecode(const glm::vec2& e);
+    // The SNORM rounding of octEncode(n) closest to n in angle
+    static glm::ivec2 quantizeNormal(const glm::vec3& n, int maxValue);
+
+    // T is GLshort or GLbyte; maxErrorDegrees is the largest angle to the input
+    template <typename T>
+    static void quantizeNormals(const std::vector<glm::vec3>& normals, std::vector<glm::tvec2<T>>& result,
+                                float& maxErrorDegrees)
+    {
+        const int maxValue = std::numeric_limits<T>::max();
+        float maxDistance = 0.f;
+        result.resize(normals.size());
+        for (size_t i = 0; i < normals.size(); ++i)
+        {
+            const glm::ivec2 q = quantizeNormal(normals[i], maxValue);
+            result[i] = glm::tvec2<T>(static_cast<T>(q.x), static_cast<T>(q.y));
+
+            const float length = glm::length(normals[i]);
+            if (length > 0.f)
+            {
+                const glm::vec3 decoded = octDecode(decodeSnorm(q, maxValue));
+                maxDistance = glm::max(maxDistance, glm::length(decoded - normals[i] / length));
+            }
+        }
+        // The chord between two unit vectors, unlike their dot, holds up for tiny angles
+        maxErrorDegrees = glm::degrees(2.f * std::asin(glm::min(maxDistance * 0.5f, 1.f)));
+    }
+
+private:
+    // As GL normalizes a SNORM attribute
+    static glm::vec2 decodeSnorm(const glm::ivec2& q, int maxValue);
+};
+
+#endif
@@ -18,12 +18,29 @@ End Header ---------------------------------------------------------*/
 #include <vector>
 #include <glm/glm.hpp>
 
+#include "BVH.h"
+#include "MeshOptimizer.h"
+#include "VertexQuantizer.h"
 
+// How big an object space error looks in a view, for picking LODs
+struct LODView
+{
+    glm::vec3 eye;
+    // Pixels per world unit at distance 1, or at any distance for an orthographic view
+    float pixelScale;
+    bool bOrthographic;
+    // Coarser LODs are picked while their error stays under this many pixels
+    float maxPixelError;
+
+    static LODView fromProjection(const glm::vec3& eye, const glm::mat4& projection, float viewportHeight,
+                                  float maxPixelError = 1.f);
+};
 
 class Mesh
 {
 public:
     friend class OBJManager;
+    friend class MeshCache;
     Mesh();
     virtual ~Mesh();
 
@@ -50,7 +67,81 @@ public:
     glm::vec3 getMinBound() const;
     glm::vec3 getMaxBound() const;
 
+    // Tight bounds of the vertex buffer as uploaded by setupMesh
+    glm::vec3 getAABBMin() const;
+    glm::vec3 getAABBMax() const;
+
+    // A range of the index buffer; LOD 0 is the full mesh, the coarser ones follow it
+    struct LOD
+    {
+        GLuint firstIndex;
+        GLuint indexCount;
+        // Object space distance to the full mesh
+        float error;
+    };
+
+    // Vertex cache and overdraw order of the triangles and fetch order of the
+    // vertices, see MeshOptimizer. Renumbers the vertices, so call it once the
+    // positions are final and before normals, the BVH, LODs and setupMesh
+    void optimizeIndexOrder();
+    struct IndexOrderStats
+    {
+        MeshOptimizer::CacheStats before;
+        MeshOptimizer::CacheStats after;
+        bool bOptimized;
+    };
+    const IndexOrderStats& getIndexOrderStats() const;
+
+    static const unsigned MESHLET_MAX_VERTICES = 64;
+    static const unsigned MESHLET_MAX_TRIANGLES = 124;
+    // Regroups LOD 0's triangles into meshlets of neighbours with similar
+    // normals, for cluster culling in GPUCuller. Meshes too small to gain from
+    // it get none. Needs the vertex normals; call before the BVH and LODs
+    void buildMeshlets();
+    const std::vector<Meshlet>& getMeshlets() const;
+
+    // Simplified index lists for up to maxLevels coarser LODs, each about half
+    // the triangles of the one before. Call before setupMesh, which uploads them
+    void buildLODs(unsigned maxLevels = 4);
+    unsigned getLODCount() const;
+    LOD getLOD(unsigned lod) const;
+    // Coarsest LOD whose error stays under the view's pixel budget when drawn with model
+    unsigned selectLOD(const LODView& view, const glm::mat4& model) const;
+
+    // Layout setupMesh uploads the attributes in, see VertexQuantizer. The
+    // float copies stay for the BVH, LODs and CPU side work; call setupMesh
+    // again after a change
+    void setVertexFormat(VertexFormat format);
+    VertexFormat getVertexFormat() const;
+    struct VertexFormatStats
+    {
+        // Position, normal and UV bytes as floats and as uploaded, the decode constants included
+        size_t floatBytes;
+        size_t bytes;
+        // Largest distance from the float data in object space, in degrees and in UV space
+        float maxPositionError;
+        float maxNormalError;
+        float maxUVError;
+    };
+    const VertexFormatStats& getVertexFormatStats() const;
+    // GL_UNSIGNED_SHORT when every vertex fits in 16 bits, else GL_UNSIGNED_INT; set by setupMesh
+    GLenum getIndexType() const;
+    // Size of the uploaded index buffer, every LOD included
+    size_t getIndexBufferBytes() const;
+
     virtual void render(int Flag = 0) const;
+    // Draw with the command stored at commandOffset in the bound GL_DRAW_INDIRECT_BUFFER
+    void renderIndirect(GLintptr commandOffset) const;
+    // drawCount tightly packed commands starting at commandOffset, one per meshlet
+    void renderMultiIndirect(GLintptr commandOffset, GLsizei drawCount) const;
+    // Split bind and draw so consecutive batches of one mesh bind its VAO once
+    void bindVertexArray() const;
+    void renderInstanced(GLsizei instanceCount, unsigned lod = 0) const;
+    // Per-instance IDs (attribute 4, divisor 1) for indirect instanced draws
+    void setInstanceBuffer(GLuint instanceBuffer);
+    // Triangle BVH over the object-space vertex buffer; rebuild after positions change
+    void buildBVH();
+    const MeshBVH& getBVH() const;
     void setupMesh();
     void setupVNormalMesh();
     void setupFNormalMesh();
@@ -92,18 +183,34 @@ private:
     GLuint vbo_pos_;
     GLuint vbo_norm_;
     GLuint vbo_uv_;
+    GLuint decode_buffer_;
+    GLuint vnormal_vbo_, vnormal_ebo_;
+    GLuint fnormal_vbo_, fnormal_ebo_;
 
     GLuint ebo_;
+    GLenum index_type_;
+    size_t index_buffer_bytes_;
+    GLuint instance_buffer_;
 
     std::vector<glm::vec3> face_centroid_;
 
     std::vector<GLuint> vertex_indices_;
+    // Indices of LOD 1 and up, uploaded right after vertex_indices_; the
+    // ranges in lods_ start at the beginning of lod_indices_
+    std::vector<GLuint> lod_indices_;
+    std::vector<LOD> lods_;
+    IndexOrderStats index_order_stats_;
+    std::vector<Meshlet> meshlets_;
+    VertexFormat vertex_format_;
+    VertexFormatStats vertex_format_stats_;
     std::vector<glm::vec3> vertex_buffer_;
     std::vector<glm::vec2> vertex_uv_;
     std::vector<glm::vec3> vertex_normals_, vertex_normal_display_;
     std::vector<glm::vec3> vertex_tangent_, vertex_bitangent;
 
     glm::vec3 bounding_box_[2];
+    glm::vec3 aabb_[2];
+    MeshBVH bvh_;
     GLfloat normal_length_;
 };
 
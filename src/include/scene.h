@@ -16,6 +16,8 @@ End Header ---------------------------------------------------------*/
 #include <glad/glad.h>  // include glad to get all the required OpenGL headers
 #include <GLFW/glfw3.h>
 
+struct FramePacket;
+
 #define _GET_GL_ERROR   { GLenum err = glGetError(); std::cout << "[OpenGL Error] " << glewGetErrorString(err) << std::endl; }
 
 class Scene
@@ -38,6 +40,16 @@ public:
     // Display : encapsulates per-frame behavior of the scene
     virtual int Display();
 
+    // SupportsRenderThread : the scene splits its frame into BuildFrame and RenderFrame,
+    // otherwise the main thread runs Display and owns the GL context
+    virtual bool SupportsRenderThread() const;
+
+    // BuildFrame : main thread, runs the UI and copies everything the frame draws into the packet
+    virtual void BuildFrame(FramePacket& packet);
+
+    // RenderFrame : thread that owns the GL context, draws the frame from the packet alone
+    virtual int RenderFrame(const FramePacket& packet);
+
     // preRender : called to setup stuff prior to rendering the frame
     virtual int preRender();
 
@@ -58,7 +70,19 @@ public:
 
     virtual void ProcessMouseInput(GLFWwindow* pWwindow);
 
+    // setWindowSize : the size the frame is presented at, follows the window right away
+    void setWindowSize(int width, int height);
+
+    // Resize : called once the window stopped resizing, reallocates size dependent resources.
+    // Runs on the thread that owns the GL context
+    virtual void Resize(int width, int height);
+
 protected:
+    // GL call counters, frame capture and the per frame JSON log
+    void renderGLCallsImGUI();
+    // Same from the counters the packet brought back, the buttons queue commands in it
+    void renderGLCallsImGUI(FramePacket& packet);
+
     int window_height_, window_width_;
 
     // Common functionality for all scene
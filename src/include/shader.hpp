@@ -15,10 +15,12 @@ End Header ---------------------------------------------------------*/
 #include <glad/glad.h>  // include glad to get all the required OpenGL headers
 #include <glm/glm.hpp>
 
+#include <cstdint>
 #include <string>
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <vector>
 
 class Shader
 {
@@ -31,34 +33,58 @@ public:
 
     unsigned loadShader(const char* vertex_file_path, const char* fragment_file_path, const char* geometryPath = nullptr);
     void reloadShader(const char* vertex_file_path, const char* fragment_file_path, const char* geometryPath = nullptr);
+    unsigned loadComputeShader(const char* compute_file_path);
+
+    // Submits the compile and link without asking for their status, so the driver can work
+    // on every program a scene loads at once. The current program, or the fallback if
+    // there is none yet, stays in use until the new one has linked; a failed link keeps it
+    void loadShaderAsync(const char* vertex_file_path, const char* fragment_file_path,
+                         const char* geometryPath = nullptr);
+    // Swaps in a pending program once the driver reports it complete; true when none is pending.
+    // Without KHR_parallel_shader_compile there is no way to ask, so it waits instead
+    bool poll();
+    // Waits for a pending program
+    void finish();
 
     // use/activate the shader
     void use();
+    // Program use binds: this shader's, or the fallback while it has none
     int getHandle();
     void cleanup();
 
     // utility uniform functions
-    void SetUniform(const std::string& name, GLboolean value) const;
-    void SetUniform(const std::string& name, GLint value) const;
-    void SetUniform(const std::string& name, GLuint value) const;
-    void SetUniform(const std::string& name, GLfloat value) const;
-    void SetUniform(const std::string& name, const GLdouble value) const;
-    void SetUniform(const std::string& name, const glm::vec3& value) const;
-    void SetUniform(const std::string& name, const glm::vec2& value) const;
-    void SetUniform(const std::string& name, GLfloat x, GLfloat y, GLfloat z) const;
-    void SetUniform(const std::string& name, const glm::vec4& value) const;
-    void SetUniform(const std::string& name, GLfloat x, GLfloat y, GLfloat z, GLfloat w) const;
-    void SetUniform(const std::string& name, const glm::mat4& mat) const;
-    void SetUniform(const std::string& name, const glm::mat3& mat) const;
-    void SetUniform(const std::string& name, GLuint numParams, const float* params) const;
+    void SetUniform(const char* name, GLboolean value) const;
+    void SetUniform(const char* name, GLint value) const;
+    void SetUniform(const char* name, GLuint value) const;
+    void SetUniform(const char* name, GLfloat value) const;
+    void SetUniform(const char* name, const GLdouble value) const;
+    void SetUniform(const char* name, const glm::vec3& value) const;
+    void SetUniform(const char* name, const glm::vec2& value) const;
+    void SetUniform(const char* name, GLfloat x, GLfloat y, GLfloat z) const;
+    void SetUniform(const char* name, const glm::vec4& value) const;
+    void SetUniform(const char* name, GLfloat x, GLfloat y, GLfloat z, GLfloat w) const;
+    void SetUniform(const char* name, const glm::mat4& mat) const;
+    void SetUniform(const char* name, const glm::mat3& mat) const;
+    void SetUniform(const char* name, GLuint numParams, const float* params) const;
+    void SetUniform(const char* name, GLuint count, const glm::vec4* values) const;
 
 
 private:
-    std::string vertex_code_;
-    std::string fragment_code_;
-    std::string geometry_code_;
-    std::ifstream v_shader_file_;
-    std::ifstream f_shader_file_;
-    std::ifstream g_shader_file_;
+    void beginLoad(const std::vector<GLenum>& stageTypes, const std::vector<std::string>& stagePaths);
+    void completePending();
+    GLint getUniformLocation(const char* name) const;
+
+    static bool hasParallelCompile();
+    static GLuint getFallbackProgram();
+    static void resetFallbackUniforms();
+
+    // Flat shaded stand-in for programs still compiling
+    static GLuint fallback_program_;
+
+    GLuint pending_id_;
+    std::vector<GLuint> pending_shaders_;
+    std::vector<GLenum> pending_stage_types_;
+    std::string pending_cache_file_;
+    uint64_t pending_cache_key_;
 };
 #endif
@@ -23,8 +23,11 @@ End Header ---------------------------------------------------------*/
 #include <imgui_impl_opengl3.h>
 
 #include "Camera.h"
+#include "FramePacket.h"
 #include "mesh.h"
 #include "OBJManager.h"
+#include "RenderQueue.h"
+#include "RenderThread.h"
 #include "scene.h"
 #include "shader.hpp"
 
@@ -38,16 +41,73 @@ public:
 
     int Init(GLFWwindow* pWwindow) override;
 
-    int Render() override;
-    int postRender() override;
+    bool SupportsRenderThread() const override;
+    void BuildFrame(FramePacket& packet) override;
+    int RenderFrame(const FramePacket& packet) override;
+
+    void Resize(int width, int height) override;
 
     void SetupImGUI(GLFWwindow* pWwindow) override;
-    int RenderImGUI() override;
 
     void ProcessInput(GLFWwindow* pWwindow, double dt) override;
 
 private:
+    // A light as the shading shader takes it, already moved along its orbit
+    struct FrameLight
+    {
+        glm::vec3 position;
+        glm::vec3 ambient;
+        glm::vec3 diffuse;
+        glm::vec3 specular;
+        int type;
+        float falloff;
+        float innerAngle, outerAngle;
+    };
+
+    // Settings the frame is drawn with, copied from the members the UI edits
+    struct Frame
+    {
+        Mesh* model;
+        int material;
+        glm::vec3 globalAmbient;
+        glm::vec3 fogColor;
+        float fogMinDist, fogMaxDist;
+        float attenuation[3];
+        float ratio, fresnel, mixRatio;
+        bool bCalcUVGPU, bCalcUVPos;
+        bool bShowUV, bShowReflect, bShowRefract;
+        bool bShowVNormal, bShowFNormal;
+        bool bUseLOD;
+        FrameLight* lights;
+        int lightCount;
+    };
+
+    // Written by the render thread into the slot of the packet it drew
+    struct RenderStats
+    {
+        TextureStreamer::Stats textures;
+        RenderQueue::Stats queue;
+        MaterialLibrary::Stats materials;
+        bool bBindless;
+        size_t arenaBytes;
+        size_t arenaReservedBytes;
+        // Of the packet's model, after the frame's commands changed its vertex format
+        VertexFormat vertexFormat;
+        Mesh::VertexFormatStats vertexStats;
+        GLenum indexType;
+        size_t indexBufferBytes;
+    };
+
     void initMembers();
+    void createEnvironmentTarget();
+    void buildImGUI(FramePacket& packet);
+    // CPU projections rewrite the mesh's UVs, GPU ones only switch the shader's mapping mode
+    void recalculateUVs(Mesh* mesh, const std::string& uvType, bool bCPU, bool bFromPosition);
+    // One instanced draw per queue execute for runs of the same mesh
+    void submitDraws(const FrameDrawItem* draws, unsigned count);
+    glm::mat4 lightSphereModel(int light) const;
+    // Casts a pending click through the model and the light spheres, then copies the last pick into the packet
+    void pickAtCursor(FramePacket& packet);
 
     enum CamDirection { Left, Right, Bottom, Top, Back, Front };
 
@@ -64,25 +124,15 @@ private:
     unsigned int ubo_matirices_;
 
     //matrix for model rendering
-    glm::mat4 model_ = glm::mat4(1.0f);
     glm::vec3 scale_ = glm::vec3(0.0f);
-    glm::mat4 view_ = glm::mat4(1.0f);
-    glm::mat4 projection_ = glm::mat4(1.0f);
-    glm::mat3 normal_matrix_ = glm::mat3(0.0f);
     glm::vec3 global_ambient_ = glm::vec3(0.f, 0.f, 0.1f);
 
     //matrix for drawing normal
-    glm::mat4 draw_norm_model_ = glm::mat4(1.0f);
     glm::vec3 draw_norm_scale_ = glm::vec3(0.0f);
     glm::mat4 draw_norm_view_ = glm::mat4(1.0f);
     glm::mat4 draw_norm_projection_ = glm::mat4(1.0f);
 
-    glm::vec4 light_pos_ = glm::vec4(1.f);
-    glm::vec3 obj_color_ = glm::vec3(0.f);
-    glm::vec3 ka_ = glm::vec3(0.f,0.f,0.01f);
-    glm::vec3 kd_ = glm::vec3(1.f);
-    glm::vec3 ks_ = glm::vec3(1.f);
-
+    //size of the environment map faces, follows the window once a resize settles
     float screen_width_, screen_height_;
 
     float orbit_radius_;
@@ -91,6 +141,7 @@ private:
     float normal_size_;
     bool b_show_v_normal_;
     bool b_show_f_normal_;
+    bool b_use_lod_;
     bool b_reload_shader_;
     bool b_recalc_uv_;
     bool b_rotate_;
@@ -110,7 +161,6 @@ private:
     std::string current_light_num_;
     std::vector<std::string> current_light_type_;
 
-    glm::vec3 light_positions_[16];
     std::vector<glm::vec3> la_;
     std::vector<glm::vec3> ld_;
     std::vector<glm::vec3> ls_;
@@ -120,10 +170,21 @@ private:
     std::vector<float> spot_falloff_;
     int total_light_num_;
 
-    unsigned int diff_texture_;
-    unsigned int spec_texture_;
-    unsigned int grid_texture_;
+    int metal_material_;
+    int grid_material_;
+    // The UI edits this copy, changes reach the library through the frame's commands
+    std::vector<MaterialLibrary::Material> material_edits_;
+    RenderQueue render_queue_;
+    RenderStats render_stats_[RenderThread::PACKET_COUNT] = {};
+
+    //click in NDC, ProcessInput takes it and BuildFrame casts it
+    glm::vec2 pick_cursor_ = glm::vec2(0.f);
+    bool b_pick_pending_ = false;
+    bool b_pick_held_ = false;
+    FramePick pick_ = {};
+    SceneBVH pick_bvh_;
     unsigned int cubemap_texture_[6];
+    std::string cubemap_faces_[6];
 
     float fog_max_dist_;
     float fog_min_dist_;
@@ -139,8 +200,8 @@ private:
 
     unsigned int fbo_;
     unsigned int rbo_;
-    GLuint fb_texture_[6];
-    GLuint skybox_vao_;
+    GLuint env_texture_;
+    GLuint skybox_vao_[6];
     GLuint skybox_vbo_pos_[6];
     GLuint skybox_vbo_uv_;
     GLuint skybox_ebo_;
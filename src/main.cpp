@@ -10,15 +10,20 @@ Project:  HGraphics
 Author: Elliott Hong <s.hong@digipen.edu>
 Creation date: Sep 29, 2021
 End Header ---------------------------------------------------------*/
+#include <cstring>
 #include <iostream>
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 
+#include "AllocationCounter.h"
 #include "DeferredScene.h"
 #include "scene.h"
 #include "simpleScene.h"
 #include "CrashHandler.h"
 #include "Camera.h"
+#include "GLInstrumentation.h"
+#include "JobSystem.h"
+#include "RenderThread.h"
 
 Scene* simple_scene;
 Scene* deferredScene;
@@ -30,9 +35,27 @@ const int windowHeight = 1050;
 double deltaTime = 0.0;
 double lastFrame = 0.0;
 
+// Dragging the window edge fires a callback per pixel; render targets are
+// reallocated once the size has been stable for this long
+const double resizeSettleTime = 0.25;
+bool bResizePending = false;
+double lastResizeTime = 0.0;
+
+// Scenes that support it are drawn on a render thread while the main thread
+// builds the next frame; off, the same frame packets are drawn on the main thread
+const bool bUseRenderThread = true;
+RenderThread renderThread;
+
 void framebuffer_size_callback(GLFWwindow* window, int width, int height)
 {
-    glViewport(0, 0, width, height);
+    // The context may belong to the render thread, which sets the viewport every frame anyway
+    if (!renderThread.isThreaded())
+        glViewport(0, 0, width, height);
+    if (current_scene != nullptr && width > 0 && height > 0)
+        current_scene->setWindowSize(width, height);
+
+    bResizePending = true;
+    lastResizeTime = glfwGetTime();
 }
 
 void mouse_callback(GLFWwindow* window, double xposIn, double yposIn)
@@ -41,7 +64,7 @@ void mouse_callback(GLFWwindow* window, double xposIn, double yposIn)
     Camera::setMousePos((float)xposIn, (float)yposIn);
 }
 
-int main()
+int main(int argc, char** argv)
 {
     if (!glfwInit())
     {
@@ -72,10 +95,22 @@ int main()
         std::cout << "Failed to initialize GLAD" << std::endl;
         return -1;
     }
+    // The wrappers add a call to every GL entry point, they go in only when asked for
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--gl-instrumentation") != 0)
+            continue;
+        if (GLInstrumentation::isCompiledIn())
+            GL_INSTRUMENTATION.install();
+        else
+            std::cout << "GLInstrumentation: built without HGRAPHICS_GL_INSTRUMENTATION" << std::endl;
+    }
 
     CrashHandler::catchStackOverflow();
     SetUnhandledExceptionFilter(CrashHandler::WriteDump);
 
+    JOB_SYSTEM.init();
+
     deferredScene = new DeferredScene(windowWidth, windowHeight);
     simple_scene = new SimpleScene(windowWidth, windowHeight);
     simple_scene->LoadAllModels();
@@ -85,21 +120,74 @@ int main()
     current_scene->Init(window);
     current_scene->SetupImGUI(window);
 
+    if (current_scene->SupportsRenderThread())
+        renderThread.start(window, current_scene, bUseRenderThread);
+
     while (!glfwWindowShouldClose(window))
     {
         double currentFrame = glfwGetTime();
         deltaTime = currentFrame - lastFrame;
         lastFrame = currentFrame;
 
+        // Nothing to draw into while minimized
+        int framebufferWidth, framebufferHeight;
+        glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+        if (framebufferWidth == 0 || framebufferHeight == 0 || glfwGetWindowAttrib(window, GLFW_ICONIFIED))
+        {
+            glfwWaitEvents();
+            lastFrame = glfwGetTime();
+            continue;
+        }
+
+        const bool bResize = bResizePending && currentFrame - lastResizeTime >= resizeSettleTime;
+        if (bResize)
+            bResizePending = false;
+
+        if (renderThread.isStarted())
+        {
+            // Waits only while the render thread is still a whole frame behind
+            FramePacket& packet = renderThread.beginFrame();
+            packet.width = framebufferWidth;
+            packet.height = framebufferHeight;
+            packet.time = currentFrame;
+            packet.deltaTime = deltaTime;
+            if (bResize)
+            {
+                Scene* scene = current_scene;
+                packet.commands.push([scene, framebufferWidth, framebufferHeight]() {
+                    scene->Resize(framebufferWidth, framebufferHeight);
+                });
+            }
+
+            const uint64_t allocations = AllocationCounter::getThreadCount();
+            current_scene->ProcessInput(window, deltaTime);
+            current_scene->BuildFrame(packet);
+
+            ImGui::Render();
+            packet.copyDrawData(ImGui::GetDrawData());
+            packet.stats.buildAllocations = static_cast<unsigned>(AllocationCounter::getThreadCount() - allocations);
+            renderThread.submit(packet);
+            glfwPollEvents();
+            continue;
+        }
+
+        if (bResize)
+            current_scene->Resize(framebufferWidth, framebufferHeight);
+
         current_scene->Display();
         current_scene->ProcessInput(window, deltaTime);
 
         ImGui::Render();
         ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+        GL_INSTRUMENTATION.endFrame();
         glfwSwapBuffers(window);
         glfwPollEvents();
     }
 
+    // Draws the frames still in flight and takes the context back for the cleanup
+    renderThread.stop();
+
+    JOB_SYSTEM.shutdown();
 
     glfwTerminate();
     return 0;
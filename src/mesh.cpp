@@ -12,10 +12,37 @@ Creation date: Sep 29, 2021
 End Header ---------------------------------------------------------*/
 #include "mesh.h"
 
+#include "GLStateCache.h"
+#include "JobSystem.h"
+#include "MeshSimplifier.h"
+
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 #include <set>
 #include <glm/gtc/epsilon.hpp>
 
+namespace
+{
+    // Below this a coarser LOD saves less than the draw range costs
+    const size_t MIN_LOD_INDICES = 3 * 64;
+    // Fewer meshlets than this cull no better than the whole instance
+    const size_t MIN_MESHLET_COUNT = 16;
+    // Indices 0 to 0xFFFE
+    const size_t MAX_SHORT_INDEX_VERTICES = 0xFFFF;
+}
+
+LODView LODView::fromProjection(const glm::vec3& eye, const glm::mat4& projection, float viewportHeight,
+                                float maxPixelError)
+{
+    // projection[1][1] is cot(fovy / 2) or 2 / (top - bottom), either way NDC units per world unit
+    LODView view;
+    view.eye = eye;
+    view.pixelScale = projection[1][1] * viewportHeight * 0.5f;
+    view.bOrthographic = projection[3][3] == 1.f;
+    view.maxPixelError = maxPixelError;
+    return view;
+}
 
 Mesh::Mesh()
 {
@@ -25,10 +52,22 @@ Mesh::Mesh()
     vertex_count_ = 0;
     vbo_pos_ = 0;
     vbo_norm_ = 0;
+    vbo_uv_ = 0;
+    decode_buffer_ = 0;
+    vnormal_vbo_ = vnormal_ebo_ = 0;
+    fnormal_vbo_ = fnormal_ebo_ = 0;
     ebo_ = 0;
+    index_type_ = GL_UNSIGNED_INT;
+    index_buffer_bytes_ = 0;
+    instance_buffer_ = 0;
     face_count_ = 0;
     normal_length_ = 1.00f;
     bounding_box_[0] = glm::vec3(0.f);
+    aabb_[0] = glm::vec3(0.f);
+    aabb_[1] = glm::vec3(0.f);
+    index_order_stats_ = IndexOrderStats{ { 0.f, 0.f }, { 0.f, 0.f }, false };
+    vertex_format_ = VertexFormat::QUANTIZED_OCT16;
+    vertex_format_stats_ = VertexFormatStats{ 0, 0, 0.f, 0.f, 0.f };
     initData();
 }
 
@@ -39,8 +78,16 @@ Mesh::~Mesh()
 		glDeleteBuffers(1, &vbo_pos_);
     if (glIsBuffer(vbo_norm_))
 		glDeleteBuffers(1, &vbo_norm_);
+    if (glIsBuffer(vbo_uv_))
+		glDeleteBuffers(1, &vbo_uv_);
+    if (glIsBuffer(decode_buffer_))
+		glDeleteBuffers(1, &decode_buffer_);
     if (glIsBuffer(ebo_))
 		glDeleteBuffers(1, &ebo_);
+    const GLuint normalBuffers[] = { vnormal_vbo_, vnormal_ebo_, fnormal_vbo_, fnormal_ebo_ };
+    GL_STATE.deleteBuffers(4, normalBuffers);
+    const GLuint vaos[] = { vao_, vnormal_vao_, fnormal_vao_ };
+    GL_STATE.deleteVertexArrays(3, vaos);
     if(!vertex_indices_.empty())
 		glDeleteBuffers(1, vertex_indices_.data());
     vertex_indices_.clear();
@@ -61,20 +108,196 @@ void Mesh::render(int Flag) const
 
     if (Flag == 0)
     {
-        glBindVertexArray(vao_);
-        glDrawElements(GL_TRIANGLES, vertex_count_, GL_UNSIGNED_INT, 0);
+        GL_STATE.bindVertexArray(vao_);
+        glDrawElements(GL_TRIANGLES, vertex_count_, index_type_, 0);
     }
     else if (Flag == 1)
     {
-        glBindVertexArray(vnormal_vao_);
+        GL_STATE.bindVertexArray(vnormal_vao_);
         glDrawArrays(GL_LINES, 0, face_count_);
     }
     else if (Flag == 2)
     {
-        glBindVertexArray(fnormal_vao_);
+        GL_STATE.bindVertexArray(fnormal_vao_);
         glDrawArrays(GL_LINES, 0, face_count_);
     }
-    glBindVertexArray(0);
+}
+
+void Mesh::renderIndirect(GLintptr commandOffset) const
+{
+    if (vao_ == 0) return;
+
+    GL_STATE.bindVertexArray(vao_);
+    glDrawElementsIndirect(GL_TRIANGLES, index_type_, reinterpret_cast<const void*>(commandOffset));
+}
+
+void Mesh::renderMultiIndirect(GLintptr commandOffset, GLsizei drawCount) const
+{
+    if (vao_ == 0 || drawCount == 0) return;
+
+    GL_STATE.bindVertexArray(vao_);
+    glMultiDrawElementsIndirect(GL_TRIANGLES, index_type_, reinterpret_cast<const void*>(commandOffset), drawCount, 0);
+}
+
+void Mesh::bindVertexArray() const
+{
+    GL_STATE.bindVertexArray(vao_);
+}
+
+void Mesh::renderInstanced(GLsizei instanceCount, unsigned lod) const
+{
+    if (vao_ == 0) return;
+
+    const LOD level = getLOD(lod);
+    const size_t indexSize = index_type_ == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLuint);
+    glDrawElementsInstanced(GL_TRIANGLES, level.indexCount, index_type_,
+                            reinterpret_cast<const void*>(static_cast<uintptr_t>(level.firstIndex) * indexSize),
+                            instanceCount);
+}
+
+void Mesh::setInstanceBuffer(GLuint instanceBuffer)
+{
+    instance_buffer_ = instanceBuffer;
+    if (vao_ == 0 || instance_buffer_ == 0) return;
+
+    GL_STATE.bindVertexArray(vao_);
+    GL_STATE.bindBuffer(GL_ARRAY_BUFFER, instance_buffer_);
+    glEnableVertexAttribArray(4);
+    glVertexAttribIPointer(4, 1, GL_UNSIGNED_INT, sizeof(GLuint), static_cast<void*>(0));
+    glVertexAttribDivisor(4, 1);
+    GL_STATE.bindVertexArray(0);
+}
+
+void Mesh::buildBVH()
+{
+    bvh_.build(vertex_buffer_.data(), vertex_indices_.data(), getTriangleCount());
+}
+
+const MeshBVH& Mesh::getBVH() const
+{
+    return bvh_;
+}
+
+void Mesh::optimizeIndexOrder()
+{
+    const size_t vertexCount = vertex_buffer_.size();
+    index_order_stats_.before = MeshOptimizer::analyzeVertexCache(vertex_indices_.data(), vertex_indices_.size(),
+                                                                  vertexCount);
+
+    MeshOptimizer::optimizeVertexCache(vertex_indices_.data(), vertex_indices_.size(), vertexCount);
+    MeshOptimizer::optimizeOverdraw(vertex_indices_.data(), vertex_indices_.size(), vertex_buffer_.data(),
+                                    vertexCount);
+
+    // Every per vertex array follows the new numbering; the ones not filled yet are skipped
+    std::vector<GLuint> remap;
+    MeshOptimizer::optimizeVertexFetch(vertex_indices_.data(), vertex_indices_.size(), vertexCount, remap);
+    MeshOptimizer::remapVertices(vertex_buffer_, remap);
+    MeshOptimizer::remapVertices(vertex_normals_, remap);
+    MeshOptimizer::remapVertices(vertex_uv_, remap);
+    MeshOptimizer::remapVertices(vertex_tangent_, remap);
+    MeshOptimizer::remapVertices(vertex_bitangent, remap);
+
+    index_order_stats_.after = MeshOptimizer::analyzeVertexCache(vertex_indices_.data(), vertex_indices_.size(),
+                                                                 vertexCount);
+    index_order_stats_.bOptimized = true;
+}
+
+const Mesh::IndexOrderStats& Mesh::getIndexOrderStats() const
+{
+    return index_order_stats_;
+}
+
+void Mesh::buildMeshlets()
+{
+    meshlets_.clear();
+    if (getTriangleCount() < MIN_MESHLET_COUNT * MESHLET_MAX_TRIANGLES)
+        return;
+
+    const glm::vec3* normals = vertex_normals_.size() == vertex_buffer_.size() ? vertex_normals_.data() : nullptr;
+    MeshOptimizer::buildMeshlets(vertex_indices_.data(), vertex_indices_.size(), vertex_buffer_.data(), normals,
+                                 vertex_buffer_.size(), MESHLET_MAX_VERTICES, MESHLET_MAX_TRIANGLES, meshlets_);
+
+    // The triangles moved, what the cache sees now is what gets drawn
+    if (index_order_stats_.bOptimized)
+        index_order_stats_.after = MeshOptimizer::analyzeVertexCache(vertex_indices_.data(), vertex_indices_.size(),
+                                                                     vertex_buffer_.size());
+}
+
+const std::vector<Meshlet>& Mesh::getMeshlets() const
+{
+    return meshlets_;
+}
+
+void Mesh::buildLODs(unsigned maxLevels)
+{
+    lod_indices_.clear();
+    lods_.clear();
+
+    // Every level starts from the full mesh so its error is measured against it
+    std::vector<GLuint> simplified;
+    size_t previousCount = vertex_indices_.size();
+    float error = 0.f;
+    for (unsigned level = 1; level <= maxLevels; ++level)
+    {
+        const size_t target = previousCount / 2 / 3 * 3;
+        if (target < MIN_LOD_INDICES)
+            break;
+
+        const float levelError = MeshSimplifier::simplify(vertex_buffer_.data(), vertex_buffer_.size(),
+                                                          vertex_indices_.data(), vertex_indices_.size(), target,
+                                                          FLT_MAX, simplified);
+        // Locked seams and borders can stop it short; a level that barely shrank isn't worth keeping
+        if (simplified.size() * 10 > previousCount * 9)
+            break;
+
+        error = std::max(error, levelError);
+        MeshOptimizer::optimizeVertexCache(simplified.data(), simplified.size(), vertex_buffer_.size());
+        MeshOptimizer::optimizeOverdraw(simplified.data(), simplified.size(), vertex_buffer_.data(),
+                                        vertex_buffer_.size());
+        lods_.push_back({ static_cast<GLuint>(lod_indices_.size()), static_cast<GLuint>(simplified.size()), error });
+        lod_indices_.insert(lod_indices_.end(), simplified.begin(), simplified.end());
+        previousCount = simplified.size();
+    }
+}
+
+unsigned Mesh::getLODCount() const
+{
+    return static_cast<unsigned>(lods_.size()) + 1;
+}
+
+Mesh::LOD Mesh::getLOD(unsigned lod) const
+{
+    if (lod == 0 || lod > lods_.size())
+        return { 0, static_cast<GLuint>(vertex_indices_.size()), 0.f };
+
+    LOD level = lods_[lod - 1];
+    level.firstIndex += static_cast<GLuint>(vertex_indices_.size());
+    return level;
+}
+
+unsigned Mesh::selectLOD(const LODView& view, const glm::mat4& model) const
+{
+    if (lods_.empty())
+        return 0;
+
+    const float scale = std::max(std::max(glm::length(glm::vec3(model[0])), glm::length(glm::vec3(model[1]))),
+                                 glm::length(glm::vec3(model[2])));
+    float pixelsPerUnit = view.pixelScale * scale;
+    if (!view.bOrthographic)
+    {
+        // Distance to the bounding sphere, a camera inside it gets the full mesh
+        const glm::vec3 center = glm::vec3(model * glm::vec4((aabb_[0] + aabb_[1]) * 0.5f, 1.f));
+        const float radius = glm::length(aabb_[1] - aabb_[0]) * 0.5f * scale;
+        const float distance = glm::length(center - view.eye) - radius;
+        if (distance <= 0.f)
+            return 0;
+        pixelsPerUnit /= distance;
+    }
+
+    unsigned lod = 0;
+    while (lod < lods_.size() && lods_[lod].error * pixelsPerUnit <= view.maxPixelError)
+        ++lod;
+    return lod;
 }
 
 void Mesh::setupMesh()
@@ -82,94 +305,216 @@ void Mesh::setupMesh()
     vertex_count_ = static_cast<GLuint>(vertex_indices_.size());
     face_count_ = getTriangleCount() * 2;
 
+    aabb_[0] = glm::vec3(FLT_MAX);
+    aabb_[1] = glm::vec3(-FLT_MAX);
+    for (const auto& v : vertex_buffer_)
+    {
+        aabb_[0] = glm::min(aabb_[0], v);
+        aabb_[1] = glm::max(aabb_[1], v);
+    }
+
+    // Runs again when the vertex format or the UVs change, the old objects go first
+    GL_STATE.deleteVertexArrays(1, &vao_);
+    const GLuint buffers[] = { vbo_pos_, vbo_norm_, vbo_uv_, decode_buffer_, ebo_ };
+    GL_STATE.deleteBuffers(5, buffers);
+    vbo_norm_ = vbo_uv_ = 0;
+
     glGenVertexArrays(1, &vao_);
     glGenBuffers(1, &vbo_pos_);
     glGenBuffers(1, &ebo_);
 
-    glBindVertexArray(vao_);
+    GL_STATE.bindVertexArray(vao_);
 
-    glBindBuffer(GL_ARRAY_BUFFER, vbo_pos_);
-    glBufferData(GL_ARRAY_BUFFER, vertex_buffer_.size() * sizeof(GLfloat) * 3, vertex_buffer_.data(), GL_STATIC_DRAW);
-
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo_);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, vertex_indices_.size() * sizeof(GLuint), vertex_indices_.data(), GL_STATIC_DRAW);
-
-    if (!vertex_normals_.empty())
+    // Every LOD shares the one index buffer, the coarser ones after the full mesh. Half
+    // the size when the vertices fit in 16 bits; 0xFFFF stays free for a restart index
+    GL_STATE.bindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo_);
+    index_type_ = vertex_buffer_.size() <= MAX_SHORT_INDEX_VERTICES ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+    if (index_type_ == GL_UNSIGNED_SHORT)
     {
-        glGenBuffers(1, &vbo_norm_);
-        glBindBuffer(GL_ARRAY_BUFFER, vbo_norm_);
-        glBufferData(GL_ARRAY_BUFFER, vertex_normals_.size() * sizeof(GLfloat) * 3, vertex_normals_.data(), GL_STATIC_DRAW);
+        std::vector<GLushort> shortIndices;
+        shortIndices.reserve(vertex_indices_.size() + lod_indices_.size());
+        shortIndices.insert(shortIndices.end(), vertex_indices_.begin(), vertex_indices_.end());
+        shortIndices.insert(shortIndices.end(), lod_indices_.begin(), lod_indices_.end());
+        index_buffer_bytes_ = shortIndices.size() * sizeof(GLushort);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, index_buffer_bytes_, shortIndices.data(), GL_STATIC_DRAW);
     }
-
-    if (!vertex_uv_.empty())
+    else
     {
-        glGenBuffers(1, &vbo_uv_);
-        glBindBuffer(GL_ARRAY_BUFFER, vbo_uv_);
-        glBufferData(GL_ARRAY_BUFFER, vertex_uv_.size() * sizeof(GLfloat) * 2, vertex_uv_.data(), GL_STATIC_DRAW);
+        const GLsizeiptr indexBytes = vertex_indices_.size() * sizeof(GLuint);
+        index_buffer_bytes_ = indexBytes + lod_indices_.size() * sizeof(GLuint);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, index_buffer_bytes_, nullptr, GL_STATIC_DRAW);
+        glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, indexBytes, vertex_indices_.data());
+        if (!lod_indices_.empty())
+            glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, indexBytes, lod_indices_.size() * sizeof(GLuint),
+                            lod_indices_.data());
     }
 
-    glBindBuffer(GL_ARRAY_BUFFER, vbo_pos_);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(GLfloat) * 3, static_cast<void*>(0));
+    VertexFormatStats& stats = vertex_format_stats_;
+    stats = VertexFormatStats{ 0, 0, 0.f, 0.f, 0.f };
+    stats.floatBytes = vertex_buffer_.size() * sizeof(glm::vec3) + vertex_normals_.size() * sizeof(glm::vec3) +
+                       vertex_uv_.size() * sizeof(glm::vec2);
+    stats.bytes = sizeof(VertexDecode);
+    VertexDecode decode = VertexQuantizer::identityDecode();
 
-    if (!vertex_normals_.empty())
+    if (vertex_format_ == VertexFormat::FLOAT)
     {
-        glBindBuffer(GL_ARRAY_BUFFER, vbo_norm_);
-        glEnableVertexAttribArray(1);
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(GLfloat) * 3, static_cast<void*>(0));
-    }
+        stats.bytes += stats.floatBytes;
+
+        GL_STATE.bindBuffer(GL_ARRAY_BUFFER, vbo_pos_);
+        glBufferData(GL_ARRAY_BUFFER, vertex_buffer_.size() * sizeof(GLfloat) * 3, vertex_buffer_.data(), GL_STATIC_DRAW);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(GLfloat) * 3, static_cast<void*>(0));
+
+        if (!vertex_normals_.empty())
+        {
+            glGenBuffers(1, &vbo_norm_);
+            GL_STATE.bindBuffer(GL_ARRAY_BUFFER, vbo_norm_);
+            glBufferData(GL_ARRAY_BUFFER, vertex_normals_.size() * sizeof(GLfloat) * 3, vertex_normals_.data(), GL_STATIC_DRAW);
+            glEnableVertexAttribArray(1);
+            glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(GLfloat) * 3, static_cast<void*>(0));
+        }
 
-    if (!vertex_uv_.empty())
+        if (!vertex_uv_.empty())
+        {
+            glGenBuffers(1, &vbo_uv_);
+            GL_STATE.bindBuffer(GL_ARRAY_BUFFER, vbo_uv_);
+            glBufferData(GL_ARRAY_BUFFER, vertex_uv_.size() * sizeof(GLfloat) * 2, vertex_uv_.data(), GL_STATIC_DRAW);
+            glEnableVertexAttribArray(2);
+            glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(GLfloat) * 2, static_cast<void*>(0));
+        }
+    }
+    else
     {
-        glBindBuffer(GL_ARRAY_BUFFER, vbo_uv_);
-        glEnableVertexAttribArray(2);
-        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(GLfloat) * 2, static_cast<void*>(0));
+        // Positions in 8 bytes; the last two hold the 2x8 normal when it fits
+        std::vector<glm::u16vec4> positions;
+        VertexQuantizer::quantizePositions(vertex_buffer_, aabb_[0], aabb_[1], positions, decode,
+                                           stats.maxPositionError);
+        const bool bPackedNormals = vertex_format_ == VertexFormat::QUANTIZED_OCT8;
+        if (!vertex_normals_.empty())
+            decode.positionOffset.w = 1.f;
+
+        std::vector<glm::i16vec2> normals;
+        if (!vertex_normals_.empty() && bPackedNormals)
+        {
+            std::vector<glm::i8vec2> packed;
+            VertexQuantizer::quantizeNormals(vertex_normals_, packed, stats.maxNormalError);
+            for (size_t i = 0; i < packed.size() && i < positions.size(); ++i)
+                std::memcpy(&positions[i].w, &packed[i], sizeof(glm::i8vec2));
+        }
+        else if (!vertex_normals_.empty())
+            VertexQuantizer::quantizeNormals(vertex_normals_, normals, stats.maxNormalError);
+
+        GL_STATE.bindBuffer(GL_ARRAY_BUFFER, vbo_pos_);
+        glBufferData(GL_ARRAY_BUFFER, positions.size() * sizeof(glm::u16vec4), positions.data(), GL_STATIC_DRAW);
+        stats.bytes += positions.size() * sizeof(glm::u16vec4);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(glm::u16vec4), static_cast<void*>(0));
+        if (!vertex_normals_.empty() && bPackedNormals)
+        {
+            glEnableVertexAttribArray(1);
+            glVertexAttribPointer(1, 2, GL_BYTE, GL_TRUE, sizeof(glm::u16vec4),
+                                  reinterpret_cast<void*>(3 * sizeof(GLushort)));
+        }
+
+        if (!normals.empty())
+        {
+            glGenBuffers(1, &vbo_norm_);
+            GL_STATE.bindBuffer(GL_ARRAY_BUFFER, vbo_norm_);
+            glBufferData(GL_ARRAY_BUFFER, normals.size() * sizeof(glm::i16vec2), normals.data(), GL_STATIC_DRAW);
+            stats.bytes += normals.size() * sizeof(glm::i16vec2);
+            glEnableVertexAttribArray(1);
+            glVertexAttribPointer(1, 2, GL_SHORT, GL_TRUE, sizeof(glm::i16vec2), static_cast<void*>(0));
+        }
+
+        if (!vertex_uv_.empty())
+        {
+            std::vector<glm::u16vec2> uvs;
+            VertexQuantizer::quantizeUVs(vertex_uv_, uvs, decode, stats.maxUVError);
+            glGenBuffers(1, &vbo_uv_);
+            GL_STATE.bindBuffer(GL_ARRAY_BUFFER, vbo_uv_);
+            glBufferData(GL_ARRAY_BUFFER, uvs.size() * sizeof(glm::u16vec2), uvs.data(), GL_STATIC_DRAW);
+            stats.bytes += uvs.size() * sizeof(glm::u16vec2);
+            glEnableVertexAttribArray(2);
+            glVertexAttribPointer(2, 2, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(glm::u16vec2), static_cast<void*>(0));
+        }
     }
 
-    glBindVertexArray(0);
+    // Float meshes get the identity so the shaders decode every mesh alike
+    decode_buffer_ = VertexQuantizer::createDecodeBuffer(decode);
+    VertexQuantizer::bindDecodeBuffer(decode_buffer_);
+
+    GL_STATE.bindVertexArray(0);
+
+    // Recreated VAO must keep reading the culler's instance IDs
+    setInstanceBuffer(instance_buffer_);
+}
+
+void Mesh::setVertexFormat(VertexFormat format)
+{
+    vertex_format_ = format;
+}
+
+VertexFormat Mesh::getVertexFormat() const
+{
+    return vertex_format_;
+}
+
+const Mesh::VertexFormatStats& Mesh::getVertexFormatStats() const
+{
+    return vertex_format_stats_;
+}
+
+GLenum Mesh::getIndexType() const
+{
+    return index_type_;
+}
+
+size_t Mesh::getIndexBufferBytes() const
+{
+    return index_buffer_bytes_;
 }
 
 void Mesh::setupVNormalMesh()
 {
     glGenVertexArrays(1, &vnormal_vao_);
-    glGenBuffers(1, &vbo_pos_);
-    glGenBuffers(1, &ebo_);
+    glGenBuffers(1, &vnormal_vbo_);
+    glGenBuffers(1, &vnormal_ebo_);
 
-    glBindVertexArray(vnormal_vao_);
+    GL_STATE.bindVertexArray(vnormal_vao_);
 
-    glBindBuffer(GL_ARRAY_BUFFER, vbo_pos_);
+    GL_STATE.bindBuffer(GL_ARRAY_BUFFER, vnormal_vbo_);
     glBufferData(GL_ARRAY_BUFFER, vertex_normal_display_.size() * sizeof(GLfloat) * 3, vertex_normal_display_.data(),
                  GL_STATIC_DRAW);
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo_);
+    GL_STATE.bindBuffer(GL_ELEMENT_ARRAY_BUFFER, vnormal_ebo_);
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, vertex_indices_.size() * sizeof(GLuint), vertex_indices_.data(), GL_STATIC_DRAW);
 
-    glBindBuffer(GL_ARRAY_BUFFER, vbo_pos_);
+    GL_STATE.bindBuffer(GL_ARRAY_BUFFER, vnormal_vbo_);
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(GLfloat) * 3, static_cast<void*>(0));
 
-    glBindVertexArray(0);
+    GL_STATE.bindVertexArray(0);
 }
 
 void Mesh::setupFNormalMesh()
 {
     glGenVertexArrays(1, &fnormal_vao_);
-    glGenBuffers(1, &vbo_pos_);
-    glGenBuffers(1, &ebo_);
+    glGenBuffers(1, &fnormal_vbo_);
+    glGenBuffers(1, &fnormal_ebo_);
 
-    glBindVertexArray(fnormal_vao_);
+    GL_STATE.bindVertexArray(fnormal_vao_);
 
-    glBindBuffer(GL_ARRAY_BUFFER, vbo_pos_);
+    GL_STATE.bindBuffer(GL_ARRAY_BUFFER, fnormal_vbo_);
     glBufferData(GL_ARRAY_BUFFER, face_centroid_.size() * sizeof(GLfloat) * 3, face_centroid_.data(), GL_STATIC_DRAW);
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo_);
+    GL_STATE.bindBuffer(GL_ELEMENT_ARRAY_BUFFER, fnormal_ebo_);
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, vertex_indices_.size() * sizeof(GLuint), vertex_indices_.data(), GL_STATIC_DRAW);
 
-    glBindBuffer(GL_ARRAY_BUFFER, vbo_pos_);
+    GL_STATE.bindBuffer(GL_ARRAY_BUFFER, fnormal_vbo_);
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(GLfloat) * 3, static_cast<void*>(0));
 
-    glBindVertexArray(0);
+    GL_STATE.bindVertexArray(0);
 }
 
 
@@ -266,6 +611,16 @@ glm::vec3 Mesh::getMaxBound() const
     return bounding_box_[1];
 }
 
+glm::vec3 Mesh::getAABBMin() const
+{
+    return aabb_[0];
+}
+
+glm::vec3 Mesh::getAABBMax() const
+{
+    return aabb_[1];
+}
+
 struct compareVec
 {
     bool operator()(const glm::vec3& lhs, const glm::vec3& rhs) const
@@ -294,70 +649,89 @@ int Mesh::calcVertexNormals(GLboolean bFlipNormals)
     vertex_normal_display_.resize(static_cast<__int64>(numVertices) * 2, glm::vec3(0.0f));
     face_centroid_.resize(static_cast<__int64>(getTriangleCount())* 2, glm::vec3(0.f));
 
-    std::vector<std::set<glm::vec3, compareVec>> vNormalSet;
-    vNormalSet.resize(numVertices);
     setNormalLength(0.1f);
 
-    // For every face
-    size_t index = 0;
-    while (index < vertex_indices_.size())
+    // For every face, in parallel: each face writes only its own slots
+    const size_t faceCount = getTriangleCount();
+    std::vector<glm::vec3> faceNormals(faceCount);
+    JOB_SYSTEM.parallelFor(0, faceCount, 4096, [&](size_t first, size_t last)
     {
-        GLuint a = vertex_indices_.at(index++);
-        GLuint b = vertex_indices_.at(index++);
-        GLuint c = vertex_indices_.at(index++);
+        for (size_t face = first; face < last; ++face)
+        {
+            GLuint a = vertex_indices_[3 * face];
+            GLuint b = vertex_indices_[3 * face + 1];
+            GLuint c = vertex_indices_[3 * face + 2];
 
-        glm::vec3 vA = vertex_buffer_[a];
-        glm::vec3 vB = vertex_buffer_[b];
-        glm::vec3 vC = vertex_buffer_[c];
+            glm::vec3 vA = vertex_buffer_[a];
+            glm::vec3 vB = vertex_buffer_[b];
+            glm::vec3 vC = vertex_buffer_[c];
 
-        // Edge vectors
-        glm::vec3 E1 = vB - vA;
-        glm::vec3 E2 = vC - vA;
+            // Edge vectors
+            glm::vec3 E1 = vB - vA;
+            glm::vec3 E2 = vC - vA;
 
-        glm::vec3 N = glm::normalize(glm::cross(E1, E2));
+            glm::vec3 N = glm::normalize(glm::cross(E1, E2));
 
-        glm::vec3 faceCenter = (vA + vB + vC) / 3.f;
-        face_centroid_[(static_cast<__int64>(index) / 3 - 1) * 2] = (faceCenter);
+            glm::vec3 faceCenter = (vA + vB + vC) / 3.f;
+            face_centroid_[face * 2] = (faceCenter);
 
-        glm::vec3 F1 = vA - faceCenter;
-        glm::vec3 F2 = vB - faceCenter;
-        glm::vec3 fN = glm::normalize(glm::cross(F1, F2));
+            glm::vec3 F1 = vA - faceCenter;
+            glm::vec3 F2 = vB - faceCenter;
+            glm::vec3 fN = glm::normalize(glm::cross(F1, F2));
 
-        if (bFlipNormals)
-            fN = fN * -1.0f;
+            if (bFlipNormals)
+                fN = fN * -1.0f;
 
-        face_centroid_[(static_cast<__int64>(index) / 3 - 1) * 2 + 1] = (faceCenter) + normal_length_ * fN;
+            face_centroid_[face * 2 + 1] = (faceCenter) + normal_length_ * fN;
 
-        if (bFlipNormals)
-            N = N * -1.0f;
+            if (bFlipNormals)
+                N = N * -1.0f;
 
-        // For vertex a
-        vNormalSet.at(a).insert(N);
-        vNormalSet.at(b).insert(N);
-        vNormalSet.at(c).insert(N);
-    }
-
-    // Now sum up the values per vertex
-    for (int i = 0; i < vNormalSet.size(); ++i)
+            faceNormals[face] = N;
+        }
+    });
+
+    // Faces around every vertex, grouped by a counting sort so the vertices can be summed in parallel
+    std::vector<GLuint> faceStart(static_cast<size_t>(numVertices) + 1, 0);
+    for (size_t index = 0; index < faceCount * 3; ++index)
+        ++faceStart.at(static_cast<size_t>(vertex_indices_[index]) + 1);
+    for (GLuint i = 0; i < numVertices; ++i)
+        faceStart[i + 1] += faceStart[i];
+
+    std::vector<GLuint> vertexFaces(faceCount * 3);
+    std::vector<GLuint> cursor(faceStart.begin(), faceStart.end() - 1);
+    for (size_t index = 0; index < faceCount * 3; ++index)
+        vertexFaces[cursor[vertex_indices_[index]]++] = static_cast<GLuint>(index / 3);
+
+    // Now sum up the values per vertex, faces in the same plane count once
+    JOB_SYSTEM.parallelFor(0, numVertices, 2048, [&](size_t first, size_t last)
     {
-        glm::vec3 vNormal(0.0f);
-
-        auto nIt = vNormalSet[i].begin();
-        while (nIt != vNormalSet[i].end())
+        std::set<glm::vec3, compareVec> vNormalSet;
+        for (size_t i = first; i < last; ++i)
         {
-            vNormal += (*nIt);
-            ++nIt;
-        }
+            vNormalSet.clear();
+            for (GLuint k = faceStart[i]; k < faceStart[i + 1]; ++k)
+                vNormalSet.insert(faceNormals[vertexFaces[k]]);
 
-        // save vertex normal
-        vertex_normals_[i] = glm::normalize(vNormal);
+            glm::vec3 vNormal(0.0f);
 
-        // save normal to display
-        glm::vec3 vA = vertex_buffer_[i];
+            auto nIt = vNormalSet.begin();
+            while (nIt != vNormalSet.end())
+            {
+                vNormal += (*nIt);
+                ++nIt;
+            }
 
-        vertex_normal_display_[2 * static_cast<__int64>(i)] = vA;
-        vertex_normal_display_[(2 * static_cast<__int64>(i)) + 1] = vA + (normal_length_ * vertex_normals_[i]);
-    }
+            // save vertex normal
+            vertex_normals_[i] = glm::normalize(vNormal);
+
+            // save normal to display
+            glm::vec3 vA = vertex_buffer_[i];
+
+            vertex_normal_display_[2 * i] = vA;
+            vertex_normal_display_[(2 * i) + 1] = vA + (normal_length_ * vertex_normals_[i]);
+        }
+    });
 
     // success
     rFlag = 0;
@@ -402,63 +776,67 @@ int Mesh::calcUVs(UVType uvType, bool posEntity)
     vertex_uv_.clear();
 
     glm::vec3 delta = getModelScale();
-    glm::vec3 centroidVec = glm::vec3(0.f);
     size_t vboSize = vertex_buffer_.size();
-    vertex_uv_.reserve(vboSize);
+    vertex_uv_.resize(vboSize);
 
-    for (size_t nVertex = 0; nVertex < vboSize; ++nVertex)
+    // Every vertex maps on its own
+    JOB_SYSTEM.parallelFor(0, vboSize, 8192, [&](size_t first, size_t last)
     {
-        glm::vec3 V = vertex_buffer_[nVertex];
-        glm::vec2 uv(0.0f);
+        glm::vec3 centroidVec = glm::vec3(0.f);
+        for (size_t nVertex = first; nVertex < last; ++nVertex)
+        {
+            glm::vec3 V = vertex_buffer_[nVertex];
+            glm::vec2 uv(0.0f);
 
-        glm::vec3 normVertex = glm::vec3((V.x - bounding_box_[0].x) / delta.x,
-                                         (V.y - bounding_box_[0].y) / delta.y,
-                                         (V.z - bounding_box_[0].z) / delta.z);
-        if (posEntity)
-            centroidVec = V;//getCentroidVector(V);
-        else
-            centroidVec = glm::normalize(normVertex);
+            glm::vec3 normVertex = glm::vec3((V.x - bounding_box_[0].x) / delta.x,
+                                             (V.y - bounding_box_[0].y) / delta.y,
+                                             (V.z - bounding_box_[0].z) / delta.z);
+            if (posEntity)
+                centroidVec = V;//getCentroidVector(V);
+            else
+                centroidVec = glm::normalize(normVertex);
 
 
-        float theta(0.0f);
-        float z(0.0f);
-        float phi(0.0f);
+            float theta(0.0f);
+            float z(0.0f);
+            float phi(0.0f);
 
-        switch (uvType)
-        {
-        case UVType::PLANAR_UV:
-            uv.x = (centroidVec.x - (-1.0f)) / (2.0f);
-            uv.y = (centroidVec.y - (-1.0f)) / (2.0f);
-            break;
+            switch (uvType)
+            {
+            case UVType::PLANAR_UV:
+                uv.x = (centroidVec.x - (-1.0f)) / (2.0f);
+                uv.y = (centroidVec.y - (-1.0f)) / (2.0f);
+                break;
 
-        case UVType::CYLINDRICAL_UV:
-            theta = glm::degrees(glm::atan(centroidVec.z, centroidVec.x));
-            theta += 180.0f;
+            case UVType::CYLINDRICAL_UV:
+                theta = glm::degrees(glm::atan(centroidVec.z, centroidVec.x));
+                theta += 180.0f;
 
-            //z = (centroidVec.z + 1.0f) * 0.5f;
-            z = centroidVec.y;
+                //z = (centroidVec.z + 1.0f) * 0.5f;
+                z = centroidVec.y;
 
-            uv.x = 1 - theta / 360.f;
-            uv.y = (z - bounding_box_[0].y) / (bounding_box_[1].y - bounding_box_[0].y);
-            break;
+                uv.x = 1 - theta / 360.f;
+                uv.y = (z - bounding_box_[0].y) / (bounding_box_[1].y - bounding_box_[0].y);
+                break;
 
-        case UVType::SPHERICAL_UV:
-            theta = glm::degrees(glm::atan(centroidVec.z, centroidVec.x));
-            theta += 180.0f;
+            case UVType::SPHERICAL_UV:
+                theta = glm::degrees(glm::atan(centroidVec.z, centroidVec.x));
+                theta += 180.0f;
 
-            phi = 180.f - acosf(centroidVec.y / centroidVec.length()) * 180.f / acosf(-1);
+                phi = 180.f - acosf(centroidVec.y / centroidVec.length()) * 180.f / acosf(-1);
 
-            uv.x =  1 - theta / 360.0f;
-            uv.y = (phi / 180.0f);
-            break;
+                uv.x =  1 - theta / 360.0f;
+                uv.y = (phi / 180.0f);
+                break;
 
-        case UVType::CUBE_MAPPED_UV:
-            uv = calcCubeMap(centroidVec);
-            break;
-        }
+            case UVType::CUBE_MAPPED_UV:
+                uv = calcCubeMap(centroidVec);
+                break;
+            }
 
-        vertex_uv_.push_back(uv);
-    }
+            vertex_uv_[nVertex] = uv;
+        }
+    });
 
     //unsigned int index = 0;
     //for (; index < vertex_indices_.size();)
@@ -12,6 +12,13 @@ Creation date: Sep 29, 2021
 End Header ---------------------------------------------------------*/
 #include "scene.h"
 
+#include <string>
+#include <imgui.h>
+#include "AllocationCounter.h"
+#include "FramePacket.h"
+#include "FrameArena.h"
+#include "GLInstrumentation.h"
+#include "GLStateCache.h"
 #include "OBJManager.h"
 
 Scene::Scene()
@@ -37,17 +44,19 @@ void Scene::LoadAllModels()
 
     //OBJ_MANAGER->ReadSectionFile("models/Power_Plant_Files/Section1.txt");
 
-    OBJ_MANAGER->loadOBJFile("../assets/models/quad.obj", "quad", false, Mesh::UVType::PLANAR_UV);
-    OBJ_MANAGER->loadOBJFile("../assets/models/sphere.obj", "sphere", false, Mesh::UVType::CUBE_MAPPED_UV);
-    OBJ_MANAGER->loadOBJFile("../assets/models/bunny_high_poly.obj", "bunny_high_poly", false, Mesh::UVType::CUBE_MAPPED_UV);
-    OBJ_MANAGER->loadOBJFile("../assets/models/cube.obj", "cube", true, Mesh::UVType::CUBE_MAPPED_UV);
-    OBJ_MANAGER->loadOBJFile("../assets/models/4Sphere.obj", "4Sphere", false, Mesh::UVType::CUBE_MAPPED_UV);
-    OBJ_MANAGER->loadOBJFile("../assets/models/bunny.obj", "bunny", false, Mesh::UVType::CUBE_MAPPED_UV);
-    OBJ_MANAGER->loadOBJFile("../assets/models/cup.obj", "cup", false, Mesh::UVType::CUBE_MAPPED_UV);
-    OBJ_MANAGER->loadOBJFile("../assets/models/cube2.obj", "cube2", false, Mesh::UVType::CUBE_MAPPED_UV);
-    OBJ_MANAGER->loadOBJFile("../assets/models/rhino.obj", "rhino", false, Mesh::UVType::CUBE_MAPPED_UV);
-    OBJ_MANAGER->loadOBJFile("../assets/models/starwars1.obj", "starwars1", false, Mesh::UVType::CUBE_MAPPED_UV);
-    OBJ_MANAGER->loadOBJFile("../assets/models/sphere_modified.obj", "sphere_modified", false, Mesh::UVType::CUBE_MAPPED_UV);
+    OBJ_MANAGER->loadOBJFiles({
+        { "../assets/models/quad.obj", "quad", false, Mesh::UVType::PLANAR_UV },
+        { "../assets/models/sphere.obj", "sphere", false, Mesh::UVType::CUBE_MAPPED_UV },
+        { "../assets/models/bunny_high_poly.obj", "bunny_high_poly", false, Mesh::UVType::CUBE_MAPPED_UV },
+        { "../assets/models/cube.obj", "cube", true, Mesh::UVType::CUBE_MAPPED_UV },
+        { "../assets/models/4Sphere.obj", "4Sphere", false, Mesh::UVType::CUBE_MAPPED_UV },
+        { "../assets/models/bunny.obj", "bunny", false, Mesh::UVType::CUBE_MAPPED_UV },
+        { "../assets/models/cup.obj", "cup", false, Mesh::UVType::CUBE_MAPPED_UV },
+        { "../assets/models/cube2.obj", "cube2", false, Mesh::UVType::CUBE_MAPPED_UV },
+        { "../assets/models/rhino.obj", "rhino", false, Mesh::UVType::CUBE_MAPPED_UV },
+        { "../assets/models/starwars1.obj", "starwars1", false, Mesh::UVType::CUBE_MAPPED_UV },
+        { "../assets/models/sphere_modified.obj", "sphere_modified", false, Mesh::UVType::CUBE_MAPPED_UV },
+    });
     OBJ_MANAGER->setupSphere("orbitSphere");
     OBJ_MANAGER->setupPlane("plane");
     OBJ_MANAGER->setupOrbitLine("orbitLine", 2.5f);
@@ -55,8 +64,20 @@ void Scene::LoadAllModels()
     //OBJ_MANAGER->loadTexture("textures/SilkMedieval_512_ao.png", "ambTexture");
     OBJ_MANAGER->loadTexture("../assets/textures/metal_roof_diff_512x512.png", "diffTexture");
     OBJ_MANAGER->loadTexture("../assets/textures/metal_roof_spec_512x512.png", "specTexture");
-    //OBJ_MANAGER->loadTexture("../assets/textures/SilkMedieval_512_normal.png", "normTexture");
+    //OBJ_MANAGER->loadTexture("../assets/textures/SilkMedieval_512_normal.png", "normTexture", true);
     OBJ_MANAGER->loadTexture("../assets/textures/grid.png", "gridTexture");
+
+    MaterialLibrary& materials = OBJ_MANAGER->getMaterialLibrary();
+    MaterialLibrary::Material metalRoof{ "diffTexture", "specTexture", "" };
+    metalRoof.ka = glm::vec3(0.f, 0.f, 0.01f);
+    materials.addMaterial("metalRoof", metalRoof);
+    MaterialLibrary::Material uvGrid{ "gridTexture", "gridTexture", "" };
+    uvGrid.ka = metalRoof.ka;
+    materials.addMaterial("uvGrid", uvGrid);
+    materials.addMaterial("silkMedieval", { "albedoTexture", "", "normTexture" });
+    MaterialLibrary::Material flatBlue;
+    flatBlue.color = glm::vec3(0.f, 0.f, 1.f);
+    materials.addMaterial("flatBlue", flatBlue);
 }
 
 int Scene::Init(GLFWwindow* pWwindow)
@@ -81,8 +102,37 @@ int Scene::Display()
     return -1;
 }
 
+bool Scene::SupportsRenderThread() const
+{
+    return false;
+}
+
+void Scene::BuildFrame(FramePacket&)
+{
+}
+
+int Scene::RenderFrame(const FramePacket& packet)
+{
+    preRender();
+
+    Render();
+
+    postRender();
+
+    return 0;
+}
+
 int Scene::preRender()
 {
+    if (OBJ_MANAGER)
+    {
+        // Textures arrive whenever their decode finishes, what they allocate is not per frame
+        const AllocationCounter::AllowScope allow;
+        OBJ_MANAGER->updateTextures();
+    }
+    // Uploads above bind behind the cache's back, the frame starts clean after them
+    GL_STATE.beginFrame();
+    FRAME_ARENA.beginFrame();
     return 0;
 }
 
@@ -111,6 +161,71 @@ int Scene::RenderImGUI()
     return -1;
 }
 
+// Without a command buffer the buttons act right away
+static void renderGLCalls(const FramePacket::Stats& stats, CommandBuffer* commands)
+{
+    if (!ImGui::CollapsingHeader("GL Calls"))
+        return;
+    if (!GLInstrumentation::isCompiledIn())
+    {
+        ImGui::Text("Built without HGRAPHICS_GL_INSTRUMENTATION");
+        return;
+    }
+    if (!GL_INSTRUMENTATION.isInstalled())
+    {
+        ImGui::Text("Run with --gl-instrumentation to count calls");
+        return;
+    }
+
+    ImGui::Text("Frame %u: %u calls, %u draws, %u indirect, %u dispatches", stats.calls.frame, stats.calls.calls,
+        stats.calls.draws, stats.calls.indirectDraws, stats.calls.dispatches);
+    ImGui::Text("Triangles: %llu", static_cast<unsigned long long>(stats.calls.triangles));
+    ImGui::Text("Uploads: %.1f KB buffer, %.1f KB texture", stats.calls.bufferBytes / 1024.f,
+        stats.calls.textureBytes / 1024.f);
+
+    if (stats.bCapturePending)
+        ImGui::Text("Capturing...");
+    else if (ImGui::Button("Capture Frame"))
+    {
+        const std::string path = "gl_frame_" + std::to_string(stats.calls.frame + 2) + ".txt";
+        if (commands)
+            commands->push([path]() { GL_INSTRUMENTATION.captureNextFrame(path); });
+        else
+            GL_INSTRUMENTATION.captureNextFrame(path);
+    }
+    if (!stats.lastCapture.empty())
+        ImGui::Text("Last capture: %s", stats.lastCapture.c_str());
+
+    bool bJson = stats.bJsonLogging;
+    if (ImGui::Checkbox("Log Frames to gl_frames.jsonl", &bJson))
+    {
+        const std::string path = bJson ? "gl_frames.jsonl" : "";
+        if (commands)
+            commands->push([path]() { GL_INSTRUMENTATION.setJsonLog(path); });
+        else
+            GL_INSTRUMENTATION.setJsonLog(path);
+    }
+
+    if (ImGui::TreeNode("Entry Points"))
+    {
+        for (const GLInstrumentation::EntryStats& entry : stats.entries)
+            ImGui::Text("%6u  %s", entry.calls, entry.name);
+        ImGui::TreePop();
+    }
+}
+
+void Scene::renderGLCallsImGUI()
+{
+    FramePacket::Stats stats;
+    stats.read();
+    renderGLCalls(stats, nullptr);
+}
+
+void Scene::renderGLCallsImGUI(FramePacket& packet)
+{
+    renderGLCalls(packet.stats, &packet.commands);
+}
+
 void Scene::ProcessInput(GLFWwindow* pWwindow, double dt)
 {
 }
@@ -118,3 +233,14 @@ void Scene::ProcessInput(GLFWwindow* pWwindow, double dt)
 void Scene::ProcessMouseInput(GLFWwindow* pWwindow)
 {
 }
+
+void Scene::setWindowSize(int width, int height)
+{
+    window_width_ = width;
+    window_height_ = height;
+}
+
+void Scene::Resize(int width, int height)
+{
+    setWindowSize(width, height);
+}
@@ -12,150 +12,259 @@ Creation date: Sep 29, 2021
 End Header ---------------------------------------------------------*/
 #include "shader.hpp"
 
+#include "AllocationCounter.h"
+#include "GLStateCache.h"
+#include "ShaderCache.h"
+
+#include <cstring>
 #include <vector>
 
+namespace
+{
+    // GL_COMPLETION_STATUS_KHR; glad here predates KHR_parallel_shader_compile, the ARB
+    // version of the extension uses the same value
+    const GLenum COMPLETION_STATUS = 0x91B1;
+
+    const char* stageName(GLenum type)
+    {
+        switch (type)
+        {
+        case GL_VERTEX_SHADER:
+            return "Vertex";
+        case GL_FRAGMENT_SHADER:
+            return "Frag";
+        case GL_GEOMETRY_SHADER:
+            return "Geometry";
+        case GL_COMPUTE_SHADER:
+            return "Compute";
+        default:
+            return "Unknown";
+        }
+    }
+}
+
+GLuint Shader::fallback_program_ = 0;
+
 Shader::Shader()
 {
     m_ID = 0;
+    pending_id_ = 0;
+    pending_cache_key_ = 0;
 }
 
 unsigned Shader::loadShader(const char* vertex_file_path, const char* fragment_file_path, const char* geometryPath)
 {
-    std::string vertexCode;
-    std::string fragmentCode;
-    std::string geometryCode;
-    std::ifstream vShaderFile;
-    std::ifstream fShaderFile;
-    std::ifstream gShaderFile;
+    loadShaderAsync(vertex_file_path, fragment_file_path, geometryPath);
+    finish();
+    return m_ID;
+}
+
+void Shader::reloadShader(const char* vertex_file_path, const char* fragment_file_path, const char* geometryPath)
+{
+    // The old program is deleted once the new one links, a broken edit leaves it in use
+    loadShader(vertex_file_path, fragment_file_path, geometryPath);
+}
+
+unsigned Shader::loadComputeShader(const char* compute_file_path)
+{
+    // Dispatches have no stand-in, so compute programs are always waited for
+    beginLoad({ GL_COMPUTE_SHADER }, { compute_file_path });
+    finish();
+    return m_ID;
+}
+
+void Shader::loadShaderAsync(const char* vertex_file_path, const char* fragment_file_path, const char* geometryPath)
+{
+    std::vector<GLenum> stageTypes = { GL_VERTEX_SHADER, GL_FRAGMENT_SHADER };
+    std::vector<std::string> stagePaths = { vertex_file_path, fragment_file_path };
+    if (geometryPath != nullptr)
+    {
+        stageTypes.push_back(GL_GEOMETRY_SHADER);
+        stagePaths.emplace_back(geometryPath);
+    }
+    beginLoad(stageTypes, stagePaths);
+}
+
+void Shader::beginLoad(const std::vector<GLenum>& stageTypes, const std::vector<std::string>& stagePaths)
+{
+    // A reload started before the last one finished replaces it
+    if (pending_id_ != 0)
+    {
+        glDeleteProgram(pending_id_);
+        for (const GLuint shader : pending_shaders_)
+            glDeleteShader(shader);
+        pending_id_ = 0;
+        pending_shaders_.clear();
+    }
+
+    std::vector<std::string> stageSources(stagePaths.size());
+    std::ifstream shaderFile;
 
     // ensure ifstream objects can throw exceptions:
-    vShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-    fShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-    gShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+    shaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
     try
     {
-        // open files
-        vShaderFile.open(vertex_file_path);
-        fShaderFile.open(fragment_file_path);
-        std::stringstream vShaderStream, fShaderStream;
-        // read file's buffer contents into streams
-        vShaderStream << vShaderFile.rdbuf();
-        fShaderStream << fShaderFile.rdbuf();
-        // close file handlers
-        vShaderFile.close();
-        fShaderFile.close();
-        // convert stream into string
-        vertexCode = vShaderStream.str();
-        fragmentCode = fShaderStream.str();
-        if (geometryPath != nullptr)
+        for (size_t i = 0; i < stagePaths.size(); ++i)
         {
-            gShaderFile.open(geometryPath);
-            std::stringstream gShaderStream;
-            gShaderStream << gShaderFile.rdbuf();
-            gShaderFile.close();
-            geometryCode = gShaderStream.str();
+            shaderFile.open(stagePaths[i]);
+            std::stringstream shaderStream;
+            shaderStream << shaderFile.rdbuf();
+            shaderFile.close();
+            stageSources[i] = shaderStream.str();
         }
     }
-    catch (std::ifstream::failure e)
+    catch (const std::ifstream::failure&)
     {
         std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ" << std::endl;
         std::exit(EXIT_FAILURE);
     }
 
-    const char* vShaderCode = vertexCode.c_str();
-    const char* fShaderCode = fragmentCode.c_str();
-
-    // Create Shader and Compile
-    unsigned int vertexShader;
-    vertexShader = glCreateShader(GL_VERTEX_SHADER);
-
-    glShaderSource(vertexShader, 1, &vShaderCode, NULL);
-    glCompileShader(vertexShader);
-
-    // Check whether compile is successful
-    int success = 0;
-
-
-    glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
+    // A binary linked from these exact sources on this driver skips compiling and linking
+    pending_cache_file_ = ShaderCache::cachePath(stagePaths);
+    pending_cache_key_ = ShaderCache::makeKey(stageSources);
+    const GLuint cachedProgram = ShaderCache::load(pending_cache_file_, pending_cache_key_);
+    if (cachedProgram != 0)
+    {
+        if (m_ID != 0)
+            glDeleteProgram(m_ID);
+        m_ID = cachedProgram;
+        return;
+    }
 
-    if (!success)
+    // No status queries here, each one would wait for the driver to finish that compile
+    pending_stage_types_ = stageTypes;
+    pending_id_ = glCreateProgram();
+    for (size_t i = 0; i < stageTypes.size(); ++i)
     {
-        char infoLog[512];
-        glGetShaderInfoLog(vertexShader, 512, NULL, infoLog);
-        std::cout << "Error, Vertex Shader Compilation Failed ! " << infoLog << std::endl;
+        const char* shaderCode = stageSources[i].c_str();
+        const GLuint shader = glCreateShader(stageTypes[i]);
+        glShaderSource(shader, 1, &shaderCode, NULL);
+        glCompileShader(shader);
+        glAttachShader(pending_id_, shader);
+        pending_shaders_.push_back(shader);
     }
+    glProgramParameteri(pending_id_, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    glLinkProgram(pending_id_);
+}
 
-    unsigned int fragmentShader;
-    fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragmentShader, 1, &fShaderCode, NULL);
-    glCompileShader(fragmentShader);
+bool Shader::poll()
+{
+    if (pending_id_ == 0)
+        return true;
 
-    glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
-    if (!success)
+    if (hasParallelCompile())
     {
-        char infoLog[512];
-        glGetShaderInfoLog(fragmentShader, 512, NULL, infoLog);
-        std::cout << "Error, Frag Shader Compilation Failed ! " << infoLog << std::endl;
+        GLint complete = GL_FALSE;
+        glGetProgramiv(pending_id_, COMPLETION_STATUS, &complete);
+        if (!complete)
+            return false;
     }
+    completePending();
+    return true;
+}
 
-    unsigned int geometryShader;
-    if (geometryPath != nullptr)
+void Shader::finish()
+{
+    if (pending_id_ != 0)
+        completePending();
+}
+
+void Shader::completePending()
+{
+    // Reached from use() inside a frame; once per program, and the cache write allocates
+    const AllocationCounter::AllowScope allow;
+    int success = 0;
+    for (size_t i = 0; i < pending_shaders_.size(); ++i)
     {
-        const char* gShaderCode = geometryCode.c_str();
-        geometryShader = glCreateShader(GL_GEOMETRY_SHADER);
-        glShaderSource(geometryShader, 1, &gShaderCode, NULL);
-        glCompileShader(geometryShader);
-        glGetShaderiv(geometryShader, GL_COMPILE_STATUS, &success);
+        glGetShaderiv(pending_shaders_[i], GL_COMPILE_STATUS, &success);
         if (!success)
         {
             char infoLog[512];
-            glGetShaderInfoLog(geometryShader, 512, NULL, infoLog);
-            std::cout << "Error, Geometry Shader Compilation Failed ! " << infoLog << std::endl;
+            glGetShaderInfoLog(pending_shaders_[i], 512, NULL, infoLog);
+            std::cout << "Error, " << stageName(pending_stage_types_[i]) << " Shader Compilation Failed ! "
+                      << infoLog << std::endl;
         }
     }
 
-    m_ID = glCreateProgram();
-
-    glAttachShader(m_ID, vertexShader);
-    glAttachShader(m_ID, fragmentShader);
-    if (geometryPath != nullptr)
-        glAttachShader(m_ID, geometryShader);
-    glLinkProgram(m_ID);
-
-    glGetProgramiv(m_ID, GL_LINK_STATUS, &success);
-
+    glGetProgramiv(pending_id_, GL_LINK_STATUS, &success);
     if (!success)
     {
         char infoLog[512];
-        glGetProgramInfoLog(m_ID, 512, NULL, infoLog);
+        glGetProgramInfoLog(pending_id_, 512, NULL, infoLog);
         std::cout << "Error, Program Linking Failed ! " << infoLog << std::endl;
+        glDeleteProgram(pending_id_);
+    }
+    else
+    {
+        ShaderCache::save(pending_cache_file_, pending_cache_key_, pending_id_);
+        if (m_ID != 0)
+            glDeleteProgram(m_ID);
+        m_ID = pending_id_;
     }
 
     // Delete Shader after linking it to program
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
-    if (geometryPath != nullptr)
-        glDeleteShader(geometryShader);
+    for (const GLuint shader : pending_shaders_)
+        glDeleteShader(shader);
+    pending_shaders_.clear();
+    pending_id_ = 0;
+}
 
-    return m_ID;
+bool Shader::hasParallelCompile()
+{
+    static const bool bSupported = []()
+    {
+        GLint extensionCount = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &extensionCount);
+        for (GLint i = 0; i < extensionCount; ++i)
+        {
+            const char* extension = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+            if (std::strcmp(extension, "GL_KHR_parallel_shader_compile") == 0 ||
+                std::strcmp(extension, "GL_ARB_parallel_shader_compile") == 0)
+                return true;
+        }
+        return false;
+    }();
+    return bSupported;
 }
 
-void Shader::reloadShader(const char* vertex_file_path, const char* fragment_file_path, const char* geometryPath)
+GLuint Shader::getFallbackProgram()
+{
+    if (fallback_program_ == 0)
+    {
+        const AllocationCounter::AllowScope allow;
+        Shader fallback;
+        fallback.loadShader("../assets/shader/fallback.vert", "../assets/shader/fallback.frag");
+        fallback_program_ = fallback.m_ID;
+        resetFallbackUniforms();
+    }
+    return fallback_program_;
+}
+
+void Shader::resetFallbackUniforms()
 {
-    glDeleteProgram(m_ID);
-    GLuint reloaded_program = loadShader(vertex_file_path, fragment_file_path, geometryPath);
-    if(reloaded_program)
-        m_ID = reloaded_program;
+    // Uniforms default to 0, which would read queued[0] on a direct draw
+    if (fallback_program_ == 0)
+        return;
+    glProgramUniform1i(fallback_program_, glGetUniformLocation(fallback_program_, "instanceBase"), -1);
+    glProgramUniform1i(fallback_program_, glGetUniformLocation(fallback_program_, "bInstanced"), 0);
 }
 
 void Shader::use()
 {
-    glUseProgram(m_ID);
+    poll();
+    if (m_ID != 0)
+    {
+        GL_STATE.useProgram(m_ID);
+        return;
+    }
+    // Every pending program shares the fallback, start each use from direct draw values
+    GL_STATE.useProgram(getFallbackProgram());
+    resetFallbackUniforms();
 }
 
 int Shader::getHandle()
 {
-    return m_ID;
+    return m_ID != 0 ? m_ID : getFallbackProgram();
 }
 
 void Shader::cleanup()
@@ -163,133 +272,127 @@ void Shader::cleanup()
 
 }
 
-void Shader::SetUniform(const std::string& name, GLboolean value) const
+GLint Shader::getUniformLocation(const char* name) const
+{
+    // The fallback has none of the program's uniforms but the matrices
+    if (m_ID == 0)
+        return glGetUniformLocation(getFallbackProgram(), name);
+
+    const GLint location = glGetUniformLocation(m_ID, name);
+    if (location < 0)
+        std::cout << "Uniform variable " << name << " doesn't exist" << std::endl;
+    return location;
+}
+
+void Shader::SetUniform(const char* name, GLboolean value) const
 {
-    GLint location = glGetUniformLocation(m_ID, name.c_str());
+    GLint location = getUniformLocation(name);
 
     if (location >= 0)
         glUniform1i(location, value);
-    else
-        std::cout << "Uniform variable " << name << " doesn't exist" << std::endl;
 }
 
-void Shader::SetUniform(const std::string& name, GLint value) const
+void Shader::SetUniform(const char* name, GLint value) const
 {
-    GLint location = glGetUniformLocation(m_ID, name.c_str());
+    GLint location = getUniformLocation(name);
 
     if (location >= 0)
         glUniform1i(location, value);
-    else
-        std::cout << "Uniform variable " << name << " doesn't exist" << std::endl;
 }
 
-void Shader::SetUniform(const std::string& name, GLuint value) const
+void Shader::SetUniform(const char* name, GLuint value) const
 {
-    GLint location = glGetUniformLocation(m_ID, name.c_str());
+    GLint location = getUniformLocation(name);
 
     if (location >= 0)
         glUniform1ui(location, value);
-    else
-        std::cout << "Uniform variable " << name << " doesn't exist" << std::endl;
 }
 
-void Shader::SetUniform(const std::string& name, GLfloat value) const
+void Shader::SetUniform(const char* name, GLfloat value) const
 {
-    GLint location = glGetUniformLocation(m_ID, name.c_str());
+    GLint location = getUniformLocation(name);
 
     if (location >= 0)
         glUniform1f(location, value);
-    else
-        std::cout << "Uniform variable " << name << " doesn't exist" << std::endl;
 }
 
-void Shader::SetUniform(const std::string& name, const GLdouble value) const
+void Shader::SetUniform(const char* name, const GLdouble value) const
 {
-    GLint location = glGetUniformLocation(m_ID, name.c_str());
+    GLint location = getUniformLocation(name);
 
     if (location >= 0)
         glUniform1d(location, value);
-    else
-        std::cout << "Uniform variable " << name << " doesn't exist" << std::endl;
 }
 
-void Shader::SetUniform(const std::string& name, const glm::vec3& value) const
+void Shader::SetUniform(const char* name, const glm::vec3& value) const
 {
-    GLint location = glGetUniformLocation(m_ID, name.c_str());
+    GLint location = getUniformLocation(name);
 
     if (location >= 0)
         glUniform3f(location, value.x, value.y, value.z);
-    else
-        std::cout << "Uniform variable " << name << " doesn't exist" << std::endl;
 }
 
-void Shader::SetUniform(const std::string& name, const glm::vec2& value) const
+void Shader::SetUniform(const char* name, const glm::vec2& value) const
 {
-    GLint location = glGetUniformLocation(m_ID, name.c_str());
+    GLint location = getUniformLocation(name);
 
     if (location >= 0)
         glUniform2f(location, value.x, value.y);
-    else
-        std::cout << "Uniform variable " << name << " doesn't exist" << std::endl;
 }
 
-void Shader::SetUniform(const std::string& name, GLfloat x, GLfloat y, GLfloat z) const
+void Shader::SetUniform(const char* name, GLfloat x, GLfloat y, GLfloat z) const
 {
-    GLint location = glGetUniformLocation(m_ID, name.c_str());
+    GLint location = getUniformLocation(name);
 
     if (location >= 0)
         glUniform3f(location, x, y, z);
-    else
-        std::cout << "Uniform variable " << name << " doesn't exist" << std::endl;
 }
 
-void Shader::SetUniform(const std::string& name, const glm::vec4& value) const
+void Shader::SetUniform(const char* name, const glm::vec4& value) const
 {
-    GLint location = glGetUniformLocation(m_ID, name.c_str());
+    GLint location = getUniformLocation(name);
 
     if (location >= 0)
         glUniform4f(location, value.x, value.y, value.z, value.w);
-    else
-        std::cout << "Uniform variable " << name << " doesn't exist" << std::endl;
 }
 
-void Shader::SetUniform(const std::string& name, GLfloat x, GLfloat y, GLfloat z, GLfloat w) const
+void Shader::SetUniform(const char* name, GLfloat x, GLfloat y, GLfloat z, GLfloat w) const
 {
-    GLint location = glGetUniformLocation(m_ID, name.c_str());
+    GLint location = getUniformLocation(name);
 
     if (location >= 0)
         glUniform4f(location, x, y, z, w);
-    else
-        std::cout << "Uniform variable " << name << " doesn't exist" << std::endl;
 }
 
-void Shader::SetUniform(const std::string& name, const glm::mat4& mat) const
+void Shader::SetUniform(const char* name, const glm::mat4& mat) const
 {
-    GLint location = glGetUniformLocation(m_ID, name.c_str());
+    GLint location = getUniformLocation(name);
 
     if (location >= 0)
         glUniformMatrix4fv(location, 1, false, &mat[0][0]);
-    else
-        std::cout << "Uniform variable " << name << " doesn't exist" << std::endl;
 }
 
-void Shader::SetUniform(const std::string& name, const glm::mat3& mat) const
+void Shader::SetUniform(const char* name, const glm::mat3& mat) const
 {
-    GLint location = glGetUniformLocation(m_ID, name.c_str());
+    GLint location = getUniformLocation(name);
 
     if (location >= 0)
         glUniformMatrix3fv(location, 1, false, &mat[0][0]);
-    else
-        std::cout << "Uniform variable " << name << " doesn't exist" << std::endl;
 }
 
-void Shader::SetUniform(const std::string& name, GLuint numParams, const float* params) const
+void Shader::SetUniform(const char* name, GLuint numParams, const float* params) const
 {
-    GLint location = glGetUniformLocation(m_ID, name.c_str());
+    GLint location = getUniformLocation(name);
 
     if (location >= 0)
         glUniform3fv(location, numParams, params);
-    else
-        std::cout << "Uniform variable " << name << " doesn't exist" << std::endl;
 
 }
+
+void Shader::SetUniform(const char* name, GLuint count, const glm::vec4* values) const
+{
+    GLint location = getUniformLocation(name);
+
+    if (location >= 0)
+        glUniform4fv(location, count, &values[0][0]);
+}
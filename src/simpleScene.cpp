@@ -14,7 +14,14 @@ End Header ---------------------------------------------------------*/
 #define STB_IMAGE_IMPLEMENTATION
 
 #include <array>
-
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+#include "AllocationCounter.h"
+#include "FrameArena.h"
+#include "GLStateCache.h"
+#include "GPUCuller.h"
 #include "stb_image.h"
 #include <memory>
 #include <queue>
@@ -30,12 +37,13 @@ SimpleScene::~SimpleScene()
     loaded_model_name_.clear();
     loaded_shader_.clear();
     initMembers();
-    glDeleteVertexArrays(1, &skybox_vao_);
+    glDeleteVertexArrays(6, skybox_vao_);
     glDeleteBuffers(1, skybox_vbo_pos_);
     glDeleteBuffers(1, &skybox_vbo_uv_);
     glDeleteBuffers(1, &skybox_ebo_);
-    glDeleteBuffers(1, &fbo_);
-    glDeleteBuffers(1, &rbo_);
+    glDeleteFramebuffers(1, &fbo_);
+    glDeleteRenderbuffers(1, &rbo_);
+    glDeleteTextures(1, &env_texture_);
 }
 
 SimpleScene::SimpleScene(int windowWidth, int windowHeight) :
@@ -48,6 +56,9 @@ SimpleScene::SimpleScene(int windowWidth, int windowHeight) :
     initMembers();
     screen_width_ = static_cast<float>(windowWidth);
     screen_height_ = static_cast<float>(windowHeight);
+    fbo_ = 0;
+    rbo_ = 0;
+    env_texture_ = 0;
 }
 
 void SimpleScene::initMembers()
@@ -56,14 +67,15 @@ void SimpleScene::initMembers()
     orbit_radius_ = 2.5f;
     b_show_v_normal_ = false;
     b_show_f_normal_ = false;
+    b_use_lod_ = true;
     b_reload_shader_ = false;
     b_recalc_uv_ = false;
     b_rotate_ = true;
     b_calc_uv_gpu_ = true;
     normal_size_ = 0.2f;
     total_light_num_ = 1;
-    diff_texture_ = 0;
-    spec_texture_ = 0;
+    metal_material_ = -1;
+    grid_material_ = -1;
     fog_max_dist_ = 20.f;
     fog_min_dist_ = 0.1f;
     fog_color_ = glm::vec3(0.5f, 0.5f, 0.5f);
@@ -81,18 +93,16 @@ int SimpleScene::Init(GLFWwindow* pWindow)
     light_sphere_shader_ = std::make_unique<Shader>();
     skybox_shader_ = std::make_unique<Shader>();
 
-    main_shader_->loadShader("../assets/shader/phongShading.vert",
+    // Compiled together in the background, drawn with the fallback until each program links
+    main_shader_->loadShaderAsync("../assets/shader/phongShading.vert",
         "../assets/shader/phongShading.frag");
-    draw_normal_shader_->loadShader("../assets/shader/normalShader.vert",
+    draw_normal_shader_->loadShaderAsync("../assets/shader/normalShader.vert",
         "../assets/shader/normalShader.frag");
-    light_sphere_shader_->loadShader("../assets/shader/lightSphere.vert",
+    light_sphere_shader_->loadShaderAsync("../assets/shader/lightSphere.vert",
         "../assets/shader/lightSphere.frag");
-    skybox_shader_->loadShader("../assets/shader/skybox.vert",
+    skybox_shader_->loadShaderAsync("../assets/shader/skybox.vert",
         "../assets/shader/skybox.frag");
 
-    diff_texture_ = obj_manager_.getTexture("diffTexture");
-    spec_texture_ = obj_manager_.getTexture("specTexture");
-    grid_texture_ = obj_manager_.getTexture("gridTexture");
     std::array<std::string, 6> faces = { {
 	    "../assets/textures/left.jpg",
 	    "../assets/textures/right.jpg",
@@ -104,7 +114,8 @@ int SimpleScene::Init(GLFWwindow* pWindow)
 
     for (int i = 0; i < 6; ++i)
     {
-        cubemap_texture_[i] = obj_manager_.load_cubemap(faces[i]);
+        cubemap_faces_[i] = faces[i];
+        obj_manager_.load_cubemap(faces[i]);
     }
 
     frame_buffer_cam_[0] = std::make_unique<Camera>(glm::vec3(0.0f, 0.f, 0.f), glm::vec3(-1.0f, 0.0f, 0.0f));
@@ -165,20 +176,35 @@ int SimpleScene::Init(GLFWwindow* pWindow)
 	    {0.0f, 0.0f}
 	} };
 
-    glGenVertexArrays(1, &skybox_vao_);
+    glGenBuffers(1, &skybox_vbo_uv_);
+    GL_STATE.bindBuffer(GL_ARRAY_BUFFER, skybox_vbo_uv_);
+    glBufferData(GL_ARRAY_BUFFER, 4 * sizeof(glm::vec2), skyboxUV.data(), GL_STATIC_DRAW);
+
+    glGenBuffers(1, &skybox_ebo_);
+    glGenVertexArrays(6, skybox_vao_);
     for (int i = 0; i < 6; ++i)
     {
         glGenBuffers(1, &skybox_vbo_pos_[i]);
-        glBindBuffer(GL_ARRAY_BUFFER, skybox_vbo_pos_[i]);
+        GL_STATE.bindBuffer(GL_ARRAY_BUFFER, skybox_vbo_pos_[i]);
         glBufferData(GL_ARRAY_BUFFER, 4 * sizeof(glm::vec3), skyboxVertices[i].data(), GL_STATIC_DRAW);
-        glGenBuffers(1, &skybox_vbo_uv_);
-        glBindBuffer(GL_ARRAY_BUFFER, skybox_vbo_uv_);
-        glBufferData(GL_ARRAY_BUFFER, 4 * sizeof(glm::vec2), skyboxUV.data(), GL_STATIC_DRAW);
-    }
 
-    glGenBuffers(1, &skybox_ebo_);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, skybox_ebo_);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, obj_manager_.GetMesh("quad")->getIndexBufferSize() * sizeof(glm::ivec3), obj_manager_.GetMesh("quad")->getIndexBuffer(), GL_STATIC_DRAW);
+        // One VAO per face so drawing the skybox only switches VAOs
+        GL_STATE.bindVertexArray(skybox_vao_[i]);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), static_cast<void*>(0));
+
+        GL_STATE.bindBuffer(GL_ARRAY_BUFFER, skybox_vbo_uv_);
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), static_cast<void*>(0));
+
+        GL_STATE.bindBuffer(GL_ELEMENT_ARRAY_BUFFER, skybox_ebo_);
+        if (i == 0)
+        {
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, obj_manager_.GetMesh("quad")->getIndexBufferSize() * sizeof(glm::ivec3),
+                         obj_manager_.GetMesh("quad")->getIndexBuffer(), GL_STATIC_DRAW);
+        }
+    }
+    GL_STATE.bindVertexArray(0);
 
     loaded_shader_.emplace_back("../assets/shader/phongShading");
     loaded_shader_.emplace_back("../assets/shader/blinnShading");
@@ -191,20 +217,39 @@ int SimpleScene::Init(GLFWwindow* pWindow)
     camera_ = std::make_unique<Camera>(glm::vec3(0.0f, 0.5f, -6.f));
 
     glGenFramebuffers(1, &fbo_);
-    glBindFramebuffer(GL_FRAMEBUFFER, fbo_);
+    glGenRenderbuffers(1, &rbo_);
+    createEnvironmentTarget();
 
-    for (int i = 0; i < 6; ++i)
-    {
-        glGenTextures(1, &fb_texture_[i]);
-        glBindTexture(GL_TEXTURE_2D, fb_texture_[i]);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, (GLsizei)screen_width_, (GLsizei)screen_height_, 0, GL_RGB, GL_UNSIGNED_BYTE, NULL);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    }
+    main_shader_->SetUniform("mappingMode", 2);
+
+    MaterialLibrary& materials = obj_manager_.getMaterialLibrary();
+    metal_material_ = materials.findMaterial("metalRoof");
+    grid_material_ = materials.findMaterial("uvGrid");
+    for (unsigned i = 0; i < materials.getMaterialCount(); ++i)
+        material_edits_.push_back(materials.getMaterial(static_cast<int>(i)));
+
+    return Scene::Init(pWindow);
+}
+
+void SimpleScene::createEnvironmentTarget()
+{
+    // Immutable storage can't be resized, a new size needs a new texture
+    if (env_texture_ != 0)
+        GL_STATE.deleteTextures(1, &env_texture_);
+
+    GL_STATE.bindFramebuffer(GL_FRAMEBUFFER, fbo_);
+
+    // One layer per environment face, sampled as a single array by the shading shaders
+    glGenTextures(1, &env_texture_);
+    GL_STATE.bindTexture(0, GL_TEXTURE_2D_ARRAY, env_texture_);
+    glTexStorage3D(GL_TEXTURE_2D_ARRAY, 1, GL_RGB8, (GLsizei)screen_width_, (GLsizei)screen_height_, 6);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    GL_STATE.bindTexture(0, GL_TEXTURE_2D_ARRAY, 0);
+    glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, env_texture_, 0, 0);
 
-    glGenRenderbuffers(1, &rbo_);
     glBindRenderbuffer(GL_RENDERBUFFER, rbo_);
     glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, (GLsizei)screen_width_, (GLsizei)screen_height_);
     glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, rbo_);
@@ -212,365 +257,403 @@ int SimpleScene::Init(GLFWwindow* pWindow)
     if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
         std::cout << "ERROR::FRAMEBUFFER:: Framebuffer is not complete!" << std::endl;
 
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
-    main_shader_->SetUniform("mappingMode", 2);
+    GL_STATE.bindFramebuffer(GL_FRAMEBUFFER, 0);
+}
 
-    return Scene::Init(pWindow);
+void SimpleScene::Resize(int width, int height)
+{
+    // The window size belongs to the main thread, which set it when the window changed
+    if (static_cast<float>(width) == screen_width_ && static_cast<float>(height) == screen_height_)
+        return;
+
+    screen_width_ = static_cast<float>(width);
+    screen_height_ = static_cast<float>(height);
+    createEnvironmentTarget();
 }
 
-int SimpleScene::Render()
+bool SimpleScene::SupportsRenderThread() const
 {
-    glEnable(GL_DEPTH_TEST);
-    glClearColor(fog_color_.x, fog_color_.y, fog_color_.z, 1.0f);
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    return true;
+}
 
-    glDisable(GL_DEPTH_TEST);
-    glDepthMask(GL_FALSE);
+void SimpleScene::BuildFrame(FramePacket& packet)
+{
+    packet.camera.view = camera_->GetViewMatrix();
+    packet.camera.projection = glm::perspective(glm::radians(camera_->zoom_),
+        (float)packet.width / (float)packet.height, 0.1f, 100.0f);
+    packet.camera.position = camera_->GetPosition();
+    packet.camera.zNear = 0.1f;
+    packet.camera.zFar = 100.f;
+
+    //Before the UI, so the Model panel shows a click in the frame it happened
+    pickAtCursor(packet);
+    buildImGUI(packet);
+
+    Frame* frame = packet.memory.create<Frame>();
+    frame->model = obj_manager_.GetMesh(current_model_name_);
+    frame->material = b_show_uv_ ? grid_material_ : metal_material_;
+    frame->globalAmbient = global_ambient_;
+    frame->fogColor = fog_color_;
+    frame->fogMinDist = fog_min_dist_;
+    frame->fogMaxDist = fog_max_dist_;
+    for (int i = 0; i < 3; ++i)
+        frame->attenuation[i] = att_const_[i];
+    frame->ratio = ratio_;
+    frame->fresnel = fresnel_;
+    frame->mixRatio = mix_ratio_;
+    frame->bCalcUVGPU = b_calc_uv_gpu_;
+    frame->bCalcUVPos = b_calc_uv_pos_;
+    frame->bShowUV = b_show_uv_;
+    frame->bShowReflect = b_show_reflect_;
+    frame->bShowRefract = b_show_refract_;
+    frame->bShowVNormal = b_show_v_normal_;
+    frame->bShowFNormal = b_show_f_normal_;
+    frame->bUseLOD = b_use_lod_;
+
+    frame->lightCount = total_light_num_;
+    frame->lights = packet.memory.createArray<FrameLight>(total_light_num_);
+
+    //The light spheres come first, the environment faces draw only those
+    Mesh* sphere = obj_manager_.GetMesh("orbitSphere");
+    packet.drawCount = static_cast<unsigned>(total_light_num_) + 1;
+    packet.draws = packet.memory.createArray<FrameDrawItem>(packet.drawCount);
 
-    view_ = camera_->GetViewMatrix();
-    projection_ = glm::perspective(glm::radians(camera_->zoom_), (float)screen_width_ / (float)screen_height_, 0.1f,
-        100.0f);
-    skybox_shader_->use();
-    skybox_shader_->SetUniform("view", view_);
-    skybox_shader_->SetUniform("projection", projection_);
+    for (int i = 0; i < total_light_num_; ++i)
+    {
+        const float angle = glm::radians(360.f / static_cast<float>(total_light_num_) * i);
+        const glm::mat4 orbit = glm::rotate(angle_of_rotation_, glm::vec3(0.0f, 1.0f, 0.0f));
+
+        FrameLight& light = frame->lights[i];
+        light.position = glm::vec3(orbit * glm::vec4(cosf(angle) * orbit_radius_, 0.3f, sinf(angle) * orbit_radius_, 1.f));
+        light.ambient = la_[i];
+        light.diffuse = ld_[i];
+        light.specular = ls_[i];
+        light.type = light_type_[i];
+        light.falloff = spot_falloff_[i];
+        light.innerAngle = glm::cos(glm::radians(spot_inner_[i]));
+        light.outerAngle = glm::cos(glm::radians(spot_outer_[i]));
+
+        packet.draws[i] = { RenderQueue::Pass::SOLID, light_sphere_shader_.get(), -1, sphere, lightSphereModel(i),
+            glm::vec4(ld_[i], 1.f) };
+    }
+    packet.draws[total_light_num_] = { RenderQueue::Pass::SOLID, main_shader_.get(), frame->material, frame->model,
+        glm::mat4(1.f), glm::vec4(1.f) };
 
-    glBindVertexArray(skybox_vao_);
-    glEnableVertexAttribArray(0);
-    glEnableVertexAttribArray(1);
-    for (int i = 0; i < 6; ++i)
+    packet.sceneData = frame;
+
+    //The orbit steps once the frame took its angle
+    if (b_rotate_)
+        angle_of_rotation_ += 0.01f;
+}
+
+glm::mat4 SimpleScene::lightSphereModel(int light) const
+{
+    const float angle = glm::radians(360.f / static_cast<float>(total_light_num_) * light);
+    const glm::mat4 orbit = glm::rotate(angle_of_rotation_, glm::vec3(0.0f, 1.0f, 0.0f));
+    return orbit * glm::translate(glm::vec3(cosf(angle) * orbit_radius_, 0.0f, sinf(angle) * orbit_radius_)) *
+        glm::scale(glm::vec3(0.08f));
+}
+
+void SimpleScene::pickAtCursor(FramePacket& packet)
+{
+    Mesh* model = obj_manager_.GetMesh(current_model_name_);
+    Mesh* sphere = obj_manager_.GetMesh("orbitSphere");
+    if (b_pick_pending_ && model && sphere)
     {
-        glBindBuffer(GL_ARRAY_BUFFER, skybox_vbo_pos_[i]);
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+        //Mesh BVHs are built once at load, the render thread never changes them
+        {
+            //A click is a one-off, the scene BVH is built for it from the objects as they are drawn
+            const AllocationCounter::AllowScope allow;
+            std::vector<InstanceData> instances(static_cast<size_t>(total_light_num_) + 1);
+            instances[0].model = glm::mat4(1.f);
+            instances[0].mesh_index = 0;
+            for (int i = 0; i < total_light_num_; ++i)
+            {
+                instances[i + 1].model = lightSphereModel(i);
+                instances[i + 1].mesh_index = 1;
+            }
+            pick_bvh_.build({ &model->getBVH(), &sphere->getBVH() }, instances);
+        }
 
-        glBindBuffer(GL_ARRAY_BUFFER, skybox_vbo_uv_);
-        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+        const auto start = std::chrono::high_resolution_clock::now();
 
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, cubemap_texture_[i]);
-        skybox_shader_->SetUniform("skybox", 0);
+        //unproject the cursor on the near and far planes
+        const glm::mat4 inverseViewProj = glm::inverse(packet.camera.projection * packet.camera.view);
+        glm::vec4 nearPoint = inverseViewProj * glm::vec4(pick_cursor_, -1.f, 1.f);
+        glm::vec4 farPoint = inverseViewProj * glm::vec4(pick_cursor_, 1.f, 1.f);
+        nearPoint /= nearPoint.w;
+        farPoint /= farPoint.w;
 
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, skybox_ebo_);
-        glDrawElements(GL_TRIANGLES, obj_manager_.GetMesh("quad")->getIndexBufferSize(), GL_UNSIGNED_INT, 0);
+        const Ray ray{ glm::vec3(nearPoint), glm::vec3(farPoint - nearPoint) };
+        pick_.hit = RayHit();
+        pick_bvh_.intersect(ray, pick_.hit);
+        pick_.distance = pick_.hit.isHit() ? pick_.hit.t * glm::length(ray.direction) : 0.f;
+
+        pick_.queryMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+        //instance 0 is the model, light spheres follow in light order
+        if (!pick_.hit.isHit())
+            pick_.name[0] = '\0';
+        else if (pick_.hit.instance == 0)
+            std::snprintf(pick_.name, sizeof(pick_.name), "%s", current_model_name_.c_str());
+        else
+            std::snprintf(pick_.name, sizeof(pick_.name), "Light#%u", pick_.hit.instance);
     }
+    b_pick_pending_ = false;
 
-    glEnable(GL_DEPTH_TEST);
-    glDepthMask(GL_TRUE);
-    main_shader_->use();
+    packet.pick = pick_;
+}
+
+int SimpleScene::RenderFrame(const FramePacket& packet)
+{
+    preRender();
+
+    const Frame& frame = *static_cast<const Frame*>(packet.sceneData);
+    const FrameCamera& camera = packet.camera;
+
+    GL_STATE.viewport(0, 0, packet.width, packet.height);
 
-    if (b_show_uv_)
+    // Streamed textures replace their placeholders once resident
+    for (int i = 0; i < 6; ++i)
     {
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, grid_texture_);
+        cubemap_texture_[i] = obj_manager_.getTexture(cubemap_faces_[i]);
     }
-    else
+
+    GL_STATE.enable(GL_DEPTH_TEST);
+    glClearColor(frame.fogColor.x, frame.fogColor.y, frame.fogColor.z, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    GL_STATE.disable(GL_DEPTH_TEST);
+    GL_STATE.depthMask(GL_FALSE);
+
+    skybox_shader_->use();
+    skybox_shader_->SetUniform("view", camera.view);
+    skybox_shader_->SetUniform("projection", camera.projection);
+    skybox_shader_->SetUniform("skybox", 0);
+
+    for (int i = 0; i < 6; ++i)
     {
-        // bind diffuse map
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, diff_texture_);
-        // bind specular map
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, spec_texture_);
+        GL_STATE.bindVertexArray(skybox_vao_[i]);
+        GL_STATE.bindTexture(0, GL_TEXTURE_2D, cubemap_texture_[i]);
+        glDrawElements(GL_TRIANGLES, obj_manager_.GetMesh("quad")->getIndexBufferSize(), GL_UNSIGNED_INT, 0);
     }
 
-    model_ = glm::mat4(1.f);
-    main_shader_->SetUniform("model", model_);
-    normal_matrix_ = glm::mat3(glm::transpose(glm::inverse(model_)));
-    draw_norm_model_ = model_;
-
-    main_shader_->SetUniform("view", view_);
-    main_shader_->SetUniform("projection", projection_);
-    main_shader_->SetUniform("normalMatrix", normal_matrix_);
-    main_shader_->SetUniform("viewPos", camera_->GetPosition());
-    main_shader_->SetUniform("lightNum", total_light_num_);
-    main_shader_->SetUniform("globalAmbient", global_ambient_);
-
-    main_shader_->SetUniform("Fog.MaxDist", fog_max_dist_);
-    main_shader_->SetUniform("Fog.MinDist", fog_min_dist_);
-    main_shader_->SetUniform("Fog.Color", fog_color_);
-    main_shader_->SetUniform("bCalcUV", b_calc_uv_gpu_);
-    main_shader_->SetUniform("bCalcPos", b_calc_uv_pos_);
-    main_shader_->SetUniform("Emissive", obj_color_);
-    main_shader_->SetUniform("Ka", ka_);
-    main_shader_->SetUniform("Kd", kd_);
-    main_shader_->SetUniform("Ks", ks_);
-
-    main_shader_->SetUniform("bShowUV", b_show_uv_);
-    main_shader_->SetUniform("bShowReflect", b_show_reflect_);
-    main_shader_->SetUniform("bShowRefract", b_show_refract_);
-
-    main_shader_->SetUniform("min_", obj_manager_.GetMesh(current_model_name_)->getMinBound());
-    main_shader_->SetUniform("max_", obj_manager_.GetMesh(current_model_name_)->getMaxBound());
+    GL_STATE.enable(GL_DEPTH_TEST);
+    GL_STATE.depthMask(GL_TRUE);
+    main_shader_->use();
+
+    // Material textures and the environment faces are bound once for the pass,
+    // the render queue only picks materials
+    obj_manager_.getMaterialLibrary().bind();
+    GL_STATE.bindTexture(4, GL_TEXTURE_2D_ARRAY, env_texture_);
+
+    main_shader_->SetUniform("view", camera.view);
+    main_shader_->SetUniform("projection", camera.projection);
+    main_shader_->SetUniform("viewPos", camera.position);
+    main_shader_->SetUniform("lightNum", frame.lightCount);
+    main_shader_->SetUniform("globalAmbient", frame.globalAmbient);
+
+    main_shader_->SetUniform("Fog.MaxDist", frame.fogMaxDist);
+    main_shader_->SetUniform("Fog.MinDist", frame.fogMinDist);
+    main_shader_->SetUniform("Fog.Color", frame.fogColor);
+    main_shader_->SetUniform("bCalcUV", frame.bCalcUVGPU);
+    main_shader_->SetUniform("bCalcPos", frame.bCalcUVPos);
+
+    main_shader_->SetUniform("bShowUV", frame.bShowUV);
+    main_shader_->SetUniform("bShowReflect", frame.bShowReflect);
+    main_shader_->SetUniform("bShowRefract", frame.bShowRefract);
+
+    main_shader_->SetUniform("min_", frame.model->getMinBound());
+    main_shader_->SetUniform("max_", frame.model->getMaxBound());
     main_shader_->SetUniform("bModel", true);
 
-    for (int i = 0; i < total_light_num_; ++i)
+    for (int i = 0; i < frame.lightCount; ++i)
     {
-        std::stringstream Light;
-
-        Light << "Lights[" << i << "].position";
+        const FrameLight& light = frame.lights[i];
+        //Names go to the frame arena, std::string names allocated on every frame
+        const auto field = [i](const char* name) { return FRAME_ARENA.format("Lights[%d].%s", i, name); };
 
-        model_ = glm::mat4(1.f);
-        light_pos_ = glm::vec4(1.f);
-        model_ = glm::rotate(angle_of_rotation_, glm::vec3(0.0f, 1.0f, 0.0f)) *
-            glm::translate(glm::vec3(cosf(glm::radians(360.f / static_cast<float>(total_light_num_) * i)) * orbit_radius_, 0.3f,
-                sinf(glm::radians(360.f / static_cast<float>(total_light_num_) * i)) * orbit_radius_));
-        light_positions_[i] = model_[3];
-        if (current_light_type_[i] == "Point")
+        if (light.type == Point)
         {
-            main_shader_->SetUniform("Lights[" + std::to_string(i) + "].lightType", light_type_[i]);
-            main_shader_->SetUniform(Light.str(), light_positions_[i]);
-            main_shader_->SetUniform("Lights[" + std::to_string(i) + "].ambient", la_[i]);
-            main_shader_->SetUniform("Lights[" + std::to_string(i) + "].diffuse", ld_[i]);
-            main_shader_->SetUniform("Lights[" + std::to_string(i) + "].specular", ls_[i]);
-            main_shader_->SetUniform("Lights[" + std::to_string(i) + "].constant", att_const_[0]);
-            main_shader_->SetUniform("Lights[" + std::to_string(i) + "].linear", att_const_[1]);
-            main_shader_->SetUniform("Lights[" + std::to_string(i) + "].quadratic", att_const_[2]);
+            main_shader_->SetUniform(field("lightType"), light.type);
+            main_shader_->SetUniform(field("position"), light.position);
+            main_shader_->SetUniform(field("ambient"), light.ambient);
+            main_shader_->SetUniform(field("diffuse"), light.diffuse);
+            main_shader_->SetUniform(field("specular"), light.specular);
+            main_shader_->SetUniform(field("constant"), frame.attenuation[0]);
+            main_shader_->SetUniform(field("linear"), frame.attenuation[1]);
+            main_shader_->SetUniform(field("quadratic"), frame.attenuation[2]);
         }
 
         // directionLight
-        else if (current_light_type_[i] == "Direction")
+        else if (light.type == Direction)
         {
-            main_shader_->SetUniform(Light.str(), light_positions_[i]);
-            main_shader_->SetUniform("Lights[" + std::to_string(i) + "].lightType", light_type_[i]);
-            main_shader_->SetUniform("Lights[" + std::to_string(i) + "].direction", light_positions_[i]);
-            main_shader_->SetUniform("Lights[" + std::to_string(i) + "].ambient", la_[i]);
-            main_shader_->SetUniform("Lights[" + std::to_string(i) + "].diffuse", ld_[i]);
-            main_shader_->SetUniform("Lights[" + std::to_string(i) + "].specular", ls_[i]);
+            main_shader_->SetUniform(field("position"), light.position);
+            main_shader_->SetUniform(field("lightType"), light.type);
+            main_shader_->SetUniform(field("direction"), light.position);
+            main_shader_->SetUniform(field("ambient"), light.ambient);
+            main_shader_->SetUniform(field("diffuse"), light.diffuse);
+            main_shader_->SetUniform(field("specular"), light.specular);
         }
 
         // spotLight
-        else if (current_light_type_[i] == "Spot")
+        else if (light.type == Spot)
         {
-            main_shader_->SetUniform(Light.str(), light_positions_[i]);
-            main_shader_->SetUniform("Lights[" + std::to_string(i) + "].lightType", light_type_[i]);
-            main_shader_->SetUniform("Lights[" + std::to_string(i) + "].direction", -light_positions_[i]);
-            main_shader_->SetUniform("Lights[" + std::to_string(i) + "].ambient", la_[i]);
-            main_shader_->SetUniform("Lights[" + std::to_string(i) + "].diffuse", ld_[i]);
-            main_shader_->SetUniform("Lights[" + std::to_string(i) + "].specular", ls_[i]);
-            main_shader_->SetUniform("Lights[" + std::to_string(i) + "].falloff", spot_falloff_[i]);
-            main_shader_->SetUniform("Lights[" + std::to_string(i) + "].constant", att_const_[0]);
-            main_shader_->SetUniform("Lights[" + std::to_string(i) + "].linear", att_const_[1]);
-            main_shader_->SetUniform("Lights[" + std::to_string(i) + "].quadratic", att_const_[2]);
-            main_shader_->SetUniform("Lights[" + std::to_string(i) + "].inner_angle", glm::cos(glm::radians(spot_inner_[i])));
-            main_shader_->SetUniform("Lights[" + std::to_string(i) + "].outer_angle", glm::cos(glm::radians(spot_outer_[i])));
+            main_shader_->SetUniform(field("position"), light.position);
+            main_shader_->SetUniform(field("lightType"), light.type);
+            main_shader_->SetUniform(field("direction"), -light.position);
+            main_shader_->SetUniform(field("ambient"), light.ambient);
+            main_shader_->SetUniform(field("diffuse"), light.diffuse);
+            main_shader_->SetUniform(field("specular"), light.specular);
+            main_shader_->SetUniform(field("falloff"), light.falloff);
+            main_shader_->SetUniform(field("constant"), frame.attenuation[0]);
+            main_shader_->SetUniform(field("linear"), frame.attenuation[1]);
+            main_shader_->SetUniform(field("quadratic"), frame.attenuation[2]);
+            main_shader_->SetUniform(field("inner_angle"), light.innerAngle);
+            main_shader_->SetUniform(field("outer_angle"), light.outerAngle);
         }
     }
-    obj_manager_.GetMesh(current_model_name_)->render();
-
-    if (b_recalc_uv_)
-    {
-        if (current_uv_pipeline_ == "CPU")
-        {
-            if (current_uv_type_ == "None")
-            {
-                obj_manager_.GetMesh(current_model_name_)->clearVertexUVs();
-                obj_manager_.GetMesh(current_model_name_)->setupMesh();
-            }
-            else if (current_uv_type_ == "Cylindrical")
-            {
-                if (b_calc_uv_pos_)
-                {
-                    obj_manager_.GetMesh(current_model_name_)->calcUVs(Mesh::UVType::CYLINDRICAL_UV);
-                    obj_manager_.GetMesh(current_model_name_)->setupMesh();
-                }
-                else
-                {
-                    obj_manager_.GetMesh(current_model_name_)->calcUVs(Mesh::UVType::CYLINDRICAL_UV, false);
-                    obj_manager_.GetMesh(current_model_name_)->setupMesh();
-                }
-            }
-            else if (current_uv_type_ == "Spherical")
-            {
-                if (b_calc_uv_pos_)
-                {
-                    obj_manager_.GetMesh(current_model_name_)->calcUVs(Mesh::UVType::SPHERICAL_UV);
-                    obj_manager_.GetMesh(current_model_name_)->setupMesh();
-                }
-                else
-                {
-                    obj_manager_.GetMesh(current_model_name_)->calcUVs(Mesh::UVType::SPHERICAL_UV, false);
-                    obj_manager_.GetMesh(current_model_name_)->setupMesh();
-                }
-            }
-            else if (current_uv_type_ == "Cube")
-            {
-                if (b_calc_uv_pos_)
-                {
-                    obj_manager_.GetMesh(current_model_name_)->calcUVs(Mesh::UVType::CUBE_MAPPED_UV);
-                    obj_manager_.GetMesh(current_model_name_)->setupMesh();
-                }
-                else
-                {
-                    obj_manager_.GetMesh(current_model_name_)->calcUVs(Mesh::UVType::CUBE_MAPPED_UV, false);
-                    obj_manager_.GetMesh(current_model_name_)->setupMesh();
-                }
-            }
-            else if (current_uv_type_ == "Planar")
-            {
-                if (b_calc_uv_pos_)
-                {
-                    obj_manager_.GetMesh(current_model_name_)->calcUVs(Mesh::UVType::PLANAR_UV);
-                    obj_manager_.GetMesh(current_model_name_)->setupMesh();
-                }
-                else
-                {
-                    obj_manager_.GetMesh(current_model_name_)->calcUVs(Mesh::UVType::PLANAR_UV, false);
-                    obj_manager_.GetMesh(current_model_name_)->setupMesh();
-                }
-            }
-        }
-        else
-        {
-            obj_manager_.GetMesh(current_model_name_)->setupMesh();
-            if (current_uv_type_ == "Cylindrical")
-                main_shader_->SetUniform("mappingMode", 0);
-            if (current_uv_type_ == "Spherical")
-                main_shader_->SetUniform("mappingMode", 1);
-            if (current_uv_type_ == "Cube")
-                main_shader_->SetUniform("mappingMode", 2);
-            if (current_uv_type_ == "Planar")
-                main_shader_->SetUniform("mappingMode", 3);
-        }
-        b_recalc_uv_ = false;
-    }
 
     //Enviroment mapping
-    if (b_show_reflect_|| b_show_refract_)
+    if (frame.bShowReflect || frame.bShowRefract)
     {
-        glBindFramebuffer(GL_FRAMEBUFFER, fbo_);
+        GL_STATE.bindFramebuffer(GL_FRAMEBUFFER, fbo_);
+        GL_STATE.viewport(0, 0, (GLsizei)screen_width_, (GLsizei)screen_height_);
         main_shader_->use();
 
-        main_shader_->SetUniform("fresnel", fresnel_);
-        main_shader_->SetUniform("inputRatio", ratio_);
-        main_shader_->SetUniform("mixRatio", mix_ratio_);
+        main_shader_->SetUniform("fresnel", frame.fresnel);
+        main_shader_->SetUniform("inputRatio", frame.ratio);
+        main_shader_->SetUniform("mixRatio", frame.mixRatio);
         
         for (int i = 0; i < 6; ++i)
         {
-            glActiveTexture(GL_TEXTURE4 + i);
-            glBindTexture(GL_TEXTURE_2D, fb_texture_[i]);
-            main_shader_->SetUniform("cube[" + std::to_string(i) + "]", 4 + i);
-        }
-        for (int i = 0; i < 6; ++i)
-        {
-            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, fb_texture_[i], 0);
+            glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, env_texture_, 0, i);
             glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
             glm::mat4 envProj = glm::perspective(glm::radians(90.0f), 1.0f, 0.1f, 100.0f);
             glm::mat4 envView = frame_buffer_cam_[i]->GetViewMatrix();
-            glm::mat4 envModel(1.0f);
 
-            main_shader_->SetUniform("model", envModel);
-            main_shader_->SetUniform("view", envView);
-            main_shader_->SetUniform("projection", envProj);
-
-            glDisable(GL_DEPTH_TEST);
-            glDepthMask(GL_FALSE);
+            GL_STATE.disable(GL_DEPTH_TEST);
+            GL_STATE.depthMask(GL_FALSE);
             skybox_shader_->use();
             glm::mat4 skyboxView = glm::mat4(glm::mat3(envView));
             skybox_shader_->SetUniform("view", skyboxView);
             skybox_shader_->SetUniform("projection", envProj);
+            skybox_shader_->SetUniform("skybox", 0);
 
-            glBindVertexArray(skybox_vao_);
-            glEnableVertexAttribArray(0);
-            glEnableVertexAttribArray(1);
             for (int j = 0; j < 6; ++j)
             {
-                glBindBuffer(GL_ARRAY_BUFFER, skybox_vbo_pos_[j]);
-                glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), static_cast<void*>(0));
-
-                glBindBuffer(GL_ARRAY_BUFFER, skybox_vbo_uv_);
-                glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), static_cast<void*>(0));
-
-                glActiveTexture(GL_TEXTURE0);
-                glBindTexture(GL_TEXTURE_2D, cubemap_texture_[j]);
+                GL_STATE.bindVertexArray(skybox_vao_[j]);
+                GL_STATE.bindTexture(0, GL_TEXTURE_2D, cubemap_texture_[j]);
                 if (cubemap_texture_[i] == 0) {
                     std::cerr << "ERROR::CUBEMAP:: Texture " << i << " is not loaded correctly!" << std::endl;
                 }
 
-                skybox_shader_->SetUniform("skybox", 0);
-
-                glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, skybox_ebo_);
                 glDrawElements(GL_TRIANGLES, obj_manager_.GetMesh("quad")->getIndexBufferSize(), GL_UNSIGNED_INT, 0);
             }
 
-            glEnable(GL_DEPTH_TEST);
-            glDepthMask(GL_TRUE);
+            GL_STATE.enable(GL_DEPTH_TEST);
+            GL_STATE.depthMask(GL_TRUE);
 
             light_sphere_shader_->use();
             light_sphere_shader_->SetUniform("view", envView);
             light_sphere_shader_->SetUniform("projection", envProj);
-            for (auto j = 0; j < total_light_num_; ++j)
-            {
-                model_ = glm::mat4(1.f);
-                model_ = glm::rotate(angle_of_rotation_, glm::vec3(0.0f, 1.0f, 0.0f)) *
-                    glm::translate(glm::vec3(cosf(glm::radians(360.f / static_cast<float>(total_light_num_) * j)) * orbit_radius_, 0.0f,
-                        sinf(glm::radians(360.f / static_cast<float>(total_light_num_) * j)) * orbit_radius_))
-                    * glm::scale(glm::vec3(0.08f));
-                normal_matrix_ = glm::mat3(glm::transpose(glm::inverse(model_)));
-                light_sphere_shader_->SetUniform("model", model_);
-                light_sphere_shader_->SetUniform("objectColor", ld_[j]);
-
-                obj_manager_.GetMesh("orbitSphere")->render();
-            }
+            const LODView envLOD = LODView::fromProjection(frame_buffer_cam_[i]->GetPosition(), envProj, screen_height_);
+            render_queue_.begin(envView, 0.1f, 100.f, frame.bUseLOD ? &envLOD : nullptr);
+            submitDraws(packet.draws, static_cast<unsigned>(frame.lightCount));
+            render_queue_.execute();
         }
 
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        GL_STATE.bindFramebuffer(GL_FRAMEBUFFER, 0);
+        GL_STATE.viewport(0, 0, packet.width, packet.height);
     }
 
     light_sphere_shader_->use();
-    light_sphere_shader_->SetUniform("view", view_);
-    light_sphere_shader_->SetUniform("projection", projection_);
-    model_ = glm::mat4(1.f);
-    light_sphere_shader_->SetUniform("model", model_);
+    light_sphere_shader_->SetUniform("view", camera.view);
+    light_sphere_shader_->SetUniform("projection", camera.projection);
+    light_sphere_shader_->SetUniform("instanceBase", -1);
+    light_sphere_shader_->SetUniform("model", glm::mat4(1.f));
+    light_sphere_shader_->SetUniform("objectColor", glm::vec3(1.f));
     obj_manager_.GetLineMesh("orbitLine")->render();
 
-    for (auto i = 0; i < total_light_num_; ++i)
-    {
-        model_ = glm::mat4(1.f);
-        model_ = glm::rotate(angle_of_rotation_, glm::vec3(0.0f, 1.0f, 0.0f)) *
-            glm::translate(glm::vec3(cosf(glm::radians(360.f / static_cast<float>(total_light_num_) * i)) * orbit_radius_, 0.0f,
-                sinf(glm::radians(360.f / static_cast<float>(total_light_num_) * i)) * orbit_radius_))
-            * glm::scale(glm::vec3(0.08f));
-        normal_matrix_ = glm::mat3(glm::transpose(glm::inverse(model_)));
-        light_sphere_shader_->SetUniform("model", model_);
-        light_sphere_shader_->SetUniform("objectColor", ld_[i]);
-
-        obj_manager_.GetMesh("orbitSphere")->render();
-    }
+    //The model and every light sphere go through one sorted queue
+    const LODView lod = LODView::fromProjection(camera.position, camera.projection, static_cast<float>(packet.height));
+    render_queue_.begin(camera.view, camera.zNear, camera.zFar, frame.bUseLOD ? &lod : nullptr);
+    submitDraws(packet.draws, packet.drawCount);
+    render_queue_.execute();
 
 
-    if (b_show_v_normal_)
+    if (frame.bShowVNormal)
     {
         draw_normal_shader_->use();
-        draw_normal_shader_->SetUniform("model", draw_norm_model_);
-        draw_normal_shader_->SetUniform("view", view_);
-        draw_normal_shader_->SetUniform("projection", projection_);
+        draw_normal_shader_->SetUniform("model", glm::mat4(1.f));
+        draw_normal_shader_->SetUniform("view", camera.view);
+        draw_normal_shader_->SetUniform("projection", camera.projection);
         draw_normal_shader_->SetUniform("color", glm::vec3(0.32f, 0.57f, 0.86f));
-        obj_manager_.GetMesh(current_model_name_)->render(1);
+        frame.model->render(1);
     }
-    if (b_show_f_normal_)
+    if (frame.bShowFNormal)
     {
         draw_normal_shader_->use();
-        draw_normal_shader_->SetUniform("model", draw_norm_model_);
-        draw_normal_shader_->SetUniform("view", view_);
-        draw_normal_shader_->SetUniform("projection", projection_);
+        draw_normal_shader_->SetUniform("model", glm::mat4(1.f));
+        draw_normal_shader_->SetUniform("view", camera.view);
+        draw_normal_shader_->SetUniform("projection", camera.projection);
         draw_normal_shader_->SetUniform("color", glm::vec3(0.2f, 0.49f, 0.0f));
-        obj_manager_.GetMesh(current_model_name_)->render(2);
+        frame.model->render(2);
     }
-    if (b_reload_shader_)
+
+    RenderStats& stats = render_stats_[packet.index];
+    stats.textures = obj_manager_.getTextureStreamer().getStats();
+    stats.queue = render_queue_.getStats();
+    stats.materials = obj_manager_.getMaterialLibrary().getStats();
+    stats.bBindless = obj_manager_.getMaterialLibrary().isBindless();
+    stats.arenaBytes = FRAME_ARENA.getUsedBytes();
+    stats.arenaReservedBytes = FRAME_ARENA.getReservedBytes();
+    if (frame.model)
     {
-        main_shader_->reloadShader(current_v_shader_.c_str(),
-            current_f_shader_.c_str());
-        main_shader_->use();
-        b_reload_shader_ = false;
+        stats.vertexFormat = frame.model->getVertexFormat();
+        stats.vertexStats = frame.model->getVertexFormatStats();
+        stats.indexType = frame.model->getIndexType();
+        stats.indexBufferBytes = frame.model->getIndexBufferBytes();
     }
 
     return 0;
 }
 
-int SimpleScene::postRender()
+void SimpleScene::recalculateUVs(Mesh* mesh, const std::string& uvType, bool bCPU, bool bFromPosition)
 {
-    if (b_rotate_)
-        angle_of_rotation_ += 0.01f;
-    return 0;
+    if (bCPU)
+    {
+        if (uvType == "None")
+            mesh->clearVertexUVs();
+        else if (uvType == "Cylindrical")
+            mesh->calcUVs(Mesh::UVType::CYLINDRICAL_UV, bFromPosition);
+        else if (uvType == "Spherical")
+            mesh->calcUVs(Mesh::UVType::SPHERICAL_UV, bFromPosition);
+        else if (uvType == "Cube")
+            mesh->calcUVs(Mesh::UVType::CUBE_MAPPED_UV, bFromPosition);
+        else if (uvType == "Planar")
+            mesh->calcUVs(Mesh::UVType::PLANAR_UV, bFromPosition);
+        mesh->setupMesh();
+    }
+    else
+    {
+        mesh->setupMesh();
+        if (uvType == "Cylindrical")
+            main_shader_->SetUniform("mappingMode", 0);
+        if (uvType == "Spherical")
+            main_shader_->SetUniform("mappingMode", 1);
+        if (uvType == "Cube")
+            main_shader_->SetUniform("mappingMode", 2);
+        if (uvType == "Planar")
+            main_shader_->SetUniform("mappingMode", 3);
+    }
+}
+
+void SimpleScene::submitDraws(const FrameDrawItem* draws, unsigned count)
+{
+    for (unsigned i = 0; i < count; ++i)
+        render_queue_.submit(draws[i].pass, draws[i].shader, draws[i].material, draws[i].mesh, draws[i].model,
+                             draws[i].color);
 }
 
 void SimpleScene::SetupImGUI(GLFWwindow* pWwindow)
@@ -586,16 +669,39 @@ void SimpleScene::SetupImGUI(GLFWwindow* pWwindow)
     // Setup Platform/Renderer backends
     ImGui_ImplGlfw_InitForOpenGL(pWwindow, true);
     ImGui_ImplOpenGL3_Init(glsl_version);
+    // Creates the font texture and shaders now, frames are built without the GL context
+    ImGui_ImplOpenGL3_NewFrame();
 }
 
-int SimpleScene::RenderImGUI()
+void SimpleScene::buildImGUI(FramePacket& packet)
 {
-    ImGui_ImplOpenGL3_NewFrame();
     ImGui_ImplGlfw_NewFrame();
     ImGui::NewFrame();
     ImGui::Begin("Controls");
     ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.0f / ImGui::GetIO().Framerate,
         ImGui::GetIO().Framerate);
+    ImGui::Text("Render thread: %.3f ms/frame, main thread waited %.3f ms", packet.stats.renderMs,
+        packet.stats.waitMs);
+
+    //Counters of the last frame drawn from this packet, the render thread is busy with the one in between
+    const RenderStats& renderStats = render_stats_[packet.index];
+    const TextureStreamer::Stats& textureStats = renderStats.textures;
+    ImGui::Text("Textures: %u resident, %u streaming (%.1f MB uploaded)", textureStats.resident, textureStats.pending,
+        textureStats.uploadedBytes / (1024.f * 1024.f));
+    const RenderQueue::Stats& queueStats = renderStats.queue;
+    ImGui::Text("Render queue: %u draws in %u batches (%u program, %u material, %u mesh changes), %u triangles",
+        queueStats.draws, queueStats.batches, queueStats.shaderChanges, queueStats.materialChanges,
+        queueStats.meshChanges, queueStats.triangles);
+    const MaterialLibrary::Stats& materialStats = renderStats.materials;
+    ImGui::Text("Materials: %u layers in %u pools (%.1f MB)%s", materialStats.layers, materialStats.pools,
+        materialStats.poolBytes / (1024.f * 1024.f), renderStats.bBindless ? ", bindless" : "");
+    const GLStateCache::Counters& stateCounters = packet.stats.state;
+    ImGui::Text("GL state: %u calls issued, %u elided", stateCounters.issued, stateCounters.elided);
+    ImGui::Text("Frame arena: %.1f KB used of %.1f KB", renderStats.arenaBytes / 1024.f,
+        renderStats.arenaReservedBytes / 1024.f);
+    if (AllocationCounter::isCompiledIn())
+        ImGui::Text("Heap allocations: %u render thread, %u main thread", packet.stats.renderAllocations,
+            packet.stats.buildAllocations);
 
     //Model config
     if (ImGui::CollapsingHeader("Model"))
@@ -619,6 +725,52 @@ int SimpleScene::RenderImGUI()
         }
         ImGui::Checkbox("Draw Vertex Normal", &b_show_v_normal_);
         ImGui::Checkbox("Draw Face Normal", &b_show_f_normal_);
+        ImGui::Checkbox("Mesh LODs", &b_use_lod_);
+
+        //left click outside the ImGui windows picks
+        const FramePick& pick = packet.pick;
+        if (pick.hit.isHit())
+        {
+            ImGui::Text("Picked: %s", pick.name);
+            ImGui::Text("Triangle: %u, distance %.3f", pick.hit.triangle, pick.distance);
+        }
+        else
+            ImGui::Text("Picked: none");
+        ImGui::Text("Pick query: %.4f ms", pick.queryMs);
+        if (Mesh* mesh = obj_manager_.GetMesh(current_model_name_))
+        {
+            for (unsigned i = 0; i < mesh->getLODCount(); ++i)
+            {
+                const Mesh::LOD lod = mesh->getLOD(i);
+                ImGui::Text("LOD %u: %u triangles, error %.5f", i, lod.indexCount / 3, lod.error);
+            }
+            ImGui::Text("Meshlets: %u", static_cast<unsigned>(mesh->getMeshlets().size()));
+            const Mesh::IndexOrderStats& order = mesh->getIndexOrderStats();
+            if (order.bOptimized)
+            {
+                ImGui::Text("ACMR %.3f -> %.3f, ATVR %.3f -> %.3f (FIFO %u)", order.before.acmr, order.after.acmr,
+                            order.before.atvr, order.after.atvr, MeshOptimizer::CACHE_SIZE);
+            }
+
+            //the render thread rebuilds the mesh, its format and sizes are read from the packet's stats
+            const char* vertexFormats[] = { "Float", "Quantized, 2x16 bit normals", "Quantized, 2x8 bit normals" };
+            int vertexFormat = static_cast<int>(renderStats.vertexFormat);
+            if (ImGui::Combo("Vertex Format", &vertexFormat, vertexFormats, IM_ARRAYSIZE(vertexFormats)))
+            {
+                packet.commands.push([mesh, format = static_cast<VertexFormat>(vertexFormat)]() {
+                    mesh->setVertexFormat(format);
+                    mesh->setupMesh();
+                });
+            }
+            const Mesh::VertexFormatStats& vertexStats = renderStats.vertexStats;
+            ImGui::Text("Vertex data: %.1f KB, %.1f KB as float (%.2fx)", vertexStats.bytes / 1024.f,
+                        vertexStats.floatBytes / 1024.f,
+                        vertexStats.bytes > 0 ? static_cast<float>(vertexStats.floatBytes) / vertexStats.bytes : 0.f);
+            ImGui::Text("Max error: position %.2e, normal %.3f deg, UV %.2e", vertexStats.maxPositionError,
+                        vertexStats.maxNormalError, vertexStats.maxUVError);
+            ImGui::Text("Index data: %d bit, %.1f KB", renderStats.indexType == GL_UNSIGNED_SHORT ? 16 : 32,
+                        renderStats.indexBufferBytes / 1024.f);
+        }
     }
 
     //Shader config
@@ -630,12 +782,10 @@ int SimpleScene::RenderImGUI()
             for (const auto& shader : loaded_shader_)
             {
                 const bool is_selected = current_v_shader_ == shader;
-                const std::string&& currentVShaderPath = shader + ".vert";
-                const std::string&& currentFShaderPath = shader + ".frag";
                 if (ImGui::Selectable(shader.c_str(), is_selected))
                 {
-                    current_v_shader_ = currentVShaderPath;
-                    current_f_shader_ = currentFShaderPath;
+                    current_v_shader_ = shader + ".vert";
+                    current_f_shader_ = shader + ".frag";
                     current_shader = shader.c_str();
                 }
                 if (is_selected)
@@ -650,11 +800,23 @@ int SimpleScene::RenderImGUI()
     //Material config
     if (ImGui::CollapsingHeader("Material"))
     {
-        ImGui::Text("Surface Color Tints");
-        ImGui::ColorEdit3("Ambient", reinterpret_cast<float*>(&ka_));
-        ImGui::ColorEdit3("Diffuse", reinterpret_cast<float*>(&kd_));
-        ImGui::ColorEdit3("Specular", reinterpret_cast<float*>(&ks_));
-        ImGui::ColorEdit3("Emissive", reinterpret_cast<float*>(&obj_color_));
+        //Tints belong to the material the model is drawn with
+        const int materialId = b_show_uv_ ? grid_material_ : metal_material_;
+        if (materialId >= 0)
+        {
+            MaterialLibrary::Material& material = material_edits_[materialId];
+            ImGui::Text("Surface Color Tints");
+            bool bChanged = ImGui::ColorEdit3("Ambient", reinterpret_cast<float*>(&material.ka));
+            bChanged |= ImGui::ColorEdit3("Diffuse", reinterpret_cast<float*>(&material.kd));
+            bChanged |= ImGui::ColorEdit3("Specular", reinterpret_cast<float*>(&material.ks));
+            bChanged |= ImGui::ColorEdit3("Emissive", reinterpret_cast<float*>(&material.emissive));
+            if (bChanged)
+            {
+                packet.commands.push([this, materialId, material]() {
+                    obj_manager_.getMaterialLibrary().setMaterial(materialId, material);
+                });
+            }
+        }
 
         ImGui::Checkbox("Visualize UV", &b_show_uv_);
         ImGui::Checkbox("Visualize Reflection", &b_show_reflect_);
@@ -778,6 +940,7 @@ int SimpleScene::RenderImGUI()
         ImGui::DragFloat("Fog Min", &fog_min_dist_, 0.1f);
         ImGui::DragFloat("Fog Max", &fog_max_dist_, 0.1f);
     }
+    renderGLCallsImGUI(packet);
     ImGui::End();
 
     //Light config
@@ -959,9 +1122,7 @@ int SimpleScene::RenderImGUI()
                 if (ImGui::Selectable(light, is_selected))
                 {
                     current_light_num_ = light;
-                    std::string selectedLight = light;
-                    auto pos = selectedLight.find_first_of('#');
-                    selected_light_num_ = atoi(selectedLight.substr(pos + 1).c_str()) - 1;
+                    selected_light_num_ = atoi(strchr(light, '#') + 1) - 1;
                 }
                 if (is_selected)
                 {
@@ -972,9 +1133,8 @@ int SimpleScene::RenderImGUI()
             ImGui::EndCombo();
         }
 
-        std::string currentLight = current_light_type_[selected_light_num_];
         const char* light_types[] = { "Point", "Direction", "Spot" };
-        if (ImGui::BeginCombo("Light Type", currentLight.c_str()))
+        if (ImGui::BeginCombo("Light Type", current_light_type_[selected_light_num_].c_str()))
         {
             for (const auto& light : light_types)
             {
@@ -989,8 +1149,6 @@ int SimpleScene::RenderImGUI()
                         light_type_[selected_light_num_] = Direction;
                     else if (light == "Spot")
                         light_type_[selected_light_num_] = Spot;
-
-                    currentLight = light;
                 }
                 if (is_selected)
                     ImGui::SetItemDefaultFocus();
@@ -1014,11 +1172,45 @@ int SimpleScene::RenderImGUI()
     }
     ImGui::End();
 
-    return Scene::RenderImGUI();
+    //Mesh and shader work needs the GL context, it runs on the render thread before the frame
+    if (b_recalc_uv_)
+    {
+        packet.commands.push([this, mesh = obj_manager_.GetMesh(current_model_name_), uvType = current_uv_type_,
+            bCPU = current_uv_pipeline_ == "CPU", bFromPosition = b_calc_uv_pos_]() {
+            recalculateUVs(mesh, uvType, bCPU, bFromPosition);
+        });
+        b_recalc_uv_ = false;
+    }
+    if (b_reload_shader_)
+    {
+        packet.commands.push([this, vertex = current_v_shader_, fragment = current_f_shader_]() {
+            // The old program keeps drawing until the edit has compiled
+            main_shader_->loadShaderAsync(vertex.c_str(), fragment.c_str());
+            main_shader_->use();
+        });
+        b_reload_shader_ = false;
+    }
 }
 
 void SimpleScene::ProcessInput(GLFWwindow* pWwindow, double dt)
 {
+    //pick once per click, and not through ImGui windows; BuildFrame casts the ray
+    const bool bPickDown = glfwGetMouseButton(pWwindow, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS;
+    if (bPickDown && !b_pick_held_ && !ImGui::GetIO().WantCaptureMouse)
+    {
+        double cursorX, cursorY;
+        int width, height;
+        glfwGetCursorPos(pWwindow, &cursorX, &cursorY);
+        glfwGetWindowSize(pWwindow, &width, &height);
+        if (width > 0 && height > 0)
+        {
+            pick_cursor_ = glm::vec2(2.f * static_cast<float>(cursorX) / width - 1.f,
+                                     1.f - 2.f * static_cast<float>(cursorY) / height);
+            b_pick_pending_ = true;
+        }
+    }
+    b_pick_held_ = bPickDown;
+
     if (glfwGetKey(pWwindow, GLFW_KEY_W) == GLFW_PRESS)
         camera_->process_keyboard(Camera::Camera_Movement::CAM_FORWARD, dt);
     if (glfwGetKey(pWwindow, GLFW_KEY_S) == GLFW_PRESS)
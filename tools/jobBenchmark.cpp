@@ -0,0 +1,148 @@
+/* Start Header -------------------------------------------------------
+Copyright (C) 2021 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the prior written
+consent of DigiPen Institute of Technology is prohibited.
+File Name: jobBenchmark.cpp
+Purpose: This file is the microbenchmarks of the job system.
+Language: c++
+Platform: VS2019 / Window
+Project:  HGraphics
+Author: Elliott Hong <s.hong@digipen.edu>
+Creation date: Oct 19, 2026
+End Header ---------------------------------------------------------*/
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "AllocationCounter.h"
+#include "JobSystem.h"
+
+static void printUsage()
+{
+    std::cout << "usage: JobBenchmark [--max-threads <n>] [--jobs <n>] [--elements <n>] [--repeat <n>]" << std::endl
+              << "  Runs every benchmark with 1, 2, 4, ... up to --max-threads threads (default 64):" << std::endl
+              << "  spawn: --jobs empty jobs pushed from one thread, time per job" << std::endl
+              << "  nested: the same jobs spawned as a binary tree, every job spawns its children" << std::endl
+              << "  parallelFor: a math loop over --elements floats, speedup against one thread" << std::endl
+              << "  Times are the best of --repeat runs." << std::endl
+              << "  heap allocs: one more nested and parallelFor run after the timed ones must allocate nothing" << std::endl
+              << "    on any thread; needs HGRAPHICS_ALLOCATION_COUNTER, shows - without it" << std::endl;
+}
+
+using Clock = std::chrono::steady_clock;
+
+static double elapsedMs(Clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+template <typename Function>
+static double bestOf(int repeat, const Function& fn)
+{
+    double best = 1e30;
+    for (int i = 0; i < repeat; ++i)
+    {
+        const Clock::time_point start = Clock::now();
+        fn();
+        best = std::min(best, elapsedMs(start));
+    }
+    return best;
+}
+
+static void spawnTree(JobSystem& jobs, unsigned count, JobSystem::Counter& counter)
+{
+    if (count <= 1)
+        return;
+    const unsigned left = (count - 1) / 2;
+    const unsigned right = count - 1 - left;
+    jobs.run([&jobs, left, &counter]() { spawnTree(jobs, left, counter); }, &counter);
+    jobs.run([&jobs, right, &counter]() { spawnTree(jobs, right, counter); }, &counter);
+}
+
+int main(int argc, char** argv)
+{
+    unsigned maxThreads = 64;
+    unsigned jobCount = 100000;
+    size_t elementCount = 1u << 22;
+    int repeat = 5;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (i + 1 < argc && std::strcmp(argv[i], "--max-threads") == 0)
+            maxThreads = static_cast<unsigned>(std::atoi(argv[++i]));
+        else if (i + 1 < argc && std::strcmp(argv[i], "--jobs") == 0)
+            jobCount = static_cast<unsigned>(std::atoi(argv[++i]));
+        else if (i + 1 < argc && std::strcmp(argv[i], "--elements") == 0)
+            elementCount = static_cast<size_t>(std::atoll(argv[++i]));
+        else if (i + 1 < argc && std::strcmp(argv[i], "--repeat") == 0)
+            repeat = std::max(1, std::atoi(argv[++i]));
+        else
+        {
+            printUsage();
+            return 1;
+        }
+    }
+
+    std::vector<float> input(elementCount), output(elementCount);
+    for (size_t i = 0; i < elementCount; ++i)
+        input[i] = static_cast<float>(i % 1000) * 0.001f;
+
+    std::cout << "hardware threads: " << std::thread::hardware_concurrency() << std::endl;
+    std::cout << std::setw(8) << "threads" << std::setw(14) << "spawn ns/job" << std::setw(15) << "nested ns/job"
+              << std::setw(18) << "parallelFor ms" << std::setw(10) << "speedup" << std::setw(13) << "heap allocs"
+              << std::endl;
+
+    double singleThreadMs = 0.0;
+    bool bAllocated = false;
+    for (unsigned threads = 1; threads <= std::max(maxThreads, 1u); threads *= 2)
+    {
+        JobSystem jobs;
+        jobs.init(threads);
+
+        const double spawnMs = bestOf(repeat, [&]() {
+            JobSystem::Counter counter;
+            for (unsigned i = 0; i < jobCount; ++i)
+                jobs.run([]() {}, &counter);
+            jobs.wait(counter);
+        });
+
+        const auto nested = [&]() {
+            JobSystem::Counter counter;
+            spawnTree(jobs, jobCount, counter);
+            jobs.wait(counter);
+        };
+        const double nestedMs = bestOf(repeat, nested);
+
+        const auto parallel = [&]() {
+            jobs.parallelFor(0, elementCount, 4096, [&](size_t first, size_t last) {
+                for (size_t i = first; i < last; ++i)
+                    output[i] = std::sqrt(input[i]) * std::sin(input[i]) + std::cos(input[i] * 3.f);
+            });
+        };
+        const double forMs = bestOf(repeat, parallel);
+        if (threads == 1)
+            singleThreadMs = forMs;
+
+        // The work of a steady frame, counted over every thread
+        const uint64_t allocationsBefore = AllocationCounter::getTotalCount();
+        nested();
+        parallel();
+        const uint64_t allocations = AllocationCounter::getTotalCount() - allocationsBefore;
+        bAllocated = bAllocated || allocations != 0;
+
+        std::cout << std::fixed << std::setprecision(1) << std::setw(8) << threads
+                  << std::setw(14) << spawnMs * 1e6 / jobCount << std::setw(15) << nestedMs * 1e6 / jobCount
+                  << std::setprecision(2) << std::setw(18) << forMs << std::setw(10) << singleThreadMs / forMs
+                  << std::setw(13) << (AllocationCounter::isCompiledIn() ? std::to_string(allocations) : "-")
+                  << std::endl;
+    }
+
+    if (bAllocated)
+        std::cout << "JobBenchmark: jobs allocated on the heap" << std::endl;
+    return bAllocated ? 1 : 0;
+}
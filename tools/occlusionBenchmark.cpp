@@ -0,0 +1,277 @@
+/* Start Header -------------------------------------------------------
+Copyright (C) 2021 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the prior written
+consent of DigiPen Institute of Technology is prohibited.
+File Name: occlusionBenchmark.cpp
+Purpose: This file checks the software occlusion rasterizer against reference rasterizations and times it.
+Language: c++
+Platform: VS2019 / Window
+Project:  HGraphics
+Author: Elliott Hong <s.hong@digipen.edu>
+Creation date: Oct 19, 2026
+End Header ---------------------------------------------------------*/
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "JobSystem.h"
+#include "OcclusionRasterizer.h"
+
+static void printUsage()
+{
+    std::cout << "usage: OcclusionBenchmark [--cells <n>] [--grid <n>] [--repeat <n>] <model.obj>..." << std::endl
+              << "  Places a --grid x --grid field of each model (default 8) and renders it from several cameras:" << std::endl
+              << "  tiled: the threaded SSE rasterizer must match the scalar reference bit for bit" << std::endl
+              << "  conservative: the inner boxes (--cells per longest side, default 16) must never be nearer" << std::endl
+              << "    than the model's own triangles, coverage is the share of the model's pixels they keep" << std::endl
+              << "  culled: share of probe boxes hidden by the inner boxes and by the full triangles" << std::endl
+              << "  Times are the best of --repeat runs (default 10)." << std::endl;
+}
+
+using Clock = std::chrono::steady_clock;
+
+static double elapsedMs(Clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+template <typename Function>
+static double bestOf(int repeat, const Function& fn)
+{
+    double best = 1e30;
+    for (int i = 0; i < repeat; ++i)
+    {
+        const Clock::time_point start = Clock::now();
+        fn();
+        best = std::min(best, elapsedMs(start));
+    }
+    return best;
+}
+
+// Positions and faces only, faces are fanned into triangles; the model is
+// centered and scaled so its longest side is 1
+static bool loadOBJ(const std::string& path, std::vector<glm::vec3>& vertices, std::vector<GLuint>& indices)
+{
+    std::ifstream inFile(path);
+    if (!inFile)
+        return false;
+
+    std::string line;
+    while (std::getline(inFile, line))
+    {
+        std::istringstream stream(line);
+        std::string type;
+        stream >> type;
+        if (type == "v")
+        {
+            glm::vec3 position(0.f);
+            stream >> position.x >> position.y >> position.z;
+            vertices.push_back(position);
+        }
+        else if (type == "f")
+        {
+            std::vector<GLuint> face;
+            std::string corner;
+            while (stream >> corner)
+            {
+                const long index = std::strtol(corner.c_str(), nullptr, 10);
+                const long resolved = index < 0 ? static_cast<long>(vertices.size()) + index : index - 1;
+                if (resolved < 0 || resolved >= static_cast<long>(vertices.size()))
+                    return false;
+                face.push_back(static_cast<GLuint>(resolved));
+            }
+            for (size_t i = 2; i < face.size(); ++i)
+                indices.insert(indices.end(), { face[0], face[i - 1], face[i] });
+        }
+    }
+    if (vertices.empty() || indices.empty())
+        return false;
+
+    glm::vec3 boundsMin = vertices[0], boundsMax = vertices[0];
+    for (const glm::vec3& v : vertices)
+    {
+        boundsMin = glm::min(boundsMin, v);
+        boundsMax = glm::max(boundsMax, v);
+    }
+    const glm::vec3 center = (boundsMin + boundsMax) * 0.5f;
+    const glm::vec3 extent = boundsMax - boundsMin;
+    const float scale = 1.f / std::max({ extent.x, extent.y, extent.z, 1e-6f });
+    for (glm::vec3& v : vertices)
+        v = (v - center) * scale;
+    return true;
+}
+
+static bool benchmarkModel(const std::string& path, int cells, int grid, int repeat)
+{
+    std::vector<glm::vec3> vertices;
+    std::vector<GLuint> indices;
+    if (!loadOBJ(path, vertices, indices))
+    {
+        std::cout << "OcclusionBenchmark: failed to read " << path << std::endl;
+        return false;
+    }
+
+    OcclusionRasterizer::OccluderMesh boxes;
+    const double buildMs = bestOf(1, [&]() { boxes = OcclusionRasterizer::buildOccluder(vertices, indices, cells); });
+    glm::vec3 boundsMin = vertices[0], boundsMax = vertices[0];
+    for (const glm::vec3& v : vertices)
+    {
+        boundsMin = glm::min(boundsMin, v);
+        boundsMax = glm::max(boundsMax, v);
+    }
+
+    // A field of the model, each copy turned and sized a little differently
+    std::vector<InstanceData> instances;
+    for (int z = 0; z < grid; ++z)
+    {
+        for (int x = 0; x < grid; ++x)
+        {
+            const int i = z * grid + x;
+            InstanceData instance{};
+            instance.model = glm::translate(glm::mat4(1.f), glm::vec3((x - (grid - 1) * 0.5f) * 1.5f, 0.f,
+                                                                      (z - (grid - 1) * 0.5f) * 1.5f));
+            instance.model = glm::rotate(instance.model, static_cast<float>(i) * 0.7f, glm::vec3(0.f, 1.f, 0.f));
+            instance.model = glm::scale(instance.model, glm::vec3(0.8f + 0.05f * static_cast<float>(i % 5)));
+            instance.bounds_min = glm::vec4(boundsMin, 1.f);
+            instance.bounds_max = glm::vec4(boundsMax, 1.f);
+            instance.mesh_index = 0;
+            instances.push_back(instance);
+        }
+    }
+
+    OcclusionRasterizer boxRasterizer;
+    OcclusionRasterizer fullRasterizer;
+    boxRasterizer.setOccluders({ boxes }, instances);
+    // Both windings, so the model's nearest surface is drawn however its faces are wound
+    OcclusionRasterizer::OccluderMesh twoSided{ vertices, indices };
+    for (size_t i = 0; i + 2 < indices.size(); i += 3)
+        twoSided.indices.insert(twoSided.indices.end(), { indices[i], indices[i + 2], indices[i + 1] });
+    fullRasterizer.setOccluders({ twoSided }, instances);
+    boxRasterizer.setMaxOccluders(static_cast<unsigned>(instances.size()));
+    fullRasterizer.setMaxOccluders(static_cast<unsigned>(instances.size()));
+
+    const float radius = static_cast<float>(grid) * 1.5f;
+    const glm::mat4 projection = glm::perspective(glm::radians(60.f),
+                                                  static_cast<float>(boxRasterizer.getWidth()) / boxRasterizer.getHeight(),
+                                                  0.1f, radius * 4.f);
+    const glm::vec3 eyes[] = { glm::vec3(0.f, 0.4f, radius * 0.9f), glm::vec3(radius * 0.7f, 1.5f, radius * 0.7f),
+                               glm::vec3(-radius, 0.2f, 0.f), glm::vec3(0.f, radius, 0.1f),
+                               glm::vec3(radius * 0.3f, 0.1f, -radius * 0.3f) };
+
+    size_t mismatches = 0, violations = 0, boxPixels = 0, fullPixels = 0;
+    size_t probes = 0, boxCulled = 0, fullCulled = 0, unsafe = 0;
+    double tiledMs = 0.0, referenceMs = 0.0, setupMs = 0.0, rasterMs = 0.0;
+    std::vector<float> reference, full;
+    for (const glm::vec3& eye : eyes)
+    {
+        const glm::mat4 viewProj = projection * glm::lookAt(eye, glm::vec3(0.f), glm::vec3(0.f, 1.f, 0.f));
+
+        tiledMs += bestOf(repeat, [&]() { boxRasterizer.render(viewProj); });
+        setupMs += boxRasterizer.getStats().setupMs;
+        rasterMs += boxRasterizer.getStats().rasterMs;
+        referenceMs += bestOf(repeat, [&]() { boxRasterizer.renderReference(viewProj, reference); });
+        fullRasterizer.render(viewProj);
+        fullRasterizer.renderReference(viewProj, full);
+
+        // Both evaluate the same edge and depth equations per pixel, so they must match exactly
+        const std::vector<float>& tiled = boxRasterizer.getDepth();
+        const int width = boxRasterizer.getWidth();
+        const int height = boxRasterizer.getHeight();
+        for (int y = 0; y < height; ++y)
+        {
+            for (int x = 0; x < width; ++x)
+            {
+                const size_t i = static_cast<size_t>(y) * width + x;
+                if (reference[i] != tiled[i])
+                    ++mismatches;
+                boxPixels += reference[i] < 1.f ? 1 : 0;
+                fullPixels += full[i] < 1.f ? 1 : 0;
+
+                // A pixel center right on an edge the model's triangles share can be left out by
+                // both, isVisible reads one pixel around a rectangle, so compare to the nearest of 3x3
+                float nearest = full[i];
+                for (int ny = std::max(y - 1, 0); ny <= std::min(y + 1, height - 1); ++ny)
+                    for (int nx = std::max(x - 1, 0); nx <= std::min(x + 1, width - 1); ++nx)
+                        nearest = std::min(nearest, full[static_cast<size_t>(ny) * width + nx]);
+                if (reference[i] < nearest)
+                    ++violations;
+            }
+        }
+
+        // Small probes through the field; a probe the boxes hide must be hidden by the model too
+        for (int z = -grid * 2; z <= grid * 2; ++z)
+        {
+            for (int x = -grid * 2; x <= grid * 2; ++x)
+            {
+                const glm::vec3 center(static_cast<float>(x) * 0.75f + 0.3f, -0.2f, static_cast<float>(z) * 0.75f + 0.3f);
+                const glm::vec3 extent(0.1f);
+                const bool boxVisible = boxRasterizer.isVisible(center, extent);
+                const bool fullVisible = fullRasterizer.isVisible(center, extent);
+                ++probes;
+                boxCulled += boxVisible ? 0 : 1;
+                fullCulled += fullVisible ? 0 : 1;
+                unsafe += (!boxVisible && fullVisible) ? 1 : 0;
+            }
+        }
+    }
+
+    const size_t views = sizeof(eyes) / sizeof(eyes[0]);
+    const bool bPassed = mismatches == 0 && violations == 0 && unsafe == 0;
+    std::cout << path << ": " << indices.size() / 3 << " triangles -> " << boxes.indices.size() / 36 << " boxes in "
+              << std::fixed << std::setprecision(2) << buildMs << " ms, " << instances.size() << " instances, "
+              << views << " views" << std::endl;
+    std::cout << "  tiled:        " << mismatches << " mismatched pixels, " << tiledMs / views << " ms ("
+              << setupMs / views << " setup + " << rasterMs / views << " raster) against " << referenceMs / views
+              << " ms reference, " << JOB_SYSTEM.getThreadCount() << " threads" << std::endl;
+    std::cout << "  conservative: " << violations << " pixels nearer than the model, coverage "
+              << (fullPixels ? 100.0 * boxPixels / fullPixels : 0.0) << "%" << std::endl;
+    std::cout << "  culled:       " << boxCulled << " / " << probes << " probes by boxes, " << fullCulled
+              << " by triangles, " << unsafe << " wrongly" << std::endl;
+    std::cout << "  " << (bPassed ? "PASS" : "FAIL") << std::endl;
+    return bPassed;
+}
+
+int main(int argc, char** argv)
+{
+    int cells = 16;
+    int grid = 8;
+    int repeat = 10;
+    std::vector<std::string> models;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (i + 1 < argc && std::strcmp(argv[i], "--cells") == 0)
+            cells = std::max(1, std::atoi(argv[++i]));
+        else if (i + 1 < argc && std::strcmp(argv[i], "--grid") == 0)
+            grid = std::max(1, std::atoi(argv[++i]));
+        else if (i + 1 < argc && std::strcmp(argv[i], "--repeat") == 0)
+            repeat = std::max(1, std::atoi(argv[++i]));
+        else if (argv[i][0] != '-')
+            models.push_back(argv[i]);
+        else
+        {
+            printUsage();
+            return 1;
+        }
+    }
+    if (models.empty())
+    {
+        printUsage();
+        return 1;
+    }
+
+    JOB_SYSTEM.init();
+    bool bPassed = true;
+    for (const std::string& model : models)
+        bPassed = benchmarkModel(model, cells, grid, repeat) && bPassed;
+    JOB_SYSTEM.shutdown();
+    return bPassed ? 0 : 1;
+}
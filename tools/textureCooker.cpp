@@ -0,0 +1,94 @@
+/* Start Header -------------------------------------------------------
+Copyright (C) 2021 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the prior written
+consent of DigiPen Institute of Technology is prohibited.
+File Name: textureCooker.cpp
+Purpose: This file is the command line front end of the texture cooker.
+Language: c++
+Platform: VS2019 / Window
+Project:  HGraphics
+Author: Elliott Hong <s.hong@digipen.edu>
+Creation date: Oct 19, 2026
+End Header ---------------------------------------------------------*/
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "CookedTexture.h"
+#include "JobSystem.h"
+#include "TextureCooker.h"
+
+static void printUsage()
+{
+    std::cout << "usage: TextureCooker [--bc1 | --bc3 | --bc5 | --bc7] [--normal | --linear] [--clamp] [--no-mips] <image>..." << std::endl
+              << "  Writes <image>.htex next to each input. Without a format flag BC1 is used" << std::endl
+              << "  for opaque images, BC3 for images with alpha and BC5 for normal maps." << std::endl
+              << "  Mips are filtered in linear light unless --linear; --normal renormalizes them." << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    CookOptions options;
+    std::vector<std::string> inputs;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--bc1") == 0)
+            options.format = CookFormat::BC1;
+        else if (std::strcmp(argv[i], "--bc3") == 0)
+            options.format = CookFormat::BC3;
+        else if (std::strcmp(argv[i], "--bc5") == 0)
+            options.format = CookFormat::BC5;
+        else if (std::strcmp(argv[i], "--bc7") == 0)
+            options.format = CookFormat::BC7;
+        else if (std::strcmp(argv[i], "--normal") == 0)
+            options.content = MipContent::NORMAL;
+        else if (std::strcmp(argv[i], "--linear") == 0)
+            options.content = MipContent::LINEAR;
+        else if (std::strcmp(argv[i], "--clamp") == 0)
+            options.wrap = false;
+        else if (std::strcmp(argv[i], "--no-mips") == 0)
+            options.mipmaps = false;
+        else if (argv[i][0] == '-')
+        {
+            printUsage();
+            return 1;
+        }
+        else
+            inputs.emplace_back(argv[i]);
+    }
+
+    if (inputs.empty())
+    {
+        printUsage();
+        return 1;
+    }
+
+    JOB_SYSTEM.init();
+    int failed = 0;
+    for (const std::string& input : inputs)
+    {
+        const std::string output = CookedTexture::cookedPath(input);
+        const auto start = std::chrono::steady_clock::now();
+
+        TextureCooker::Result result;
+        if (!TextureCooker::cook(input, output, options, &result))
+        {
+            ++failed;
+            continue;
+        }
+
+        const float ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+        std::cout << output << ": " << result.width << "x" << result.height << " " << TextureCooker::getName(result.format)
+                  << ", " << result.levelCount << " levels, " << result.sourceBytes / 1024 << " KB -> "
+                  << result.cookedBytes / 1024 << " KB (" << ms << " ms)" << std::endl;
+    }
+
+    JOB_SYSTEM.shutdown();
+    return failed == 0 ? 0 : 1;
+}